@@ -259,6 +259,17 @@ function build(settings)
 		tools[i] = Link(settings, toolname, Compile(settings, v), engine, zlib, pnglite)
 	end
 
+	-- build benchmarks, not part of the default targets
+	benchmarks_src = Collect("src/benchmarks/*.cpp")
+	benchmarks_objs = {}
+	benchmarks_objs["serverbrowser"] = Compile(client_settings, "src/engine/client/serverbrowser.cpp")
+	benchmarks_objs["sound"] = Compile(client_settings, "src/engine/client/sound_mixer.cpp")
+	benchmarks = {}
+	for i,v in ipairs(benchmarks_src) do
+		benchname = PathFilename(PathBase(v))
+		benchmarks[i] = Link(settings, "bench_"..benchname, Compile(settings, v), benchmarks_objs[benchname] or {}, engine, zlib, pnglite)
+	end
+
 	-- build client, server, version server and master server
 	client_exe = Link(client_settings, "openfng", game_shared, game_client,
 		engine, client, game_editor, zlib, pnglite, wavpack,
@@ -267,6 +278,11 @@ function build(settings)
 	server_exe = Link(server_settings, "openfng_srv", engine, server,
 		game_shared, game_server, zlib, server_link_other)
 
+	-- bots that put load on a game server, not part of the default targets
+	loadgen = Compile(settings, Collect("src/loadgen/*.cpp"))
+	loadgen_exe = Link(server_settings, "game_loadgen", engine, loadgen,
+		game_shared, zlib, server_link_other)
+
 	serverlaunch = {}
 	if platform == "macosx" then
 		serverlaunch = Link(launcher_settings, "serverlaunch", server_osxlaunch)
@@ -278,6 +294,11 @@ function build(settings)
 	masterserver_exe = Link(server_settings, "mastersrv", masterserver,
 		engine, zlib)
 
+	-- headless replay of recorded input, not part of the default targets
+	replay = Compile(settings, Collect("src/replay/*.cpp"))
+	replay_exe = Link(server_settings, "openfng_replay", engine, replay,
+		game_shared, game_server, zlib, server_link_other)
+
 	-- make targets
 	c = PseudoTarget("client".."_"..settings.config_name, client_exe, client_depends)
 	s = PseudoTarget("server".."_"..settings.config_name, server_exe, serverlaunch)
@@ -286,6 +307,9 @@ function build(settings)
 	v = PseudoTarget("versionserver".."_"..settings.config_name, versionserver_exe)
 	m = PseudoTarget("masterserver".."_"..settings.config_name, masterserver_exe)
 	t = PseudoTarget("tools".."_"..settings.config_name, tools)
+	b = PseudoTarget("benchmarks".."_"..settings.config_name, benchmarks)
+	r = PseudoTarget("replay".."_"..settings.config_name, replay_exe)
+	l = PseudoTarget("loadgen".."_"..settings.config_name, loadgen_exe)
 
 	all = PseudoTarget(settings.config_name, c, s, v, m, t)
 	return all
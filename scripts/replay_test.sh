@@ -0,0 +1,32 @@
+#!/bin/sh
+# plays the recorded openfng game in src/replay/fixtures back and checks the
+# world against the recorded hashes, once with the event driven scoring and
+# once with the old path that looks at every client every tick. run it from
+# the source root, so the replay finds the maps and openfng.cfg the fixture
+# was recorded with:
+#   bam replay_release && scripts/replay_test.sh [path to openfng_replay]
+#
+# to record a new fixture, run the server from the source root with
+# sv_input_record set, put game_loadgen -a bots on it, gzip the record and
+# write the hashes with openfng_replay -o
+
+REPLAY=${1:-./openfng_replay}
+FIXTURE=src/replay/fixtures/openfng_scoring
+
+# an empty home, so configs in the user's own storage directory don't
+# change the game
+WORKDIR=`mktemp -d`
+trap 'rm -rf "$WORKDIR"' EXIT
+RECORD="$WORKDIR/openfng_scoring.rec"
+gunzip -c $FIXTURE.rec.gz > "$RECORD" || exit 1
+
+RESULT=0
+HOME="$WORKDIR" "$REPLAY" -c $FIXTURE.hashes "$RECORD" "dbg_fng_poll 0" || RESULT=1
+HOME="$WORKDIR" "$REPLAY" -c $FIXTURE.hashes "$RECORD" "dbg_fng_poll 1" || RESULT=1
+
+if [ $RESULT -eq 0 ]; then
+	echo "replay test passed"
+else
+	echo "replay test FAILED"
+fi
+exit $RESULT
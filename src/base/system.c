@@ -1,5 +1,9 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE /* sched_setaffinity */
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -17,6 +21,7 @@
 	#include <sys/stat.h>
 	#include <sys/types.h>
 	#include <sys/socket.h>
+	#include <sys/uio.h>
 	#include <sys/ioctl.h>
 	#include <errno.h>
 	#include <netdb.h>
@@ -27,6 +32,10 @@
 
 	#include <dirent.h>
 
+	#if defined(CONF_PLATFORM_LINUX)
+		#include <sched.h>
+	#endif
+
 	#if defined(CONF_PLATFORM_MACOSX)
 		#include <Carbon/Carbon.h>
 	#endif
@@ -185,6 +194,19 @@ typedef struct MEMTAIL
 static struct MEMHEADER *first = 0;
 static const int MEM_GUARD_VAL = 0xbaadc0de;
 
+/* the allocation list is shared by all threads, assets get decoded on the job threads */
+#if defined(CONF_FAMILY_UNIX)
+	static pthread_mutex_t memory_lock = PTHREAD_MUTEX_INITIALIZER;
+	static void mem_lock() { pthread_mutex_lock(&memory_lock); }
+	static void mem_unlock() { pthread_mutex_unlock(&memory_lock); }
+#elif defined(CONF_FAMILY_WINDOWS)
+	static volatile LONG memory_lock = 0;
+	static void mem_lock() { while(InterlockedCompareExchange(&memory_lock, 1, 0) != 0) Sleep(0); }
+	static void mem_unlock() { InterlockedExchange(&memory_lock, 0); }
+#else
+	#error not implemented on this platform
+#endif
+
 void *mem_alloc_debug(const char *filename, int line, unsigned size, unsigned alignment)
 {
 	/* TODO: fix alignment */
@@ -199,17 +221,19 @@ void *mem_alloc_debug(const char *filename, int line, unsigned size, unsigned al
 	header->filename = filename;
 	header->line = line;
 
+	tail->guard = MEM_GUARD_VAL;
+
+	mem_lock();
 	memory_stats.allocated += header->size;
 	memory_stats.total_allocations++;
 	memory_stats.active_allocations++;
 
-	tail->guard = MEM_GUARD_VAL;
-
 	header->prev = (MEMHEADER *)0;
 	header->next = first;
 	if(first)
 		first->prev = header;
 	first = header;
+	mem_unlock();
 
 	/*dbg_msg("mem", "++ %p", header+1); */
 	return header+1;
@@ -225,6 +249,7 @@ void mem_free(void *p)
 		if(tail->guard != MEM_GUARD_VAL)
 			dbg_msg("mem", "!! %p", p);
 		/* dbg_msg("mem", "-- %p", p); */
+		mem_lock();
 		memory_stats.allocated -= header->size;
 		memory_stats.active_allocations--;
 
@@ -234,6 +259,7 @@ void mem_free(void *p)
 			first = header->next;
 		if(header->next)
 			header->next->prev = header->prev;
+		mem_unlock();
 
 		free(header);
 	}
@@ -242,12 +268,14 @@ void mem_free(void *p)
 void mem_debug_dump(IOHANDLE file)
 {
 	char buf[1024];
-	MEMHEADER *header = first;
+	MEMHEADER *header;
 	if(!file)
 		file = io_open("memory.txt", IOFLAG_WRITE);
 
 	if(file)
 	{
+		mem_lock();
+		header = first;
 		while(header)
 		{
 			str_format(buf, sizeof(buf), "%s(%d): %d", header->filename, header->line, header->size);
@@ -255,6 +283,7 @@ void mem_debug_dump(IOHANDLE file)
 			io_write_newline(file);
 			header = header->next;
 		}
+		mem_unlock();
 
 		io_close(file);
 	}
@@ -320,6 +349,8 @@ IOHANDLE io_open(const char *filename, int flags)
 	}
 	if(flags == IOFLAG_WRITE)
 		return (IOHANDLE)fopen(filename, "wb");
+	if(flags == (IOFLAG_WRITE|IOFLAG_APPEND))
+		return (IOHANDLE)fopen(filename, "ab");
 	return 0x0;
 }
 
@@ -463,6 +494,25 @@ void thread_detach(void *thread)
 #endif
 }
 
+int thread_set_affinity(int core)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	cpu_set_t set;
+	if(core < 0 || core >= CPU_SETSIZE)
+		return -1;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	return sched_setaffinity(0, sizeof(set), &set);
+#elif defined(CONF_FAMILY_WINDOWS)
+	/* the mask has a bit per core, a wider shift is undefined */
+	if(core < 0 || core >= (int)(sizeof(DWORD_PTR)*8))
+		return -1;
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1<<core) ? 0 : -1;
+#else
+	return -1;
+#endif
+}
+
 
 
 
@@ -553,7 +603,12 @@ void lock_release(LOCK lock)
 /* -----  time ----- */
 int64 time_get()
 {
-#if defined(CONF_FAMILY_UNIX)
+#if defined(CONF_FAMILY_UNIX) && defined(CLOCK_MONOTONIC)
+	/* monotonic, so the tick scheduling doesn't jump with the wall clock */
+	struct timespec spec;
+	clock_gettime(CLOCK_MONOTONIC, &spec);
+	return (int64)spec.tv_sec*(int64)1000000+(int64)spec.tv_nsec/1000;
+#elif defined(CONF_FAMILY_UNIX)
 	struct timeval val;
 	gettimeofday(&val, NULL);
 	return (int64)val.tv_sec*(int64)1000000+(int64)val.tv_usec;
@@ -986,7 +1041,41 @@ NETSOCKET net_udp_create(NETADDR bindaddr)
 	return sock;
 }
 
+static int priv_net_sendto_vec(int sock, const struct sockaddr *sa, int salen, const void *head, int head_size, const void *data, int size)
+{
+	/* hand both parts to the kernel in one datagram, saves gluing them together first */
+#if defined(CONF_FAMILY_WINDOWS)
+	WSABUF bufs[2];
+	DWORD sent = 0;
+	bufs[0].buf = (char *)head;
+	bufs[0].len = head_size;
+	bufs[1].buf = (char *)data;
+	bufs[1].len = size;
+	if(WSASendTo((SOCKET)sock, bufs, 2, &sent, 0, sa, salen, NULL, NULL) != 0)
+		return -1;
+	return (int)sent;
+#else
+	struct iovec iov[2];
+	struct msghdr msg;
+	iov[0].iov_base = (void *)head;
+	iov[0].iov_len = head_size;
+	iov[1].iov_base = (void *)data;
+	iov[1].iov_len = size;
+	mem_zero(&msg, sizeof(msg));
+	msg.msg_name = (void *)sa;
+	msg.msg_namelen = salen;
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+	return sendmsg(sock, &msg, 0);
+#endif
+}
+
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size)
+{
+	return net_udp_send_vec(sock, addr, 0, 0, data, size);
+}
+
+int net_udp_send_vec(NETSOCKET sock, const NETADDR *addr, const void *head, int head_size, const void *data, int size)
 {
 	int d = -1;
 
@@ -1005,7 +1094,7 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in(addr, &sa);
 
-			d = sendto((int)sock.ipv4sock, (const char*)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			d = priv_net_sendto_vec((int)sock.ipv4sock, (struct sockaddr *)&sa, sizeof(sa), head, head_size, data, size);
 		}
 		else
 			dbg_msg("net", "can't sent ipv4 traffic to this socket");
@@ -1028,7 +1117,7 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in6(addr, &sa);
 
-			d = sendto((int)sock.ipv6sock, (const char*)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			d = priv_net_sendto_vec((int)sock.ipv6sock, (struct sockaddr *)&sa, sizeof(sa), head, head_size, data, size);
 		}
 		else
 			dbg_msg("net", "can't sent ipv6 traffic to this socket");
@@ -1049,7 +1138,7 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 		dbg_msg("net", "\taddr = %s", addrstr);
 
 	}*/
-	network_stats.sent_bytes += size;
+	network_stats.sent_bytes += head_size+size;
 	network_stats.sent_packets++;
 	return d;
 }
@@ -1525,13 +1614,18 @@ void swap_endian(void *data, unsigned elem_size, unsigned num)
 }
 
 int net_socket_read_wait(NETSOCKET sock, int time)
+{
+	return net_socket_read_wait_us(sock, time*1000);
+}
+
+int net_socket_read_wait_us(NETSOCKET sock, int time)
 {
 	struct timeval tv;
 	fd_set readfds;
 	int sockid;
 
-	tv.tv_sec = 0;
-	tv.tv_usec = 1000*time;
+	tv.tv_sec = time/1000000;
+	tv.tv_usec = time%1000000;
 	sockid = 0;
 
 	FD_ZERO(&readfds);
@@ -2036,6 +2130,263 @@ unsigned str_quickhash(const char *str)
 	return hash;
 }
 
+/* profiling */
+#if defined(_MSC_VER)
+	#define PERF_THREAD_LOCAL __declspec(thread)
+	#define perf_barrier() MemoryBarrier()
+#else
+	#define PERF_THREAD_LOCAL __thread
+	#define perf_barrier() __sync_synchronize()
+#endif
+
+enum
+{
+	PERF_RING_SIZE=8192, /* must be a power of two */
+	PERF_MAX_THREADS=32
+};
+
+typedef struct
+{
+	int zone;
+	int64 start;
+	int64 end;
+} PERF_EVENT;
+
+/* single producer (the owning thread), single consumer (perf_collect) */
+typedef struct
+{
+	PERF_EVENT events[PERF_RING_SIZE];
+	volatile unsigned write;
+	volatile unsigned read;
+	volatile unsigned dropped;
+	int index;
+} PERF_RING;
+
+static volatile int perf_sampling = 0;
+static LOCK perf_lock = 0;
+static PERF_ZONE_STATS perf_zones[PERF_MAX_ZONES];
+static int perf_zone_count = 0;
+static PERF_RING *perf_rings[PERF_MAX_THREADS];
+static int perf_ring_count = 0;
+static PERF_THREAD_LOCAL PERF_RING *perf_thread_ring = 0;
+static int64 perf_dropped_total = 0;
+static IOHANDLE perf_trace_file = 0;
+static int perf_trace_count = 0;
+static int64 perf_trace_epoch = 0;
+
+void perf_init()
+{
+	if(!perf_lock)
+		perf_lock = lock_create();
+}
+
+int perf_zone(const char *name)
+{
+	int i, zone = -1;
+	dbg_assert(perf_lock != 0, "perf_init wasn't called");
+
+	lock_wait(perf_lock);
+	for(i = 0; i < perf_zone_count; i++)
+	{
+		if(str_comp(perf_zones[i].name, name) == 0)
+		{
+			zone = i;
+			break;
+		}
+	}
+	if(zone == -1 && perf_zone_count < PERF_MAX_ZONES)
+	{
+		zone = perf_zone_count++;
+		mem_zero(&perf_zones[zone], sizeof(perf_zones[zone]));
+		perf_zones[zone].name = name;
+	}
+	lock_release(perf_lock);
+	return zone;
+}
+
+void perf_set_enabled(int enabled) { perf_sampling = enabled; }
+int perf_enabled() { return perf_sampling; }
+
+int64 perf_begin()
+{
+	if(!perf_sampling)
+		return 0;
+	return time_get();
+}
+
+static PERF_RING *perf_ring_create()
+{
+	PERF_RING *ring = 0;
+	lock_wait(perf_lock);
+	if(perf_ring_count < PERF_MAX_THREADS)
+	{
+		ring = (PERF_RING *)mem_alloc(sizeof(PERF_RING), 8);
+		mem_zero(ring, sizeof(PERF_RING));
+		ring->index = perf_ring_count;
+		perf_rings[perf_ring_count++] = ring;
+	}
+	lock_release(perf_lock);
+	return ring;
+}
+
+void perf_end(int zone, int64 start)
+{
+	PERF_RING *ring;
+	PERF_EVENT *e;
+	unsigned w;
+
+	if(!start || zone < 0)
+		return;
+
+	ring = perf_thread_ring;
+	if(!ring)
+	{
+		ring = perf_thread_ring = perf_ring_create();
+		if(!ring)
+			return;
+	}
+
+	w = ring->write;
+	if(w - ring->read >= PERF_RING_SIZE)
+	{
+		ring->dropped++;
+		return;
+	}
+
+	e = &ring->events[w&(PERF_RING_SIZE-1)];
+	e->zone = zone;
+	e->start = start;
+	e->end = time_get();
+	perf_barrier();
+	ring->write = w+1;
+}
+
+static void perf_trace_write(const PERF_EVENT *e, int tid)
+{
+	char buf[256];
+	int64 freq = time_freq();
+	str_format(buf, sizeof(buf), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.0f,\"dur\":%d}",
+		perf_trace_count ? ",\n" : "", perf_zones[e->zone].name, tid,
+		(double)(e->start-perf_trace_epoch)*1000000.0/freq, (int)((e->end-e->start)*1000000/freq));
+	io_write(perf_trace_file, buf, str_length(buf));
+	perf_trace_count++;
+}
+
+void perf_collect()
+{
+	int i, b;
+	unsigned r, w;
+	int64 freq = time_freq();
+
+	if(!perf_lock)
+		return;
+
+	lock_wait(perf_lock);
+	for(i = 0; i < perf_ring_count; i++)
+	{
+		PERF_RING *ring = perf_rings[i];
+		w = ring->write;
+		perf_barrier();
+		for(r = ring->read; r != w; r++)
+		{
+			const PERF_EVENT *e = &ring->events[r&(PERF_RING_SIZE-1)];
+			PERF_ZONE_STATS *zone = &perf_zones[e->zone];
+			int64 us = (e->end-e->start)*1000000/freq;
+
+			/* bucket n holds durations below 2^n microseconds */
+			for(b = 0; b < PERF_HISTOGRAM_BUCKETS-1 && us >= ((int64)1<<b); b++);
+			zone->buckets[b]++;
+			zone->count++;
+			zone->total += us;
+			if(us > zone->max)
+				zone->max = us;
+
+			if(perf_trace_file)
+				perf_trace_write(e, ring->index);
+		}
+		perf_barrier();
+		ring->read = w;
+
+		perf_dropped_total += ring->dropped;
+		ring->dropped = 0;
+	}
+	lock_release(perf_lock);
+}
+
+const PERF_ZONE_STATS *perf_zone_stats(int zone)
+{
+	if(zone < 0 || zone >= perf_zone_count)
+		return 0;
+	return &perf_zones[zone];
+}
+
+int perf_num_zones() { return perf_zone_count; }
+
+int64 perf_zone_percentile(const PERF_ZONE_STATS *stats, int percentile)
+{
+	int64 target, sum = 0;
+	int b;
+	if(!stats->count)
+		return 0;
+
+	target = (stats->count*percentile+99)/100;
+	for(b = 0; b < PERF_HISTOGRAM_BUCKETS-1; b++)
+	{
+		sum += stats->buckets[b];
+		if(sum >= target)
+			return (int64)1<<b;
+	}
+	return stats->max;
+}
+
+void perf_reset()
+{
+	int i;
+	if(!perf_lock)
+		return;
+
+	lock_wait(perf_lock);
+	for(i = 0; i < perf_zone_count; i++)
+	{
+		const char *name = perf_zones[i].name;
+		mem_zero(&perf_zones[i], sizeof(perf_zones[i]));
+		perf_zones[i].name = name;
+	}
+	perf_dropped_total = 0;
+	lock_release(perf_lock);
+}
+
+int64 perf_dropped() { return perf_dropped_total; }
+
+int perf_trace_start(const char *filename)
+{
+	IOHANDLE file;
+	perf_trace_stop();
+
+	file = io_open(filename, IOFLAG_WRITE);
+	if(!file)
+		return -1;
+
+	lock_wait(perf_lock);
+	io_write(file, "[\n", 2);
+	perf_trace_file = file;
+	perf_trace_count = 0;
+	perf_trace_epoch = time_get();
+	lock_release(perf_lock);
+	return 0;
+}
+
+void perf_trace_stop()
+{
+	if(!perf_trace_file)
+		return;
+
+	lock_wait(perf_lock);
+	io_write(perf_trace_file, "\n]\n", 3);
+	io_close(perf_trace_file);
+	perf_trace_file = 0;
+	lock_release(perf_lock);
+}
 
 #if defined(__cplusplus)
 }
@@ -182,6 +182,7 @@ enum {
 	IOFLAG_READ = 1,
 	IOFLAG_WRITE = 2,
 	IOFLAG_RANDOM = 4,
+	IOFLAG_APPEND = 8,
 
 	IOSEEK_START = 0,
 	IOSEEK_CUR = 1,
@@ -197,6 +198,7 @@ typedef struct IOINTERNAL *IOHANDLE;
 	Parameters:
 		filename - File to open.
 		flags - A set of flags. IOFLAG_READ, IOFLAG_WRITE, IOFLAG_RANDOM.
+			IOFLAG_WRITE|IOFLAG_APPEND appends to an existing file.
 
 	Returns:
 		Returns a handle to the file on success and 0 on failure.
@@ -397,6 +399,20 @@ void thread_yield();
 */
 void thread_detach(void *thread);
 
+/*
+	Function: thread_set_affinity
+		Pins the calling thread to a cpu core.
+
+	Parameters:
+		core - Index of the core.
+
+	Returns:
+		0 on success, -1 on failure, if the core is out of range for
+		this platform (64 cores on 64 bit windows, 32 on 32 bit) or if
+		not supported on this platform.
+*/
+int thread_set_affinity(int core);
+
 /* Group: Locks */
 typedef void* LOCK;
 
@@ -589,6 +605,25 @@ NETSOCKET net_udp_create(NETADDR bindaddr);
 */
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size);
 
+/*
+	Function: net_udp_send_vec
+		Sends two buffers as a single packet over an UDP socket,
+		without copying them together first.
+
+	Parameters:
+		sock - Socket to use.
+		addr - Where to send the packet.
+		head - Pointer to the start of the packet.
+		head_size - Size of the start of the packet.
+		data - Pointer to the rest of the packet.
+		size - Size of the rest of the packet.
+
+	Returns:
+		On success it returns the number of bytes sent. Returns -1
+		on error.
+*/
+int net_udp_send_vec(NETSOCKET sock, const NETADDR *addr, const void *head, int head_size, const void *data, int size);
+
 /*
 	Function: net_udp_recv
 		Recives a packet over an UDP socket.
@@ -1165,6 +1200,19 @@ int net_would_block();
 
 int net_socket_read_wait(NETSOCKET sock, int time);
 
+/*
+	Function: net_socket_read_wait_us
+		Waits until the socket has data to read or the timeout expires.
+
+	Parameters:
+		sock - Socket to wait on.
+		time - Timeout in microseconds.
+
+	Returns:
+		1 if there is data to read, 0 otherwise.
+*/
+int net_socket_read_wait_us(NETSOCKET sock, int time);
+
 void mem_debug_dump(IOHANDLE file);
 
 void swap_endian(void *data, unsigned elem_size, unsigned num);
@@ -1293,8 +1341,136 @@ int str_utf8_encode(char *ptr, int chr);
 */
 int str_utf8_check(const char *str);
 
+/* Group: Profiling */
+enum
+{
+	PERF_MAX_ZONES=64,
+	PERF_HISTOGRAM_BUCKETS=24
+};
+
+typedef struct
+{
+	const char *name;
+	int64 count;
+	int64 total; /* microseconds */
+	int64 max; /* microseconds */
+	int64 buckets[PERF_HISTOGRAM_BUCKETS];
+} PERF_ZONE_STATS;
+
+/*
+	Function: perf_init
+		Sets up the profiler. Call it once at startup, before any
+		other perf_ function and before starting threads.
+*/
+void perf_init();
+
+/*
+	Function: perf_zone
+		Looks up or registers a named profiling zone.
+
+	Parameters:
+		name - Zone name. The pointer is stored, so it has to stay valid.
+
+	Returns:
+		Zone id to pass to <perf_end>, or -1 if all zones are taken.
+
+	Remarks:
+		Register zones on the main thread before sampling from others.
+*/
+int perf_zone(const char *name);
+
+/*
+	Function: perf_set_enabled
+		Turns sampling on or off. While off <perf_begin> returns 0 and
+		<perf_end> returns immediately.
+*/
+void perf_set_enabled(int enabled);
+int perf_enabled();
+
+/*
+	Function: perf_begin
+		Starts timing a zone.
+
+	Returns:
+		Timestamp to pass to <perf_end>, 0 if sampling is off.
+*/
+int64 perf_begin();
+
+/*
+	Function: perf_end
+		Stops timing a zone and puts the sample into the calling thread's
+		ring buffer. Samples are dropped if the ring is full.
+*/
+void perf_end(int zone, int64 start);
+
+/*
+	Function: perf_collect
+		Drains the ring buffers of all threads into the zone histograms
+		and the trace file, if one is open.
+*/
+void perf_collect();
+
+/*
+	Function: perf_zone_stats
+		Returns the aggregated statistics of a zone, see <perf_collect>.
+*/
+const PERF_ZONE_STATS *perf_zone_stats(int zone);
+int perf_num_zones();
+
+/*
+	Function: perf_zone_percentile
+		Estimates a latency percentile from the histogram of a zone.
+
+	Parameters:
+		stats - Zone statistics.
+		percentile - Percentile between 0 and 100.
+
+	Returns:
+		Upper bound of the histogram bucket in microseconds.
+*/
+int64 perf_zone_percentile(const PERF_ZONE_STATS *stats, int percentile);
+
+/*
+	Function: perf_reset
+		Clears all zone histograms.
+*/
+void perf_reset();
+
+/*
+	Function: perf_dropped
+		Returns the number of samples lost to full ring buffers.
+*/
+int64 perf_dropped();
+
+/*
+	Function: perf_trace_start
+		Writes all further collected samples to a file in chrome trace
+		event format (load it via chrome://tracing).
+
+	Returns:
+		0 on success.
+*/
+int perf_trace_start(const char *filename);
+void perf_trace_stop();
+
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef __cplusplus
+class CPerfScope
+{
+	int m_Zone;
+	int64 m_Start;
+public:
+	CPerfScope(int Zone) : m_Zone(Zone), m_Start(perf_begin()) {}
+	~CPerfScope() { perf_end(m_Zone, m_Start); }
+};
+
+/* times the rest of the enclosing scope */
+#define PERF_SCOPE(name) \
+	static int s_PerfZone_##name = perf_zone(#name); \
+	CPerfScope PerfScope_##name(s_PerfZone_##name)
+#endif
+
 #endif
@@ -86,6 +86,19 @@ public:
 		num_elements = 0;
 	}
 
+	/*
+		Function: clear_keep
+			Removes all elements but keeps the allocated space
+			for the ones that get added next.
+
+		Remarks:
+			- Invalidates ranges
+	*/
+	void clear_keep()
+	{
+		num_elements = 0;
+	}
+
 	/*
 		Function: size
 	*/
@@ -242,7 +255,7 @@ public:
 	*/
 	void set_size(int new_size)
 	{
-		if(list_size < new_size)
+		if(list_size < new_size)
 			alloc(new_size);
 		num_elements = new_size;
 	}
@@ -0,0 +1,144 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/array.h>
+
+#include <engine/shared/jobs.h>
+
+#include <engine/external/pnglite/pnglite.h>
+
+// decodes the images the client loads at startup, once one after the other
+// like it used to and once on a job pool with the main thread taking the
+// results in order, which is what the game client does now. the texture
+// upload is stood in for by a copy and a checksum over the pixels.
+// run it from the directory that holds data/, or pass that directory
+
+enum
+{
+	NUM_THREADS=4, // same as the engine
+};
+
+struct CImageJob
+{
+	CJob m_Job;
+	char m_aFilename[512];
+	unsigned char *m_pData;
+	unsigned m_DataSize;
+};
+
+static array<CImageJob *> s_apJobs;
+
+static int AddFile(const char *pName, int IsDir, int DirType, void *pUser)
+{
+	int l = str_length(pName);
+	if(IsDir || l < 4 || str_comp(pName+l-4, ".png") != 0)
+		return 0;
+
+	CImageJob *pJob = new CImageJob;
+	str_format(pJob->m_aFilename, sizeof(pJob->m_aFilename), "%s/%s", (const char *)pUser, pName);
+	pJob->m_pData = 0;
+	pJob->m_DataSize = 0;
+	s_apJobs.add(pJob);
+	return 0;
+}
+
+static int DecodeJob(void *pUser)
+{
+	CImageJob *pJob = (CImageJob *)pUser;
+	png_t Png; // ignore_convention
+
+	int Error = png_open_file(&Png, pJob->m_aFilename); // ignore_convention
+	if(Error != PNG_NO_ERROR)
+	{
+		if(Error != PNG_FILE_ERROR)
+			png_close_file(&Png); // ignore_convention
+		return 0;
+	}
+	if(Png.depth != 8 || (Png.color_type != PNG_TRUECOLOR && Png.color_type != PNG_TRUECOLOR_ALPHA)) // ignore_convention
+	{
+		png_close_file(&Png); // ignore_convention
+		return 0;
+	}
+
+	pJob->m_DataSize = Png.width * Png.height * Png.bpp; // ignore_convention
+	pJob->m_pData = (unsigned char *)mem_alloc(pJob->m_DataSize, 1);
+	png_get_data(&Png, pJob->m_pData); // ignore_convention
+	png_close_file(&Png); // ignore_convention
+	return 1;
+}
+
+static unsigned Upload(CImageJob *pJob)
+{
+	static unsigned char s_aTexture[2048*2048*4];
+	unsigned Checksum = 0;
+	if(pJob->m_pData)
+	{
+		mem_copy(s_aTexture, pJob->m_pData, min(pJob->m_DataSize, (unsigned)sizeof(s_aTexture)));
+		for(unsigned i = 0; i < pJob->m_DataSize; i += 4)
+			Checksum = Checksum*31 + s_aTexture[i];
+		mem_free(pJob->m_pData);
+		pJob->m_pData = 0;
+	}
+	return Checksum;
+}
+
+static double Ms(int64 Ticks)
+{
+	return Ticks*1000.0/time_freq();
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	png_init(0, 0); // ignore_convention
+
+	const char *pDataDir = argc > 1 ? argv[1] : "data"; // ignore_convention
+	static char s_aSkins[512], s_aFlags[512];
+	str_format(s_aSkins, sizeof(s_aSkins), "%s/skins", pDataDir);
+	str_format(s_aFlags, sizeof(s_aFlags), "%s/countryflags", pDataDir);
+	fs_listdir(pDataDir, AddFile, 0, (void *)pDataDir);
+	fs_listdir(s_aSkins, AddFile, 0, s_aSkins);
+	fs_listdir(s_aFlags, AddFile, 0, s_aFlags);
+	if(!s_apJobs.size())
+	{
+		dbg_msg("bench", "no images found in '%s'", pDataDir);
+		return 1;
+	}
+
+	// the old way, decode and upload one after the other
+	unsigned SerialChecksum = 0;
+	int Failed = 0;
+	int64 Start = time_get();
+	for(int i = 0; i < s_apJobs.size(); i++)
+	{
+		if(!DecodeJob(s_apJobs[i]))
+			Failed++;
+		SerialChecksum += Upload(s_apJobs[i]);
+	}
+	int64 Serial = time_get()-Start;
+
+	// decode on the pool, upload in order on this thread
+	CJobPool Pool;
+	Pool.Init(NUM_THREADS);
+	unsigned PooledChecksum = 0;
+	Start = time_get();
+	for(int i = 0; i < s_apJobs.size(); i++)
+		Pool.Add(&s_apJobs[i]->m_Job, DecodeJob, s_apJobs[i]);
+	for(int i = 0; i < s_apJobs.size(); i++)
+	{
+		while(s_apJobs[i]->m_Job.Status() != CJob::STATE_DONE)
+			thread_yield();
+		PooledChecksum += Upload(s_apJobs[i]);
+	}
+	int64 Pooled = time_get()-Start;
+
+	dbg_msg("bench", "%d images (%d failed)", s_apJobs.size(), Failed);
+	dbg_msg("bench", "serial: %.2fms", Ms(Serial));
+	dbg_msg("bench", "%d job threads: %.2fms, %.1fx", (int)NUM_THREADS, Ms(Pooled), Ms(Serial)/Ms(Pooled));
+	dbg_msg("bench", "checksums %s", SerialChecksum == PooledChecksum ? "match" : "differ");
+
+	for(int i = 0; i < s_apJobs.size(); i++)
+		delete s_apJobs[i];
+	return SerialChecksum == PooledChecksum ? 0 : 1;
+}
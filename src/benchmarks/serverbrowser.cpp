@@ -0,0 +1,171 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h> // rand
+
+#include <base/system.h>
+
+#include <engine/config.h>
+#include <engine/console.h>
+#include <engine/friends.h>
+#include <engine/kernel.h>
+#include <engine/masterserver.h>
+
+#include <engine/shared/config.h>
+#include <engine/shared/memheap.h>
+
+#include <engine/client/serverbrowser.h>
+
+// feeds synthetic server infos into the browser the way a refresh does and
+// measures filtering and sorting, checking the incremental view against a full rebuild
+
+class CFakeFriends : public IFriends
+{
+public:
+	void Init() {}
+	int NumFriends() const { return 0; }
+	const CFriendInfo *GetFriend(int Index) const { return 0; }
+	int GetFriendState(const char *pName, const char *pClan) const { return FRIEND_NO; }
+	bool IsFriend(const char *pName, const char *pClan, bool PlayersOnly) const { return false; }
+	void AddFriend(const char *pName, const char *pClan) {}
+	void RemoveFriend(const char *pName, const char *pClan) {}
+};
+
+enum
+{
+	NUM_SERVERS=5000,
+};
+
+static const char *s_apMaps[] = {"dm1", "dm2", "dm6", "ctf1", "ctf5", "openfng5", "fng_space", "ghost", "blmapv3", "run_guy"};
+static const char *s_apGameTypes[] = {"DM", "TDM", "CTF", "fng2", "openfng", "DDRace", "iCTF"};
+static const char *s_apWords[] = {"Best", "Pro", "Fun", "German", "Brazil", "Nordic", "24/7", "Newbie", "Clan", "Private"};
+
+static NETADDR s_aAddrs[NUM_SERVERS];
+static CServerInfo s_aInfos[NUM_SERVERS];
+
+static void RandomizeInfo(CServerInfo *pInfo, int Index)
+{
+	mem_zero(pInfo, sizeof(*pInfo));
+	str_format(pInfo->m_aName, sizeof(pInfo->m_aName), "%s %s server #%d", s_apWords[rand()%10], s_apWords[rand()%10], Index);
+	str_copy(pInfo->m_aMap, s_apMaps[rand()%10], sizeof(pInfo->m_aMap));
+	str_copy(pInfo->m_aGameType, s_apGameTypes[rand()%7], sizeof(pInfo->m_aGameType));
+	str_copy(pInfo->m_aVersion, "0.6 626fce9a778df4d4", sizeof(pInfo->m_aVersion));
+	pInfo->m_MaxClients = 16;
+	pInfo->m_MaxPlayers = 16;
+	pInfo->m_NumClients = rand()%17;
+	pInfo->m_NumPlayers = pInfo->m_NumClients - (pInfo->m_NumClients ? rand()%(pInfo->m_NumClients+1) : 0);
+	pInfo->m_Flags = rand()%8 == 0 ? SERVER_FLAG_PASSWORD : 0;
+	for(int i = 0; i < pInfo->m_NumClients; i++)
+	{
+		str_format(pInfo->m_aClients[i].m_aName, sizeof(pInfo->m_aClients[i].m_aName), "player%d", rand()%100000);
+		str_copy(pInfo->m_aClients[i].m_aClan, s_apWords[rand()%10], sizeof(pInfo->m_aClients[i].m_aClan));
+		pInfo->m_aClients[i].m_Country = rand()%4 ? -1 : 276;
+		pInfo->m_aClients[i].m_Player = i < pInfo->m_NumPlayers;
+	}
+}
+
+static int64 FeedAll(CServerBrowser *pBrowser, bool ResortEach)
+{
+	int64 Start = time_get();
+	for(int i = 0; i < NUM_SERVERS; i++)
+	{
+		pBrowser->Set(s_aAddrs[i], IServerBrowser::SET_TOKEN, pBrowser->CurrentToken(), &s_aInfos[i]);
+		if(ResortEach)
+			pBrowser->Update(true);
+	}
+	return time_get()-Start;
+}
+
+static int CheckView(CServerBrowser *pBrowser)
+{
+	static NETADDR s_aView[NUM_SERVERS];
+	int Num = pBrowser->NumSortedServers();
+	for(int i = 0; i < Num; i++)
+		s_aView[i] = pBrowser->SortedGet(i)->m_NetAddr;
+
+	pBrowser->Update(true);
+
+	int Errors = Num == pBrowser->NumSortedServers() ? 0 : 1;
+	for(int i = 0; i < Num && i < pBrowser->NumSortedServers(); i++)
+		if(net_addr_comp(&s_aView[i], &pBrowser->SortedGet(i)->m_NetAddr) != 0 || pBrowser->SortedGet(i)->m_SortedIndex != i)
+			Errors++;
+	return Errors;
+}
+
+static double Ms(int64 Ticks)
+{
+	return Ticks*1000.0/time_freq();
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	srand(1);
+
+	IKernel *pKernel = IKernel::Create();
+	IConsole *pConsole = CreateConsole(CFGFLAG_CLIENT);
+	IConfig *pConfig = CreateConfig();
+	IEngineMasterServer *pMasterServer = CreateEngineMasterServer();
+	CFakeFriends Friends;
+	CServerBrowser ServerBrowser;
+
+	pKernel->RegisterInterface(pConsole);
+	pKernel->RegisterInterface(pConfig);
+	pKernel->RegisterInterface(static_cast<IMasterServer*>(pMasterServer));
+	pKernel->RegisterInterface(static_cast<IFriends*>(&Friends));
+	pKernel->RegisterInterface(static_cast<IServerBrowser*>(&ServerBrowser));
+	pConfig->Reset();
+
+	// no network is needed, infos are fed in directly and the favorites list is empty
+	ServerBrowser.SetBaseInfo(0, "0.6 626fce9a778df4d4");
+
+	for(int i = 0; i < NUM_SERVERS; i++)
+	{
+		mem_zero(&s_aAddrs[i], sizeof(s_aAddrs[i]));
+		s_aAddrs[i].type = NETTYPE_IPV4;
+		s_aAddrs[i].ip[0] = 10;
+		s_aAddrs[i].ip[1] = rand()%256;
+		s_aAddrs[i].ip[2] = i>>8;
+		s_aAddrs[i].ip[3] = i&0xff;
+		s_aAddrs[i].port = 8303;
+		RandomizeInfo(&s_aInfos[i], i);
+	}
+
+	g_Config.m_BrFilterEmpty = 1;
+	g_Config.m_BrFilterPw = 1;
+	g_Config.m_BrFilterPure = 0;
+	g_Config.m_BrFilterPureMap = 0;
+	str_copy(g_Config.m_BrFilterString, "server", sizeof(g_Config.m_BrFilterString));
+
+	static const char *s_apSortNames[] = {"name", "ping", "map", "gametype", "numplayers"};
+	int Errors = 0;
+	for(int Sort = IServerBrowser::SORT_NAME; Sort <= IServerBrowser::SORT_NUMPLAYERS; Sort++)
+	{
+		g_Config.m_BrSort = Sort;
+		g_Config.m_BrSortOrder = Sort&1;
+
+		ServerBrowser.Refresh(IServerBrowser::TYPE_FAVORITES);
+		int64 Insert = FeedAll(&ServerBrowser, false);
+		int Err = CheckView(&ServerBrowser);
+
+		// second round of infos, every server changes its place
+		for(int i = 0; i < NUM_SERVERS; i++)
+			RandomizeInfo(&s_aInfos[i], i);
+		int64 Update = FeedAll(&ServerBrowser, false);
+		Err += CheckView(&ServerBrowser);
+
+		int64 Start = time_get();
+		ServerBrowser.Update(true);
+		int64 Full = time_get()-Start;
+
+		dbg_msg("bench", "sort=%s: %d servers, %d shown, insert %.2fms, update %.2fms, full resort %.3fms, errors %d",
+			s_apSortNames[Sort], ServerBrowser.NumServers(), ServerBrowser.NumSortedServers(), Ms(Insert), Ms(Update), Ms(Full), Err);
+		Errors += Err;
+	}
+
+	// what it costs when every info triggers a full filter and sort
+	g_Config.m_BrSort = IServerBrowser::SORT_NAME;
+	ServerBrowser.Refresh(IServerBrowser::TYPE_FAVORITES);
+	dbg_msg("bench", "resorting after every info: %.2fms", Ms(FeedAll(&ServerBrowser, true)));
+
+	return Errors ? 1 : 0;
+}
@@ -0,0 +1,320 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h> // rand
+
+#include <base/system.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/snapshot.h>
+
+// records a stream of snapshot packets like a full high bandwidth server sends
+// them, then decodes it the way the client used to (unpack, crc pass, two
+// copies into the storage) and the way it does now, checking both give the
+// same snapshots. pass a number of ticks to record, the default is 30 seconds
+
+enum
+{
+	NUM_PLAYERS=16,
+	NUM_PICKUPS=24,
+	MAX_PROJECTILES=32,
+
+	// item types, sizes in ints like the game objects
+	TYPE_PLAYERINFO=1,
+	TYPE_CHARACTER,
+	TYPE_PROJECTILE,
+	TYPE_PICKUP,
+	TYPE_GAMEINFO,
+	TYPE_EVENT,
+	TYPE_NAME, // not statically sized
+	NUM_TYPES,
+};
+
+static const int s_aTypeSizes[NUM_TYPES] = {0, 5, 22, 6, 4, 8, 3, 0};
+
+struct CPacket
+{
+	int m_Tick;
+	int m_DeltaTick;
+	int m_Crc;
+	int m_Size;
+	unsigned char *m_pData;
+};
+
+static CSnapshotDelta s_Delta;
+static CPacket *s_pPackets = 0;
+static int s_NumPackets = 0;
+
+static void BuildSnapshot(CSnapshotBuilder *pBuilder, int Tick)
+{
+	static int s_aaCharacters[NUM_PLAYERS][22];
+	static int s_aaProjectiles[MAX_PROJECTILES][6];
+	static int s_aProjectileAlive[MAX_PROJECTILES];
+	static int s_EventID = 0;
+
+	pBuilder->Init();
+
+	int *pGameInfo = (int *)pBuilder->NewItem(TYPE_GAMEINFO, 0, s_aTypeSizes[TYPE_GAMEINFO]*4);
+	for(int i = 0; i < s_aTypeSizes[TYPE_GAMEINFO]; i++)
+		pGameInfo[i] = i == 0 ? Tick : 10;
+
+	for(int p = 0; p < NUM_PLAYERS; p++)
+	{
+		int *pInfo = (int *)pBuilder->NewItem(TYPE_PLAYERINFO, p, s_aTypeSizes[TYPE_PLAYERINFO]*4);
+		pInfo[0] = p == 0;
+		pInfo[1] = p;
+		pInfo[2] = p&1;
+		pInfo[3] = Tick/50 + p*3; // score
+		pInfo[4] = 40+p;
+
+		int *pName = (int *)pBuilder->NewItem(TYPE_NAME, p, 4*4);
+		for(int i = 0; i < 4; i++)
+			pName[i] = p*1000+i;
+
+		// players move every tick, some of them are dead now and then
+		if((Tick/100+p)%7 == 0)
+			continue;
+		int *pChar = s_aaCharacters[p];
+		pChar[0] = Tick;
+		pChar[1] += rand()%9-4;
+		pChar[2] += rand()%9-4;
+		pChar[3] = rand()%64-32;
+		pChar[4] = rand()%64-32;
+		pChar[5] = (pChar[5]+rand()%5)%256;
+		if(rand()%8 == 0)
+			pChar[6] = rand()%3;
+		if(rand()%16 == 0)
+			pChar[10] = rand()%10;
+		mem_copy(pBuilder->NewItem(TYPE_CHARACTER, p, s_aTypeSizes[TYPE_CHARACTER]*4), pChar, s_aTypeSizes[TYPE_CHARACTER]*4);
+	}
+
+	for(int i = 0; i < NUM_PICKUPS; i++)
+	{
+		if((Tick/250+i)%5 == 0)
+			continue;
+		int *pPickup = (int *)pBuilder->NewItem(TYPE_PICKUP, i, s_aTypeSizes[TYPE_PICKUP]*4);
+		pPickup[0] = i*64;
+		pPickup[1] = i*32;
+		pPickup[2] = i%3;
+		pPickup[3] = 0;
+	}
+
+	for(int i = 0; i < MAX_PROJECTILES; i++)
+	{
+		if(!s_aProjectileAlive[i] && rand()%20 == 0)
+		{
+			s_aProjectileAlive[i] = 40+rand()%40;
+			for(int k = 0; k < 6; k++)
+				s_aaProjectiles[i][k] = rand()%1000;
+			s_aaProjectiles[i][5] = Tick;
+		}
+		if(!s_aProjectileAlive[i])
+			continue;
+		s_aProjectileAlive[i]--;
+		mem_copy(pBuilder->NewItem(TYPE_PROJECTILE, i, s_aTypeSizes[TYPE_PROJECTILE]*4), s_aaProjectiles[i], s_aTypeSizes[TYPE_PROJECTILE]*4);
+	}
+
+	// events only live for one snapshot
+	int NumEvents = rand()%6;
+	for(int i = 0; i < NumEvents; i++)
+	{
+		int *pEvent = (int *)pBuilder->NewItem(TYPE_EVENT, s_EventID++&0x3fff, s_aTypeSizes[TYPE_EVENT]*4);
+		pEvent[0] = rand()%2000;
+		pEvent[1] = rand()%2000;
+		pEvent[2] = rand()%40;
+	}
+}
+
+static void RecordStream(int NumTicks)
+{
+	static CSnapshotBuilder s_Builder;
+	static char s_aaSnapshots[2][CSnapshot::MAX_SIZE];
+	static char s_aDelta[CSnapshot::MAX_SIZE];
+	static char s_aCompressed[CSnapshot::MAX_SIZE];
+	CSnapshot *pEmpty = (CSnapshot *)s_aaSnapshots[1];
+	pEmpty->Clear();
+
+	s_pPackets = (CPacket *)mem_alloc(sizeof(CPacket)*NumTicks, 1);
+	for(int Tick = 0; Tick < NumTicks; Tick++)
+	{
+		// the client acks every snapshot, so the previous one is the delta
+		CSnapshot *pCur = (CSnapshot *)s_aaSnapshots[Tick&1];
+		CSnapshot *pPrev = (CSnapshot *)s_aaSnapshots[(Tick+1)&1];
+		BuildSnapshot(&s_Builder, Tick);
+		s_Builder.Finish(pCur);
+
+		int DeltaSize = s_Delta.CreateDelta(pPrev, pCur, s_aDelta);
+		CPacket *pPacket = &s_pPackets[s_NumPackets++];
+		pPacket->m_Tick = Tick;
+		pPacket->m_DeltaTick = Tick-1;
+		pPacket->m_Crc = pCur->Crc();
+		pPacket->m_Size = DeltaSize ? CVariableInt::Compress(s_aDelta, DeltaSize, s_aCompressed) : 0;
+		pPacket->m_pData = (unsigned char *)mem_alloc(pPacket->m_Size+1, 1);
+		mem_copy(pPacket->m_pData, s_aCompressed, pPacket->m_Size);
+	}
+}
+
+// the unpacking the way it was, item lookups are linear searches
+static int UnpackDeltaReference(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData, int DataSize)
+{
+	static CSnapshotBuilder s_Builder;
+	CSnapshotDelta::CData *pDelta = (CSnapshotDelta::CData *)pSrcData;
+	int *pData = (int *)pDelta->m_pData;
+	int *pEnd = (int *)(((char *)pSrcData + DataSize));
+
+	s_Builder.Init();
+
+	int *pDeleted = pData;
+	pData += pDelta->m_NumDeletedItems;
+	if(pData > pEnd)
+		return -1;
+
+	for(int i = 0; i < pFrom->NumItems(); i++)
+	{
+		CSnapshotItem *pFromItem = pFrom->GetItem(i);
+		int ItemSize = pFrom->GetItemSize(i);
+		int Keep = 1;
+		for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
+		{
+			if(pDeleted[d] == pFromItem->Key())
+			{
+				Keep = 0;
+				break;
+			}
+		}
+		if(Keep)
+			mem_copy(s_Builder.NewItem(pFromItem->Type(), pFromItem->ID(), ItemSize), pFromItem->Data(), ItemSize);
+	}
+
+	for(int i = 0; i < pDelta->m_NumUpdateItems; i++)
+	{
+		if(pData+2 > pEnd)
+			return -1;
+		int Type = *pData++;
+		int ID = *pData++;
+		int ItemSize = s_aTypeSizes[Type]*4;
+		if(!ItemSize)
+			ItemSize = (*pData++) * 4;
+		int Key = (Type<<16)|ID;
+
+		int *pNewData = s_Builder.GetItemData(Key);
+		if(!pNewData)
+			pNewData = (int *)s_Builder.NewItem(Key>>16, Key&0xffff, ItemSize);
+
+		int FromIndex = pFrom->GetItemIndex(Key);
+		if(FromIndex != -1)
+		{
+			int *pPast = pFrom->GetItem(FromIndex)->Data();
+			for(int k = 0; k < ItemSize/4; k++)
+				pNewData[k] = pPast[k]+pData[k];
+		}
+		else
+			mem_copy(pNewData, pData, ItemSize);
+
+		pData += ItemSize/4;
+	}
+
+	return s_Builder.Finish(pTo);
+}
+
+static double Ms(int64 Ticks)
+{
+	return Ticks*1000.0/time_freq();
+}
+
+// decodes the whole stream into a storage, returns the crc errors. the
+// checksum goes over all bytes of the snapshots when verifying
+static int DecodeStream(bool Reference, bool Verify, int64 *pTime, unsigned *pChecksum)
+{
+	static int s_aDeltaData[CSnapshot::MAX_SIZE/sizeof(int)];
+	static int s_aUnpackData[CSnapshot::MAX_SIZE/sizeof(int)];
+	CSnapshotStorage Storage;
+	Storage.Init();
+	int Errors = 0;
+	*pChecksum = 0;
+
+	int64 Start = time_get();
+	for(int i = 0; i < s_NumPackets; i++)
+	{
+		const CPacket *pPacket = &s_pPackets[i];
+		static CSnapshot s_Empty;
+		CSnapshot *pDeltaShot = &s_Empty;
+		s_Empty.Clear();
+		if(pPacket->m_DeltaTick >= 0 && Storage.Get(pPacket->m_DeltaTick, 0, &pDeltaShot, 0) < 0)
+		{
+			Errors++;
+			continue;
+		}
+
+		void *pDeltaData = s_Delta.EmptyDelta();
+		int DeltaSize = sizeof(int)*3;
+		if(pPacket->m_Size)
+		{
+			DeltaSize = CVariableInt::Decompress(pPacket->m_pData, pPacket->m_Size, s_aDeltaData);
+			pDeltaData = s_aDeltaData;
+		}
+
+		CSnapshot *pSnap = (CSnapshot *)s_aUnpackData;
+		int SnapSize, Crc;
+		if(Reference)
+		{
+			SnapSize = UnpackDeltaReference(pDeltaShot, pSnap, pDeltaData, DeltaSize);
+			Crc = pSnap->Crc();
+		}
+		else
+			SnapSize = s_Delta.UnpackDelta(pDeltaShot, pSnap, pDeltaData, DeltaSize, &Crc);
+		if(SnapSize < 0 || Crc != pPacket->m_Crc)
+		{
+			Errors++;
+			continue;
+		}
+
+		Storage.PurgeUntil(pPacket->m_DeltaTick);
+		Storage.Add(pPacket->m_Tick, 0, SnapSize, pSnap, 1);
+		if(Reference)
+			Storage.m_pLast->DetachAlt(); // the alternative used to be copied right away
+		if(Verify)
+		{
+			for(int b = 0; b < SnapSize; b++)
+				*pChecksum = *pChecksum*31 + ((unsigned char *)pSnap)[b];
+		}
+	}
+	*pTime = time_get()-Start;
+
+	Storage.PurgeAll();
+	return Errors;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	srand(1);
+
+	int NumTicks = argc > 1 ? str_toint(argv[1]) : 50*30; // ignore_convention
+	if(NumTicks < 1)
+		NumTicks = 1;
+	for(int i = 0; i < NUM_TYPES; i++)
+		s_Delta.SetStaticsize(i, s_aTypeSizes[i]*4);
+
+	RecordStream(NumTicks);
+	int64 Bytes = 0;
+	for(int i = 0; i < s_NumPackets; i++)
+		Bytes += s_pPackets[i].m_Size;
+	dbg_msg("bench", "%d snapshots recorded, %d bytes compressed", s_NumPackets, (int)Bytes);
+
+	int64 RefTime, NewTime;
+	unsigned RefChecksum, NewChecksum;
+	int RefErrors = DecodeStream(true, false, &RefTime, &RefChecksum);
+	int NewErrors = DecodeStream(false, false, &NewTime, &NewChecksum);
+	int64 Dummy;
+	DecodeStream(true, true, &Dummy, &RefChecksum);
+	DecodeStream(false, true, &Dummy, &NewChecksum);
+
+	dbg_msg("bench", "reference: %.2fms, %.2fus per snapshot, %d errors", Ms(RefTime), Ms(RefTime)*1000.0/s_NumPackets, RefErrors);
+	dbg_msg("bench", "fast path: %.2fms, %.2fus per snapshot, %d errors, %.1fx", Ms(NewTime), Ms(NewTime)*1000.0/s_NumPackets, NewErrors, Ms(RefTime)/Ms(NewTime));
+	dbg_msg("bench", "snapshots %s", RefChecksum == NewChecksum ? "match" : "differ");
+
+	for(int i = 0; i < s_NumPackets; i++)
+		mem_free(s_pPackets[i].m_pData);
+	mem_free(s_pPackets);
+	return RefErrors || NewErrors || RefChecksum != NewChecksum ? 1 : 0;
+}
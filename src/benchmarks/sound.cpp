@@ -0,0 +1,181 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h> // rand
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/sound.h>
+#include <engine/client/sound_mixer.h>
+
+// mixes synthetic voices into a buffer the way the audio callback does, without
+// an audio device. checks the vector loops against the scalar ones and runs a
+// game thread that keeps starting and stopping sounds while the mixer is busy
+
+enum
+{
+	MIXING_RATE=48000,
+	BUFFER_FRAMES=512,
+	NUM_TEST_SAMPLES=16,
+	MIX_SECONDS=10,
+};
+
+static CSoundMixer s_Mixer;
+static short s_aOut[BUFFER_FRAMES*2];
+static volatile int s_ProducerRunning = 0;
+static int s_Plays = 0;
+static int s_Drops = 0;
+
+static void CreateSamples()
+{
+	for(int i = 0; i < NUM_TEST_SAMPLES; i++)
+	{
+		CSoundMixer::CSample *pSample = &s_Mixer.m_aSamples[i];
+		pSample->m_Channels = 1 + (i&1);
+		pSample->m_Rate = MIXING_RATE;
+		pSample->m_NumFrames = MIXING_RATE/10 + rand()%(MIXING_RATE*2) + 1;
+		pSample->m_pData = (short *)mem_alloc(pSample->m_NumFrames*pSample->m_Channels*sizeof(short), 1);
+		for(int f = 0; f < pSample->m_NumFrames*pSample->m_Channels; f++)
+			pSample->m_pData[f] = (short)(rand()%65536 - 32768);
+	}
+}
+
+static int CheckLoops()
+{
+	static short s_aIn[1024*2];
+	static int s_aVector[1024*2];
+	static int s_aScalar[1024*2];
+	static short s_aVectorOut[1024*2];
+	static short s_aScalarOut[1024*2];
+	int Errors = 0;
+
+	for(int Run = 0; Run < 200; Run++)
+	{
+		int Channels = 1 + (Run&1);
+		unsigned Frames = rand()%1024;
+		int Lvol = rand()%256;
+		int Rvol = rand()%256;
+		for(int i = 0; i < 1024*2; i++)
+		{
+			s_aIn[i] = (short)(rand()%65536 - 32768);
+			s_aVector[i] = s_aScalar[i] = (rand()%65536 - 32768)*(rand()%64);
+		}
+
+		CSoundMixer::MixFrames(s_aVector, s_aIn, Channels, Frames, Lvol, Rvol);
+		CSoundMixer::MixFramesScalar(s_aScalar, s_aIn, Channels, Frames, Lvol, Rvol);
+		if(mem_comp(s_aVector, s_aScalar, sizeof(s_aVector)) != 0)
+			Errors++;
+
+		CSoundMixer::ClampOutput(s_aVectorOut, s_aVector, Frames*2, Run%101);
+		CSoundMixer::ClampOutputScalar(s_aScalarOut, s_aScalar, Frames*2, Run%101);
+		if(mem_comp(s_aVectorOut, s_aScalarOut, Frames*2*sizeof(short)) != 0)
+			Errors++;
+	}
+	return Errors;
+}
+
+static double Ms(int64 Ticks)
+{
+	return Ticks*1000.0/time_freq();
+}
+
+static void MixVoices(int NumVoices, bool Positioned)
+{
+	s_Mixer.StopAll();
+	s_Mixer.m_CenterX = 0;
+	s_Mixer.m_CenterY = 0;
+	for(int i = 0; i < CSoundMixer::NUM_CHANNELS; i++)
+		s_Mixer.m_aChannels[i].m_Pan = Positioned ? 255 : 0;
+	for(int i = 0; i < NumVoices; i++)
+	{
+		// half of the positioned sounds are out of range, like on a busy map
+		int Flags = ISound::FLAG_LOOP | (Positioned ? ISound::FLAG_POS : 0);
+		int x = Positioned ? (rand()%(CSoundMixer::FALLOFF_RANGE*4)) - CSoundMixer::FALLOFF_RANGE*2 : 0;
+		s_Mixer.Play(i%CSoundMixer::NUM_CHANNELS, i%NUM_TEST_SAMPLES, Flags, x, 0);
+	}
+
+	int Buffers = MIX_SECONDS*MIXING_RATE/BUFFER_FRAMES;
+	int64 Start = time_get();
+	for(int i = 0; i < Buffers; i++)
+		s_Mixer.Mix(s_aOut, BUFFER_FRAMES);
+	int64 Time = time_get()-Start;
+
+	dbg_msg("bench", "%2d voices%s: %ds of audio in %.2fms, %.1fus per buffer, %.0fx realtime",
+		NumVoices, Positioned ? " (positioned)" : "", (int)MIX_SECONDS, Ms(Time), Ms(Time)*1000.0/Buffers, MIX_SECONDS*1000.0/Ms(Time));
+}
+
+static void ProducerThread(void *pUser)
+{
+	// the game thread, fire sounds and stop some of them again
+	while(s_ProducerRunning)
+	{
+		int Sample = rand()%NUM_TEST_SAMPLES;
+		if(s_Mixer.Play(rand()%CSoundMixer::NUM_CHANNELS, Sample, rand()%4 == 0 ? ISound::FLAG_LOOP : 0, 0, 0) >= 0)
+			s_Plays++;
+		else
+			s_Drops++;
+		if(rand()%8 == 0)
+			s_Mixer.Stop(rand()%NUM_TEST_SAMPLES);
+		if(rand()%500 == 0)
+			s_Mixer.StopAll();
+		thread_sleep(0);
+	}
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	srand(1);
+
+	s_Mixer.Init(BUFFER_FRAMES);
+	CreateSamples();
+
+	int Errors = CheckLoops();
+	dbg_msg("bench", "vector against scalar loops: %d errors", Errors);
+
+	static const int s_aNumVoices[] = {1, 8, 16, 32, 64};
+	for(unsigned i = 0; i < sizeof(s_aNumVoices)/sizeof(s_aNumVoices[0]); i++)
+		MixVoices(s_aNumVoices[i], false);
+	MixVoices(CSoundMixer::NUM_VOICES, true);
+
+	// scalar loops for comparison
+	{
+		static int s_aMix[BUFFER_FRAMES*2];
+		int Buffers = MIX_SECONDS*MIXING_RATE/BUFFER_FRAMES;
+		int64 Start = time_get();
+		for(int b = 0; b < Buffers; b++)
+		{
+			mem_zero(s_aMix, sizeof(s_aMix));
+			for(int v = 0; v < CSoundMixer::NUM_VOICES; v++)
+			{
+				CSoundMixer::CSample *pSample = &s_Mixer.m_aSamples[v%NUM_TEST_SAMPLES];
+				int Offset = (b*BUFFER_FRAMES)%(pSample->m_NumFrames-BUFFER_FRAMES > 0 ? pSample->m_NumFrames-BUFFER_FRAMES : 1);
+				CSoundMixer::MixFramesScalar(s_aMix, &pSample->m_pData[Offset*pSample->m_Channels], pSample->m_Channels, min((int)BUFFER_FRAMES, pSample->m_NumFrames), 255, 255);
+			}
+			CSoundMixer::ClampOutputScalar(s_aOut, s_aMix, BUFFER_FRAMES*2, 100);
+		}
+		int64 Time = time_get()-Start;
+		dbg_msg("bench", "64 voices, scalar loops: %ds of audio in %.2fms", (int)MIX_SECONDS, Ms(Time));
+	}
+
+	// mix while another thread keeps feeding the command queue
+	s_Mixer.StopAll();
+	s_ProducerRunning = 1;
+	void *pThread = thread_create(ProducerThread, 0);
+	int64 Start = time_get();
+	int Buffers = 0;
+	while(time_get() < Start + time_freq())
+	{
+		s_Mixer.Mix(s_aOut, BUFFER_FRAMES);
+		Buffers++;
+	}
+	s_ProducerRunning = 0;
+	thread_wait(pThread);
+	dbg_msg("bench", "concurrent: %d buffers mixed, %d sounds started, %d dropped", Buffers, s_Plays, s_Drops);
+
+	s_Mixer.Shutdown();
+	for(int i = 0; i < NUM_TEST_SAMPLES; i++)
+		mem_free(s_Mixer.m_aSamples[i].m_pData);
+
+	return Errors ? 1 : 0;
+}
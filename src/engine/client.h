@@ -112,6 +112,7 @@ public:
 	// TODO: Refactor: should redo this a bit i think, too many virtual calls
 	virtual int SnapNumItems(int SnapID) = 0;
 	virtual void *SnapFindItem(int SnapID, int Type, int ID) = 0;
+	// the item data is shared with the snapshot the next one is unpacked from, don't change it
 	virtual void *SnapGetItem(int SnapID, int Index, CSnapItem *pItem) = 0;
 	virtual void SnapInvalidateItem(int SnapID, int Index) = 0;
 
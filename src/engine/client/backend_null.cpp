@@ -0,0 +1,189 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+
+#include "backend_null.h"
+#include "sdl_semaphore.h"
+
+static int TexFormatPixelSize(int Format)
+{
+	if(Format == CCommandBuffer::TEXFORMAT_RGB)
+		return 3;
+	if(Format == CCommandBuffer::TEXFORMAT_ALPHA)
+		return 1;
+	return 4;
+}
+
+CGraphicsBackend_Null::CGraphicsBackend_Null()
+{
+	mem_zero(m_aTextureMemSize, sizeof(m_aTextureMemSize));
+	m_TextureMemoryUsage = 0;
+	mem_zero(m_aQuadBlockSize, sizeof(m_aQuadBlockSize));
+	mem_zero(&m_Current, sizeof(m_Current));
+	mem_zero(&m_Last, sizeof(m_Last));
+	mem_zero(&m_Total, sizeof(m_Total));
+	mem_zero(&m_Peak, sizeof(m_Peak));
+	m_NumFrames = 0;
+	m_LastSwap = 0;
+	m_FrameTimeTotal = 0;
+	m_FrameTimeMin = 0;
+	m_FrameTimeMax = 0;
+}
+
+int CGraphicsBackend_Null::Init(const char *pName, int *Width, int *Height, int FsaaSamples, int Flags)
+{
+	// there is no desktop to take the resolution from
+	if(*Width == 0 || *Height == 0)
+	{
+		*Width = 1920;
+		*Height = 1080;
+	}
+
+	dbg_msg("gfx", "headless backend, %dx%d", *Width, *Height);
+	m_LastSwap = time_get();
+	return 0;
+}
+
+int CGraphicsBackend_Null::Shutdown()
+{
+	PrintStats();
+	return 0;
+}
+
+int CGraphicsBackend_Null::MemoryUsage() const
+{
+	return m_TextureMemoryUsage;
+}
+
+void CGraphicsBackend_Null::Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand)
+{
+	int Size = pCommand->m_Width*pCommand->m_Height*TexFormatPixelSize(pCommand->m_StoreFormat);
+	m_TextureMemoryUsage += Size - m_aTextureMemSize[pCommand->m_Slot];
+	m_aTextureMemSize[pCommand->m_Slot] = Size;
+
+	m_Current.m_TextureUploads++;
+	m_Current.m_TextureBytes += pCommand->m_Width*pCommand->m_Height*pCommand->m_PixelSize;
+	mem_free(pCommand->m_pData);
+}
+
+void CGraphicsBackend_Null::Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand)
+{
+	m_Current.m_TextureUploads++;
+	m_Current.m_TextureBytes += pCommand->m_Width*pCommand->m_Height*TexFormatPixelSize(pCommand->m_Format);
+	mem_free(pCommand->m_pData);
+}
+
+void CGraphicsBackend_Null::Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand)
+{
+	m_TextureMemoryUsage -= m_aTextureMemSize[pCommand->m_Slot];
+	m_aTextureMemSize[pCommand->m_Slot] = 0;
+}
+
+void CGraphicsBackend_Null::Cmd_QuadBlock_Create(const CCommandBuffer::SCommand_QuadBlock_Create *pCommand)
+{
+	m_aQuadBlockSize[pCommand->m_Slot] = pCommand->m_NumQuads;
+	mem_free(pCommand->m_pVertices);
+}
+
+void CGraphicsBackend_Null::Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand)
+{
+	m_Current.m_DrawCalls++;
+	if(pCommand->m_PrimType == CCommandBuffer::PRIMTYPE_QUADS)
+		m_Current.m_Vertices += pCommand->m_PrimCount*4;
+	else if(pCommand->m_PrimType == CCommandBuffer::PRIMTYPE_LINES)
+		m_Current.m_Vertices += pCommand->m_PrimCount*2;
+}
+
+void CGraphicsBackend_Null::Cmd_RenderQuadBlock(const CCommandBuffer::SCommand_RenderQuadBlock *pCommand)
+{
+	m_Current.m_DrawCalls++;
+	m_Current.m_Vertices += m_aQuadBlockSize[pCommand->m_Slot]*4;
+}
+
+void CGraphicsBackend_Null::Cmd_Swap(const CCommandBuffer::SCommand_Swap *pCommand)
+{
+	int64 Now = time_get();
+	int64 FrameTime = Now - m_LastSwap;
+	m_LastSwap = Now;
+
+	m_FrameTimeTotal += FrameTime;
+	if(m_NumFrames == 0 || FrameTime < m_FrameTimeMin)
+		m_FrameTimeMin = FrameTime;
+	if(FrameTime > m_FrameTimeMax)
+		m_FrameTimeMax = FrameTime;
+
+	m_Total.m_DrawCalls += m_Current.m_DrawCalls;
+	m_Total.m_Vertices += m_Current.m_Vertices;
+	m_Total.m_TextureUploads += m_Current.m_TextureUploads;
+	m_Total.m_TextureBytes += m_Current.m_TextureBytes;
+	m_Total.m_CommandBytes += m_Current.m_CommandBytes;
+	m_Total.m_Buffers += m_Current.m_Buffers;
+
+	m_Peak.m_DrawCalls = max(m_Peak.m_DrawCalls, m_Current.m_DrawCalls);
+	m_Peak.m_Vertices = max(m_Peak.m_Vertices, m_Current.m_Vertices);
+	m_Peak.m_TextureUploads = max(m_Peak.m_TextureUploads, m_Current.m_TextureUploads);
+	m_Peak.m_TextureBytes = max(m_Peak.m_TextureBytes, m_Current.m_TextureBytes);
+	m_Peak.m_CommandBytes = max(m_Peak.m_CommandBytes, m_Current.m_CommandBytes);
+	m_Peak.m_Buffers = max(m_Peak.m_Buffers, m_Current.m_Buffers);
+
+	m_Last = m_Current;
+	mem_zero(&m_Current, sizeof(m_Current));
+	m_NumFrames++;
+}
+
+void CGraphicsBackend_Null::Cmd_VideoModes(const CCommandBuffer::SCommand_VideoModes *pCommand)
+{
+	*pCommand->m_pNumModes = 0;
+}
+
+void CGraphicsBackend_Null::RunBuffer(CCommandBuffer *pBuffer)
+{
+	// commands and vertices, including the swap and texture commands
+	m_Current.m_CommandBytes += pBuffer->m_CmdBuffer.DataUsed() + pBuffer->m_DataBuffer.DataUsed();
+	m_Current.m_Buffers++;
+
+	unsigned CmdIndex = 0;
+	while(1)
+	{
+		const CCommandBuffer::SCommand *pBaseCommand = pBuffer->GetCommand(&CmdIndex);
+		if(pBaseCommand == 0x0)
+			break;
+
+		switch(pBaseCommand->m_Cmd)
+		{
+		case CCommandBuffer::CMD_NOP: break;
+		case CCommandBuffer::CMD_SIGNAL: static_cast<const CCommandBuffer::SCommand_Signal *>(pBaseCommand)->m_pSemaphore->signal(); break;
+		case CCommandBuffer::CMD_TEXTURE_CREATE: Cmd_Texture_Create(static_cast<const CCommandBuffer::SCommand_Texture_Create *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_TEXTURE_DESTROY: Cmd_Texture_Destroy(static_cast<const CCommandBuffer::SCommand_Texture_Destroy *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_TEXTURE_UPDATE: Cmd_Texture_Update(static_cast<const CCommandBuffer::SCommand_Texture_Update *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_CLEAR: break;
+		case CCommandBuffer::CMD_QUADBLOCK_CREATE: Cmd_QuadBlock_Create(static_cast<const CCommandBuffer::SCommand_QuadBlock_Create *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_QUADBLOCK_DESTROY: m_aQuadBlockSize[static_cast<const CCommandBuffer::SCommand_QuadBlock_Destroy *>(pBaseCommand)->m_Slot] = 0; break;
+		case CCommandBuffer::CMD_RENDER: Cmd_Render(static_cast<const CCommandBuffer::SCommand_Render *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_RENDER_QUADBLOCK: Cmd_RenderQuadBlock(static_cast<const CCommandBuffer::SCommand_RenderQuadBlock *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_SWAP: Cmd_Swap(static_cast<const CCommandBuffer::SCommand_Swap *>(pBaseCommand)); break;
+		case CCommandBuffer::CMD_SCREENSHOT: break; // leaves the image empty
+		case CCommandBuffer::CMD_VIDEOMODES: Cmd_VideoModes(static_cast<const CCommandBuffer::SCommand_VideoModes *>(pBaseCommand)); break;
+		default: dbg_msg("graphics", "unknown command %d", pBaseCommand->m_Cmd);
+		}
+	}
+}
+
+void CGraphicsBackend_Null::PrintStats() const
+{
+	if(!m_NumFrames)
+		return;
+
+	double Freq = time_freq()/1000.0;
+	int Frames = m_NumFrames;
+	dbg_msg("gfx", "%d frames, frame time avg=%.3fms min=%.3fms max=%.3fms",
+		Frames, m_FrameTimeTotal/Freq/Frames, m_FrameTimeMin/Freq, m_FrameTimeMax/Freq);
+	dbg_msg("gfx", "per frame avg/peak: draw calls %d/%d, vertices %d/%d, command bytes %d/%d, buffers %.2f/%d",
+		(int)(m_Total.m_DrawCalls/Frames), (int)m_Peak.m_DrawCalls, (int)(m_Total.m_Vertices/Frames), (int)m_Peak.m_Vertices,
+		(int)(m_Total.m_CommandBytes/Frames), (int)m_Peak.m_CommandBytes, m_Total.m_Buffers/(float)Frames, (int)m_Peak.m_Buffers);
+	dbg_msg("gfx", "texture uploads %d (%d kb), peak %d (%d kb) in one frame, %d kb of texture memory",
+		(int)m_Total.m_TextureUploads, (int)(m_Total.m_TextureBytes/1024), (int)m_Peak.m_TextureUploads, (int)(m_Peak.m_TextureBytes/1024), m_TextureMemoryUsage/1024);
+}
+
+IGraphicsBackend *CreateGraphicsBackendNull() { return new CGraphicsBackend_Null; }
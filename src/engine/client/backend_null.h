@@ -0,0 +1,72 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_CLIENT_BACKEND_NULL_H
+#define ENGINE_CLIENT_BACKEND_NULL_H
+
+#include "graphics_threaded.h"
+
+// graphics backend without a window or GL context. command buffers are consumed
+// right away on the main thread and only counted, so the client side cost of
+// building them can be measured on machines without a gpu
+class CGraphicsBackend_Null : public IGraphicsBackend
+{
+public:
+	struct CFrameStats
+	{
+		int64 m_DrawCalls;
+		int64 m_Vertices;
+		int64 m_TextureUploads;
+		int64 m_TextureBytes;
+		int64 m_CommandBytes;
+		int64 m_Buffers;
+	};
+
+private:
+	int m_aTextureMemSize[CCommandBuffer::MAX_TEXTURES];
+	int m_TextureMemoryUsage;
+	int m_aQuadBlockSize[CCommandBuffer::MAX_QUAD_BLOCKS];
+
+	CFrameStats m_Current;
+	CFrameStats m_Last;
+	CFrameStats m_Total; // over all frames
+	CFrameStats m_Peak;
+	int m_NumFrames;
+
+	// time spent between swaps, that is everything the client does for a frame
+	int64 m_LastSwap;
+	int64 m_FrameTimeTotal;
+	int64 m_FrameTimeMin;
+	int64 m_FrameTimeMax;
+
+	void Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand);
+	void Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand);
+	void Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand);
+	void Cmd_QuadBlock_Create(const CCommandBuffer::SCommand_QuadBlock_Create *pCommand);
+	void Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand);
+	void Cmd_RenderQuadBlock(const CCommandBuffer::SCommand_RenderQuadBlock *pCommand);
+	void Cmd_Swap(const CCommandBuffer::SCommand_Swap *pCommand);
+	void Cmd_VideoModes(const CCommandBuffer::SCommand_VideoModes *pCommand);
+
+public:
+	CGraphicsBackend_Null();
+
+	virtual int Init(const char *pName, int *Width, int *Height, int FsaaSamples, int Flags);
+	virtual int Shutdown();
+
+	virtual int MemoryUsage() const;
+
+	virtual void Minimize() {}
+	virtual void Maximize() {}
+	virtual int WindowActive() { return 1; }
+	virtual int WindowOpen() { return 1; }
+
+	virtual void RunBuffer(CCommandBuffer *pBuffer);
+	virtual bool IsIdle() const { return true; }
+	virtual void WaitForIdle() {}
+
+	int NumFrames() const { return m_NumFrames; }
+	const CFrameStats &LastFrame() const { return m_Last; }
+	void PrintStats() const;
+};
+
+#endif
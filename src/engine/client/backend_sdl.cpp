@@ -2,6 +2,7 @@
 #include "SDL.h"
 #include "SDL_opengl.h"
 
+#include <base/math.h>
 #include <base/tl/threading.h>
 
 #include "graphics_threaded.h"
@@ -201,7 +202,7 @@ void CCommandProcessorFragment_OpenGL::Cmd_Init(const SCommand_Init *pCommand)
 void CCommandProcessorFragment_OpenGL::Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand)
 {
 	glBindTexture(GL_TEXTURE_2D, m_aTextures[pCommand->m_Slot].m_Tex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, pCommand->m_X, pCommand->m_Y, pCommand->m_Width, pCommand->m_Height,
+	glTexSubImage2D(GL_TEXTURE_2D, pCommand->m_Level, pCommand->m_X, pCommand->m_Y, pCommand->m_Width, pCommand->m_Height,
 		TexFormatToOpenGLFormat(pCommand->m_Format), GL_UNSIGNED_BYTE, pCommand->m_pData);
 	mem_free(pCommand->m_pData);
 }
@@ -221,7 +222,7 @@ void CCommandProcessorFragment_OpenGL::Cmd_Texture_Create(const CCommandBuffer::
 	// resample if needed
 	if(pCommand->m_Format == CCommandBuffer::TEXFORMAT_RGBA || pCommand->m_Format == CCommandBuffer::TEXFORMAT_RGB)
 	{
-		int MaxTexSize;
+		int MaxTexSize;
 		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
 		if(Width > MaxTexSize || Height > MaxTexSize)
 		{
@@ -269,6 +270,15 @@ void CCommandProcessorFragment_OpenGL::Cmd_Texture_Create(const CCommandBuffer::
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexImage2D(GL_TEXTURE_2D, 0, StoreOglformat, Width, Height, 0, Oglformat, GL_UNSIGNED_BYTE, pTexData);
 	}
+	else if(pCommand->m_NumLevels)
+	{
+		// only the levels the owner fills in, the rest would never be updated
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pCommand->m_NumLevels-1);
+		for(int l = 0; l < pCommand->m_NumLevels; l++)
+			glTexImage2D(GL_TEXTURE_2D, l, StoreOglformat, max(Width>>l, 1), max(Height>>l, 1), 0, Oglformat, GL_UNSIGNED_BYTE, pTexData);
+	}
 	else
 	{
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -278,7 +288,9 @@ void CCommandProcessorFragment_OpenGL::Cmd_Texture_Create(const CCommandBuffer::
 
 	// calculate memory usage
 	m_aTextures[pCommand->m_Slot].m_MemSize = Width*Height*pCommand->m_PixelSize;
-	while(Width > 2 && Height > 2)
+	for(int l = 1; l < pCommand->m_NumLevels; l++)
+		m_aTextures[pCommand->m_Slot].m_MemSize += max(Width>>l, 1)*max(Height>>l, 1)*pCommand->m_PixelSize;
+	while(!pCommand->m_NumLevels && Width > 2 && Height > 2)
 	{
 		Width>>=1;
 		Height>>=1;
@@ -319,6 +331,65 @@ void CCommandProcessorFragment_OpenGL::Cmd_Render(const CCommandBuffer::SCommand
 	};
 }
 
+void CCommandProcessorFragment_OpenGL::Cmd_QuadBlock_Create(const CCommandBuffer::SCommand_QuadBlock_Create *pCommand)
+{
+	CQuadBlock *pBlock = &m_aQuadBlocks[pCommand->m_Slot];
+	if(pBlock->m_pVertices)
+		mem_free(pBlock->m_pVertices);
+	pBlock->m_pVertices = pCommand->m_pVertices;
+	pBlock->m_NumQuads = pCommand->m_NumQuads;
+}
+
+void CCommandProcessorFragment_OpenGL::Cmd_QuadBlock_Destroy(const CCommandBuffer::SCommand_QuadBlock_Destroy *pCommand)
+{
+	CQuadBlock *pBlock = &m_aQuadBlocks[pCommand->m_Slot];
+	if(pBlock->m_pVertices)
+		mem_free(pBlock->m_pVertices);
+	pBlock->m_pVertices = 0;
+	pBlock->m_NumQuads = 0;
+}
+
+void CCommandProcessorFragment_OpenGL::Cmd_RenderQuadBlock(const CCommandBuffer::SCommand_RenderQuadBlock *pCommand)
+{
+	const CQuadBlock *pBlock = &m_aQuadBlocks[pCommand->m_Slot];
+	if(!pBlock->m_pVertices)
+		return;
+
+	int NumVertices = pBlock->m_NumQuads*4;
+	if(NumVertices > m_MaxBlockVertices)
+	{
+		if(m_pBlockVertices)
+			mem_free(m_pBlockVertices);
+		m_MaxBlockVertices = NumVertices;
+		m_pBlockVertices = (float *)mem_alloc(sizeof(float)*5*m_MaxBlockVertices, sizeof(void*));
+	}
+
+	// position and final texture coordinates, the color is the same for the whole block
+	const IGraphics::CBlockVertex *pIn = pBlock->m_pVertices;
+	float *pOut = m_pBlockVertices;
+	const float Nudge = pCommand->m_Nudge;
+	const float Inset = pCommand->m_Inset;
+	for(int i = 0; i < NumVertices; i++, pIn++, pOut += 5)
+	{
+		pOut[0] = pIn->m_X;
+		pOut[1] = pIn->m_Y;
+		pOut[2] = -5.0f;
+		pOut[3] = pIn->m_U + Nudge + pIn->m_InsetU*Inset;
+		pOut[4] = pIn->m_V + Nudge + pIn->m_InsetV*Inset;
+	}
+
+	SetState(pCommand->m_State);
+
+	glVertexPointer(3, GL_FLOAT, sizeof(float)*5, m_pBlockVertices);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(float)*5, m_pBlockVertices + 3);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glColor4f(pCommand->m_Color.r, pCommand->m_Color.g, pCommand->m_Color.b, pCommand->m_Color.a);
+
+	glDrawArrays(GL_QUADS, 0, NumVertices);
+}
+
 void CCommandProcessorFragment_OpenGL::Cmd_Screenshot(const CCommandBuffer::SCommand_Screenshot *pCommand)
 {
 	// fetch image data
@@ -358,6 +429,18 @@ CCommandProcessorFragment_OpenGL::CCommandProcessorFragment_OpenGL()
 {
 	mem_zero(m_aTextures, sizeof(m_aTextures));
 	m_pTextureMemoryUsage = 0;
+	mem_zero(m_aQuadBlocks, sizeof(m_aQuadBlocks));
+	m_pBlockVertices = 0;
+	m_MaxBlockVertices = 0;
+}
+
+CCommandProcessorFragment_OpenGL::~CCommandProcessorFragment_OpenGL()
+{
+	for(int i = 0; i < CCommandBuffer::MAX_QUAD_BLOCKS; i++)
+		if(m_aQuadBlocks[i].m_pVertices)
+			mem_free(m_aQuadBlocks[i].m_pVertices);
+	if(m_pBlockVertices)
+		mem_free(m_pBlockVertices);
 }
 
 bool CCommandProcessorFragment_OpenGL::RunCommand(const CCommandBuffer::SCommand * pBaseCommand)
@@ -369,7 +452,10 @@ bool CCommandProcessorFragment_OpenGL::RunCommand(const CCommandBuffer::SCommand
 	case CCommandBuffer::CMD_TEXTURE_DESTROY: Cmd_Texture_Destroy(static_cast<const CCommandBuffer::SCommand_Texture_Destroy *>(pBaseCommand)); break;
 	case CCommandBuffer::CMD_TEXTURE_UPDATE: Cmd_Texture_Update(static_cast<const CCommandBuffer::SCommand_Texture_Update *>(pBaseCommand)); break;
 	case CCommandBuffer::CMD_CLEAR: Cmd_Clear(static_cast<const CCommandBuffer::SCommand_Clear *>(pBaseCommand)); break;
+	case CCommandBuffer::CMD_QUADBLOCK_CREATE: Cmd_QuadBlock_Create(static_cast<const CCommandBuffer::SCommand_QuadBlock_Create *>(pBaseCommand)); break;
+	case CCommandBuffer::CMD_QUADBLOCK_DESTROY: Cmd_QuadBlock_Destroy(static_cast<const CCommandBuffer::SCommand_QuadBlock_Destroy *>(pBaseCommand)); break;
 	case CCommandBuffer::CMD_RENDER: Cmd_Render(static_cast<const CCommandBuffer::SCommand_Render *>(pBaseCommand)); break;
+	case CCommandBuffer::CMD_RENDER_QUADBLOCK: Cmd_RenderQuadBlock(static_cast<const CCommandBuffer::SCommand_RenderQuadBlock *>(pBaseCommand)); break;
 	case CCommandBuffer::CMD_SCREENSHOT: Cmd_Screenshot(static_cast<const CCommandBuffer::SCommand_Screenshot *>(pBaseCommand)); break;
 	default: return false;
 	}
@@ -3,6 +3,7 @@
 #include "SDL_opengl.h"
 
 #include "graphics_threaded.h"
+#include "sdl_semaphore.h"
 
 
 
@@ -30,16 +31,6 @@
 
 	#include <objc/objc-runtime.h>
 
-	class semaphore
-	{
-		SDL_sem *sem;
-	public:
-		semaphore() { sem = SDL_CreateSemaphore(0); }
-		~semaphore() { SDL_DestroySemaphore(sem); }
-		void wait() { SDL_SemWait(sem); }
-		void signal() { SDL_SemPost(sem); }
-	};
-
 	struct SGLContext
 	{
 		id m_Context;
@@ -175,6 +166,17 @@ class CCommandProcessorFragment_OpenGL
 	CTexture m_aTextures[CCommandBuffer::MAX_TEXTURES];
 	volatile int *m_pTextureMemoryUsage;
 
+	struct CQuadBlock
+	{
+		IGraphics::CBlockVertex *m_pVertices;
+		int m_NumQuads;
+	};
+	CQuadBlock m_aQuadBlocks[CCommandBuffer::MAX_QUAD_BLOCKS];
+
+	// quad blocks are expanded into this with the final texture coordinates
+	float *m_pBlockVertices;
+	int m_MaxBlockVertices;
+
 public:
 	enum
 	{
@@ -199,11 +201,15 @@ private:
 	void Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand);
 	void Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand);
 	void Cmd_Clear(const CCommandBuffer::SCommand_Clear *pCommand);
+	void Cmd_QuadBlock_Create(const CCommandBuffer::SCommand_QuadBlock_Create *pCommand);
+	void Cmd_QuadBlock_Destroy(const CCommandBuffer::SCommand_QuadBlock_Destroy *pCommand);
 	void Cmd_Render(const CCommandBuffer::SCommand_Render *pCommand);
+	void Cmd_RenderQuadBlock(const CCommandBuffer::SCommand_RenderQuadBlock *pCommand);
 	void Cmd_Screenshot(const CCommandBuffer::SCommand_Screenshot *pCommand);
 
 public:
 	CCommandProcessorFragment_OpenGL();
+	~CCommandProcessorFragment_OpenGL();
 
 	bool RunCommand(const CCommandBuffer::SCommand * pBaseCommand);
 };
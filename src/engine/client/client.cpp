@@ -623,6 +623,7 @@ void CClient::SnapInvalidateItem(int SnapID, int Index)
 {
 	CSnapshotItem *i;
 	dbg_assert(SnapID >= 0 && SnapID < NUM_SNAPSHOT_TYPES, "invalid SnapID");
+	m_aSnapshots[SnapID]->DetachAlt();
 	i = m_aSnapshots[SnapID]->m_pAltSnap->GetItem(Index);
 	if(i)
 	{
@@ -1261,10 +1262,9 @@ void CClient::ProcessServerPacket(CNetChunk *pPacket)
 					int PurgeTick;
 					void *pDeltaData;
 					int DeltaSize;
-					unsigned char aTmpBuffer2[CSnapshot::MAX_SIZE];
-					unsigned char aTmpBuffer3[CSnapshot::MAX_SIZE];
-					CSnapshot *pTmpBuffer3 = (CSnapshot*)aTmpBuffer3;	// Fix compiler warning for strict-aliasing
+					CSnapshot *pTmpBuffer3 = (CSnapshot*)m_aSnapshotUnpackData;
 					int SnapSize;
+					int SnapCrc;
 
 					CompleteSize = (NumParts-1) * MAX_SNAPSHOT_PACKSIZE + PartSize;
 
@@ -1303,30 +1303,30 @@ void CClient::ProcessServerPacket(CNetChunk *pPacket)
 
 					if(CompleteSize)
 					{
-						int IntSize = CVariableInt::Decompress(m_aSnapshotIncommingData, CompleteSize, aTmpBuffer2);
+						int IntSize = CVariableInt::Decompress(m_aSnapshotIncommingData, CompleteSize, m_aSnapshotDeltaData);
 
 						if(IntSize < 0) // failure during decompression, bail
 							return;
 
-						pDeltaData = aTmpBuffer2;
+						pDeltaData = m_aSnapshotDeltaData;
 						DeltaSize = IntSize;
 					}
 
-					// unpack delta
-					SnapSize = m_SnapshotDelta.UnpackDelta(pDeltaShot, pTmpBuffer3, pDeltaData, DeltaSize);
+					// unpack delta, the crc is summed up on the way
+					SnapSize = m_SnapshotDelta.UnpackDelta(pDeltaShot, pTmpBuffer3, pDeltaData, DeltaSize, &SnapCrc);
 					if(SnapSize < 0)
 					{
 						m_pConsole->Print(IConsole::OUTPUT_LEVEL_DEBUG, "client", "delta unpack failed!");
 						return;
 					}
 
-					if(Msg != NETMSG_SNAPEMPTY && pTmpBuffer3->Crc() != Crc)
+					if(Msg != NETMSG_SNAPEMPTY && SnapCrc != Crc)
 					{
 						if(g_Config.m_Debug)
 						{
 							char aBuf[256];
 							str_format(aBuf, sizeof(aBuf), "snapshot crc error #%d - tick=%d wantedcrc=%d gotcrc=%d compressed_size=%d delta_tick=%d",
-								m_SnapCrcErrors, GameTick, Crc, pTmpBuffer3->Crc(), CompleteSize, DeltaTick);
+								m_SnapCrcErrors, GameTick, Crc, SnapCrc, CompleteSize, DeltaTick);
 							m_pConsole->Print(IConsole::OUTPUT_LEVEL_DEBUG, "client", aBuf);
 						}
 
@@ -1459,7 +1459,8 @@ void CClient::OnDemoPlayerSnapshot(void *pData, int Size)
 	m_aSnapshots[SNAP_CURRENT] = pTemp;
 
 	mem_copy(m_aSnapshots[SNAP_CURRENT]->m_pSnap, pData, Size);
-	mem_copy(m_aSnapshots[SNAP_CURRENT]->m_pAltSnap, pData, Size);
+	m_aSnapshots[SNAP_CURRENT]->m_pAltSnap = m_aSnapshots[SNAP_CURRENT]->m_pSnap;
+	m_aSnapshots[SNAP_CURRENT]->m_SnapSize = Size;
 
 	GameClient()->OnNewSnapshot();
 }
@@ -1726,7 +1727,8 @@ void CClient::Run()
 
 	// init graphics
 	{
-		if(g_Config.m_GfxThreaded)
+		// the headless backend only exists for the threaded graphics
+		if(g_Config.m_GfxThreaded || g_Config.m_GfxHeadless)
 			m_pGraphics = CreateEngineGraphicsThreaded();
 		else
 			m_pGraphics = CreateEngineGraphics();
@@ -1943,6 +1945,12 @@ void CClient::Run()
 		if(State() == IClient::STATE_QUITING)
 			break;
 
+		if(g_Config.m_GfxHeadless && g_Config.m_GfxHeadlessFrames && m_RenderFrames >= g_Config.m_GfxHeadlessFrames)
+		{
+			Quit();
+			break;
+		}
+
 		// beNice
 		if(g_Config.m_ClCpuThrottle)
 			thread_sleep(g_Config.m_ClCpuThrottle);
@@ -2113,12 +2121,14 @@ const char *CClient::DemoPlayer_Play(const char *pFilename, int StorageType)
 	m_aSnapshots[SNAP_PREV] = &m_aDemorecSnapshotHolders[SNAP_PREV];
 
 	m_aSnapshots[SNAP_CURRENT]->m_pSnap = (CSnapshot *)m_aDemorecSnapshotData[SNAP_CURRENT][0];
-	m_aSnapshots[SNAP_CURRENT]->m_pAltSnap = (CSnapshot *)m_aDemorecSnapshotData[SNAP_CURRENT][1];
+	m_aSnapshots[SNAP_CURRENT]->m_pAltSnap = m_aSnapshots[SNAP_CURRENT]->m_pSnap;
+	m_aSnapshots[SNAP_CURRENT]->m_pAltData = (CSnapshot *)m_aDemorecSnapshotData[SNAP_CURRENT][1];
 	m_aSnapshots[SNAP_CURRENT]->m_SnapSize = 0;
 	m_aSnapshots[SNAP_CURRENT]->m_Tick = -1;
 
 	m_aSnapshots[SNAP_PREV]->m_pSnap = (CSnapshot *)m_aDemorecSnapshotData[SNAP_PREV][0];
-	m_aSnapshots[SNAP_PREV]->m_pAltSnap = (CSnapshot *)m_aDemorecSnapshotData[SNAP_PREV][1];
+	m_aSnapshots[SNAP_PREV]->m_pAltSnap = m_aSnapshots[SNAP_PREV]->m_pSnap;
+	m_aSnapshots[SNAP_PREV]->m_pAltData = (CSnapshot *)m_aDemorecSnapshotData[SNAP_PREV][1];
 	m_aSnapshots[SNAP_PREV]->m_SnapSize = 0;
 	m_aSnapshots[SNAP_PREV]->m_Tick = -1;
 
@@ -2294,7 +2304,8 @@ int main(int argc, const char **argv) // ignore_convention
 	pClient->RegisterInterfaces();
 
 	// create the components
-	IEngine *pEngine = CreateEngine("Teeworlds");
+	// enough job threads to decode the assets in parallel at startup, idle ones just sleep
+	IEngine *pEngine = CreateEngine("Teeworlds", 4);
 	IConsole *pConsole = CreateConsole(CFGFLAG_CLIENT);
 	IStorage *pStorage = CreateStorage("OpenFNG", IStorage::STORAGETYPE_CLIENT, argc, argv); // ignore_convention
 	IConfig *pConfig = CreateConfig();
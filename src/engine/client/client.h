@@ -151,6 +151,8 @@ class CClient : public IClient, public CDemoPlayer::IListner
 
 	int m_RecivedSnapshots;
 	char m_aSnapshotIncommingData[CSnapshot::MAX_SIZE];
+	int m_aSnapshotDeltaData[CSnapshot::MAX_SIZE/sizeof(int)]; // decoder scratch, kept between snapshots
+	int m_aSnapshotUnpackData[CSnapshot::MAX_SIZE/sizeof(int)];
 
 	class CSnapshotStorage::CHolder m_aDemorecSnapshotHolders[NUM_SNAPSHOT_TYPES];
 	char *m_aDemorecSnapshotData[NUM_SNAPSHOT_TYPES][2][CSnapshot::MAX_SIZE];
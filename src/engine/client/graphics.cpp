@@ -20,20 +20,7 @@
 #include <math.h> // cosf, sinf
 
 #include "graphics.h"
-
-
-#if defined(CONF_PLATFORM_MACOSX)
-
-	class semaphore
-	{
-		SDL_sem *sem;
-	public:
-		semaphore() { sem = SDL_CreateSemaphore(0); }
-		~semaphore() { SDL_DestroySemaphore(sem); }
-		void wait() { SDL_SemWait(sem); }
-		void signal() { SDL_SemPost(sem); }
-	};
-#endif
+#include "sdl_semaphore.h"
 
 
 static CVideoMode g_aFakeModes[] = {
@@ -298,6 +285,11 @@ int CGraphics_OpenGL::UnloadTexture(int Index)
 }
 
 int CGraphics_OpenGL::LoadTextureRawSub(int TextureID, int x, int y, int Width, int Height, int Format, const void *pData)
+{
+	return LoadTextureRawSubLevel(TextureID, 0, x, y, Width, Height, Format, pData);
+}
+
+int CGraphics_OpenGL::LoadTextureRawSubLevel(int TextureID, int Level, int x, int y, int Width, int Height, int Format, const void *pData)
 {
 	int Oglformat = GL_RGBA;
 	if(Format == CImageInfo::FORMAT_RGB)
@@ -306,7 +298,7 @@ int CGraphics_OpenGL::LoadTextureRawSub(int TextureID, int x, int y, int Width,
 		Oglformat = GL_ALPHA;
 
 	glBindTexture(GL_TEXTURE_2D, m_aTextures[TextureID].m_Tex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, Width, Height, Oglformat, GL_UNSIGNED_BYTE, pData);
+	glTexSubImage2D(GL_TEXTURE_2D, Level, x, y, Width, Height, Oglformat, GL_UNSIGNED_BYTE, pData);
 	return 0;
 }
 
@@ -414,6 +406,50 @@ int CGraphics_OpenGL::LoadTextureRaw(int Width, int Height, int Format, const vo
 	return Tex;
 }
 
+int CGraphics_OpenGL::CreateTextureLevels(int Width, int Height, int NumLevels, int Format)
+{
+	if(g_Config.m_DbgStress)
+		return m_InvalidTexture;
+
+	// grab texture
+	int Tex = m_FirstFreeTexture;
+	m_FirstFreeTexture = m_aTextures[Tex].m_Next;
+	m_aTextures[Tex].m_Next = -1;
+
+	int Oglformat = GL_RGBA;
+	int PixelSize = 4;
+	if(Format == CImageInfo::FORMAT_RGB)
+	{
+		Oglformat = GL_RGB;
+		PixelSize = 3;
+	}
+	else if(Format == CImageInfo::FORMAT_ALPHA)
+	{
+		Oglformat = GL_ALPHA;
+		PixelSize = 1;
+	}
+
+	// the first level is big enough to clear all of them
+	void *pEmpty = mem_alloc(Width*Height*PixelSize, 1);
+	mem_zero(pEmpty, Width*Height*PixelSize);
+
+	glGenTextures(1, &m_aTextures[Tex].m_Tex);
+	glBindTexture(GL_TEXTURE_2D, m_aTextures[Tex].m_Tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, NumLevels-1);
+	m_aTextures[Tex].m_MemSize = 0;
+	for(int l = 0; l < NumLevels; l++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, l, Oglformat, max(Width>>l, 1), max(Height>>l, 1), 0, Oglformat, GL_UNSIGNED_BYTE, pEmpty);
+		m_aTextures[Tex].m_MemSize += max(Width>>l, 1)*max(Height>>l, 1)*PixelSize;
+	}
+	mem_free(pEmpty);
+
+	m_TextureMemoryUsage += m_aTextures[Tex].m_MemSize;
+	return Tex;
+}
+
 // simple uncompressed RGBA loaders
 int CGraphics_OpenGL::LoadTexture(const char *pFilename, int StorageType, int StoreFormat, int Flags)
 {
@@ -700,6 +736,47 @@ void CGraphics_OpenGL::QuadsDrawFreeform(const CFreeformItem *pArray, int Num)
 	AddVertices(4*Num);
 }
 
+void CGraphics_OpenGL::QuadsDrawSprites(const CSpriteQuadItem *pArray, int Num)
+{
+	dbg_assert(m_Drawing == DRAWING_QUADS, "called Graphics()->QuadsDrawSprites without begin");
+
+	for(int i = 0; i < Num; ++i)
+	{
+		const CSpriteQuadItem *pItem = &pArray[i];
+		CVertex *pVertex = &m_aVertices[m_NumVertices];
+
+		pVertex[0].m_Pos.x = pItem->m_Corners.m_X0;
+		pVertex[0].m_Pos.y = pItem->m_Corners.m_Y0;
+		pVertex[0].m_Tex.u = pItem->m_TlU;
+		pVertex[0].m_Tex.v = pItem->m_TlV;
+
+		pVertex[1].m_Pos.x = pItem->m_Corners.m_X1;
+		pVertex[1].m_Pos.y = pItem->m_Corners.m_Y1;
+		pVertex[1].m_Tex.u = pItem->m_BrU;
+		pVertex[1].m_Tex.v = pItem->m_TlV;
+
+		pVertex[2].m_Pos.x = pItem->m_Corners.m_X3;
+		pVertex[2].m_Pos.y = pItem->m_Corners.m_Y3;
+		pVertex[2].m_Tex.u = pItem->m_BrU;
+		pVertex[2].m_Tex.v = pItem->m_BrV;
+
+		pVertex[3].m_Pos.x = pItem->m_Corners.m_X2;
+		pVertex[3].m_Pos.y = pItem->m_Corners.m_Y2;
+		pVertex[3].m_Tex.u = pItem->m_TlU;
+		pVertex[3].m_Tex.v = pItem->m_BrV;
+
+		for(int v = 0; v < 4; v++)
+		{
+			pVertex[v].m_Color.r = pItem->m_R;
+			pVertex[v].m_Color.g = pItem->m_G;
+			pVertex[v].m_Color.b = pItem->m_B;
+			pVertex[v].m_Color.a = pItem->m_A;
+		}
+
+		AddVertices(4);
+	}
+}
+
 void CGraphics_OpenGL::QuadsText(float x, float y, float Size, const char *pText)
 {
 	float StartX = x;
@@ -729,6 +806,61 @@ void CGraphics_OpenGL::QuadsText(float x, float y, float Size, const char *pText
 	}
 }
 
+int CGraphics_OpenGL::QuadBlockCreate(const CBlockVertex *pVertices, int NumQuads)
+{
+	if(NumQuads <= 0 || m_FirstFreeQuadBlock < 0)
+		return -1;
+
+	int Block = m_FirstFreeQuadBlock;
+	m_FirstFreeQuadBlock = m_aQuadBlocks[Block].m_Next;
+	m_aQuadBlocks[Block].m_Next = -1;
+	m_aQuadBlocks[Block].m_NumQuads = NumQuads;
+	m_aQuadBlocks[Block].m_pVertices = (CBlockVertex *)mem_alloc(sizeof(CBlockVertex)*4*NumQuads, sizeof(void*));
+	mem_copy(m_aQuadBlocks[Block].m_pVertices, pVertices, sizeof(CBlockVertex)*4*NumQuads);
+	return Block;
+}
+
+void CGraphics_OpenGL::QuadBlockDestroy(int Block)
+{
+	if(Block < 0)
+		return;
+
+	mem_free(m_aQuadBlocks[Block].m_pVertices);
+	m_aQuadBlocks[Block].m_pVertices = 0;
+	m_aQuadBlocks[Block].m_NumQuads = 0;
+	m_aQuadBlocks[Block].m_Next = m_FirstFreeQuadBlock;
+	m_FirstFreeQuadBlock = Block;
+}
+
+void CGraphics_OpenGL::QuadBlockDraw(int Block, float r, float g, float b, float a, float Nudge, float Inset)
+{
+	if(Block < 0 || !m_aQuadBlocks[Block].m_pVertices)
+		return;
+
+	dbg_assert(m_Drawing == 0, "called Graphics()->QuadBlockDraw while drawing");
+
+	// no vertex buffers here either, expand into the regular vertex array
+	m_Drawing = DRAWING_QUADS;
+	const CBlockVertex *pIn = m_aQuadBlocks[Block].m_pVertices;
+	int NumVertices = m_aQuadBlocks[Block].m_NumQuads*4;
+	for(int i = 0; i < NumVertices; i++, pIn++)
+	{
+		CVertex *pOut = &m_aVertices[m_NumVertices++];
+		pOut->m_Pos.x = pIn->m_X;
+		pOut->m_Pos.y = pIn->m_Y;
+		pOut->m_Tex.u = pIn->m_U + Nudge + pIn->m_InsetU*Inset;
+		pOut->m_Tex.v = pIn->m_V + Nudge + pIn->m_InsetV*Inset;
+		pOut->m_Color.r = r;
+		pOut->m_Color.g = g;
+		pOut->m_Color.b = b;
+		pOut->m_Color.a = a;
+		if(m_NumVertices == MAX_VERTICES)
+			Flush();
+	}
+	Flush();
+	m_Drawing = 0;
+}
+
 int CGraphics_OpenGL::Init()
 {
 	m_pStorage = Kernel()->RequestInterface<IStorage>();
@@ -744,6 +876,16 @@ int CGraphics_OpenGL::Init()
 		m_aTextures[i].m_Next = i+1;
 	m_aTextures[MAX_TEXTURES-1].m_Next = -1;
 
+	// init quad blocks
+	m_FirstFreeQuadBlock = 0;
+	for(int i = 0; i < MAX_QUAD_BLOCKS; i++)
+	{
+		m_aQuadBlocks[i].m_pVertices = 0;
+		m_aQuadBlocks[i].m_NumQuads = 0;
+		m_aQuadBlocks[i].m_Next = i+1;
+	}
+	m_aQuadBlocks[MAX_QUAD_BLOCKS-1].m_Next = -1;
+
 	// set some default settings
 	glEnable(GL_BLEND);
 	glDisable(GL_CULL_FACE);
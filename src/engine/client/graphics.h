@@ -25,6 +25,7 @@ protected:
 	{
 		MAX_VERTICES = 32*1024,
 		MAX_TEXTURES = 1024*4,
+		MAX_QUAD_BLOCKS = 1024*16,
 
 		DRAWING_QUADS=1,
 		DRAWING_LINES=2
@@ -62,6 +63,16 @@ protected:
 	int m_FirstFreeTexture;
 	int m_TextureMemoryUsage;
 
+	struct CQuadBlock
+	{
+		CBlockVertex *m_pVertices;
+		int m_NumQuads;
+		int m_Next;
+	};
+
+	CQuadBlock m_aQuadBlocks[MAX_QUAD_BLOCKS];
+	int m_FirstFreeQuadBlock;
+
 	void Flush();
 	void AddVertices(int Count);
 	void Rotate4(const CPoint &rCenter, CVertex *pPoints);
@@ -92,7 +103,9 @@ public:
 
 	virtual int UnloadTexture(int Index);
 	virtual int LoadTextureRaw(int Width, int Height, int Format, const void *pData, int StoreFormat, int Flags);
+	virtual int CreateTextureLevels(int Width, int Height, int NumLevels, int Format);
 	virtual int LoadTextureRawSub(int TextureID, int x, int y, int Width, int Height, int Format, const void *pData);
+	virtual int LoadTextureRawSubLevel(int TextureID, int Level, int x, int y, int Width, int Height, int Format, const void *pData);
 
 	// simple uncompressed RGBA loaders
 	virtual int LoadTexture(const char *pFilename, int StorageType, int StoreFormat, int Flags);
@@ -119,8 +132,13 @@ public:
 	virtual void QuadsDraw(CQuadItem *pArray, int Num);
 	virtual void QuadsDrawTL(const CQuadItem *pArray, int Num);
 	virtual void QuadsDrawFreeform(const CFreeformItem *pArray, int Num);
+	virtual void QuadsDrawSprites(const CSpriteQuadItem *pArray, int Num);
 	virtual void QuadsText(float x, float y, float Size, const char *pText);
 
+	virtual int QuadBlockCreate(const CBlockVertex *pVertices, int NumQuads);
+	virtual void QuadBlockDestroy(int Block);
+	virtual void QuadBlockDraw(int Block, float r, float g, float b, float a, float Nudge, float Inset);
+
 	virtual int Init();
 };
 
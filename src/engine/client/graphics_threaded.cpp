@@ -302,9 +302,15 @@ static int ImageFormatToPixelSize(int Format)
 
 
 int CGraphics_Threaded::LoadTextureRawSub(int TextureID, int x, int y, int Width, int Height, int Format, const void *pData)
+{
+	return LoadTextureRawSubLevel(TextureID, 0, x, y, Width, Height, Format, pData);
+}
+
+int CGraphics_Threaded::LoadTextureRawSubLevel(int TextureID, int Level, int x, int y, int Width, int Height, int Format, const void *pData)
 {
 	CCommandBuffer::SCommand_Texture_Update Cmd;
 	Cmd.m_Slot = TextureID;
+	Cmd.m_Level = Level;
 	Cmd.m_X = x;
 	Cmd.m_Y = y;
 	Cmd.m_Width = Width;
@@ -345,6 +351,7 @@ int CGraphics_Threaded::LoadTextureRaw(int Width, int Height, int Format, const
 
 	// flags
 	Cmd.m_Flags = 0;
+	Cmd.m_NumLevels = 0;
 	if(Flags&IGraphics::TEXLOAD_NOMIPMAPS)
 		Cmd.m_Flags |= CCommandBuffer::TEXFLAG_NOMIPMAPS;
 	if(g_Config.m_GfxTextureCompression)
@@ -364,6 +371,37 @@ int CGraphics_Threaded::LoadTextureRaw(int Width, int Height, int Format, const
 	return Tex;
 }
 
+int CGraphics_Threaded::CreateTextureLevels(int Width, int Height, int NumLevels, int Format)
+{
+	if(g_Config.m_DbgStress)
+		return m_InvalidTexture;
+
+	// grab texture
+	int Tex = m_FirstFreeTexture;
+	m_FirstFreeTexture = m_aTextureIndices[Tex];
+	m_aTextureIndices[Tex] = -1;
+
+	// never resampled or compressed, the levels get updated in place
+	CCommandBuffer::SCommand_Texture_Create Cmd;
+	Cmd.m_Slot = Tex;
+	Cmd.m_Width = Width;
+	Cmd.m_Height = Height;
+	Cmd.m_PixelSize = ImageFormatToPixelSize(Format);
+	Cmd.m_Format = ImageFormatToTexFormat(Format);
+	Cmd.m_StoreFormat = Cmd.m_Format;
+	Cmd.m_Flags = CCommandBuffer::TEXFLAG_QUALITY;
+	Cmd.m_NumLevels = NumLevels;
+
+	// the first level is big enough to clear all of them
+	int MemSize = Width*Height*Cmd.m_PixelSize;
+	void *pTmpData = mem_alloc(MemSize, sizeof(void*));
+	mem_zero(pTmpData, MemSize);
+	Cmd.m_pData = pTmpData;
+
+	m_pCommandBuffer->AddCommand(Cmd);
+	return Tex;
+}
+
 // simple uncompressed RGBA loaders
 int CGraphics_Threaded::LoadTexture(const char *pFilename, int StorageType, int StoreFormat, int Flags)
 {
@@ -648,6 +686,47 @@ void CGraphics_Threaded::QuadsDrawFreeform(const CFreeformItem *pArray, int Num)
 	AddVertices(4*Num);
 }
 
+void CGraphics_Threaded::QuadsDrawSprites(const CSpriteQuadItem *pArray, int Num)
+{
+	dbg_assert(m_Drawing == DRAWING_QUADS, "called Graphics()->QuadsDrawSprites without begin");
+
+	for(int i = 0; i < Num; ++i)
+	{
+		const CSpriteQuadItem *pItem = &pArray[i];
+		CCommandBuffer::SVertex *pVertex = &m_aVertices[m_NumVertices];
+
+		pVertex[0].m_Pos.x = pItem->m_Corners.m_X0;
+		pVertex[0].m_Pos.y = pItem->m_Corners.m_Y0;
+		pVertex[0].m_Tex.u = pItem->m_TlU;
+		pVertex[0].m_Tex.v = pItem->m_TlV;
+
+		pVertex[1].m_Pos.x = pItem->m_Corners.m_X1;
+		pVertex[1].m_Pos.y = pItem->m_Corners.m_Y1;
+		pVertex[1].m_Tex.u = pItem->m_BrU;
+		pVertex[1].m_Tex.v = pItem->m_TlV;
+
+		pVertex[2].m_Pos.x = pItem->m_Corners.m_X3;
+		pVertex[2].m_Pos.y = pItem->m_Corners.m_Y3;
+		pVertex[2].m_Tex.u = pItem->m_BrU;
+		pVertex[2].m_Tex.v = pItem->m_BrV;
+
+		pVertex[3].m_Pos.x = pItem->m_Corners.m_X2;
+		pVertex[3].m_Pos.y = pItem->m_Corners.m_Y2;
+		pVertex[3].m_Tex.u = pItem->m_TlU;
+		pVertex[3].m_Tex.v = pItem->m_BrV;
+
+		for(int v = 0; v < 4; v++)
+		{
+			pVertex[v].m_Color.r = pItem->m_R;
+			pVertex[v].m_Color.g = pItem->m_G;
+			pVertex[v].m_Color.b = pItem->m_B;
+			pVertex[v].m_Color.a = pItem->m_A;
+		}
+
+		AddVertices(4);
+	}
+}
+
 void CGraphics_Threaded::QuadsText(float x, float y, float Size, const char *pText)
 {
 	float StartX = x;
@@ -745,7 +824,16 @@ int CGraphics_Threaded::Init()
 		m_aTextureIndices[i] = i+1;
 	m_aTextureIndices[MAX_TEXTURES-1] = -1;
 
-	m_pBackend = CreateGraphicsBackend();
+	// init quad blocks
+	m_FirstFreeQuadBlock = 0;
+	for(int i = 0; i < MAX_QUAD_BLOCKS-1; i++)
+		m_aQuadBlockIndices[i] = i+1;
+	m_aQuadBlockIndices[MAX_QUAD_BLOCKS-1] = -1;
+
+	if(g_Config.m_GfxHeadless)
+		m_pBackend = CreateGraphicsBackendNull();
+	else
+		m_pBackend = CreateGraphicsBackend();
 	if(InitWindow() != 0)
 		return -1;
 
@@ -782,6 +870,62 @@ void CGraphics_Threaded::Shutdown()
 		delete m_apCommandBuffers[i];
 }
 
+int CGraphics_Threaded::QuadBlockCreate(const CBlockVertex *pVertices, int NumQuads)
+{
+	if(NumQuads <= 0 || m_FirstFreeQuadBlock < 0)
+		return -1;
+
+	// grab block
+	int Block = m_FirstFreeQuadBlock;
+	m_FirstFreeQuadBlock = m_aQuadBlockIndices[Block];
+	m_aQuadBlockIndices[Block] = -1;
+
+	CCommandBuffer::SCommand_QuadBlock_Create Cmd;
+	Cmd.m_Slot = Block;
+	Cmd.m_NumQuads = NumQuads;
+	Cmd.m_pVertices = (CBlockVertex *)mem_alloc(sizeof(CBlockVertex)*4*NumQuads, sizeof(void*));
+	mem_copy(Cmd.m_pVertices, pVertices, sizeof(CBlockVertex)*4*NumQuads);
+
+	if(!AddCommandKick(Cmd))
+	{
+		mem_free(Cmd.m_pVertices);
+		m_aQuadBlockIndices[Block] = m_FirstFreeQuadBlock;
+		m_FirstFreeQuadBlock = Block;
+		return -1;
+	}
+	return Block;
+}
+
+void CGraphics_Threaded::QuadBlockDestroy(int Block)
+{
+	if(Block < 0)
+		return;
+
+	CCommandBuffer::SCommand_QuadBlock_Destroy Cmd;
+	Cmd.m_Slot = Block;
+	AddCommandKick(Cmd);
+
+	m_aQuadBlockIndices[Block] = m_FirstFreeQuadBlock;
+	m_FirstFreeQuadBlock = Block;
+}
+
+void CGraphics_Threaded::QuadBlockDraw(int Block, float r, float g, float b, float a, float Nudge, float Inset)
+{
+	if(Block < 0)
+		return;
+
+	CCommandBuffer::SCommand_RenderQuadBlock Cmd;
+	Cmd.m_State = m_State;
+	Cmd.m_Slot = Block;
+	Cmd.m_Color.r = r;
+	Cmd.m_Color.g = g;
+	Cmd.m_Color.b = b;
+	Cmd.m_Color.a = a;
+	Cmd.m_Nudge = Nudge;
+	Cmd.m_Inset = Inset;
+	AddCommandKick(Cmd);
+}
+
 void CGraphics_Threaded::Minimize()
 {
 	m_pBackend->Minimize();
@@ -51,6 +51,7 @@ public:
 	enum
 	{
 		MAX_TEXTURES=1024*4,
+		MAX_QUAD_BLOCKS=1024*16,
 	};
 
 	enum
@@ -74,9 +75,14 @@ public:
 		CMD_TEXTURE_DESTROY,
 		CMD_TEXTURE_UPDATE,
 
+		// cached geometry
+		CMD_QUADBLOCK_CREATE,
+		CMD_QUADBLOCK_DESTROY,
+
 		// rendering
 		CMD_CLEAR,
 		CMD_RENDER,
+		CMD_RENDER_QUADBLOCK,
 
 		// swap
 		CMD_SWAP,
@@ -182,6 +188,16 @@ public:
 		SVertex *m_pVertices; // you should use the command buffer data to allocate vertices for this command
 	};
 
+	struct SCommand_RenderQuadBlock : public SCommand
+	{
+		SCommand_RenderQuadBlock() : SCommand(CMD_RENDER_QUADBLOCK) {}
+		SState m_State;
+		int m_Slot;
+		SColor m_Color;
+		float m_Nudge;
+		float m_Inset;
+	};
+
 	struct SCommand_Screenshot : public SCommand
 	{
 		SCommand_Screenshot() : SCommand(CMD_SCREENSHOT) {}
@@ -217,6 +233,7 @@ public:
 		int m_Format;
 		int m_StoreFormat;
 		int m_Flags;
+		int m_NumLevels; // 0 for a full mipmap chain built from the data
 		void *m_pData; // will be freed by the command processor
 	};
 
@@ -226,6 +243,7 @@ public:
 
 		// texture information
 		int m_Slot;
+		int m_Level;
 
 		int m_X;
 		int m_Y;
@@ -243,6 +261,22 @@ public:
 		// texture information
 		int m_Slot;
 	};
+
+	struct SCommand_QuadBlock_Create : public SCommand
+	{
+		SCommand_QuadBlock_Create() : SCommand(CMD_QUADBLOCK_CREATE) {}
+
+		int m_Slot;
+		int m_NumQuads;
+		IGraphics::CBlockVertex *m_pVertices; // owned by the command processor from here on
+	};
+
+	struct SCommand_QuadBlock_Destroy : public SCommand
+	{
+		SCommand_QuadBlock_Destroy() : SCommand(CMD_QUADBLOCK_DESTROY) {}
+
+		int m_Slot;
+	};
 	
 	//
 	CCommandBuffer(unsigned CmdBufferSize, unsigned DataBufferSize)
@@ -325,6 +359,7 @@ class CGraphics_Threaded : public IEngineGraphics
 
 		MAX_VERTICES = 32*1024,
 		MAX_TEXTURES = 1024*4,
+		MAX_QUAD_BLOCKS = CCommandBuffer::MAX_QUAD_BLOCKS,
 		
 		DRAWING_QUADS=1,
 		DRAWING_LINES=2
@@ -360,12 +395,30 @@ class CGraphics_Threaded : public IEngineGraphics
 	int m_FirstFreeTexture;
 	int m_TextureMemoryUsage;
 
+	int m_aQuadBlockIndices[MAX_QUAD_BLOCKS];
+	int m_FirstFreeQuadBlock;
+
 	void FlushVertices();
 	void AddVertices(int Count);
 	void Rotate4(const CCommandBuffer::SPoint &rCenter, CCommandBuffer::SVertex *pPoints);
 
 	void KickCommandBuffer();
 
+	template<class T>
+	bool AddCommandKick(const T &Command)
+	{
+		if(m_pCommandBuffer->AddCommand(Command))
+			return true;
+
+		// kick command buffer and try again
+		KickCommandBuffer();
+		if(m_pCommandBuffer->AddCommand(Command))
+			return true;
+
+		dbg_msg("graphics", "failed to allocate memory for command");
+		return false;
+	}
+
 	int IssueInit();
 	int InitWindow();
 public:
@@ -392,7 +445,9 @@ public:
 
 	virtual int UnloadTexture(int Index);
 	virtual int LoadTextureRaw(int Width, int Height, int Format, const void *pData, int StoreFormat, int Flags);
+	virtual int CreateTextureLevels(int Width, int Height, int NumLevels, int Format);
 	virtual int LoadTextureRawSub(int TextureID, int x, int y, int Width, int Height, int Format, const void *pData);
+	virtual int LoadTextureRawSubLevel(int TextureID, int Level, int x, int y, int Width, int Height, int Format, const void *pData);
 
 	// simple uncompressed RGBA loaders
 	virtual int LoadTexture(const char *pFilename, int StorageType, int StoreFormat, int Flags);
@@ -419,8 +474,13 @@ public:
 	virtual void QuadsDraw(CQuadItem *pArray, int Num);
 	virtual void QuadsDrawTL(const CQuadItem *pArray, int Num);
 	virtual void QuadsDrawFreeform(const CFreeformItem *pArray, int Num);
+	virtual void QuadsDrawSprites(const CSpriteQuadItem *pArray, int Num);
 	virtual void QuadsText(float x, float y, float Size, const char *pText);
 
+	virtual int QuadBlockCreate(const CBlockVertex *pVertices, int NumQuads);
+	virtual void QuadBlockDestroy(int Block);
+	virtual void QuadBlockDraw(int Block, float r, float g, float b, float a, float Nudge, float Inset);
+
 	virtual void Minimize();
 	virtual void Maximize();
 
@@ -442,3 +502,4 @@ public:
 };
 
 extern IGraphicsBackend *CreateGraphicsBackend();
+extern IGraphicsBackend *CreateGraphicsBackendNull();
@@ -0,0 +1,23 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_CLIENT_SDL_SEMAPHORE_H
+#define ENGINE_CLIENT_SDL_SEMAPHORE_H
+
+#include <base/tl/threading.h>
+
+// base/tl/threading.h has no semaphore on macosx, use the one SDL provides
+#if defined(CONF_PLATFORM_MACOSX)
+	#include "SDL.h"
+
+	class semaphore
+	{
+		SDL_sem *sem;
+	public:
+		semaphore() { sem = SDL_CreateSemaphore(0); }
+		~semaphore() { SDL_DestroySemaphore(sem); }
+		void wait() { SDL_SemWait(sem); }
+		void signal() { SDL_SemPost(sem); }
+	};
+#endif
+
+#endif
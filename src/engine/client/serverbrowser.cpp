@@ -21,14 +21,41 @@
 
 class SortWrap
 {
-	typedef bool (CServerBrowser::*SortFunc)(int, int) const;
+	typedef int (CServerBrowser::*SortFunc)(int, int) const;
 	SortFunc m_pfnSort;
-	CServerBrowser *m_pThis;
+	const CServerBrowser *m_pThis;
 public:
-	SortWrap(CServerBrowser *t, SortFunc f) : m_pfnSort(f), m_pThis(t) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
+	SortWrap(const CServerBrowser *t, SortFunc f) : m_pfnSort(f), m_pThis(t) {}
+	bool operator()(int a, int b) const
+	{
+		// ties are broken by the server index, so the order is the same as a stable sort gives
+		int Cmp = (m_pThis->*m_pfnSort)(a, b);
+		if(g_Config.m_BrSortOrder)
+			Cmp = -Cmp;
+		return Cmp < 0 || (Cmp == 0 && a < b);
+	}
 };
 
+// packs the first characters of a string into a number that orders like str_comp
+static int64 StrSortKey(const char *pStr)
+{
+	int64 Key = 0;
+	for(int i = 0; i < 7; i++)
+	{
+		Key = (Key<<8) | (unsigned char)*pStr;
+		if(*pStr)
+			pStr++;
+	}
+	return Key;
+}
+
+static int CompareStr(int64 Key1, int64 Key2, const char *pStr1, const char *pStr2)
+{
+	if(Key1 != Key2)
+		return Key1 < Key2 ? -1 : 1;
+	return str_comp(pStr1, pStr2);
+}
+
 CServerBrowser::CServerBrowser()
 {
 	m_pMasterServer = 0;
@@ -53,6 +80,8 @@ CServerBrowser::CServerBrowser()
 	m_Sorthash = 0;
 	m_aFilterString[0] = 0;
 	m_aFilterGametypeString[0] = 0;
+	m_aFilterServerAddress[0] = 0;
+	m_FilterCountryIndex = -1;
 
 	// the token is to keep server refresh separated from each other
 	m_CurrentToken = 1;
@@ -81,179 +110,208 @@ const CServerInfo *CServerBrowser::SortedGet(int Index) const
 }
 
 
-bool CServerBrowser::SortCompareName(int Index1, int Index2) const
+int CServerBrowser::SortCompareName(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
 	//	make sure empty entries are listed last
-	return (a->m_GotInfo && b->m_GotInfo) || (!a->m_GotInfo && !b->m_GotInfo) ? str_comp(a->m_Info.m_aName, b->m_Info.m_aName) < 0 :
-			a->m_GotInfo ? true : false;
+	if(a->m_GotInfo != b->m_GotInfo)
+		return a->m_GotInfo ? -1 : 1;
+	return CompareStr(a->m_NameKey, b->m_NameKey, a->m_Info.m_aName, b->m_Info.m_aName);
 }
 
-bool CServerBrowser::SortCompareMap(int Index1, int Index2) const
+int CServerBrowser::SortCompareMap(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
-	return str_comp(a->m_Info.m_aMap, b->m_Info.m_aMap) < 0;
+	return CompareStr(a->m_MapKey, b->m_MapKey, a->m_Info.m_aMap, b->m_Info.m_aMap);
 }
 
-bool CServerBrowser::SortComparePing(int Index1, int Index2) const
+int CServerBrowser::SortComparePing(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
-	return a->m_Info.m_Latency < b->m_Info.m_Latency;
+	return a->m_Info.m_Latency - b->m_Info.m_Latency;
 }
 
-bool CServerBrowser::SortCompareGametype(int Index1, int Index2) const
+int CServerBrowser::SortCompareGametype(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
-	return str_comp(a->m_Info.m_aGameType, b->m_Info.m_aGameType) < 0;
+	return CompareStr(a->m_GameTypeKey, b->m_GameTypeKey, a->m_Info.m_aGameType, b->m_Info.m_aGameType);
 }
 
-bool CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
+int CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
-	return a->m_Info.m_NumPlayers < b->m_Info.m_NumPlayers;
+	return a->m_Info.m_NumPlayers - b->m_Info.m_NumPlayers;
 }
 
-bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
+int CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
 {
 	CServerEntry *a = m_ppServerlist[Index1];
 	CServerEntry *b = m_ppServerlist[Index2];
-	return a->m_Info.m_NumClients < b->m_Info.m_NumClients;
+	return a->m_Info.m_NumClients - b->m_Info.m_NumClients;
 }
 
-void CServerBrowser::Filter()
+CServerBrowser::SortFunc CServerBrowser::GetSortFunc() const
 {
-	int i = 0, p = 0;
-	m_NumSortedServers = 0;
+	if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
+		return &CServerBrowser::SortComparePing;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
+		return &CServerBrowser::SortCompareMap;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
+		return g_Config.m_BrFilterSpectators ? &CServerBrowser::SortCompareNumPlayers : &CServerBrowser::SortCompareNumClients;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
+		return &CServerBrowser::SortCompareGametype;
+	return &CServerBrowser::SortCompareName;
+}
 
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
-	{
-		if(m_pSortedServerlist)
-			mem_free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)mem_alloc(m_NumSortedServersCapacity*sizeof(int), 1);
-	}
+void CServerBrowser::UpdateSortKeys(CServerEntry *pEntry)
+{
+	static const char *s_apPureMaps[] = {"dm1", "dm2", "dm6", "dm7", "dm8", "dm9", "ctf1", "ctf2", "ctf3", "ctf4", "ctf5", "ctf6", "ctf7"};
 
-	// filter the servers
-	for(i = 0; i < m_NumServers; i++)
-	{
-		int Filtered = 0;
+	pEntry->m_NameKey = StrSortKey(pEntry->m_Info.m_aName);
+	pEntry->m_MapKey = StrSortKey(pEntry->m_Info.m_aMap);
+	pEntry->m_GameTypeKey = StrSortKey(pEntry->m_Info.m_aGameType);
 
-		if(g_Config.m_BrFilterEmpty && ((g_Config.m_BrFilterSpectators && m_ppServerlist[i]->m_Info.m_NumPlayers == 0) || m_ppServerlist[i]->m_Info.m_NumClients == 0))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterFull && ((g_Config.m_BrFilterSpectators && m_ppServerlist[i]->m_Info.m_NumPlayers == m_ppServerlist[i]->m_Info.m_MaxPlayers) ||
-				m_ppServerlist[i]->m_Info.m_NumClients == m_ppServerlist[i]->m_Info.m_MaxClients))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPw && m_ppServerlist[i]->m_Info.m_Flags&SERVER_FLAG_PASSWORD)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPure &&
-			(str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "DM") != 0 &&
-			str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "TDM") != 0 &&
-			str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "CTF") != 0))
+	pEntry->m_PureGameType = str_comp(pEntry->m_Info.m_aGameType, "DM") == 0 ||
+		str_comp(pEntry->m_Info.m_aGameType, "TDM") == 0 ||
+		str_comp(pEntry->m_Info.m_aGameType, "CTF") == 0;
+
+	pEntry->m_PureMap = false;
+	for(unsigned i = 0; i < sizeof(s_apPureMaps)/sizeof(s_apPureMaps[0]); i++)
+	{
+		if(str_comp(pEntry->m_Info.m_aMap, s_apPureMaps[i]) == 0)
 		{
-			Filtered = 1;
+			pEntry->m_PureMap = true;
+			break;
 		}
-		else if(g_Config.m_BrFilterPureMap &&
-			!(str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm1") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm2") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm6") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm7") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm8") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm9") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf1") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf2") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf3") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf4") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf5") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf6") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf7") == 0)
-		)
+	}
+}
+
+bool CServerBrowser::FilterServer(CServerEntry *pEntry) const
+{
+	CServerInfo *pInfo = &pEntry->m_Info;
+	int Filtered = 0;
+	int p;
+
+	if(g_Config.m_BrFilterEmpty && ((g_Config.m_BrFilterSpectators && pInfo->m_NumPlayers == 0) || pInfo->m_NumClients == 0))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterFull && ((g_Config.m_BrFilterSpectators && pInfo->m_NumPlayers == pInfo->m_MaxPlayers) ||
+			pInfo->m_NumClients == pInfo->m_MaxClients))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPw && pInfo->m_Flags&SERVER_FLAG_PASSWORD)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPure && !pEntry->m_PureGameType)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPureMap && !pEntry->m_PureMap)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPing < pInfo->m_Latency)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterCompatversion && str_comp_num(pInfo->m_aVersion, m_aNetVersion, 3) != 0)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(pInfo->m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(pInfo->m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = 1;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find_nocase(pInfo->m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = 1;
+	else
+	{
+		if(g_Config.m_BrFilterCountry)
 		{
 			Filtered = 1;
-		}
-		else if(g_Config.m_BrFilterPing < m_ppServerlist[i]->m_Info.m_Latency)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterCompatversion && str_comp_num(m_ppServerlist[i]->m_Info.m_aVersion, m_aNetVersion, 3) != 0)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else
-		{
-			if(g_Config.m_BrFilterCountry)
+			// match against player country
+			for(p = 0; p < pInfo->m_NumClients; p++)
 			{
-				Filtered = 1;
-				// match against player country
-				for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
+				if(pInfo->m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 				{
-					if(m_ppServerlist[i]->m_Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = 0;
-						break;
-					}
+					Filtered = 0;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != 0)
-			{
-				int MatchFound = 0;
-
-				m_ppServerlist[i]->m_Info.m_QuickSearchHit = 0;
+		if(!Filtered && g_Config.m_BrFilterString[0] != 0)
+		{
+			int MatchFound = 0;
 
-				// match against server name
-				if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aName, g_Config.m_BrFilterString))
-				{
-					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-				}
+			pInfo->m_QuickSearchHit = 0;
 
-				// match against players
-				for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
-				{
-					if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName, g_Config.m_BrFilterString) ||
-						str_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan, g_Config.m_BrFilterString))
-					{
-						MatchFound = 1;
-						m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-						break;
-					}
-				}
+			// match against server name
+			if(str_find_nocase(pInfo->m_aName, g_Config.m_BrFilterString))
+			{
+				MatchFound = 1;
+				pInfo->m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+			}
 
-				// match against map
-				if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aMap, g_Config.m_BrFilterString))
+			// match against players
+			for(p = 0; p < pInfo->m_NumClients; p++)
+			{
+				if(str_find_nocase(pInfo->m_aClients[p].m_aName, g_Config.m_BrFilterString) ||
+					str_find_nocase(pInfo->m_aClients[p].m_aClan, g_Config.m_BrFilterString))
 				{
 					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+					pInfo->m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+					break;
 				}
-
-				if(!MatchFound)
-					Filtered = 1;
 			}
-		}
 
-		if(Filtered == 0)
-		{
-			// check for friend
-			m_ppServerlist[i]->m_Info.m_FriendState = IFriends::FRIEND_NO;
-			for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
+			// match against map
+			if(str_find_nocase(pInfo->m_aMap, g_Config.m_BrFilterString))
 			{
-				m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName,
-					m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan);
-				m_ppServerlist[i]->m_Info.m_FriendState = max(m_ppServerlist[i]->m_Info.m_FriendState, m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState);
+				MatchFound = 1;
+				pInfo->m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
 			}
 
-			if(!g_Config.m_BrFilterFriends || m_ppServerlist[i]->m_Info.m_FriendState != IFriends::FRIEND_NO)
-				m_pSortedServerlist[m_NumSortedServers++] = i;
+			if(!MatchFound)
+				Filtered = 1;
 		}
 	}
+
+	if(Filtered)
+		return false;
+
+	// check for friend
+	pInfo->m_FriendState = IFriends::FRIEND_NO;
+	for(p = 0; p < pInfo->m_NumClients; p++)
+	{
+		pInfo->m_aClients[p].m_FriendState = m_pFriends->GetFriendState(pInfo->m_aClients[p].m_aName, pInfo->m_aClients[p].m_aClan);
+		pInfo->m_FriendState = max(pInfo->m_FriendState, pInfo->m_aClients[p].m_FriendState);
+	}
+
+	return !g_Config.m_BrFilterFriends || pInfo->m_FriendState != IFriends::FRIEND_NO;
+}
+
+void CServerBrowser::ReserveSorted()
+{
+	if(m_NumSortedServersCapacity >= m_NumServers)
+		return;
+
+	int *pNewList = (int *)mem_alloc(m_NumServerCapacity*sizeof(int), 1);
+	if(m_pSortedServerlist)
+	{
+		mem_copy(pNewList, m_pSortedServerlist, m_NumSortedServers*sizeof(int));
+		mem_free(m_pSortedServerlist);
+	}
+	m_NumSortedServersCapacity = m_NumServerCapacity;
+	m_pSortedServerlist = pNewList;
+}
+
+void CServerBrowser::Filter()
+{
+	m_NumSortedServers = 0;
+	ReserveSorted();
+
+	// filter the servers
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		m_ppServerlist[i]->m_Info.m_SortedIndex = -1;
+		if(FilterServer(m_ppServerlist[i]))
+			m_pSortedServerlist[m_NumSortedServers++] = i;
+	}
 }
 
 int CServerBrowser::SortHash() const
@@ -274,6 +332,15 @@ int CServerBrowser::SortHash() const
 	return i;
 }
 
+bool CServerBrowser::FilterChanged() const
+{
+	return m_Sorthash != SortHash() ||
+		m_FilterCountryIndex != g_Config.m_BrFilterCountryIndex ||
+		str_comp(m_aFilterString, g_Config.m_BrFilterString) != 0 ||
+		str_comp(m_aFilterGametypeString, g_Config.m_BrFilterGametype) != 0 ||
+		str_comp(m_aFilterServerAddress, g_Config.m_BrFilterServerAddress) != 0;
+}
+
 void CServerBrowser::Sort()
 {
 	int i;
@@ -282,17 +349,7 @@ void CServerBrowser::Sort()
 	Filter();
 
 	// sort
-	if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareName));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortComparePing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareMap));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this,
-					g_Config.m_BrFilterSpectators ? &CServerBrowser::SortCompareNumPlayers : &CServerBrowser::SortCompareNumClients));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareGametype));
+	std::sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, GetSortFunc()));
 
 	// set indexes
 	for(i = 0; i < m_NumSortedServers; i++)
@@ -300,9 +357,43 @@ void CServerBrowser::Sort()
 
 	str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype, sizeof(m_aFilterGametypeString));
 	str_copy(m_aFilterString, g_Config.m_BrFilterString, sizeof(m_aFilterString));
+	str_copy(m_aFilterServerAddress, g_Config.m_BrFilterServerAddress, sizeof(m_aFilterServerAddress));
+	m_FilterCountryIndex = g_Config.m_BrFilterCountryIndex;
 	m_Sorthash = SortHash();
 }
 
+// finding the new place is a binary search, but moving the entries behind it
+// is linear. it's a memmove of ints, cheap enough for a few thousand servers
+void CServerBrowser::UpdateSorted(CServerEntry *pEntry)
+{
+	int Index = pEntry->m_Info.m_ServerIndex;
+	int First = m_NumSortedServers; // first sorted index that moved
+
+	// take the server out of the view
+	if(pEntry->m_Info.m_SortedIndex >= 0)
+	{
+		First = pEntry->m_Info.m_SortedIndex;
+		mem_move(&m_pSortedServerlist[First], &m_pSortedServerlist[First+1], (m_NumSortedServers-First-1)*sizeof(int));
+		m_NumSortedServers--;
+		pEntry->m_Info.m_SortedIndex = -1;
+	}
+
+	// and put it back at the right place if it passes the filters
+	if(FilterServer(pEntry))
+	{
+		ReserveSorted();
+		int *pPos = std::lower_bound(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, Index, SortWrap(this, GetSortFunc()));
+		int Pos = pPos-m_pSortedServerlist;
+		mem_move(pPos+1, pPos, (m_NumSortedServers-Pos)*sizeof(int));
+		*pPos = Index;
+		m_NumSortedServers++;
+		First = min(First, Pos);
+	}
+
+	for(int i = First; i < m_NumSortedServers; i++)
+		m_ppServerlist[m_pSortedServerlist[i]]->m_Info.m_SortedIndex = i;
+}
+
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
 {
 	if(pEntry->m_pPrevReq || pEntry->m_pNextReq || m_pFirstReqServer == pEntry)
@@ -323,9 +414,18 @@ void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
 	}
 }
 
+static int AddrHash(const NETADDR &Addr)
+{
+	// the first byte alone puts whole providers into one bucket
+	unsigned Hash = Addr.port;
+	for(int i = 0; i < 16; i++)
+		Hash = Hash*31 + Addr.ip[i];
+	return (Hash^(Hash>>8)^(Hash>>16))&0xff;
+}
+
 CServerBrowser::CServerEntry *CServerBrowser::Find(const NETADDR &Addr)
 {
-	CServerEntry *pEntry = m_aServerlistIp[Addr.ip[0]];
+	CServerEntry *pEntry = m_aServerlistIp[AddrHash(Addr)];
 
 	for(; pEntry; pEntry = pEntry->m_pNextIp)
 	{
@@ -351,8 +451,12 @@ void CServerBrowser::QueueRequest(CServerEntry *pEntry)
 void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
 	int Fav = pEntry->m_Info.m_Favorite;
+	int ServerIndex = pEntry->m_Info.m_ServerIndex;
+	int SortedIndex = pEntry->m_Info.m_SortedIndex;
 	pEntry->m_Info = Info;
 	pEntry->m_Info.m_Favorite = Fav;
+	pEntry->m_Info.m_ServerIndex = ServerIndex;
+	pEntry->m_Info.m_SortedIndex = SortedIndex;
 	pEntry->m_Info.m_NetAddr = pEntry->m_Addr;
 
 	// all these are just for nice compability
@@ -370,11 +474,12 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 	}*/
 
 	pEntry->m_GotInfo = 1;
+	UpdateSortKeys(pEntry);
 }
 
 CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 {
-	int Hash = Addr.ip[0];
+	int Hash = AddrHash(Addr);
 	CServerEntry *pEntry = 0;
 	int i;
 
@@ -389,6 +494,8 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 	pEntry->m_Info.m_Latency = 999;
 	net_addr_str(&Addr, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aAddress), true);
 	str_copy(pEntry->m_Info.m_aName, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aName));
+	pEntry->m_Info.m_SortedIndex = -1;
+	UpdateSortKeys(pEntry);
 
 	// check if it's a favorite
 	for(i = 0; i < m_NumFavoriteServers; i++)
@@ -463,7 +570,11 @@ void CServerBrowser::Set(const NETADDR &Addr, int Type, int Token, const CServer
 		}
 	}
 
-	Sort();
+	// only the changed server has to be placed, unless the filters changed since the last sort
+	if(FilterChanged())
+		Sort();
+	else if(pEntry)
+		UpdateSorted(pEntry);
 }
 
 void CServerBrowser::Refresh(int Type)
@@ -628,7 +739,7 @@ void CServerBrowser::Update(bool ForceResort)
 	}
 
 	// check if we need to resort
-	if(m_Sorthash != SortHash() || ForceResort)
+	if(ForceResort || FilterChanged())
 		Sort();
 }
 
@@ -20,6 +20,13 @@ public:
 
 		CServerEntry *m_pPrevReq; // request list
 		CServerEntry *m_pNextReq;
+
+		// precomputed on every info update, for filtering and sorting
+		int64 m_NameKey;
+		int64 m_MapKey;
+		int64 m_GameTypeKey;
+		bool m_PureGameType;
+		bool m_PureMap;
 	};
 
 	enum
@@ -50,6 +57,7 @@ public:
 	void Request(const NETADDR &Addr) const;
 
 	void SetBaseInfo(class CNetClient *pClient, const char *pNetVersion);
+	int CurrentToken() const { return m_CurrentToken; }
 
 private:
 	CNetClient *m_pNetClient;
@@ -81,6 +89,8 @@ private:
 	int m_Sorthash;
 	char m_aFilterString[64];
 	char m_aFilterGametypeString[128];
+	char m_aFilterServerAddress[128];
+	int m_FilterCountryIndex;
 
 	// the token is to keep server refresh separated from each other
 	int m_CurrentToken;
@@ -89,17 +99,25 @@ private:
 	int64 m_BroadcastTime;
 
 	// sorting criterions
-	bool SortCompareName(int Index1, int Index2) const;
-	bool SortCompareMap(int Index1, int Index2) const;
-	bool SortComparePing(int Index1, int Index2) const;
-	bool SortCompareGametype(int Index1, int Index2) const;
-	bool SortCompareNumPlayers(int Index1, int Index2) const;
-	bool SortCompareNumClients(int Index1, int Index2) const;
+	int SortCompareName(int Index1, int Index2) const;
+	int SortCompareMap(int Index1, int Index2) const;
+	int SortComparePing(int Index1, int Index2) const;
+	int SortCompareGametype(int Index1, int Index2) const;
+	int SortCompareNumPlayers(int Index1, int Index2) const;
+	int SortCompareNumClients(int Index1, int Index2) const;
+
+	typedef int (CServerBrowser::*SortFunc)(int, int) const;
+	SortFunc GetSortFunc() const;
 
 	//
+	void UpdateSortKeys(CServerEntry *pEntry);
+	bool FilterServer(CServerEntry *pEntry) const;
+	void ReserveSorted();
 	void Filter();
 	void Sort();
+	void UpdateSorted(CServerEntry *pEntry);
 	int SortHash() const;
+	bool FilterChanged() const;
 
 	CServerEntry *Find(const NETADDR &Addr);
 	CServerEntry *Add(const NETADDR &Addr);
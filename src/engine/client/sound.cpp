@@ -11,194 +11,33 @@
 #include "SDL.h"
 
 #include "sound.h"
+#include "sound_mixer.h"
 
 extern "C" { // wavpack
 	#include <engine/external/wavpack/wavpack.h>
 }
 #include <math.h>
 
-enum
-{
-	NUM_SAMPLES = 512,
-	NUM_VOICES = 64,
-	NUM_CHANNELS = 16,
-};
-
-struct CSample
-{
-	short *m_pData;
-	int m_NumFrames;
-	int m_Rate;
-	int m_Channels;
-	int m_LoopStart;
-	int m_LoopEnd;
-	int m_PausedAt;
-};
-
-struct CChannel
-{
-	int m_Vol;
-	int m_Pan;
-} ;
-
-struct CVoice
-{
-	CSample *m_pSample;
-	CChannel *m_pChannel;
-	int m_Tick;
-	int m_Vol; // 0 - 255
-	int m_Flags;
-	int m_X, m_Y;
-} ;
+typedef CSoundMixer::CSample CSample;
 
-static CSample m_aSamples[NUM_SAMPLES] = { {0} };
-static CVoice m_aVoices[NUM_VOICES] = { {0} };
-static CChannel m_aChannels[NUM_CHANNELS] = { {255, 0} };
-
-static LOCK m_SoundLock = 0;
-
-static int m_CenterX = 0;
-static int m_CenterY = 0;
+static CSoundMixer m_Mixer;
 
 static int m_MixingRate = 48000;
-static volatile int m_SoundVolume = 100;
-
-static int m_NextVoice = 0;
-static int *m_pMixBuffer = 0;	// buffer only used by the thread callback function
-static unsigned m_MaxFrames = 0;
-
-// TODO: there should be a faster way todo this
-static short Int2Short(int i)
-{
-	if(i > 0x7fff)
-		return 0x7fff;
-	else if(i < -0x7fff)
-		return -0x7fff;
-	return i;
-}
 
-static int IntAbs(int i)
+static void SdlCallback(void *pUnused, Uint8 *pStream, int Len)
 {
-	if(i<0)
-		return -i;
-	return i;
+	(void)pUnused;
+	m_Mixer.Mix((short *)pStream, Len/2/2);
 }
 
-static void Mix(short *pFinalOut, unsigned Frames)
-{
-	int MasterVol;
-	mem_zero(m_pMixBuffer, m_MaxFrames*2*sizeof(int));
-	Frames = min(Frames, m_MaxFrames);
-
-	// aquire lock while we are mixing
-	lock_wait(m_SoundLock);
-
-	MasterVol = m_SoundVolume;
-
-	for(unsigned i = 0; i < NUM_VOICES; i++)
-	{
-		if(m_aVoices[i].m_pSample)
-		{
-			// mix voice
-			CVoice *v = &m_aVoices[i];
-			int *pOut = m_pMixBuffer;
-
-			int Step = v->m_pSample->m_Channels; // setup input sources
-			short *pInL = &v->m_pSample->m_pData[v->m_Tick*Step];
-			short *pInR = &v->m_pSample->m_pData[v->m_Tick*Step+1];
-
-			unsigned End = v->m_pSample->m_NumFrames-v->m_Tick;
-
-			int Rvol = v->m_pChannel->m_Vol;
-			int Lvol = v->m_pChannel->m_Vol;
-
-			// make sure that we don't go outside the sound data
-			if(Frames < End)
-				End = Frames;
-
-			// check if we have a mono sound
-			if(v->m_pSample->m_Channels == 1)
-				pInR = pInL;
-
-			// volume calculation
-			if(v->m_Flags&ISound::FLAG_POS && v->m_pChannel->m_Pan)
-			{
-				// TODO: we should respect the channel panning value
-				const int Range = 1500; // magic value, remove
-				int dx = v->m_X - m_CenterX;
-				int dy = v->m_Y - m_CenterY;
-				int Dist = (int)sqrtf((float)dx*dx+dy*dy); // float here. nasty
-				int p = IntAbs(dx);
-				if(Dist >= 0 && Dist < Range)
-				{
-					// panning
-					if(dx > 0)
-						Lvol = ((Range-p)*Lvol)/Range;
-					else
-						Rvol = ((Range-p)*Rvol)/Range;
-
-					// falloff
-					Lvol = (Lvol*(Range-Dist))/Range;
-					Rvol = (Rvol*(Range-Dist))/Range;
-				}
-				else
-				{
-					Lvol = 0;
-					Rvol = 0;
-				}
-			}
-
-			// process all frames
-			for(unsigned s = 0; s < End; s++)
-			{
-				*pOut++ += (*pInL)*Lvol;
-				*pOut++ += (*pInR)*Rvol;
-				pInL += Step;
-				pInR += Step;
-				v->m_Tick++;
-			}
-
-			// free voice if not used any more
-			if(v->m_Tick == v->m_pSample->m_NumFrames)
-			{
-				if(v->m_Flags&ISound::FLAG_LOOP)
-					v->m_Tick = 0;
-				else
-					v->m_pSample = 0;
-			}
-		}
-	}
-
-
-	// release the lock
-	lock_release(m_SoundLock);
-
-	{
-		// clamp accumulated values
-		// TODO: this seams slow
-		for(unsigned i = 0; i < Frames; i++)
-		{
-			int j = i<<1;
-			int vl = ((m_pMixBuffer[j]*MasterVol)/101)>>8;
-			int vr = ((m_pMixBuffer[j+1]*MasterVol)/101)>>8;
 
-			pFinalOut[j] = Int2Short(vl);
-			pFinalOut[j+1] = Int2Short(vr);
-		}
-	}
-
-#if defined(CONF_ARCH_ENDIAN_BIG)
-	swap_endian(pFinalOut, sizeof(short), Frames * 2);
-#endif
-}
-
-static void SdlCallback(void *pUnused, Uint8 *pStream, int Len)
+CSound::CSound()
 {
-	(void)pUnused;
-	Mix((short *)pStream, Len/2/2);
+	m_SoundEnabled = 0;
+	m_DecodeLock = lock_create();
+	m_SampleLock = lock_create();
 }
 
-
 int CSound::Init()
 {
 	m_SoundEnabled = 0;
@@ -207,8 +46,6 @@ int CSound::Init()
 
 	SDL_AudioSpec Format;
 
-	m_SoundLock = lock_create();
-
 	if(!g_Config.m_SndEnable)
 		return 0;
 
@@ -237,8 +74,7 @@ int CSound::Init()
 	else
 		dbg_msg("client/sound", "sound init successful");
 
-	m_MaxFrames = g_Config.m_SndBufferSize*2;
-	m_pMixBuffer = (int *)mem_alloc(m_MaxFrames*2*sizeof(int), 1);
+	m_Mixer.Init(g_Config.m_SndBufferSize*2);
 
 	SDL_PauseAudio(0);
 
@@ -255,12 +91,7 @@ int CSound::Update()
 	if(!m_pGraphics->WindowActive() && g_Config.m_SndNonactiveMute)
 		WantedVolume = 0;
 
-	if(WantedVolume != m_SoundVolume)
-	{
-		lock_wait(m_SoundLock);
-		m_SoundVolume = WantedVolume;
-		lock_release(m_SoundLock);
-	}
+	m_Mixer.m_Volume = WantedVolume;
 
 	return 0;
 }
@@ -269,30 +100,24 @@ int CSound::Shutdown()
 {
 	SDL_CloseAudio();
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
-	lock_destroy(m_SoundLock);
-	if(m_pMixBuffer)
-	{
-		mem_free(m_pMixBuffer);
-		m_pMixBuffer = 0;
-	}
+	m_Mixer.Shutdown();
 	return 0;
 }
 
 int CSound::AllocID()
 {
 	// TODO: linear search, get rid of it
-	for(unsigned SampleID = 0; SampleID < NUM_SAMPLES; SampleID++)
+	for(unsigned SampleID = 0; SampleID < CSoundMixer::NUM_SAMPLES; SampleID++)
 	{
-		if(m_aSamples[SampleID].m_pData == 0x0)
+		if(m_Mixer.m_aSamples[SampleID].m_pData == 0x0)
 			return SampleID;
 	}
 
 	return -1;
 }
 
-void CSound::RateConvert(int SampleID)
+static void RateConvert(CSample *pSample)
 {
-	CSample *pSample = &m_aSamples[SampleID];
 	int NumFrames = 0;
 	short *pNewData = 0;
 
@@ -326,16 +151,20 @@ void CSound::RateConvert(int SampleID)
 	mem_free(pSample->m_pData);
 	pSample->m_pData = pNewData;
 	pSample->m_NumFrames = NumFrames;
+	pSample->m_Rate = m_MixingRate;
 }
 
 int CSound::ReadData(void *pBuffer, int Size)
 {
-	return io_read(ms_File, pBuffer, Size);
+	int Bytes = min(Size, (int)(ms_ReadSize-ms_ReadPos));
+	mem_copy(pBuffer, ms_pReadData+ms_ReadPos, Bytes);
+	ms_ReadPos += Bytes;
+	return Bytes;
 }
 
 int CSound::LoadWV(const char *pFilename)
 {
-	CSample *pSample;
+	CSample Sample;
 	int SampleID = -1;
 	char aError[100];
 	WavpackContext *pContext;
@@ -351,17 +180,27 @@ int CSound::LoadWV(const char *pFilename)
 	if(!m_pStorage)
 		return -1;
 
-	ms_File = m_pStorage->OpenFile(pFilename, IOFLAG_READ, IStorage::TYPE_ALL);
-	if(!ms_File)
+	// this runs on the job threads while the client starts up. reading the file
+	// and resampling happen in parallel, the decoder is shared
+	IOHANDLE File = m_pStorage->OpenFile(pFilename, IOFLAG_READ, IStorage::TYPE_ALL);
+	if(!File)
 	{
 		dbg_msg("sound/wv", "failed to open file. filename='%s'", pFilename);
 		return -1;
 	}
 
-	SampleID = AllocID();
-	if(SampleID < 0)
-		return -1;
-	pSample = &m_aSamples[SampleID];
+	unsigned FileSize = (unsigned)io_length(File);
+	unsigned char *pFileData = (unsigned char *)mem_alloc(FileSize, 1);
+	FileSize = io_read(File, pFileData, FileSize);
+	io_close(File);
+
+	mem_zero(&Sample, sizeof(Sample));
+
+	// wavpack decodes into a single global context
+	lock_wait(m_DecodeLock);
+	ms_pReadData = pFileData;
+	ms_ReadSize = FileSize;
+	ms_ReadPos = 0;
 
 	pContext = WavpackOpenFileInput(ReadData, aError);
 	if (pContext)
@@ -375,109 +214,86 @@ int CSound::LoadWV(const char *pFilename)
 		short *pDst;
 		int i;
 
-		pSample->m_Channels = m_aChannels;
-		pSample->m_Rate = SampleRate;
+		Sample.m_Channels = m_aChannels;
+		Sample.m_Rate = SampleRate;
 
-		if(pSample->m_Channels > 2)
-		{
+		if(Sample.m_Channels > 2)
 			dbg_msg("sound/wv", "file is not mono or stereo. filename='%s'", pFilename);
-			return -1;
-		}
-
-		/*
-		if(snd->rate != 44100)
-		{
-			dbg_msg("sound/wv", "file is %d Hz, not 44100 Hz. filename='%s'", snd->rate, filename);
-			return -1;
-		}*/
-
-		if(BitsPerSample != 16)
-		{
+		else if(BitsPerSample != 16)
 			dbg_msg("sound/wv", "bps is %d, not 16, filname='%s'", BitsPerSample, pFilename);
-			return -1;
-		}
-
-		pData = (int *)mem_alloc(4*m_aSamples*m_aChannels, 1);
-		WavpackUnpackSamples(pContext, pData, m_aSamples); // TODO: check return value
-		pSrc = pData;
+		else
+		{
+			pData = (int *)mem_alloc(4*m_aSamples*m_aChannels, 1);
+			WavpackUnpackSamples(pContext, pData, m_aSamples); // TODO: check return value
+			pSrc = pData;
 
-		pSample->m_pData = (short *)mem_alloc(2*m_aSamples*m_aChannels, 1);
-		pDst = pSample->m_pData;
+			Sample.m_pData = (short *)mem_alloc(2*m_aSamples*m_aChannels, 1);
+			pDst = Sample.m_pData;
 
-		for (i = 0; i < m_aSamples*m_aChannels; i++)
-			*pDst++ = (short)*pSrc++;
+			for (i = 0; i < m_aSamples*m_aChannels; i++)
+				*pDst++ = (short)*pSrc++;
 
-		mem_free(pData);
+			mem_free(pData);
 
-		pSample->m_NumFrames = m_aSamples;
-		pSample->m_LoopStart = -1;
-		pSample->m_LoopEnd = -1;
-		pSample->m_PausedAt = 0;
+			Sample.m_NumFrames = m_aSamples;
+			Sample.m_LoopStart = -1;
+			Sample.m_LoopEnd = -1;
+			Sample.m_PausedAt = 0;
+		}
 	}
 	else
 	{
 		dbg_msg("sound/wv", "failed to open %s: %s", pFilename, aError);
 	}
 
-	io_close(ms_File);
-	ms_File = NULL;
+	ms_pReadData = 0;
+	lock_release(m_DecodeLock);
+	mem_free(pFileData);
+
+	if(!Sample.m_pData)
+		return -1;
+
+	RateConvert(&Sample);
+
+	// hand the sample to the mixer. it is only read once something plays it,
+	// which can't happen before its id is returned
+	lock_wait(m_SampleLock);
+	SampleID = AllocID();
+	if(SampleID >= 0)
+		m_Mixer.m_aSamples[SampleID] = Sample;
+	lock_release(m_SampleLock);
+
+	if(SampleID < 0)
+	{
+		mem_free(Sample.m_pData);
+		return -1;
+	}
 
 	if(g_Config.m_Debug)
 		dbg_msg("sound/wv", "loaded %s", pFilename);
 
-	RateConvert(SampleID);
 	return SampleID;
 }
 
 void CSound::SetListenerPos(float x, float y)
 {
-	m_CenterX = (int)x;
-	m_CenterY = (int)y;
+	m_Mixer.m_CenterX = (int)x;
+	m_Mixer.m_CenterY = (int)y;
 }
 
 
 void CSound::SetChannel(int ChannelID, float Vol, float Pan)
 {
-	m_aChannels[ChannelID].m_Vol = (int)(Vol*255.0f);
-	m_aChannels[ChannelID].m_Pan = (int)(Pan*255.0f); // TODO: this is only on and off right now
+	m_Mixer.m_aChannels[ChannelID].m_Vol = (int)(Vol*255.0f);
+	m_Mixer.m_aChannels[ChannelID].m_Pan = (int)(Pan*255.0f); // TODO: this is only on and off right now
 }
 
 int CSound::Play(int ChannelID, int SampleID, int Flags, float x, float y)
 {
-	int VoiceID = -1;
-	int i;
-
-	lock_wait(m_SoundLock);
-
-	// search for voice
-	for(i = 0; i < NUM_VOICES; i++)
-	{
-		int id = (m_NextVoice + i) % NUM_VOICES;
-		if(!m_aVoices[id].m_pSample)
-		{
-			VoiceID = id;
-			m_NextVoice = id+1;
-			break;
-		}
-	}
-
-	// voice found, use it
-	if(VoiceID != -1)
-	{
-		m_aVoices[VoiceID].m_pSample = &m_aSamples[SampleID];
-		m_aVoices[VoiceID].m_pChannel = &m_aChannels[ChannelID];
-		if(Flags & FLAG_LOOP)
-			m_aVoices[VoiceID].m_Tick = m_aSamples[SampleID].m_PausedAt;
-		else
-			m_aVoices[VoiceID].m_Tick = 0;
-		m_aVoices[VoiceID].m_Vol = 255;
-		m_aVoices[VoiceID].m_Flags = Flags;
-		m_aVoices[VoiceID].m_X = (int)x;
-		m_aVoices[VoiceID].m_Y = (int)y;
-	}
-
-	lock_release(m_SoundLock);
-	return VoiceID;
+	// nothing drains the command queue without a device
+	if(!m_SoundEnabled)
+		return -1;
+	return m_Mixer.Play(ChannelID, SampleID, Flags, (int)x, (int)y);
 }
 
 int CSound::PlayAt(int ChannelID, int SampleID, int Flags, float x, float y)
@@ -492,42 +308,19 @@ int CSound::Play(int ChannelID, int SampleID, int Flags)
 
 void CSound::Stop(int SampleID)
 {
-	// TODO: a nice fade out
-	lock_wait(m_SoundLock);
-	CSample *pSample = &m_aSamples[SampleID];
-	for(int i = 0; i < NUM_VOICES; i++)
-	{
-		if(m_aVoices[i].m_pSample == pSample)
-		{
-			if(m_aVoices[i].m_Flags & FLAG_LOOP)
-				m_aVoices[i].m_pSample->m_PausedAt = m_aVoices[i].m_Tick;
-			else
-				m_aVoices[i].m_pSample->m_PausedAt = 0;
-			m_aVoices[i].m_pSample = 0;
-		}
-	}
-	lock_release(m_SoundLock);
+	if(m_SoundEnabled)
+		m_Mixer.Stop(SampleID);
 }
 
 void CSound::StopAll()
 {
-	// TODO: a nice fade out
-	lock_wait(m_SoundLock);
-	for(int i = 0; i < NUM_VOICES; i++)
-	{
-		if(m_aVoices[i].m_pSample)
-		{
-			if(m_aVoices[i].m_Flags & FLAG_LOOP)
-				m_aVoices[i].m_pSample->m_PausedAt = m_aVoices[i].m_Tick;
-			else
-				m_aVoices[i].m_pSample->m_PausedAt = 0;
-		}
-		m_aVoices[i].m_pSample = 0;
-	}
-	lock_release(m_SoundLock);
+	if(m_SoundEnabled)
+		m_Mixer.StopAll();
 }
 
-IOHANDLE CSound::ms_File = 0;
+const unsigned char *CSound::ms_pReadData = 0;
+unsigned CSound::ms_ReadSize = 0;
+unsigned CSound::ms_ReadPos = 0;
 
 IEngineSound *CreateEngineSound() { return new CSound; }
 
@@ -9,22 +9,28 @@ class CSound : public IEngineSound
 {
 	int m_SoundEnabled;
 
+	// LoadWV can run on several job threads at once
+	LOCK m_DecodeLock;
+	LOCK m_SampleLock;
+
+	// the file being decoded, guarded by m_DecodeLock
+	static const unsigned char *ms_pReadData;
+	static unsigned ms_ReadSize;
+	static unsigned ms_ReadPos;
+	static int ReadData(void *pBuffer, int Size);
+
 public:
 	IEngineGraphics *m_pGraphics;
 	IStorage *m_pStorage;
 
+	CSound();
+
 	virtual int Init();
 
 	int Update();
 	int Shutdown();
 	int AllocID();
 
-	static void RateConvert(int SampleID);
-
-	// TODO: Refactor: clean this mess up
-	static IOHANDLE ms_File;
-	static int ReadData(void *pBuffer, int Size);
-
 	virtual bool IsSoundEnabled() { return m_SoundEnabled != 0; }
 
 	virtual int LoadWV(const char *pFilename);
@@ -0,0 +1,363 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/threading.h>
+
+#include <engine/sound.h>
+
+#include "sound_mixer.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MIXER_SSE2
+#endif
+
+CSoundMixer::CSoundMixer()
+{
+	mem_zero(m_aVoices, sizeof(m_aVoices));
+	mem_zero(m_aSamples, sizeof(m_aSamples));
+	for(int i = 0; i < NUM_CHANNELS; i++)
+	{
+		m_aChannels[i].m_Vol = 255;
+		m_aChannels[i].m_Pan = 0;
+	}
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		m_aVoiceSample[i] = -1;
+		m_aVoiceStarted[i] = 0;
+		m_aVoiceEnded[i] = 0;
+	}
+	m_NextVoice = 0;
+	m_CommandWrite = 0;
+	m_CommandRead = 0;
+	m_pMixBuffer = 0;
+	m_MaxFrames = 0;
+	m_CenterX = 0;
+	m_CenterY = 0;
+	m_Volume = 100;
+}
+
+void CSoundMixer::Init(unsigned MaxFrames)
+{
+	m_MaxFrames = MaxFrames;
+	m_pMixBuffer = (int *)mem_alloc(m_MaxFrames*2*sizeof(int), 16);
+}
+
+void CSoundMixer::Shutdown()
+{
+	if(m_pMixBuffer)
+	{
+		mem_free(m_pMixBuffer);
+		m_pMixBuffer = 0;
+	}
+	m_MaxFrames = 0;
+}
+
+bool CSoundMixer::PushCommand(const CCommand &Cmd, bool Wait)
+{
+	// only the game thread writes, only the audio thread reads
+	while(m_CommandWrite - m_CommandRead >= COMMAND_QUEUE_SIZE)
+	{
+		if(!Wait)
+			return false;
+		thread_yield();
+	}
+
+	unsigned Write = m_CommandWrite;
+	m_aCommands[Write&(COMMAND_QUEUE_SIZE-1)] = Cmd;
+	sync_barrier(); // the command has to be visible before the position
+	m_CommandWrite = Write+1;
+	return true;
+}
+
+int CSoundMixer::Play(int ChannelID, int SampleID, int Flags, int x, int y)
+{
+	if(SampleID < 0 || SampleID >= NUM_SAMPLES || !m_aSamples[SampleID].m_pData || m_aSamples[SampleID].m_NumFrames <= 0)
+		return -1;
+
+	// search for voice
+	int VoiceID = -1;
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		int id = (m_NextVoice + i) % NUM_VOICES;
+		if(m_aVoiceSample[id] == -1 || m_aVoiceEnded[id] == m_aVoiceStarted[id])
+		{
+			VoiceID = id;
+			break;
+		}
+	}
+
+	if(VoiceID == -1)
+		return -1;
+
+	CCommand Cmd;
+	Cmd.m_Type = CMD_PLAY;
+	Cmd.m_Voice = VoiceID;
+	Cmd.m_Seq = m_aVoiceStarted[VoiceID]+1;
+	Cmd.m_Sample = SampleID;
+	Cmd.m_Channel = ChannelID;
+	Cmd.m_Flags = Flags;
+	Cmd.m_X = x;
+	Cmd.m_Y = y;
+
+	// dropping a sound is better than stalling the game on the audio thread
+	if(!PushCommand(Cmd, false))
+		return -1;
+
+	m_aVoiceStarted[VoiceID] = Cmd.m_Seq;
+	m_aVoiceSample[VoiceID] = SampleID;
+	m_NextVoice = VoiceID+1;
+	return VoiceID;
+}
+
+void CSoundMixer::Stop(int SampleID)
+{
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		if(m_aVoiceSample[i] != SampleID)
+			continue;
+
+		if(m_aVoiceEnded[i] != m_aVoiceStarted[i])
+		{
+			CCommand Cmd;
+			mem_zero(&Cmd, sizeof(Cmd));
+			Cmd.m_Type = CMD_STOP;
+			Cmd.m_Voice = i;
+			Cmd.m_Seq = m_aVoiceStarted[i];
+			PushCommand(Cmd, true); // a lost stop would leave loops playing
+		}
+		m_aVoiceSample[i] = -1;
+	}
+}
+
+void CSoundMixer::StopAll()
+{
+	CCommand Cmd;
+	mem_zero(&Cmd, sizeof(Cmd));
+	Cmd.m_Type = CMD_STOPALL;
+	PushCommand(Cmd, true);
+
+	for(int i = 0; i < NUM_VOICES; i++)
+		m_aVoiceSample[i] = -1;
+}
+
+void CSoundMixer::StopVoice(CVoice *pVoice)
+{
+	// TODO: a nice fade out
+	if(pVoice->m_Flags&ISound::FLAG_LOOP)
+		pVoice->m_pSample->m_PausedAt = pVoice->m_Tick;
+	else
+		pVoice->m_pSample->m_PausedAt = 0;
+	pVoice->m_pSample = 0;
+}
+
+void CSoundMixer::ProcessCommands()
+{
+	unsigned Write = m_CommandWrite;
+	sync_barrier(); // read the position before the commands
+
+	for(unsigned Read = m_CommandRead; Read != Write; Read++)
+	{
+		const CCommand *pCmd = &m_aCommands[Read&(COMMAND_QUEUE_SIZE-1)];
+		if(pCmd->m_Type == CMD_PLAY)
+		{
+			CVoice *pVoice = &m_aVoices[pCmd->m_Voice];
+			pVoice->m_pSample = &m_aSamples[pCmd->m_Sample];
+			pVoice->m_pChannel = &m_aChannels[pCmd->m_Channel];
+			pVoice->m_Seq = pCmd->m_Seq;
+			pVoice->m_Flags = pCmd->m_Flags;
+			pVoice->m_X = pCmd->m_X;
+			pVoice->m_Y = pCmd->m_Y;
+			if(pCmd->m_Flags&ISound::FLAG_LOOP)
+				pVoice->m_Tick = clamp(pVoice->m_pSample->m_PausedAt, 0, pVoice->m_pSample->m_NumFrames-1);
+			else
+				pVoice->m_Tick = 0;
+		}
+		else if(pCmd->m_Type == CMD_STOP)
+		{
+			CVoice *pVoice = &m_aVoices[pCmd->m_Voice];
+			if(pVoice->m_pSample && pVoice->m_Seq == pCmd->m_Seq)
+				StopVoice(pVoice);
+		}
+		else if(pCmd->m_Type == CMD_STOPALL)
+		{
+			for(int i = 0; i < NUM_VOICES; i++)
+				if(m_aVoices[i].m_pSample)
+					StopVoice(&m_aVoices[i]);
+		}
+	}
+
+	sync_barrier(); // done with the commands before handing the slots back
+	m_CommandRead = Write;
+}
+
+bool CSoundMixer::VoiceVolume(const CVoice *pVoice, int *pLvol, int *pRvol) const
+{
+	int Lvol = pVoice->m_pChannel->m_Vol;
+	int Rvol = pVoice->m_pChannel->m_Vol;
+
+	if(pVoice->m_Flags&ISound::FLAG_POS && pVoice->m_pChannel->m_Pan)
+	{
+		// TODO: we should respect the channel panning value
+		const int Range = FALLOFF_RANGE;
+		int dx = pVoice->m_X - m_CenterX;
+		int dy = pVoice->m_Y - m_CenterY;
+
+		// most positioned sounds are out of range, only take the root for the rest
+		float DistSq = (float)dx*dx + (float)dy*dy;
+		if(DistSq >= (float)Range*Range)
+			Lvol = Rvol = 0;
+		else
+		{
+			int Dist = (int)sqrtf(DistSq);
+			int p = absolute(dx);
+
+			// panning
+			if(dx > 0)
+				Lvol = ((Range-p)*Lvol)/Range;
+			else
+				Rvol = ((Range-p)*Rvol)/Range;
+
+			// falloff
+			Lvol = (Lvol*(Range-Dist))/Range;
+			Rvol = (Rvol*(Range-Dist))/Range;
+		}
+	}
+
+	*pLvol = Lvol;
+	*pRvol = Rvol;
+	return Lvol != 0 || Rvol != 0;
+}
+
+void CSoundMixer::MixVoice(int VoiceID, unsigned Frames)
+{
+	CVoice *pVoice = &m_aVoices[VoiceID];
+	CSample *pSample = pVoice->m_pSample;
+	int Lvol, Rvol;
+	bool Audible = VoiceVolume(pVoice, &Lvol, &Rvol);
+	int *pOut = m_pMixBuffer;
+
+	// silent voices only advance, loops wrap around within the same buffer
+	while(Frames)
+	{
+		unsigned Block = min(Frames, (unsigned)(pSample->m_NumFrames-pVoice->m_Tick));
+		if(Audible)
+			MixFrames(pOut, &pSample->m_pData[pVoice->m_Tick*pSample->m_Channels], pSample->m_Channels, Block, Lvol, Rvol);
+		pOut += Block*2;
+		Frames -= Block;
+		pVoice->m_Tick += Block;
+
+		if(pVoice->m_Tick == pSample->m_NumFrames)
+		{
+			if(pVoice->m_Flags&ISound::FLAG_LOOP)
+				pVoice->m_Tick = 0;
+			else
+			{
+				// free voice, the game thread picks it up from here
+				pVoice->m_pSample = 0;
+				m_aVoiceEnded[VoiceID] = pVoice->m_Seq;
+				break;
+			}
+		}
+	}
+}
+
+void CSoundMixer::Mix(short *pFinalOut, unsigned Frames)
+{
+	ProcessCommands();
+
+	Frames = min(Frames, m_MaxFrames);
+	mem_zero(m_pMixBuffer, Frames*2*sizeof(int));
+
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		if(m_aVoices[i].m_pSample)
+			MixVoice(i, Frames);
+	}
+
+	ClampOutput(pFinalOut, m_pMixBuffer, Frames*2, m_Volume);
+
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(pFinalOut, sizeof(short), Frames * 2);
+#endif
+}
+
+#if defined(MIXER_SSE2)
+// multiplies 8 interleaved samples with their channel volume and adds them to 8 ints
+static inline void MixBlock(int *pOut, __m128i In, __m128i Vol)
+{
+	__m128i Lo = _mm_mullo_epi16(In, Vol);
+	__m128i Hi = _mm_mulhi_epi16(In, Vol);
+	__m128i *pDst = (__m128i *)pOut;
+	_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_unpacklo_epi16(Lo, Hi)));
+	_mm_storeu_si128(pDst+1, _mm_add_epi32(_mm_loadu_si128(pDst+1), _mm_unpackhi_epi16(Lo, Hi)));
+}
+#endif
+
+void CSoundMixer::MixFrames(int *pOut, const short *pIn, int Channels, unsigned Frames, int Lvol, int Rvol)
+{
+	unsigned i = 0;
+#if defined(MIXER_SSE2)
+	// volumes are 0-255, so the 16-bit multiply is exact
+	const __m128i Vol = _mm_set_epi16(Rvol, Lvol, Rvol, Lvol, Rvol, Lvol, Rvol, Lvol);
+	if(Channels == 2)
+	{
+		for(; i+4 <= Frames; i += 4)
+			MixBlock(pOut+i*2, _mm_loadu_si128((const __m128i *)(pIn+i*2)), Vol);
+	}
+	else
+	{
+		// duplicate mono samples into both channels
+		for(; i+8 <= Frames; i += 8)
+		{
+			__m128i In = _mm_loadu_si128((const __m128i *)(pIn+i));
+			MixBlock(pOut+i*2, _mm_unpacklo_epi16(In, In), Vol);
+			MixBlock(pOut+i*2+8, _mm_unpackhi_epi16(In, In), Vol);
+		}
+	}
+#endif
+	MixFramesScalar(pOut+i*2, pIn+i*Channels, Channels, Frames-i, Lvol, Rvol);
+}
+
+void CSoundMixer::MixFramesScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int Lvol, int Rvol)
+{
+	const short *pInL = pIn;
+	const short *pInR = Channels == 1 ? pIn : pIn+1;
+	for(unsigned s = 0; s < Frames; s++)
+	{
+		*pOut++ += (*pInL)*Lvol;
+		*pOut++ += (*pInR)*Rvol;
+		pInL += Channels;
+		pInR += Channels;
+	}
+}
+
+void CSoundMixer::ClampOutput(short *pOut, const int *pIn, unsigned Samples, int MasterVol)
+{
+	unsigned i = 0;
+#if defined(MIXER_SSE2)
+	const __m128 Scale = _mm_set1_ps(MasterVol/(101.0f*256.0f));
+	const __m128 Max = _mm_set1_ps(32767.0f);
+	const __m128 Min = _mm_set1_ps(-32767.0f);
+	for(; i+8 <= Samples; i += 8)
+	{
+		__m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pIn+i))), Scale);
+		__m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pIn+i+4))), Scale);
+		a = _mm_min_ps(_mm_max_ps(a, Min), Max);
+		b = _mm_min_ps(_mm_max_ps(b, Min), Max);
+		_mm_storeu_si128((__m128i *)(pOut+i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+	}
+#endif
+	ClampOutputScalar(pOut+i, pIn+i, Samples-i, MasterVol);
+}
+
+void CSoundMixer::ClampOutputScalar(short *pOut, const int *pIn, unsigned Samples, int MasterVol)
+{
+	// same scale as ((v*MasterVol)/101)>>8, in float so a loud mix can't overflow
+	const float Scale = MasterVol/(101.0f*256.0f);
+	for(unsigned i = 0; i < Samples; i++)
+		pOut[i] = (short)clamp(pIn[i]*Scale, -32767.0f, 32767.0f);
+}
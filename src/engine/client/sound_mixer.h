@@ -0,0 +1,122 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_CLIENT_SOUND_MIXER_H
+#define ENGINE_CLIENT_SOUND_MIXER_H
+
+// software mixer behind CSound. the game thread never touches the voices, it
+// pushes play and stop commands into a single producer, single consumer queue
+// that the audio thread drains at the start of every mix. nothing in here
+// talks to the audio device, so it can be driven offline as well.
+class CSoundMixer
+{
+public:
+	enum
+	{
+		NUM_SAMPLES=512,
+		NUM_VOICES=64,
+		NUM_CHANNELS=16,
+
+		COMMAND_QUEUE_SIZE=512, // must be a power of two
+
+		// distance at which positioned sounds become silent
+		FALLOFF_RANGE=1500,
+	};
+
+	struct CSample
+	{
+		short *m_pData;
+		int m_NumFrames;
+		int m_Rate;
+		int m_Channels;
+		int m_LoopStart;
+		int m_LoopEnd;
+		int m_PausedAt; // only touched by the audio thread once the sample is loaded
+	};
+
+	struct CChannel
+	{
+		int m_Vol;
+		int m_Pan;
+	};
+
+private:
+	struct CVoice
+	{
+		CSample *m_pSample;
+		CChannel *m_pChannel;
+		unsigned m_Seq;
+		int m_Tick;
+		int m_Flags;
+		int m_X, m_Y;
+	};
+
+	enum
+	{
+		CMD_PLAY=0,
+		CMD_STOP,
+		CMD_STOPALL,
+	};
+
+	struct CCommand
+	{
+		int m_Type;
+		int m_Voice;
+		unsigned m_Seq;
+		int m_Sample;
+		int m_Channel;
+		int m_Flags;
+		int m_X, m_Y;
+	};
+
+	// audio thread
+	CVoice m_aVoices[NUM_VOICES];
+	int *m_pMixBuffer;
+	unsigned m_MaxFrames;
+
+	// game thread. a voice is free again when the game stopped it or when the
+	// mixer reports that the last start on it has run out
+	int m_aVoiceSample[NUM_VOICES];
+	unsigned m_aVoiceStarted[NUM_VOICES];
+	volatile unsigned m_aVoiceEnded[NUM_VOICES];
+	int m_NextVoice;
+
+	CCommand m_aCommands[COMMAND_QUEUE_SIZE];
+	volatile unsigned m_CommandWrite;
+	volatile unsigned m_CommandRead;
+
+	bool PushCommand(const CCommand &Cmd, bool Wait);
+	void ProcessCommands();
+	void StopVoice(CVoice *pVoice);
+	bool VoiceVolume(const CVoice *pVoice, int *pLvol, int *pRvol) const;
+	void MixVoice(int VoiceID, unsigned Frames);
+
+public:
+	CSample m_aSamples[NUM_SAMPLES];
+	CChannel m_aChannels[NUM_CHANNELS];
+
+	// read by the audio thread on every mix, a stale value only lasts one buffer
+	volatile int m_CenterX;
+	volatile int m_CenterY;
+	volatile int m_Volume;
+
+	CSoundMixer();
+
+	void Init(unsigned MaxFrames);
+	void Shutdown();
+
+	// game thread
+	int Play(int ChannelID, int SampleID, int Flags, int x, int y);
+	void Stop(int SampleID);
+	void StopAll();
+
+	// audio thread, mixes interleaved 16-bit stereo
+	void Mix(short *pFinalOut, unsigned Frames);
+
+	// inner loops, the vector versions fall back to the scalar ones for the remainder
+	static void MixFrames(int *pOut, const short *pIn, int Channels, unsigned Frames, int Lvol, int Rvol);
+	static void MixFramesScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int Lvol, int Rvol);
+	static void ClampOutput(short *pOut, const int *pIn, unsigned Samples, int MasterVol);
+	static void ClampOutputScalar(short *pOut, const int *pIn, unsigned Samples, int MasterVol);
+};
+
+#endif
@@ -2,7 +2,9 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <base/system.h>
 #include <base/math.h>
+#include <base/tl/array.h>
 #include <engine/graphics.h>
+#include <engine/storage.h>
 #include <engine/textrender.h>
 
 #ifdef CONF_FAMILY_WINDOWS
@@ -13,19 +15,62 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-// TODO: Refactor: clean this up
+#include <zlib.h>
+
 enum
 {
-	MAX_CHARACTERS = 64,
+	ATLAS_START_SIZE=512,
+	ATLAS_MAX_SIZE=2048,
+
+	GLYPH_HASH_SIZE=1024, // must be a power of two
+
+	LAYOUT_CACHE_SIZE=512, // must be a power of two
+	LAYOUT_CACHE_MAX_TEXT=128,
+
+	GLYPH_CACHE_VERSION=1,
 };
 
 
 static int aFontSizes[] = {8,9,10,11,12,13,14,15,16,17,18,19,20,36,64};
 #define NUM_FONT_SIZES (sizeof(aFontSizes)/sizeof(int))
 
+// a rasterized glyph as the glyph cache file stores it, followed by
+// m_Width*m_Height bytes of the glyph and as many of its outline,
+// padded to keep the next one aligned
+struct CGlyphBitmap
+{
+	int m_Chr;
+	int m_FontSize;
+	int m_Width; // including the outline and one pixel of border
+	int m_Height;
+	int m_Left;
+	int m_Top;
+	int m_Advance;
+};
+
+static int GlyphRecordSize(int Width, int Height)
+{
+	return (sizeof(CGlyphBitmap) + Width*Height*2 + 3)&~3;
+}
+
+struct CGlyphCacheHeader
+{
+	char m_aID[4];
+	int m_Version;
+	unsigned m_FontCrc;
+};
+
+struct CCachedGlyph
+{
+	const CGlyphBitmap *m_pBitmap;
+	int m_Next;
+};
+
 struct CFontChar
 {
 	int m_ID;
+	int m_SizeIndex;
+	int m_Next;
 
 	// these values are scaled to the pFont size
 	// width * font_size == real_size
@@ -36,27 +81,14 @@ struct CFontChar
 	float m_AdvanceX;
 
 	float m_aUvs[4];
-	int64 m_TouchTime;
 };
 
-struct CFontSizeData
+// a row in the atlas, glyphs of about its height are placed next to each other
+struct CAtlasShelf
 {
-	int m_FontSize;
-	FT_Face *m_pFace;
-
-	int m_aTextures[2];
-	int m_TextureWidth;
-	int m_TextureHeight;
-
-	int m_NumXChars;
-	int m_NumYChars;
-
-	int m_CharMaxWidth;
-	int m_CharMaxHeight;
-
-	CFontChar m_aCharacters[MAX_CHARACTERS*MAX_CHARACTERS];
-
-	int m_CurrentCharacter;
+	int m_Y;
+	int m_Height;
+	int m_Width;
 };
 
 class CFont
@@ -64,14 +96,36 @@ class CFont
 public:
 	char m_aFilename[512];
 	FT_Face m_FtFace;
-	CFontSizeData m_aSizes[NUM_FONT_SIZES];
+	int m_CurrentSize;
+
+	// all sizes share one atlas, the outlines go into a second texture at the same place
+	int m_aTextures[2];
+	int m_AtlasSize;
+	int m_AtlasGeneration;
+	array<CAtlasShelf> m_lShelves;
+	int m_ShelvesHeight;
+
+	// glyphs in the atlas
+	array<CFontChar> m_lChars;
+	int m_aCharHash[GLYPH_HASH_SIZE];
+
+	// every glyph rasterized so far, loaded from the glyph cache or rendered by freetype
+	array<CCachedGlyph> m_lGlyphs;
+	int m_aGlyphHash[GLYPH_HASH_SIZE];
+	unsigned char *m_pCacheData;
+	array<void *> m_lGlyphAllocs;
+	unsigned m_FontCrc;
+	char m_aCacheFilename[512];
+	IOHANDLE m_CacheFile;
 };
 
 
 class CTextRender : public IEngineTextRender
 {
 	IGraphics *m_pGraphics;
+	IStorage *m_pStorage;
 	IGraphics *Graphics() { return m_pGraphics; }
+	IStorage *Storage() { return m_pStorage; }
 
 	int WordLength(const char *pText)
 	{
@@ -103,6 +157,25 @@ class CTextRender : public IEngineTextRender
 
 	FT_Library m_FTLibrary;
 
+	// measurements of recently measured strings, TextWidth and TextLineCount
+	// get called with the same labels and names every frame
+	struct CLayoutEntry
+	{
+		unsigned m_Hash;
+		CFont *m_pFont;
+		int m_Length;
+		float m_Size;
+		float m_LineWidth;
+		float m_ScreenScaleX;
+		float m_ScreenScaleY;
+		char m_aText[LAYOUT_CACHE_MAX_TEXT];
+
+		float m_Width;
+		int m_LineCount;
+	};
+
+	CLayoutEntry m_aLayoutCache[LAYOUT_CACHE_SIZE];
+
 	int GetFontSizeIndex(int Pixelsize)
 	{
 		for(unsigned i = 0; i < NUM_FONT_SIZES; i++)
@@ -114,6 +187,10 @@ class CTextRender : public IEngineTextRender
 		return NUM_FONT_SIZES-1;
 	}
 
+	static unsigned GlyphHash(int Chr, int Size)
+	{
+		return ((unsigned)Chr*31 + (unsigned)Size)&(GLYPH_HASH_SIZE-1);
+	}
 
 
 	void Grow(unsigned char *pIn, unsigned char *pOut, int w, int h)
@@ -140,33 +217,34 @@ class CTextRender : public IEngineTextRender
 			}
 	}
 
-	void InitTexture(CFontSizeData *pSizeData, int CharWidth, int CharHeight, int Xchars, int Ychars)
+	// drops all glyphs from the atlas, they are uploaded again from the glyph cache when used
+	void InitAtlas(CFont *pFont, int Size)
 	{
 		static int FontMemoryUsage = 0;
-		int Width = CharWidth*Xchars;
-		int Height = CharHeight*Ychars;
-		void *pMem = mem_alloc(Width*Height, 1);
-		mem_zero(pMem, Width*Height);
+		void *pMem = mem_alloc(Size*Size, 1);
+		mem_zero(pMem, Size*Size);
 
 		for(int i = 0; i < 2; i++)
 		{
-			if(pSizeData->m_aTextures[i] != 0)
+			if(pFont->m_aTextures[i] != 0)
 			{
-				Graphics()->UnloadTexture(pSizeData->m_aTextures[i]);
-				FontMemoryUsage -= pSizeData->m_TextureWidth*pSizeData->m_TextureHeight;
-				pSizeData->m_aTextures[i] = 0;
+				Graphics()->UnloadTexture(pFont->m_aTextures[i]);
+				FontMemoryUsage -= pFont->m_AtlasSize*pFont->m_AtlasSize;
+				pFont->m_aTextures[i] = 0;
 			}
 
-			pSizeData->m_aTextures[i] = Graphics()->LoadTextureRaw(Width, Height, CImageInfo::FORMAT_ALPHA, pMem, CImageInfo::FORMAT_ALPHA, IGraphics::TEXLOAD_NOMIPMAPS);
-			FontMemoryUsage += Width*Height;
+			pFont->m_aTextures[i] = Graphics()->LoadTextureRaw(Size, Size, CImageInfo::FORMAT_ALPHA, pMem, CImageInfo::FORMAT_ALPHA, IGraphics::TEXLOAD_NOMIPMAPS);
+			FontMemoryUsage += Size*Size;
 		}
 
-		pSizeData->m_NumXChars = Xchars;
-		pSizeData->m_NumYChars = Ychars;
-		pSizeData->m_TextureWidth = Width;
-		pSizeData->m_TextureHeight = Height;
-		pSizeData->m_CurrentCharacter = 0;
-		
+		pFont->m_AtlasSize = Size;
+		pFont->m_AtlasGeneration++;
+		pFont->m_lShelves.clear();
+		pFont->m_ShelvesHeight = 0;
+		pFont->m_lChars.clear();
+		for(int i = 0; i < GLYPH_HASH_SIZE; i++)
+			pFont->m_aCharHash[i] = -1;
+
 		dbg_msg("", "pFont memory usage: %d", FontMemoryUsage);
 
 		mem_free(pMem);
@@ -181,248 +259,320 @@ class CTextRender : public IEngineTextRender
 		return OutlineThickness;
 	}
 
-	void IncreaseTextureSize(CFontSizeData *pSizeData)
-	{
-		if(pSizeData->m_TextureWidth < pSizeData->m_TextureHeight)
-			pSizeData->m_NumXChars <<= 1;
-		else
-			pSizeData->m_NumYChars <<= 1;
-		InitTexture(pSizeData, pSizeData->m_CharMaxWidth, pSizeData->m_CharMaxHeight, pSizeData->m_NumXChars, pSizeData->m_NumYChars);
-	}
-
-
-	// TODO: Refactor: move this into a pFont class
-	void InitIndex(CFont *pFont, int Index)
+	// shelf packing, the glyph goes onto the lowest shelf it fits on without
+	// wasting too much height, or onto a new shelf below the others
+	bool AtlasAlloc(CFont *pFont, int w, int h, int *pX, int *pY)
 	{
-		CFontSizeData *pSizeData = &pFont->m_aSizes[Index];
-
-		pSizeData->m_FontSize = aFontSizes[Index];
-		FT_Set_Pixel_Sizes(pFont->m_FtFace, 0, pSizeData->m_FontSize);
-
-		int OutlineThickness = AdjustOutlineThicknessToFontSize(1, pSizeData->m_FontSize);
+		// leave a pixel between the glyphs so filtering doesn't pick up the neighbours
+		w++;
+		h++;
 
+		int Best = -1;
+		for(int i = 0; i < pFont->m_lShelves.size(); i++)
 		{
-			unsigned GlyphIndex;
-			int MaxH = 0;
-			int MaxW = 0;
-
-			int Charcode = FT_Get_First_Char(pFont->m_FtFace, &GlyphIndex);
-			while(GlyphIndex != 0)
-			{
-				// do stuff
-				FT_Load_Glyph(pFont->m_FtFace, GlyphIndex, FT_LOAD_DEFAULT);
-
-				if(pFont->m_FtFace->glyph->metrics.width > MaxW) MaxW = pFont->m_FtFace->glyph->metrics.width; // ignore_convention
-				if(pFont->m_FtFace->glyph->metrics.height > MaxH) MaxH = pFont->m_FtFace->glyph->metrics.height; // ignore_convention
-				Charcode = FT_Get_Next_Char(pFont->m_FtFace, Charcode, &GlyphIndex);
-			}
-
-			MaxW = (MaxW>>6)+2+OutlineThickness*2;
-			MaxH = (MaxH>>6)+2+OutlineThickness*2;
+			const CAtlasShelf &Shelf = pFont->m_lShelves[i];
+			if(Shelf.m_Height >= h && Shelf.m_Width+w <= pFont->m_AtlasSize &&
+				(Best == -1 || Shelf.m_Height < pFont->m_lShelves[Best].m_Height))
+				Best = i;
+		}
 
-			for(pSizeData->m_CharMaxWidth = 1; pSizeData->m_CharMaxWidth < MaxW; pSizeData->m_CharMaxWidth <<= 1);
-			for(pSizeData->m_CharMaxHeight = 1; pSizeData->m_CharMaxHeight < MaxH; pSizeData->m_CharMaxHeight <<= 1);
+		if((Best == -1 || pFont->m_lShelves[Best].m_Height > h+h/2) && pFont->m_ShelvesHeight+h <= pFont->m_AtlasSize)
+		{
+			CAtlasShelf Shelf;
+			Shelf.m_Y = pFont->m_ShelvesHeight;
+			Shelf.m_Height = h;
+			Shelf.m_Width = 0;
+			pFont->m_ShelvesHeight += h;
+			Best = pFont->m_lShelves.add(Shelf);
 		}
 
-		//dbg_msg("pFont", "init size %d, texture size %d %d", pFont->sizes[index].font_size, w, h);
-		//FT_New_Face(m_FTLibrary, "data/fonts/vera.ttf", 0, &pFont->ft_face);
-		InitTexture(pSizeData, pSizeData->m_CharMaxWidth, pSizeData->m_CharMaxHeight, 8, 8);
-	}
+		if(Best == -1)
+			return false;
 
-	CFontSizeData *GetSize(CFont *pFont, int Pixelsize)
-	{
-		int Index = GetFontSizeIndex(Pixelsize);
-		if(pFont->m_aSizes[Index].m_FontSize != aFontSizes[Index])
-			InitIndex(pFont, Index);
-		return &pFont->m_aSizes[Index];
+		CAtlasShelf &Shelf = pFont->m_lShelves[Best];
+		*pX = Shelf.m_Width;
+		*pY = Shelf.m_Y;
+		Shelf.m_Width += w;
+		return true;
 	}
 
-
-	void UploadGlyph(CFontSizeData *pSizeData, int Texnum, int SlotID, int Chr, const void *pData)
+	unsigned FontCrc(const char *pFilename)
 	{
-		int x = (SlotID%pSizeData->m_NumXChars) * (pSizeData->m_TextureWidth/pSizeData->m_NumXChars);
-		int y = (SlotID/pSizeData->m_NumXChars) * (pSizeData->m_TextureHeight/pSizeData->m_NumYChars);
+		IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+		if(!File)
+			return 0;
 
-		Graphics()->LoadTextureRawSub(pSizeData->m_aTextures[Texnum], x, y,
-			pSizeData->m_TextureWidth/pSizeData->m_NumXChars,
-			pSizeData->m_TextureHeight/pSizeData->m_NumYChars,
-			CImageInfo::FORMAT_ALPHA, pData);
-		/*
-		glBindTexture(GL_TEXTURE_2D, pSizeData->m_aTextures[Texnum]);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y,
-			pSizeData->m_TextureWidth/pSizeData->m_NumXChars,
-			pSizeData->m_TextureHeight/pSizeData->m_NumYChars,
-			m_FontTextureFormat, GL_UNSIGNED_BYTE, pData);*/
+		unsigned Crc = crc32(0L, 0x0, 0);
+		unsigned char aBuf[16*1024];
+		while(1)
+		{
+			unsigned Bytes = io_read(File, aBuf, sizeof(aBuf));
+			if(Bytes <= 0)
+				break;
+			Crc = crc32(Crc, aBuf, Bytes);
+		}
+		io_close(File);
+		return Crc;
 	}
 
-	// 32k of data used for rendering glyphs
-	unsigned char ms_aGlyphData[(1024/8) * (1024/8)];
-	unsigned char ms_aGlyphDataOutlined[(1024/8) * (1024/8)];
+	void AddCachedGlyph(CFont *pFont, const CGlyphBitmap *pBitmap)
+	{
+		CCachedGlyph Glyph;
+		unsigned Hash = GlyphHash(pBitmap->m_Chr, pBitmap->m_FontSize);
+		Glyph.m_pBitmap = pBitmap;
+		Glyph.m_Next = pFont->m_aGlyphHash[Hash];
+		pFont->m_aGlyphHash[Hash] = pFont->m_lGlyphs.add(Glyph);
+	}
 
-	int GetSlot(CFontSizeData *pSizeData)
+	const CGlyphBitmap *FindCachedGlyph(CFont *pFont, int Chr, int FontSize)
 	{
-		int CharCount = pSizeData->m_NumXChars*pSizeData->m_NumYChars;
-		if(pSizeData->m_CurrentCharacter < CharCount)
+		for(int i = pFont->m_aGlyphHash[GlyphHash(Chr, FontSize)]; i != -1; i = pFont->m_lGlyphs[i].m_Next)
 		{
-			int i = pSizeData->m_CurrentCharacter;
-			pSizeData->m_CurrentCharacter++;
-			return i;
+			const CGlyphBitmap *pBitmap = pFont->m_lGlyphs[i].m_pBitmap;
+			if(pBitmap->m_Chr == Chr && pBitmap->m_FontSize == FontSize)
+				return pBitmap;
 		}
+		return 0;
+	}
 
-		// kick out the oldest
-		// TODO: remove this linear search
+	// reads the glyphs rasterized in earlier runs, the file is started over when the font changed
+	void LoadGlyphCache(CFont *pFont)
+	{
+		const char *pName = pFont->m_aFilename;
+		for(const char *p = pFont->m_aFilename; *p; p++)
+			if(*p == '/' || *p == '\\')
+				pName = p+1;
+		str_format(pFont->m_aCacheFilename, sizeof(pFont->m_aCacheFilename), "fontcache/%s.glyphs", pName);
+		pFont->m_FontCrc = FontCrc(pFont->m_aFilename);
+
+		IOHANDLE File = Storage()->OpenFile(pFont->m_aCacheFilename, IOFLAG_READ, IStorage::TYPE_SAVE);
+		if(File)
 		{
-			int Oldest = 0;
-			for(int i = 1; i < CharCount; i++)
+			int Size = (int)io_length(File);
+			if(Size >= (int)sizeof(CGlyphCacheHeader))
 			{
-				if(pSizeData->m_aCharacters[i].m_TouchTime < pSizeData->m_aCharacters[Oldest].m_TouchTime)
-					Oldest = i;
+				pFont->m_pCacheData = (unsigned char *)mem_alloc(Size, sizeof(int));
+				Size = io_read(File, pFont->m_pCacheData, Size);
 			}
+			io_close(File);
 
-			if(time_get()-pSizeData->m_aCharacters[Oldest].m_TouchTime < time_freq() &&
-				(pSizeData->m_NumXChars < MAX_CHARACTERS || pSizeData->m_NumYChars < MAX_CHARACTERS))
+			const CGlyphCacheHeader *pHeader = (const CGlyphCacheHeader *)pFont->m_pCacheData;
+			if(pHeader && mem_comp(pHeader->m_aID, "TWGC", 4) == 0 && pHeader->m_Version == GLYPH_CACHE_VERSION && pHeader->m_FontCrc == pFont->m_FontCrc)
 			{
-				IncreaseTextureSize(pSizeData);
-				return GetSlot(pSizeData);
+				int Offset = sizeof(CGlyphCacheHeader);
+				while(Offset+(int)sizeof(CGlyphBitmap) <= Size)
+				{
+					const CGlyphBitmap *pBitmap = (const CGlyphBitmap *)(pFont->m_pCacheData+Offset);
+					if(pBitmap->m_Width <= 0 || pBitmap->m_Height <= 0 || pBitmap->m_Width > ATLAS_START_SIZE || pBitmap->m_Height > ATLAS_START_SIZE)
+						break;
+					int RecordSize = GlyphRecordSize(pBitmap->m_Width, pBitmap->m_Height);
+					if(Offset+RecordSize > Size)
+						break; // cut off while writing
+					AddCachedGlyph(pFont, pBitmap);
+					Offset += RecordSize;
+				}
+
+				dbg_msg("textrender", "loaded %d glyphs from '%s'", pFont->m_lGlyphs.size(), pFont->m_aCacheFilename);
+				pFont->m_CacheFile = Storage()->OpenFile(pFont->m_aCacheFilename, IOFLAG_WRITE|IOFLAG_APPEND, IStorage::TYPE_SAVE);
+				return;
 			}
 
-			return Oldest;
+			mem_free(pFont->m_pCacheData);
+			pFont->m_pCacheData = 0;
+		}
+
+		// no usable cache, start a new one
+		pFont->m_CacheFile = Storage()->OpenFile(pFont->m_aCacheFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(pFont->m_CacheFile)
+		{
+			CGlyphCacheHeader Header;
+			mem_copy(Header.m_aID, "TWGC", 4);
+			Header.m_Version = GLYPH_CACHE_VERSION;
+			Header.m_FontCrc = pFont->m_FontCrc;
+			io_write(pFont->m_CacheFile, &Header, sizeof(Header));
 		}
 	}
 
-	int RenderGlyph(CFont *pFont, CFontSizeData *pSizeData, int Chr)
+	// 32k of data used for rendering glyphs
+	unsigned char ms_aGlyphData[(1024/8) * (1024/8)];
+
+	const CGlyphBitmap *RasterizeGlyph(CFont *pFont, int FontSize, int Chr)
 	{
 		FT_Bitmap *pBitmap;
-		int SlotID = 0;
-		int SlotW = pSizeData->m_TextureWidth / pSizeData->m_NumXChars;
-		int SlotH = pSizeData->m_TextureHeight / pSizeData->m_NumYChars;
-		int SlotSize = SlotW*SlotH;
 		int x = 1;
 		int y = 1;
 		int px, py;
 
-		FT_Set_Pixel_Sizes(pFont->m_FtFace, 0, pSizeData->m_FontSize);
+		RenderSetup(pFont, FontSize);
 
 		if(FT_Load_Char(pFont->m_FtFace, Chr, FT_LOAD_RENDER|FT_LOAD_NO_BITMAP))
 		{
 			dbg_msg("pFont", "error loading glyph %d", Chr);
-			return -1;
+			return 0;
 		}
 
 		pBitmap = &pFont->m_FtFace->glyph->bitmap; // ignore_convention
 
-		// fetch slot
-		SlotID = GetSlot(pSizeData);
-		if(SlotID < 0)
-			return -1;
-
 		// adjust spacing
-		int OutlineThickness = AdjustOutlineThicknessToFontSize(1, pSizeData->m_FontSize);
+		int OutlineThickness = AdjustOutlineThicknessToFontSize(1, FontSize);
 		x += OutlineThickness;
 		y += OutlineThickness;
 
+		int Width = pBitmap->width + OutlineThickness*2 + 2; // ignore_convention
+		int Height = pBitmap->rows + OutlineThickness*2 + 2; // ignore_convention
+		if(Width*Height > (int)sizeof(ms_aGlyphData))
+		{
+			dbg_msg("pFont", "glyph %d too large", Chr);
+			return 0;
+		}
+
+		int RecordSize = GlyphRecordSize(Width, Height);
+		CGlyphBitmap *pGlyph = (CGlyphBitmap *)mem_alloc(RecordSize, sizeof(int));
+		mem_zero(pGlyph, RecordSize);
+		pFont->m_lGlyphAllocs.add(pGlyph);
+		pGlyph->m_Chr = Chr;
+		pGlyph->m_FontSize = FontSize;
+		pGlyph->m_Width = Width;
+		pGlyph->m_Height = Height;
+		pGlyph->m_Left = pFont->m_FtFace->glyph->bitmap_left; // ignore_convention
+		pGlyph->m_Top = pFont->m_FtFace->glyph->bitmap_top; // ignore_convention
+		pGlyph->m_Advance = pFont->m_FtFace->glyph->advance.x>>6; // ignore_convention
+
 		// prepare glyph data
-		mem_zero(ms_aGlyphData, SlotSize);
+		unsigned char *pData = (unsigned char *)(pGlyph+1);
+		unsigned char *pOutlined = pData + Width*Height;
 
 		if(pBitmap->pixel_mode == FT_PIXEL_MODE_GRAY) // ignore_convention
 		{
-			for(py = 0; py < pBitmap->rows; py++) // ignore_convention
-				for(px = 0; px < pBitmap->width; px++) // ignore_convention
-					ms_aGlyphData[(py+y)*SlotW+px+x] = pBitmap->buffer[py*pBitmap->pitch+px]; // ignore_convention
+			for(py = 0; py < (int)pBitmap->rows; py++) // ignore_convention
+				for(px = 0; px < (int)pBitmap->width; px++) // ignore_convention
+					pData[(py+y)*Width+px+x] = pBitmap->buffer[py*pBitmap->pitch+px]; // ignore_convention
 		}
 		else if(pBitmap->pixel_mode == FT_PIXEL_MODE_MONO) // ignore_convention
 		{
-			for(py = 0; py < pBitmap->rows; py++) // ignore_convention
-				for(px = 0; px < pBitmap->width; px++) // ignore_convention
+			for(py = 0; py < (int)pBitmap->rows; py++) // ignore_convention
+				for(px = 0; px < (int)pBitmap->width; px++) // ignore_convention
 				{
 					if(pBitmap->buffer[py*pBitmap->pitch+px/8]&(1<<(7-(px%8)))) // ignore_convention
-						ms_aGlyphData[(py+y)*SlotW+px+x] = 255;
+						pData[(py+y)*Width+px+x] = 255;
 				}
 		}
 
-		if(0) for(py = 0; py < SlotW; py++)
-			for(px = 0; px < SlotH; px++)
-				ms_aGlyphData[py*SlotW+px] = 255;
-
-		// upload the glyph
-		UploadGlyph(pSizeData, 0, SlotID, Chr, ms_aGlyphData);
-
+		// the outline
 		if(OutlineThickness == 1)
-		{
-			Grow(ms_aGlyphData, ms_aGlyphDataOutlined, SlotW, SlotH);
-			UploadGlyph(pSizeData, 1, SlotID, Chr, ms_aGlyphDataOutlined);
-		}
+			Grow(pData, pOutlined, Width, Height);
 		else
 		{
+			mem_copy(ms_aGlyphData, pData, Width*Height);
 			for(int i = OutlineThickness; i > 0; i-=2)
 			{
-				Grow(ms_aGlyphData, ms_aGlyphDataOutlined, SlotW, SlotH);
-				Grow(ms_aGlyphDataOutlined, ms_aGlyphData, SlotW, SlotH);
+				Grow(ms_aGlyphData, pOutlined, Width, Height);
+				Grow(pOutlined, ms_aGlyphData, Width, Height);
 			}
-			UploadGlyph(pSizeData, 1, SlotID, Chr, ms_aGlyphData);
+			mem_copy(pOutlined, ms_aGlyphData, Width*Height);
 		}
 
-		// set char info
+		AddCachedGlyph(pFont, pGlyph);
+		if(pFont->m_CacheFile)
 		{
-			CFontChar *pFontchr = &pSizeData->m_aCharacters[SlotID];
-			float Scale = 1.0f/pSizeData->m_FontSize;
-			float Uscale = 1.0f/pSizeData->m_TextureWidth;
-			float Vscale = 1.0f/pSizeData->m_TextureHeight;
-			int Height = pBitmap->rows + OutlineThickness*2 + 2; // ignore_convention
-			int Width = pBitmap->width + OutlineThickness*2 + 2; // ignore_convention
-
-			pFontchr->m_ID = Chr;
-			pFontchr->m_Height = Height * Scale;
-			pFontchr->m_Width = Width * Scale;
-			pFontchr->m_OffsetX = (pFont->m_FtFace->glyph->bitmap_left-1) * Scale; // ignore_convention
-			pFontchr->m_OffsetY = (pSizeData->m_FontSize - pFont->m_FtFace->glyph->bitmap_top) * Scale; // ignore_convention
-			pFontchr->m_AdvanceX = (pFont->m_FtFace->glyph->advance.x>>6) * Scale; // ignore_convention
-
-			pFontchr->m_aUvs[0] = (SlotID%pSizeData->m_NumXChars) / (float)(pSizeData->m_NumXChars);
-			pFontchr->m_aUvs[1] = (SlotID/pSizeData->m_NumXChars) / (float)(pSizeData->m_NumYChars);
-			pFontchr->m_aUvs[2] = pFontchr->m_aUvs[0] + Width*Uscale;
-			pFontchr->m_aUvs[3] = pFontchr->m_aUvs[1] + Height*Vscale;
+			io_write(pFont->m_CacheFile, pGlyph, RecordSize);
+			io_flush(pFont->m_CacheFile);
 		}
-
-		return SlotID;
+		return pGlyph;
 	}
 
-	CFontChar *GetChar(CFont *pFont, CFontSizeData *pSizeData, int Chr)
+	int RenderGlyph(CFont *pFont, int SizeIndex, int Chr)
 	{
-		CFontChar *pFontchr = NULL;
+		int FontSize = aFontSizes[SizeIndex];
+		const CGlyphBitmap *pGlyph = FindCachedGlyph(pFont, Chr, FontSize);
+		if(!pGlyph)
+			pGlyph = RasterizeGlyph(pFont, FontSize, Chr);
+		if(!pGlyph)
+			return -1;
 
-		// search for the character
-		// TODO: remove this linear search
-		int i;
-		for(i = 0; i < pSizeData->m_CurrentCharacter; i++)
+		// place it, grow the atlas or start over when it is full
+		int x, y;
+		if(!AtlasAlloc(pFont, pGlyph->m_Width, pGlyph->m_Height, &x, &y))
 		{
-			if(pSizeData->m_aCharacters[i].m_ID == Chr)
-			{
-				pFontchr = &pSizeData->m_aCharacters[i];
-				break;
-			}
+			InitAtlas(pFont, min(pFont->m_AtlasSize*2, (int)ATLAS_MAX_SIZE));
+			if(!AtlasAlloc(pFont, pGlyph->m_Width, pGlyph->m_Height, &x, &y))
+				return -1;
 		}
 
-		// check if we need to render the character
-		if(!pFontchr)
+		// upload the glyph and its outline
+		const unsigned char *pData = (const unsigned char *)(pGlyph+1);
+		Graphics()->LoadTextureRawSub(pFont->m_aTextures[0], x, y, pGlyph->m_Width, pGlyph->m_Height, CImageInfo::FORMAT_ALPHA, pData);
+		Graphics()->LoadTextureRawSub(pFont->m_aTextures[1], x, y, pGlyph->m_Width, pGlyph->m_Height, CImageInfo::FORMAT_ALPHA, pData + pGlyph->m_Width*pGlyph->m_Height);
+
+		// set char info
+		CFontChar Fontchr;
+		float Scale = 1.0f/FontSize;
+		float Uvscale = 1.0f/pFont->m_AtlasSize;
+
+		Fontchr.m_ID = Chr;
+		Fontchr.m_SizeIndex = SizeIndex;
+		Fontchr.m_Height = pGlyph->m_Height * Scale;
+		Fontchr.m_Width = pGlyph->m_Width * Scale;
+		Fontchr.m_OffsetX = (pGlyph->m_Left-1) * Scale;
+		Fontchr.m_OffsetY = (FontSize - pGlyph->m_Top) * Scale;
+		Fontchr.m_AdvanceX = pGlyph->m_Advance * Scale;
+
+		Fontchr.m_aUvs[0] = x * Uvscale;
+		Fontchr.m_aUvs[1] = y * Uvscale;
+		Fontchr.m_aUvs[2] = (x + pGlyph->m_Width) * Uvscale;
+		Fontchr.m_aUvs[3] = (y + pGlyph->m_Height) * Uvscale;
+
+		unsigned Hash = GlyphHash(Chr, SizeIndex);
+		Fontchr.m_Next = pFont->m_aCharHash[Hash];
+		int Index = pFont->m_lChars.add(Fontchr);
+		pFont->m_aCharHash[Hash] = Index;
+		return Index;
+	}
+
+	CFontChar *GetChar(CFont *pFont, int SizeIndex, int Chr)
+	{
+		for(int i = pFont->m_aCharHash[GlyphHash(Chr, SizeIndex)]; i != -1; i = pFont->m_lChars[i].m_Next)
 		{
-			int Index = RenderGlyph(pFont, pSizeData, Chr);
-			if(Index >= 0)
-				pFontchr = &pSizeData->m_aCharacters[Index];
+			if(pFont->m_lChars[i].m_ID == Chr && pFont->m_lChars[i].m_SizeIndex == SizeIndex)
+				return &pFont->m_lChars[i];
 		}
 
-		// touch the character
-		// TODO: don't call time_get here
-		if(pFontchr)
-			pFontchr->m_TouchTime = time_get();
+		// check if we need to render the character
+		int Index = RenderGlyph(pFont, SizeIndex, Chr);
+		if(Index >= 0)
+			return &pFont->m_lChars[Index];
+		return 0;
+	}
 
-		return pFontchr;
+	// puts every glyph of the text into the atlas before anything is drawn, the
+	// atlas can only start over in between two texts
+	void PrepareGlyphs(CFont *pFont, int SizeIndex, const char *pText, int Length)
+	{
+		for(int Try = 0; Try < 2; Try++)
+		{
+			int Generation = pFont->m_AtlasGeneration;
+			const char *pCurrent = pText;
+			const char *pEnd = pText+Length;
+			while(pCurrent < pEnd)
+			{
+				int Character = str_utf8_decode(&pCurrent);
+				if(Character > 0 && Character != '\n')
+					GetChar(pFont, SizeIndex, Character);
+			}
+
+			// nothing got dropped on the way
+			if(pFont->m_AtlasGeneration == Generation)
+				break;
+		}
 	}
 
 	// must only be called from the rendering function as the pFont must be set to the correct size
 	void RenderSetup(CFont *pFont, int size)
 	{
+		if(pFont->m_CurrentSize == size)
+			return;
 		FT_Set_Pixel_Sizes(pFont->m_FtFace, 0, size);
+		pFont->m_CurrentSize = size;
 	}
 
 	float Kerning(CFont *pFont, int Left, int Right)
@@ -432,11 +582,69 @@ class CTextRender : public IEngineTextRender
 		return (Kerning.x>>6);
 	}
 
+	void ClearLayoutCache()
+	{
+		mem_zero(m_aLayoutCache, sizeof(m_aLayoutCache));
+	}
+
+	// TextWidth and TextLineCount share this, the result depends on the screen mapping as well
+	void Measure(float Size, const char *pText, int Length, float LineWidth, float *pWidth, int *pLineCount)
+	{
+		float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+		Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+		float ScreenScaleX = ScreenX1-ScreenX0;
+		float ScreenScaleY = ScreenY1-ScreenY0;
+
+		if(Length < 0)
+			Length = str_length(pText);
+
+		CLayoutEntry *pEntry = 0;
+		if(Length < LAYOUT_CACHE_MAX_TEXT)
+		{
+			unsigned Hash = 2166136261u;
+			for(int i = 0; i < Length; i++)
+				Hash = (Hash^(unsigned char)pText[i])*16777619u;
+			pEntry = &m_aLayoutCache[Hash&(LAYOUT_CACHE_SIZE-1)];
+
+			if(pEntry->m_pFont == m_pDefaultFont && pEntry->m_Hash == Hash && pEntry->m_Length == Length && pEntry->m_Size == Size &&
+				pEntry->m_LineWidth == LineWidth && pEntry->m_ScreenScaleX == ScreenScaleX && pEntry->m_ScreenScaleY == ScreenScaleY &&
+				mem_comp(pEntry->m_aText, pText, Length) == 0)
+			{
+				*pWidth = pEntry->m_Width;
+				*pLineCount = pEntry->m_LineCount;
+				return;
+			}
+
+			pEntry->m_Hash = Hash;
+		}
+
+		CTextCursor Cursor;
+		SetCursor(&Cursor, 0, 0, Size, 0);
+		Cursor.m_LineWidth = LineWidth;
+		TextEx(&Cursor, pText, Length);
+		*pWidth = Cursor.m_X;
+		*pLineCount = Cursor.m_LineCount;
+
+		if(pEntry)
+		{
+			pEntry->m_pFont = m_pDefaultFont;
+			pEntry->m_Length = Length;
+			pEntry->m_Size = Size;
+			pEntry->m_LineWidth = LineWidth;
+			pEntry->m_ScreenScaleX = ScreenScaleX;
+			pEntry->m_ScreenScaleY = ScreenScaleY;
+			mem_copy(pEntry->m_aText, pText, Length);
+			pEntry->m_Width = Cursor.m_X;
+			pEntry->m_LineCount = Cursor.m_LineCount;
+		}
+	}
+
 
 public:
 	CTextRender()
 	{
 		m_pGraphics = 0;
+		m_pStorage = 0;
 
 		m_TextR = 1.0f;
 		m_TextG = 1.0f;
@@ -448,6 +656,7 @@ public:
 		m_TextOutlineA = 0.3f;
 
 		m_pDefaultFont = 0;
+		ClearLayoutCache();
 
 		// GL_LUMINANCE can be good for debugging
 		//m_FontTextureFormat = GL_ALPHA;
@@ -456,25 +665,37 @@ public:
 	virtual void Init()
 	{
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
+		m_pStorage = Kernel()->RequestInterface<IStorage>();
 		FT_Init_FreeType(&m_FTLibrary);
+		Storage()->CreateFolder("fontcache", IStorage::TYPE_SAVE);
 	}
 
 
 	virtual CFont *LoadFont(const char *pFilename)
 	{
-		CFont *pFont = (CFont *)mem_alloc(sizeof(CFont), 1);
+		CFont *pFont = new CFont;
 
-		mem_zero(pFont, sizeof(*pFont));
 		str_copy(pFont->m_aFilename, pFilename, sizeof(pFont->m_aFilename));
 
 		if(FT_New_Face(m_FTLibrary, pFont->m_aFilename, 0, &pFont->m_FtFace))
 		{
-			mem_free(pFont);
+			delete pFont;
 			return NULL;
 		}
 
-		for(unsigned i = 0; i < NUM_FONT_SIZES; i++)
-			pFont->m_aSizes[i].m_FontSize = -1;
+		pFont->m_CurrentSize = -1;
+		pFont->m_aTextures[0] = 0;
+		pFont->m_aTextures[1] = 0;
+		pFont->m_AtlasSize = 0;
+		pFont->m_AtlasGeneration = 0;
+		pFont->m_ShelvesHeight = 0;
+		pFont->m_pCacheData = 0;
+		pFont->m_CacheFile = 0;
+		for(int i = 0; i < GLYPH_HASH_SIZE; i++)
+			pFont->m_aGlyphHash[i] = -1;
+
+		LoadGlyphCache(pFont);
+		InitAtlas(pFont, ATLAS_START_SIZE);
 
 		dbg_msg("textrender", "loaded pFont from '%s'", pFilename);
 		return pFont;
@@ -482,13 +703,24 @@ public:
 
 	virtual void DestroyFont(CFont *pFont)
 	{
-		mem_free(pFont);
+		if(pFont->m_CacheFile)
+			io_close(pFont->m_CacheFile);
+		for(int i = 0; i < pFont->m_lGlyphAllocs.size(); i++)
+			mem_free(pFont->m_lGlyphAllocs[i]);
+		mem_free(pFont->m_pCacheData);
+		for(int i = 0; i < 2; i++)
+			if(pFont->m_aTextures[i])
+				Graphics()->UnloadTexture(pFont->m_aTextures[i]);
+		FT_Done_Face(pFont->m_FtFace);
+		delete pFont;
+		ClearLayoutCache();
 	}
 
 	virtual void SetDefaultFont(CFont *pFont)
 	{
 		dbg_msg("textrender", "default pFont set %p", pFont);
 		m_pDefaultFont = pFont;
+		ClearLayoutCache();
 	}
 
 
@@ -517,19 +749,18 @@ public:
 
 	virtual float TextWidth(void *pFontSetV, float Size, const char *pText, int Length)
 	{
-		CTextCursor Cursor;
-		SetCursor(&Cursor, 0, 0, Size, 0);
-		TextEx(&Cursor, pText, Length);
-		return Cursor.m_X;
+		float Width;
+		int LineCount;
+		Measure(Size, pText, Length, -1, &Width, &LineCount);
+		return Width;
 	}
 
 	virtual int TextLineCount(void *pFontSetV, float Size, const char *pText, float LineWidth)
 	{
-		CTextCursor Cursor;
-		SetCursor(&Cursor, 0, 0, Size, 0);
-		Cursor.m_LineWidth = LineWidth;
-		TextEx(&Cursor, pText, -1);
-		return Cursor.m_LineCount;
+		float Width;
+		int LineCount;
+		Measure(Size, pText, -1, LineWidth, &Width, &LineCount);
+		return LineCount;
 	}
 
 	virtual void TextColor(float r, float g, float b, float a)
@@ -551,7 +782,6 @@ public:
 	virtual void TextEx(CTextCursor *pCursor, const char *pText, int Length)
 	{
 		CFont *pFont = pCursor->m_pFont;
-		CFontSizeData *pSizeData = NULL;
 
 		//dbg_msg("textrender", "rendering text '%s'", text);
 
@@ -590,15 +820,19 @@ public:
 		if(!pFont)
 			return;
 
-		pSizeData = GetSize(pFont, ActualSize);
+		int SizeIndex = GetFontSizeIndex(ActualSize);
+		int FontSize = aFontSizes[SizeIndex];
 		RenderSetup(pFont, ActualSize);
 
-		float Scale = 1/pSizeData->m_FontSize;
+		float Scale = 1/FontSize;
 
 		// set length
 		if(Length < 0)
 			Length = str_length(pText);
 
+		if(pCursor->m_Flags&TEXTFLAG_RENDER)
+			PrepareGlyphs(pFont, SizeIndex, pText, Length);
+
 		// if we don't want to render, we can just skip the first outline pass
 		i = 1;
 		if(pCursor->m_Flags&TEXTFLAG_RENDER)
@@ -616,9 +850,9 @@ public:
 			{
 				// TODO: Make this better
 				if (i == 0)
-					Graphics()->TextureSet(pSizeData->m_aTextures[1]);
+					Graphics()->TextureSet(pFont->m_aTextures[1]);
 				else
-					Graphics()->TextureSet(pSizeData->m_aTextures[0]);
+					Graphics()->TextureSet(pFont->m_aTextures[0]);
 
 				Graphics()->QuadsBegin();
 				if (i == 0)
@@ -687,7 +921,7 @@ public:
 						continue;
 					}
 
-					CFontChar *pChr = GetChar(pFont, pSizeData, Character);
+					CFontChar *pChr = GetChar(pFont, SizeIndex, Character);
 					if(pChr)
 					{
 						float Advance = pChr->m_AdvanceX + Kerning(pFont, Character, NextCharacter)*Scale;
@@ -80,11 +80,16 @@ public:
 	virtual void WrapClamp() = 0;
 	virtual int MemoryUsage() const = 0;
 
+	// only touches the storage, can be called from the job threads
 	virtual int LoadPNG(CImageInfo *pImg, const char *pFilename, int StorageType) = 0;
 	virtual int UnloadTexture(int Index) = 0;
 	virtual int LoadTextureRaw(int Width, int Height, int Format, const void *pData, int StoreFormat, int Flags) = 0;
 	virtual int LoadTexture(const char *pFilename, int StorageType, int StoreFormat, int Flags) = 0;
 	virtual int LoadTextureRawSub(int TextureID, int x, int y, int Width, int Height, int Format, const void *pData) = 0;
+	// updates one mipmap level, the caller provides the downscaled data
+	virtual int LoadTextureRawSubLevel(int TextureID, int Level, int x, int y, int Width, int Height, int Format, const void *pData) = 0;
+	// a cleared texture with exactly NumLevels mipmap levels, to be filled with LoadTextureRawSubLevel
+	virtual int CreateTextureLevels(int Width, int Height, int NumLevels, int Format) = 0;
 	virtual void TextureSet(int TextureID) = 0;
 
 	struct CLineItem
@@ -120,6 +125,17 @@ public:
 			: m_X0(x0), m_Y0(y0), m_X1(x1), m_Y1(y1), m_X2(x2), m_Y2(y2), m_X3(x3), m_Y3(y3) {}
 	};
 	virtual void QuadsDrawFreeform(const CFreeformItem *pArray, int Num) = 0;
+
+	// freeform quads that carry their own texture subset and color, so a whole
+	// set of different sprites goes out in one call. the corners are top left,
+	// top right, bottom left and bottom right of the subset
+	struct CSpriteQuadItem
+	{
+		CFreeformItem m_Corners;
+		float m_TlU, m_TlV, m_BrU, m_BrV;
+		float m_R, m_G, m_B, m_A;
+	};
+	virtual void QuadsDrawSprites(const CSpriteQuadItem *pArray, int Num) = 0;
 	virtual void QuadsText(float x, float y, float Size, const char *pText) = 0;
 
 	struct CColorVertex
@@ -132,6 +148,23 @@ public:
 	virtual void SetColorVertex(const CColorVertex *pArray, int Num) = 0;
 	virtual void SetColor(float r, float g, float b, float a) = 0;
 
+	/*
+		Quad blocks hold static quads that are handed over once and drawn as a
+		whole with the current texture, blend mode, clipping and screen. The final
+		texture coordinate is m_U + Nudge + m_InsetU*Inset (the same for v), which
+		lets tile maps adjust their texel inset to the zoom level without
+		rebuilding the block.
+	*/
+	struct CBlockVertex
+	{
+		float m_X, m_Y;
+		float m_U, m_V;
+		float m_InsetU, m_InsetV;
+	};
+	virtual int QuadBlockCreate(const CBlockVertex *pVertices, int NumQuads) = 0;
+	virtual void QuadBlockDestroy(int Block) = 0;
+	virtual void QuadBlockDraw(int Block, float r, float g, float b, float a, float Nudge, float Inset) = 0;
+
 	virtual void TakeScreenshot(const char *pFilename) = 0;
 	virtual int GetVideoModes(CVideoMode *pModes, int MaxModes) = 0;
 
@@ -13,6 +13,12 @@ public:
 		Reset();
 		AddInt(Type);
 	}
+
+	CMsgPacker(int Type, void *pBuffer, int Size)
+	{
+		Reset(pBuffer, Size);
+		AddInt(Type);
+	}
 };
 
 #endif
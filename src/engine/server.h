@@ -33,6 +33,7 @@ public:
 	virtual bool ClientIngame(int ClientID) = 0;
 	virtual int GetClientInfo(int ClientID, CClientInfo *pInfo) = 0;
 	virtual void GetClientAddr(int ClientID, char *pAddrStr, int Size) = 0;
+	virtual int ClientSendBufferFree(int ClientID) = 0;
 
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID) = 0;
 
@@ -56,6 +57,10 @@ public:
 
 	virtual void SnapSetStaticsize(int ItemType, int Size) = 0;
 
+	// how much of the low priority stuff to leave out of the client's
+	// snapshots, 0 is everything. goes up when the client is short on bandwidth
+	virtual int SnapDetail(int ClientID) = 0;
+
 	enum
 	{
 		RCON_CID_SERV=-1,
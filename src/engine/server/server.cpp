@@ -18,6 +18,7 @@
 #include <engine/shared/demo.h>
 #include <engine/shared/econ.h>
 #include <engine/shared/filecollection.h>
+#include <engine/shared/inputrecord.h>
 #include <engine/shared/mapchecker.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
@@ -265,6 +266,19 @@ void CServer::CClient::Reset()
 	m_LastAckedSnapshot = -1;
 	m_LastInputTick = -1;
 	m_SnapRate = CClient::SNAPRATE_INIT;
+	m_SnapInterval = 0;
+	m_SnapDetail = 0;
+	m_SnapBudget = 0;
+	m_LastSnapTick = -1;
+	m_AvgSnapSize = 0;
+	for(int i = 0; i < SNAP_HISTORY; i++)
+		m_aSnapSentTick[i] = -1;
+	m_SnapSentIndex = 0;
+	m_SentBytes = 0;
+	m_AckedBytes = 0;
+	m_MinLatency = -1;
+	m_LatencySum = 0;
+	m_LatencyNum = 0;
 	m_Score = 0;
 }
 
@@ -463,6 +477,19 @@ void CServer::GetClientAddr(int ClientID, char *pAddrStr, int Size)
 		net_addr_str(m_NetServer.ClientAddr(ClientID), pAddrStr, Size, false);
 }
 
+int CServer::SnapDetail(int ClientID)
+{
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || !g_Config.m_SvSnapAdaptive)
+		return 0;
+	return m_aClients[ClientID].m_SnapDetail;
+}
+
+int CServer::ClientSendBufferFree(int ClientID)
+{
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == CClient::STATE_EMPTY)
+		return 0;
+	return m_NetServer.ClientBufferFree(ClientID);
+}
 
 const char *CServer::ClientName(int ClientID)
 {
@@ -555,6 +582,28 @@ int CServer::SendMsgEx(CMsgPacker *pMsg, int Flags, int ClientID, bool System)
 	return 0;
 }
 
+// sends a message that was packed right into the client's next packet,
+// see CNetServer::ReserveChunk. only for non-vital messages
+int CServer::SendReservedMsg(CMsgPacker *pMsg, int Flags, int ClientID, bool System)
+{
+	dbg_assert(!(Flags&MSGFLAG_VITAL), "reserved messages can't be vital");
+	if(pMsg->Error())
+		return -1;
+
+	// HACK: modify the message id in the packet and store the system flag
+	unsigned char *pData = (unsigned char *)pMsg->Data();
+	*pData <<= 1;
+	if(System)
+		*pData |= 1;
+
+	// write message to demo recorder
+	if(!(Flags&MSGFLAG_NORECORD))
+		m_DemoRecorder.RecordMessage(pMsg->Data(), pMsg->Size());
+
+	m_NetServer.CommitChunk(ClientID, pMsg->Size(), Flags&MSGFLAG_FLUSH ? NETSENDFLAG_FLUSH : 0);
+	return 0;
+}
+
 void CServer::DoSnapshot()
 {
 	GameServer()->OnPreSnap();
@@ -581,9 +630,18 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_State != CClient::STATE_INGAME)
 			continue;
 
-		// this client is trying to recover, don't spam snapshots
-		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_RECOVER && (Tick()%50) != 0)
-			continue;
+		if(g_Config.m_SvSnapAdaptive)
+		{
+			if((Tick()%SERVER_TICK_SPEED) == 0)
+				UpdateSnapRate(i);
+
+			// a client that lost track gets full snapshots at the lowest rate until it acks again
+			int Interval = m_aClients[i].m_SnapRate == CClient::SNAPRATE_RECOVER ? (int)MAX_SNAP_INTERVAL : m_aClients[i].m_SnapInterval;
+			if(m_aClients[i].m_LastSnapTick >= 0 && Tick()-m_aClients[i].m_LastSnapTick < Interval)
+				continue;
+		}
+		else if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_RECOVER && (Tick()%50) != 0)
+			continue; // this client is trying to recover, don't spam snapshots
 
 		// this client is trying to recover, don't spam snapshots
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick()%10) != 0)
@@ -601,6 +659,7 @@ void CServer::DoSnapshot()
 			int DeltashotSize;
 			int DeltaTick = -1;
 			int DeltaSize;
+			int SentBytes = 0;
 
 			m_SnapshotBuilder.Init();
 
@@ -610,9 +669,9 @@ void CServer::DoSnapshot()
 			SnapshotSize = m_SnapshotBuilder.Finish(pData);
 			Crc = pData->Crc();
 
-			// remove old snapshos
-			// keep 3 seconds worth of snapshots
-			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick-SERVER_TICK_SPEED*3);
+			// remove old snapshots, the acked one is the oldest that can still be a delta.
+			// keep at most 3 seconds worth of snapshots
+			m_aClients[i].m_Snapshots.PurgeUntil(max(m_aClients[i].m_LastAckedSnapshot, m_CurrentGameTick-SERVER_TICK_SPEED*3));
 
 			// save it the snapshot
 			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0);
@@ -652,17 +711,20 @@ void CServer::DoSnapshot()
 
 					if(NumPackets == 1)
 					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE);
+						const int MsgSize = Chunk+SNAP_MSG_HEADERSIZE;
+						CMsgPacker Msg(NETMSG_SNAPSINGLE, m_NetServer.ReserveChunk(i, MsgSize), MsgSize);
 						Msg.AddInt(m_CurrentGameTick);
 						Msg.AddInt(m_CurrentGameTick-DeltaTick);
 						Msg.AddInt(Crc);
 						Msg.AddInt(Chunk);
 						Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
-						SendMsgEx(&Msg, MSGFLAG_FLUSH, i, true);
+						SentBytes += Msg.Size();
+						SendReservedMsg(&Msg, MSGFLAG_FLUSH, i, true);
 					}
 					else
 					{
-						CMsgPacker Msg(NETMSG_SNAP);
+						const int MsgSize = Chunk+SNAP_MSG_HEADERSIZE;
+						CMsgPacker Msg(NETMSG_SNAP, m_NetServer.ReserveChunk(i, MsgSize), MsgSize);
 						Msg.AddInt(m_CurrentGameTick);
 						Msg.AddInt(m_CurrentGameTick-DeltaTick);
 						Msg.AddInt(NumPackets);
@@ -670,23 +732,132 @@ void CServer::DoSnapshot()
 						Msg.AddInt(Crc);
 						Msg.AddInt(Chunk);
 						Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
-						SendMsgEx(&Msg, MSGFLAG_FLUSH, i, true);
+						SentBytes += Msg.Size();
+						SendReservedMsg(&Msg, MSGFLAG_FLUSH, i, true);
 					}
 				}
 			}
 			else
 			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY);
+				CMsgPacker Msg(NETMSG_SNAPEMPTY, m_NetServer.ReserveChunk(i, SNAP_MSG_HEADERSIZE), SNAP_MSG_HEADERSIZE);
 				Msg.AddInt(m_CurrentGameTick);
 				Msg.AddInt(m_CurrentGameTick-DeltaTick);
-				SendMsgEx(&Msg, MSGFLAG_FLUSH, i, true);
+				SentBytes += Msg.Size();
+				SendReservedMsg(&Msg, MSGFLAG_FLUSH, i, true);
 			}
+
+			// remember what went out, acks tell how much of it arrives
+			CClient *pClient = &m_aClients[i];
+			pClient->m_LastSnapTick = m_CurrentGameTick;
+			pClient->m_AvgSnapSize = pClient->m_AvgSnapSize ? (pClient->m_AvgSnapSize*7+SentBytes)/8 : SentBytes;
+			pClient->m_SentBytes += SentBytes;
+			pClient->m_aSnapSentTick[pClient->m_SnapSentIndex] = m_CurrentGameTick;
+			pClient->m_aSnapSentBytes[pClient->m_SnapSentIndex] = SentBytes;
+			pClient->m_SnapSentIndex = (pClient->m_SnapSentIndex+1)%CClient::SNAP_HISTORY;
 		}
 	}
 
 	GameServer()->OnPostSnap();
 }
 
+void CServer::AckSnapshot(int ClientID, int AckTick)
+{
+	CClient *pClient = &m_aClients[ClientID];
+
+	// acks ride on the unreliable input, one that arrives late must not move
+	// the delta back to an older snapshot. -1 is the client asking for a full one
+	if(AckTick > m_CurrentGameTick || (AckTick >= 0 && AckTick <= pClient->m_LastAckedSnapshot))
+		return;
+	pClient->m_LastAckedSnapshot = AckTick;
+	if(AckTick > 0)
+		pClient->m_SnapRate = CClient::SNAPRATE_FULL;
+
+	int64 TagTime;
+	if(pClient->m_Snapshots.Get(AckTick, &TagTime, 0, 0) < 0)
+		return;
+
+	pClient->m_Latency = (int)(((time_get()-TagTime)*1000)/time_freq());
+	pClient->m_LatencySum += pClient->m_Latency;
+	pClient->m_LatencyNum++;
+	if(pClient->m_MinLatency < 0 || pClient->m_Latency < pClient->m_MinLatency)
+		pClient->m_MinLatency = pClient->m_Latency;
+
+	// only the acked snapshot is known to have arrived, older ones still waiting
+	// for their ack never got through and stay counted as sent only
+	for(int i = 0; i < CClient::SNAP_HISTORY; i++)
+	{
+		if(pClient->m_aSnapSentTick[i] == AckTick)
+			pClient->m_AckedBytes += pClient->m_aSnapSentBytes[i];
+		if(pClient->m_aSnapSentTick[i] >= 0 && pClient->m_aSnapSentTick[i] <= AckTick)
+			pClient->m_aSnapSentTick[i] = -1;
+	}
+}
+
+void CServer::UpdateSnapRate(int ClientID)
+{
+	CClient *pClient = &m_aClients[ClientID];
+	int BaseInterval = g_Config.m_SvHighBandwidth ? 1 : 2;
+	int Interval = max(pClient->m_SnapInterval, BaseInterval);
+	int Detail = pClient->m_SnapDetail;
+	int Budget = pClient->m_SnapBudget;
+
+	// the link is congested when the latency builds up or a good part of the snapshots isn't acked
+	int Latency = pClient->m_LatencyNum ? pClient->m_LatencySum/pClient->m_LatencyNum : -1;
+	bool Congested = (Latency >= 0 && pClient->m_MinLatency >= 0 && Latency > pClient->m_MinLatency+SNAP_CONGESTION_LATENCY) ||
+		(pClient->m_SentBytes > MIN_SNAP_BUDGET && pClient->m_AckedBytes < pClient->m_SentBytes/2);
+
+	// back off quickly, then probe for more slowly
+	if(Congested)
+		Budget = max((int)MIN_SNAP_BUDGET, min(Budget ? Budget : pClient->m_SentBytes, pClient->m_AckedBytes)*3/4);
+	else if(Budget)
+	{
+		Budget += max(Budget/8, (int)MIN_SNAP_BUDGET);
+		if(Budget > 2*pClient->m_SentBytes && Interval == BaseInterval && Detail == 0)
+			Budget = 0;
+	}
+	if(g_Config.m_SvSnapBudget && (!Budget || Budget > g_Config.m_SvSnapBudget))
+		Budget = g_Config.m_SvSnapBudget;
+
+	// over budget leave out far away low priority items first, then send less often.
+	// with room to spare restore it the other way round
+	int Rate = pClient->m_AvgSnapSize*SERVER_TICK_SPEED/Interval;
+	if(Budget && Rate > Budget)
+	{
+		if(Detail < MAX_SNAP_DETAIL)
+			Detail++;
+		else
+			Interval = clamp(pClient->m_AvgSnapSize*SERVER_TICK_SPEED/Budget+1, Interval+1, (int)MAX_SNAP_INTERVAL);
+	}
+	else if(!Congested && (!Budget || Rate < Budget*3/4))
+	{
+		// the detail is restored with more headroom, it changes the size a lot
+		if(Interval > BaseInterval && (!Budget || pClient->m_AvgSnapSize*SERVER_TICK_SPEED/(Interval-1) <= Budget))
+			Interval--;
+		else if(Interval == BaseInterval && Detail > 0 && (!Budget || Rate < Budget/2))
+			Detail--;
+	}
+
+	if(g_Config.m_Debug && (Interval != pClient->m_SnapInterval || Detail != pClient->m_SnapDetail))
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "snap rate id=%d interval=%d detail=%d budget=%d sent=%d acked=%d latency=%d/%d",
+			ClientID, Interval, Detail, Budget, pClient->m_SentBytes, pClient->m_AckedBytes, Latency, pClient->m_MinLatency);
+		Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "server", aBuf);
+	}
+
+	pClient->m_SnapInterval = Interval;
+	pClient->m_SnapDetail = Detail;
+	pClient->m_SnapBudget = Budget;
+	pClient->m_SentBytes = 0;
+	pClient->m_AckedBytes = 0;
+	pClient->m_LatencySum = 0;
+	pClient->m_LatencyNum = 0;
+
+	// the lowest latency slowly forgets, routes change
+	if(pClient->m_MinLatency >= 0)
+		pClient->m_MinLatency++;
+}
+
 
 int CServer::NewClientCallback(int ClientID, void *pUser)
 {
@@ -714,7 +885,10 @@ int CServer::DelClientCallback(int ClientID, const char *pReason, void *pUser)
 
 	// notify the mod about the drop
 	if(pThis->m_aClients[ClientID].m_State >= CClient::STATE_READY)
+	{
+		pThis->m_InputRecorder.RecordDrop(ClientID, pReason);
 		pThis->GameServer()->OnClientDrop(ClientID, pReason);
+	}
 
 	pThis->m_aClients[ClientID].m_State = CClient::STATE_EMPTY;
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
@@ -893,6 +1067,7 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 				str_format(aBuf, sizeof(aBuf), "player is ready. ClientID=%x addr=%s", ClientID, aAddrStr);
 				Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBuf);
 				m_aClients[ClientID].m_State = CClient::STATE_READY;
+				m_InputRecorder.RecordConnected(ClientID);
 				GameServer()->OnClientConnected(ClientID);
 				SendConnectionReady(ClientID);
 			}
@@ -908,15 +1083,20 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 				str_format(aBuf, sizeof(aBuf), "player has entered the game. ClientID=%x addr=%s", ClientID, aAddrStr);
 				Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 				m_aClients[ClientID].m_State = CClient::STATE_INGAME;
+				m_InputRecorder.RecordEnter(ClientID);
 				GameServer()->OnClientEnter(ClientID);
 			}
 		}
 		else if(Msg == NETMSG_INPUT)
 		{
 			CClient::CInput *pInput;
-			int64 TagTime;
 
-			m_aClients[ClientID].m_LastAckedSnapshot = Unpacker.GetInt();
+			// the ack is good even if the input turns out broken
+			int AckTick = Unpacker.GetInt();
+			if(Unpacker.Error())
+				return;
+			AckSnapshot(ClientID, AckTick);
+
 			int IntendedTick = Unpacker.GetInt();
 			int Size = Unpacker.GetInt();
 
@@ -924,12 +1104,6 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 			if(Unpacker.Error() || Size/4 > MAX_INPUT_SIZE)
 				return;
 
-			if(m_aClients[ClientID].m_LastAckedSnapshot > 0)
-				m_aClients[ClientID].m_SnapRate = CClient::SNAPRATE_FULL;
-
-			if(m_aClients[ClientID].m_Snapshots.Get(m_aClients[ClientID].m_LastAckedSnapshot, &TagTime, 0, 0) >= 0)
-				m_aClients[ClientID].m_Latency = (int)(((time_get()-TagTime)*1000)/time_freq());
-
 			// add message to report the input timing
 			// skip packets that are old
 			if(IntendedTick > m_aClients[ClientID].m_LastInputTick)
@@ -961,7 +1135,10 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 
 			// call the mod with the fresh input data
 			if(m_aClients[ClientID].m_State == CClient::STATE_INGAME)
+			{
+				m_InputRecorder.RecordDirectInput(ClientID, m_aClients[ClientID].m_LatestInput.m_aData);
 				GameServer()->OnClientDirectInput(ClientID, m_aClients[ClientID].m_LatestInput.m_aData);
+			}
 		}
 		else if(Msg == NETMSG_RCON_CMD)
 		{
@@ -1076,7 +1253,10 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 	{
 		// game message
 		if(m_aClients[ClientID].m_State >= CClient::STATE_READY)
+		{
+			m_InputRecorder.RecordMessage(ClientID, pPacket->m_pData, pPacket->m_DataSize);
 			GameServer()->OnMessage(Msg, &Unpacker, ClientID);
+		}
 	}
 }
 
@@ -1217,6 +1397,7 @@ int CServer::LoadMap(const char *pMapName)
 
 	// stop recording when we change map
 	m_DemoRecorder.Stop();
+	m_InputRecorder.Stop();
 
 	// reinit snapshot ids
 	m_IDPool.TimeoutIDs();
@@ -1243,6 +1424,42 @@ int CServer::LoadMap(const char *pMapName)
 	return 1;
 }
 
+void CServer::PrintProfile(IOHANDLE File)
+{
+	char aBuf[256];
+	perf_collect();
+	for(int i = 0; i < perf_num_zones(); i++)
+	{
+		const PERF_ZONE_STATS *pStats = perf_zone_stats(i);
+		if(!pStats->count)
+			continue;
+
+		str_format(aBuf, sizeof(aBuf), "%-24s n=%d avg=%dus p50<%dus p90<%dus p99<%dus max=%dus",
+			pStats->name, (int)pStats->count, (int)(pStats->total/pStats->count),
+			(int)perf_zone_percentile(pStats, 50), (int)perf_zone_percentile(pStats, 90),
+			(int)perf_zone_percentile(pStats, 99), (int)pStats->max);
+		if(File)
+		{
+			io_write(File, aBuf, str_length(aBuf));
+			io_write_newline(File);
+		}
+		else
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+	}
+
+	if(perf_dropped())
+	{
+		str_format(aBuf, sizeof(aBuf), "%d samples dropped", (int)perf_dropped());
+		if(File)
+		{
+			io_write(File, aBuf, str_length(aBuf));
+			io_write_newline(File);
+		}
+		else
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+	}
+}
+
 void CServer::InitRegister(CNetServer *pNetServer, IEngineMasterServer *pMasterServer, IConsole *pConsole)
 {
 	m_Register.Init(pNetServer, pMasterServer, pConsole);
@@ -1290,19 +1507,31 @@ int CServer::Run()
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
 	GameServer()->OnInit();
+	StartInputRecord();
 	str_format(aBuf, sizeof(aBuf), "version %s", GameServer()->NetVersion());
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
 	// process pending commands
 	m_pConsole->StoreCommands(false);
 
+	if(g_Config.m_SvCpuAffinity >= 0)
+	{
+		if(thread_set_affinity(g_Config.m_SvCpuAffinity) == 0)
+			str_format(aBuf, sizeof(aBuf), "pinned game thread to core %d", g_Config.m_SvCpuAffinity);
+		else
+			str_format(aBuf, sizeof(aBuf), "failed to pin game thread to core %d", g_Config.m_SvCpuAffinity);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+
 	// start game
 	{
 		int64 ReportTime = time_get();
 		int ReportInterval = 3;
 
 		m_Lastheartbeat = 0;
+		m_LastProfileDump = time_get();
 		m_GameStartTime = time_get();
+		mem_zero(&m_TickStats, sizeof(m_TickStats));
 
 		if(g_Config.m_Debug)
 		{
@@ -1312,6 +1541,8 @@ int CServer::Run()
 
 		while(m_RunServer)
 		{
+			perf_set_enabled(g_Config.m_SvProfile);
+
 			int64 t = time_get();
 			int NewTicks = 0;
 
@@ -1340,6 +1571,7 @@ int CServer::Run()
 					m_CurrentGameTick = 0;
 					Kernel()->ReregisterInterface(GameServer());
 					GameServer()->OnInit();
+					StartInputRecord();
 					UpdateServerInfo();
 				}
 				else
@@ -1350,11 +1582,29 @@ int CServer::Run()
 				}
 			}
 
+			// after a stall only catch up on the last few ticks instead of
+			// running all missed ones back-to-back
+			if(g_Config.m_SvTickMaxCatchup && t > TickStartTime(m_CurrentGameTick+1+g_Config.m_SvTickMaxCatchup))
+			{
+				// leave t just past the start of the last tick to run, so exactly that many run
+				int64 Behind = t - TickStartTime(m_CurrentGameTick+g_Config.m_SvTickMaxCatchup) - 1;
+				m_TickStats.m_NumSkipped += (int)((Behind*SERVER_TICK_SPEED)/time_freq());
+				m_GameStartTime += Behind;
+			}
+
 			while(t > TickStartTime(m_CurrentGameTick+1))
 			{
 				m_CurrentGameTick++;
 				NewTicks++;
 
+				int64 Lateness = ((t-TickStartTime(m_CurrentGameTick))*1000000)/time_freq();
+				m_TickStats.m_NumTicks++;
+				m_TickStats.m_TotalLateness += Lateness;
+				if(Lateness > m_TickStats.m_MaxLateness)
+					m_TickStats.m_MaxLateness = Lateness;
+				if(Lateness > 1000000/SERVER_TICK_SPEED/4)
+					m_TickStats.m_NumLate++;
+
 				// apply new input
 				for(int c = 0; c < MAX_CLIENTS; c++)
 				{
@@ -1365,12 +1615,17 @@ int CServer::Run()
 						if(m_aClients[c].m_aInputs[i].m_GameTick == Tick())
 						{
 							if(m_aClients[c].m_State == CClient::STATE_INGAME)
+							{
+								m_InputRecorder.RecordPredictedInput(c, m_aClients[c].m_aInputs[i].m_aData);
 								GameServer()->OnClientPredictedInput(c, m_aClients[c].m_aInputs[i].m_aData);
+							}
 							break;
 						}
 					}
 				}
 
+				PERF_SCOPE(server_tick);
+				m_InputRecorder.RecordTick(Tick());
 				GameServer()->OnTick();
 			}
 
@@ -1378,15 +1633,45 @@ int CServer::Run()
 			if(NewTicks)
 			{
 				if(g_Config.m_SvHighBandwidth || (m_CurrentGameTick%2) == 0)
+				{
+					PERF_SCOPE(server_snapshot);
 					DoSnapshot();
+				}
 
 				UpdateClientRconCommands();
+
+				// drain the sample buffers before they fill up
+				if(perf_enabled())
+					perf_collect();
 			}
 
 			// master server stuff
-			m_Register.RegisterUpdate(m_NetServer.NetType());
+			{
+				PERF_SCOPE(server_register);
+				m_Register.RegisterUpdate(m_NetServer.NetType());
+			}
 
-			PumpNetwork();
+			{
+				PERF_SCOPE(server_network);
+				PumpNetwork();
+			}
+
+			if(g_Config.m_SvProfile && g_Config.m_SvProfileDump && m_LastProfileDump+time_freq()*g_Config.m_SvProfileDump < time_get())
+			{
+				IOHANDLE File = Storage()->OpenFile(g_Config.m_SvProfileFile, IOFLAG_WRITE|IOFLAG_APPEND, IStorage::TYPE_SAVE);
+				if(File)
+				{
+					char aTimestamp[32];
+					str_timestamp(aTimestamp, sizeof(aTimestamp));
+					str_format(aBuf, sizeof(aBuf), "--- %s tick=%d", aTimestamp, m_CurrentGameTick);
+					io_write(File, aBuf, str_length(aBuf));
+					io_write_newline(File);
+					PrintProfile(File);
+					io_close(File);
+				}
+				perf_reset();
+				m_LastProfileDump = time_get();
+			}
 
 			if(ReportTime < time_get())
 			{
@@ -1413,8 +1698,11 @@ int CServer::Run()
 				ReportTime += time_freq()*ReportInterval;
 			}
 
-			// wait for incomming data
-			net_socket_read_wait(m_NetServer.Socket(), 5);
+			// wait for incomming data until the next tick is due
+			int64 Deadline = TickStartTime(m_CurrentGameTick+1);
+			int64 Now = time_get();
+			if(Deadline > Now)
+				net_socket_read_wait_us(m_NetServer.Socket(), (int)(((Deadline-Now)*1000000)/time_freq())+1);
 		}
 	}
 	// disconnect all clients on shutdown
@@ -1426,6 +1714,9 @@ int CServer::Run()
 		m_Econ.Shutdown();
 	}
 
+	perf_trace_stop();
+	m_InputRecorder.Stop();
+
 	GameServer()->OnShutdown();
 	m_pMap->Unload();
 
@@ -1471,11 +1762,77 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConTickStats(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	CTickStats *pStats = &pThis->m_TickStats;
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "ticks=%d avg_lateness=%dus max_lateness=%dus late=%d skipped=%d",
+		pStats->m_NumTicks, pStats->m_NumTicks ? (int)(pStats->m_TotalLateness/pStats->m_NumTicks) : 0,
+		(int)pStats->m_MaxLateness, pStats->m_NumLate, pStats->m_NumSkipped);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+}
+
+void CServer::ConTickStatsReset(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	mem_zero(&pThis->m_TickStats, sizeof(pThis->m_TickStats));
+}
+
+void CServer::ConProfileStats(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	if(!perf_enabled())
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", "sampling is off, enable it with sv_profile 1");
+	pThis->PrintProfile(0);
+}
+
+void CServer::ConProfileReset(IConsole::IResult *pResult, void *pUser)
+{
+	perf_collect();
+	perf_reset();
+}
+
+void CServer::ConProfileTrace(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	perf_collect();
+	if(pResult->NumArguments() == 0)
+	{
+		perf_trace_stop();
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", "trace stopped");
+		return;
+	}
+
+	char aFilename[512];
+	char aBuf[600];
+	pThis->Storage()->GetCompletePath(IStorage::TYPE_SAVE, pResult->GetString(0), aFilename, sizeof(aFilename));
+	if(perf_trace_start(aFilename) == 0)
+		str_format(aBuf, sizeof(aBuf), "tracing to '%s'", aFilename);
+	else
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s'", aFilename);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+}
+
 void CServer::ConShutdown(IConsole::IResult *pResult, void *pUser)
 {
 	((CServer *)pUser)->m_RunServer = 0;
 }
 
+void CServer::StartInputRecord()
+{
+	// a recording always starts with a fresh map, the replay harness can't pick up in between
+	m_InputRecorder.Stop();
+	if(g_Config.m_SvInputRecord[0])
+	{
+		char aFilename[256];
+		char aDate[20];
+		str_timestamp(aDate, sizeof(aDate));
+		str_format(aFilename, sizeof(aFilename), "%s_%s_%s.rec", g_Config.m_SvInputRecord, m_aCurrentMap, aDate);
+		m_InputRecorder.Start(Storage(), m_pConsole, aFilename, m_aCurrentMap, m_CurrentMapCrc);
+	}
+}
+
 void CServer::DemoRecorder_HandleAutoStart()
 {
 	if(g_Config.m_SvAutoDemoRecord)
@@ -1619,6 +1976,12 @@ void CServer::RegisterCommands()
 
 	Console()->Register("reload", "", CFGFLAG_SERVER, ConMapReload, this, "Reload the map");
 
+	Console()->Register("tick_stats", "", CFGFLAG_SERVER, ConTickStats, this, "Print tick lateness statistics since the last tick_stats_reset");
+	Console()->Register("tick_stats_reset", "", CFGFLAG_SERVER, ConTickStatsReset, this, "Reset the tick lateness statistics");
+	Console()->Register("profile_stats", "", CFGFLAG_SERVER, ConProfileStats, this, "Print the latency histograms of the profiling zones");
+	Console()->Register("profile_reset", "", CFGFLAG_SERVER, ConProfileReset, this, "Clear the profiling histograms");
+	Console()->Register("profile_trace", "?s", CFGFLAG_SERVER, ConProfileTrace, this, "Write profiling samples to a chrome trace file, stop tracing without argument");
+
 	Console()->Chain("sv_name", ConchainSpecialInfoupdate, this);
 	Console()->Chain("password", ConchainSpecialInfoupdate, this);
 
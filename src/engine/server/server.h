@@ -76,6 +76,12 @@ public:
 		AUTHED_ADMIN,
 
 		MAX_RCONCMD_SEND=16,
+
+		MAX_SNAP_INTERVAL=10,
+		MAX_SNAP_DETAIL=2,
+		MIN_SNAP_BUDGET=1024,
+		SNAP_CONGESTION_LATENCY=100, // ms above the lowest latency seen
+		SNAP_MSG_HEADERSIZE=64, // room for the ints in front of the snapshot data
 	};
 
 	class CClient
@@ -92,7 +98,9 @@ public:
 
 			SNAPRATE_INIT=0,
 			SNAPRATE_FULL,
-			SNAPRATE_RECOVER
+			SNAPRATE_RECOVER,
+
+			SNAP_HISTORY=32,
 		};
 
 		class CInput
@@ -111,6 +119,21 @@ public:
 		int m_LastInputTick;
 		CSnapshotStorage m_Snapshots;
 
+		// adaptive snapshot rate, see UpdateSnapRate
+		int m_SnapInterval; // in ticks
+		int m_SnapDetail;
+		int m_SnapBudget; // bytes per second, 0 if nothing limits it
+		int m_LastSnapTick;
+		int m_AvgSnapSize;
+		int m_aSnapSentTick[SNAP_HISTORY]; // sent and not yet acked
+		int m_aSnapSentBytes[SNAP_HISTORY];
+		int m_SnapSentIndex;
+		int m_SentBytes; // during the last second
+		int m_AckedBytes;
+		int m_MinLatency;
+		int m_LatencySum;
+		int m_LatencyNum;
+
 		CInput m_LatestInput;
 		CInput m_aInputs[200]; // TODO: handle input better
 		int m_CurrentInput;
@@ -148,6 +171,17 @@ public:
 	int m_PrintCBIndex;
 
 	int64 m_Lastheartbeat;
+
+	// lateness of the ticks against their scheduled start, in microseconds
+	struct CTickStats
+	{
+		int m_NumTicks;
+		int m_NumLate;
+		int m_NumSkipped;
+		int64 m_TotalLateness;
+		int64 m_MaxLateness;
+	} m_TickStats;
+	int64 m_LastProfileDump;
 	//static NETADDR4 master_server;
 
 	char m_aCurrentMap[64];
@@ -156,6 +190,7 @@ public:
 	int m_CurrentMapSize;
 
 	CDemoRecorder m_DemoRecorder;
+	CInputRecorder m_InputRecorder;
 	CRegister m_Register;
 	CMapChecker m_MapChecker;
 
@@ -171,6 +206,7 @@ public:
 	void Kick(int ClientID, const char *pReason);
 
 	void DemoRecorder_HandleAutoStart();
+	void StartInputRecord();
 	bool DemoRecorder_IsRecording();
 
 	//int Tick()
@@ -183,6 +219,8 @@ public:
 	bool IsAuthed(int ClientID);
 	int GetClientInfo(int ClientID, CClientInfo *pInfo);
 	void GetClientAddr(int ClientID, char *pAddrStr, int Size);
+	int ClientSendBufferFree(int ClientID);
+	int SnapDetail(int ClientID);
 	const char *ClientName(int ClientID);
 	const char *ClientClan(int ClientID);
 	int ClientCountry(int ClientID);
@@ -191,8 +229,11 @@ public:
 
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID);
 	int SendMsgEx(CMsgPacker *pMsg, int Flags, int ClientID, bool System);
+	int SendReservedMsg(CMsgPacker *pMsg, int Flags, int ClientID, bool System);
 
 	void DoSnapshot();
+	void AckSnapshot(int ClientID, int AckTick);
+	void UpdateSnapRate(int ClientID);
 
 	static int NewClientCallback(int ClientID, void *pUser);
 	static int DelClientCallback(int ClientID, const char *pReason, void *pUser);
@@ -216,6 +257,8 @@ public:
 	char *GetMapName();
 	int LoadMap(const char *pMapName);
 
+	void PrintProfile(IOHANDLE File);
+
 	void InitRegister(CNetServer *pNetServer, IEngineMasterServer *pMasterServer, IConsole *pConsole);
 	int Run();
 
@@ -226,6 +269,11 @@ public:
 	static void ConStopRecord(IConsole::IResult *pResult, void *pUser);
 	static void ConMapReload(IConsole::IResult *pResult, void *pUser);
 	static void ConLogout(IConsole::IResult *pResult, void *pUser);
+	static void ConTickStats(IConsole::IResult *pResult, void *pUser);
+	static void ConTickStatsReset(IConsole::IResult *pResult, void *pUser);
+	static void ConProfileStats(IConsole::IResult *pResult, void *pUser);
+	static void ConProfileReset(IConsole::IResult *pResult, void *pUser);
+	static void ConProfileTrace(IConsole::IResult *pResult, void *pUser);
 	static void ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainModCommandUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -74,7 +74,10 @@ MACRO_CONFIG_INT(GfxRefreshRate, gfx_refresh_rate, 0, 0, 0, CFGFLAG_SAVE|CFGFLAG
 MACRO_CONFIG_INT(GfxFinish, gfx_finish, 1, 0, 1, CFGFLAG_SAVE|CFGFLAG_CLIENT, "")
 MACRO_CONFIG_INT(GfxAsyncRender, gfx_asyncrender, 0, 0, 1, CFGFLAG_SAVE|CFGFLAG_CLIENT, "Do rendering async from the the update")
 
+MACRO_CONFIG_INT(GfxParticles, gfx_particles, 1024*8, 256, 1024*64, CFGFLAG_SAVE|CFGFLAG_CLIENT, "Maximum number of particles (applied on the next map load)")
 MACRO_CONFIG_INT(GfxThreaded, gfx_threaded, 0, 0, 1, CFGFLAG_SAVE|CFGFLAG_CLIENT, "Use the threaded graphics backend")
+MACRO_CONFIG_INT(GfxHeadless, gfx_headless, 0, 0, 1, CFGFLAG_CLIENT, "Render into a null backend without a window and count what would be drawn")
+MACRO_CONFIG_INT(GfxHeadlessFrames, gfx_headless_frames, 0, 0, 0, CFGFLAG_CLIENT, "Quit after this many headless frames (0 = never)")
 
 MACRO_CONFIG_INT(InpMousesens, inp_mousesens, 100, 5, 100000, CFGFLAG_SAVE|CFGFLAG_CLIENT, "Mouse sensitivity")
 
@@ -86,6 +89,8 @@ MACRO_CONFIG_STR(SvMap, sv_map, 128, "openfng5", CFGFLAG_SERVER, "Map to use on
 MACRO_CONFIG_INT(SvMaxClients, sv_max_clients, 16, 1, MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients that are allowed on a server")
 MACRO_CONFIG_INT(SvMaxClientsPerIP, sv_max_clients_per_ip, 2, 1, MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients with the same IP that can connect to the server")
 MACRO_CONFIG_INT(SvHighBandwidth, sv_high_bandwidth, 0, 0, 1, CFGFLAG_SERVER, "Use high bandwidth mode. Doubles the bandwidth required for the server. LAN use only")
+MACRO_CONFIG_INT(SvSnapAdaptive, sv_snap_adaptive, 1, 0, 1, CFGFLAG_SERVER, "Lower snapshot rate and detail for clients whose connection can't keep up")
+MACRO_CONFIG_INT(SvSnapBudget, sv_snap_budget, 0, 0, 1000000, CFGFLAG_SERVER, "Snapshot bytes per second and client at most (0 = only limited by the connection)")
 MACRO_CONFIG_INT(SvRegister, sv_register, 1, 0, 1, CFGFLAG_SERVER, "Register server with master server for public listing")
 MACRO_CONFIG_STR(SvRconPassword, sv_rcon_password, 32, "", CFGFLAG_SERVER, "Remote console password (full access)")
 MACRO_CONFIG_STR(SvRconModPassword, sv_rcon_mod_password, 32, "", CFGFLAG_SERVER, "Remote console password for moderators (limited access)")
@@ -93,6 +98,7 @@ MACRO_CONFIG_INT(SvRconMaxTries, sv_rcon_max_tries, 3, 0, 100, CFGFLAG_SERVER, "
 MACRO_CONFIG_INT(SvRconBantime, sv_rcon_bantime, 5, 0, 1440, CFGFLAG_SERVER, "The time a client gets banned if remote console authentication fails. 0 makes it just use kick")
 MACRO_CONFIG_INT(SvAutoDemoRecord, sv_auto_demo_record, 0, 0, 1, CFGFLAG_SERVER, "Automatically record demos")
 MACRO_CONFIG_INT(SvAutoDemoMax, sv_auto_demo_max, 10, 0, 1000, CFGFLAG_SERVER, "Maximum number of automatically recorded demos (0 = no limit)")
+MACRO_CONFIG_STR(SvInputRecord, sv_input_record, 128, "", CFGFLAG_SERVER, "Record client input of every map for the replay harness, to files named <this>_<map>_<date>.rec (empty = off)")
 MACRO_CONFIG_INT(SvAllowUTF8Names, sv_allow_utf8_names, 0, 0, 1, CFGFLAG_SERVER, "Allow UTF-8 in client names")
 
 MACRO_CONFIG_STR(EcBindaddr, ec_bindaddr, 128, "localhost", CFGFLAG_ECON, "Address to bind the external console to. Anything but 'localhost' is dangerous")
@@ -107,6 +113,11 @@ MACRO_CONFIG_INT(DbgStress, dbg_stress, 0, 0, 0, CFGFLAG_CLIENT|CFGFLAG_SERVER,
 MACRO_CONFIG_INT(DbgStressNetwork, dbg_stress_network, 0, 0, 0, CFGFLAG_CLIENT|CFGFLAG_SERVER, "Stress network")
 MACRO_CONFIG_INT(DbgPref, dbg_pref, 0, 0, 1, CFGFLAG_SERVER, "Performance outputs")
 MACRO_CONFIG_INT(DbgGraphs, dbg_graphs, 0, 0, 1, CFGFLAG_CLIENT, "Performance graphs")
+MACRO_CONFIG_INT(SvTickMaxCatchup, sv_tick_max_catchup, 0, 0, 50, CFGFLAG_SERVER, "Maximum number of ticks to run back-to-back after a stall, older ones are skipped (0 = no limit)")
+MACRO_CONFIG_INT(SvCpuAffinity, sv_cpu_affinity, -1, -1, 1023, CFGFLAG_SERVER, "Pin the game thread to this cpu core (-1 = off)")
+MACRO_CONFIG_INT(SvProfile, sv_profile, 0, 0, 1, CFGFLAG_SERVER, "Sample per-tick profiling zones")
+MACRO_CONFIG_INT(SvProfileDump, sv_profile_dump, 0, 0, 3600, CFGFLAG_SERVER, "Append the profiling histograms to sv_profile_file every x seconds (0 = off)")
+MACRO_CONFIG_STR(SvProfileFile, sv_profile_file, 128, "profile.txt", CFGFLAG_SERVER, "File to dump the profiling histograms to")
 MACRO_CONFIG_INT(DbgHitch, dbg_hitch, 0, 0, 0, CFGFLAG_SERVER, "Hitch warnings")
 MACRO_CONFIG_STR(DbgStressServer, dbg_stress_server, 32, "localhost", CFGFLAG_CLIENT, "Server to stress")
 MACRO_CONFIG_INT(DbgResizable, dbg_resizable, 0, 0, 0, CFGFLAG_CLIENT, "Enables window resizing")
@@ -55,7 +55,7 @@ public:
 		}
 	}
 
-	CEngine(const char *pAppname)
+	CEngine(const char *pAppname, int NumJobThreads)
 	{
 		dbg_logger_stdout();
 		dbg_logger_debugger();
@@ -73,8 +73,9 @@ public:
 		// init the network
 		net_init();
 		CNetBase::Init();
+		perf_init();
 
-		m_JobPool.Init(1);
+		m_JobPool.Init(NumJobThreads);
 
 		m_Logging = false;
 	}
@@ -113,4 +114,4 @@ public:
 	}
 };
 
-IEngine *CreateEngine(const char *pAppname) { return new CEngine(pAppname); }
+IEngine *CreateEngine(const char *pAppname, int NumJobThreads) { return new CEngine(pAppname, NumJobThreads); }
@@ -0,0 +1,271 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/system.h>
+
+#include <engine/console.h>
+#include <engine/storage.h>
+
+#include "inputrecord.h"
+#include "packer.h"
+
+static const unsigned char gs_aInputRecordMarker[8] = {'T', 'W', 'I', 'N', 'P', 'U', 'T', 0};
+static const int gs_InputRecordVersion = 1;
+
+static void WriteInt(unsigned char *pBuf, unsigned Value)
+{
+	pBuf[0] = (Value>>24)&0xff;
+	pBuf[1] = (Value>>16)&0xff;
+	pBuf[2] = (Value>>8)&0xff;
+	pBuf[3] = Value&0xff;
+}
+
+static unsigned ReadInt(const unsigned char *pBuf)
+{
+	return (pBuf[0]<<24) | (pBuf[1]<<16) | (pBuf[2]<<8) | pBuf[3];
+}
+
+CInputRecorder::CInputRecorder()
+{
+	m_File = 0;
+	m_pConsole = 0;
+}
+
+int CInputRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pMap, unsigned MapCrc)
+{
+	if(m_File)
+		return -1;
+
+	m_File = pStorage->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!m_File)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "Unable to open '%s' for recording", pFilename);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "input_recorder", aBuf);
+		return -1;
+	}
+
+	m_pConsole = pConsole;
+
+	CInputRecordHeader Header;
+	mem_zero(&Header, sizeof(Header));
+	mem_copy(Header.m_aMarker, gs_aInputRecordMarker, sizeof(Header.m_aMarker));
+	WriteInt(Header.m_aVersion, gs_InputRecordVersion);
+	str_copy(Header.m_aMap, pMap, sizeof(Header.m_aMap));
+	WriteInt(Header.m_aMapCrc, MapCrc);
+	io_write(m_File, &Header, sizeof(Header));
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "Recording input to '%s'", pFilename);
+	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "input_recorder", aBuf);
+	return 0;
+}
+
+int CInputRecorder::Stop()
+{
+	if(!m_File)
+		return -1;
+
+	io_close(m_File);
+	m_File = 0;
+	return 0;
+}
+
+void CInputRecorder::Write(const CPacker *pPacker)
+{
+	// every record is its size followed by the packed ints
+	unsigned char aSize[2];
+	aSize[0] = (pPacker->Size()>>8)&0xff;
+	aSize[1] = pPacker->Size()&0xff;
+	io_write(m_File, aSize, sizeof(aSize));
+	io_write(m_File, pPacker->Data(), pPacker->Size());
+}
+
+void CInputRecorder::RecordTick(int Tick)
+{
+	if(!m_File)
+		return;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(INPUTRECORD_TICK);
+	Packer.AddInt(Tick);
+	Write(&Packer);
+
+	// servers tend to get killed rather than shut down, don't lose more than a second
+	if(Tick%SERVER_TICK_SPEED == 0)
+		io_flush(m_File);
+}
+
+void CInputRecorder::RecordConnected(int ClientID)
+{
+	if(!m_File)
+		return;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(INPUTRECORD_CONNECTED);
+	Packer.AddInt(ClientID);
+	Write(&Packer);
+}
+
+void CInputRecorder::RecordEnter(int ClientID)
+{
+	if(!m_File)
+		return;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(INPUTRECORD_ENTER);
+	Packer.AddInt(ClientID);
+	Write(&Packer);
+}
+
+void CInputRecorder::RecordDrop(int ClientID, const char *pReason)
+{
+	if(!m_File)
+		return;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(INPUTRECORD_DROP);
+	Packer.AddInt(ClientID);
+	Packer.AddString(pReason ? pReason : "", 128);
+	Write(&Packer);
+}
+
+void CInputRecorder::RecordInput(int Type, int ClientID, const int *pInput)
+{
+	if(!m_File)
+		return;
+
+	// the input buffer is mostly unused, leave out the zeros at its end
+	int Num = MAX_INPUT_SIZE;
+	while(Num > 0 && pInput[Num-1] == 0)
+		Num--;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(Type);
+	Packer.AddInt(ClientID);
+	Packer.AddInt(Num);
+	for(int i = 0; i < Num; i++)
+		Packer.AddInt(pInput[i]);
+	Write(&Packer);
+}
+
+void CInputRecorder::RecordMessage(int ClientID, const void *pData, int Size)
+{
+	if(!m_File)
+		return;
+
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(INPUTRECORD_MESSAGE);
+	Packer.AddInt(ClientID);
+	Packer.AddInt(Size);
+	Packer.AddRaw(pData, Size);
+	if(Packer.Error())
+	{
+		// a replay without this message would go its own way from here on
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "message of %d bytes from client %d doesn't fit into a record, stopping the recording", Size, ClientID);
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "input_recorder", aBuf);
+		Stop();
+		return;
+	}
+	Write(&Packer);
+}
+
+
+CInputPlayer::CInputPlayer()
+{
+	m_File = 0;
+	mem_zero(&m_Header, sizeof(m_Header));
+}
+
+CInputPlayer::~CInputPlayer()
+{
+	Close();
+}
+
+int CInputPlayer::Open(class IStorage *pStorage, const char *pFilename, int StorageType)
+{
+	Close();
+
+	m_File = pStorage->OpenFile(pFilename, IOFLAG_READ, StorageType);
+	if(!m_File)
+		return -1;
+
+	if(io_read(m_File, &m_Header, sizeof(m_Header)) != sizeof(m_Header) ||
+		mem_comp(m_Header.m_aMarker, gs_aInputRecordMarker, sizeof(gs_aInputRecordMarker)) != 0 ||
+		(int)ReadInt(m_Header.m_aVersion) != gs_InputRecordVersion)
+	{
+		Close();
+		return -1;
+	}
+
+	m_Header.m_aMap[sizeof(m_Header.m_aMap)-1] = 0;
+	return 0;
+}
+
+void CInputPlayer::Close()
+{
+	if(m_File)
+		io_close(m_File);
+	m_File = 0;
+}
+
+unsigned CInputPlayer::MapCrc() const
+{
+	return ReadInt(m_Header.m_aMapCrc);
+}
+
+bool CInputPlayer::NextRecord(CRecord *pRecord)
+{
+	if(!m_File)
+		return false;
+
+	unsigned char aSize[2];
+	if(io_read(m_File, aSize, sizeof(aSize)) != sizeof(aSize))
+		return false;
+	int Size = (aSize[0]<<8) | aSize[1];
+	if(Size > (int)sizeof(m_aBuffer) || io_read(m_File, m_aBuffer, Size) != (unsigned)Size)
+		return false;
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(m_aBuffer, Size);
+	pRecord->m_Type = Unpacker.GetInt();
+	pRecord->m_ClientID = -1;
+	pRecord->m_Tick = -1;
+	pRecord->m_pReason = "";
+	pRecord->m_pData = 0;
+	pRecord->m_DataSize = 0;
+
+	if(pRecord->m_Type == INPUTRECORD_TICK)
+		pRecord->m_Tick = Unpacker.GetInt();
+	else
+	{
+		pRecord->m_ClientID = Unpacker.GetInt();
+		if(pRecord->m_ClientID < 0 || pRecord->m_ClientID >= MAX_CLIENTS)
+			return false;
+
+		if(pRecord->m_Type == INPUTRECORD_DROP)
+			pRecord->m_pReason = Unpacker.GetString();
+		else if(pRecord->m_Type == INPUTRECORD_DIRECTINPUT || pRecord->m_Type == INPUTRECORD_PREDICTEDINPUT)
+		{
+			int Num = Unpacker.GetInt();
+			if(Num < 0 || Num > MAX_INPUT_SIZE)
+				return false;
+			mem_zero(pRecord->m_aInput, sizeof(pRecord->m_aInput));
+			for(int i = 0; i < Num; i++)
+				pRecord->m_aInput[i] = Unpacker.GetInt();
+		}
+		else if(pRecord->m_Type == INPUTRECORD_MESSAGE)
+		{
+			pRecord->m_DataSize = Unpacker.GetInt();
+			pRecord->m_pData = Unpacker.GetRaw(pRecord->m_DataSize);
+		}
+	}
+
+	return !Unpacker.Error();
+}
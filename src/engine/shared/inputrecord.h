@@ -0,0 +1,86 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_SHARED_INPUTRECORD_H
+#define ENGINE_SHARED_INPUTRECORD_H
+
+#include <base/system.h>
+
+#include "protocol.h"
+
+// everything the server feeds into the game from its clients, in the order
+// it happens, starting with a map. played back by the replay harness to run
+// the game logic without any players
+enum
+{
+	INPUTRECORD_TICK=0,
+	INPUTRECORD_CONNECTED,
+	INPUTRECORD_ENTER,
+	INPUTRECORD_DROP,
+	INPUTRECORD_DIRECTINPUT,
+	INPUTRECORD_PREDICTEDINPUT,
+	INPUTRECORD_MESSAGE,
+};
+
+struct CInputRecordHeader
+{
+	unsigned char m_aMarker[8];
+	unsigned char m_aVersion[4];
+	char m_aMap[64];
+	unsigned char m_aMapCrc[4];
+};
+
+class CInputRecorder
+{
+	IOHANDLE m_File;
+	class IConsole *m_pConsole;
+
+	void Write(const class CPacker *pPacker);
+	void RecordInput(int Type, int ClientID, const int *pInput);
+public:
+	CInputRecorder();
+
+	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pMap, unsigned MapCrc);
+	int Stop();
+	bool IsRecording() const { return m_File != 0; }
+
+	void RecordTick(int Tick);
+	void RecordConnected(int ClientID);
+	void RecordEnter(int ClientID);
+	void RecordDrop(int ClientID, const char *pReason);
+	void RecordDirectInput(int ClientID, const int *pInput) { RecordInput(INPUTRECORD_DIRECTINPUT, ClientID, pInput); }
+	void RecordPredictedInput(int ClientID, const int *pInput) { RecordInput(INPUTRECORD_PREDICTEDINPUT, ClientID, pInput); }
+	void RecordMessage(int ClientID, const void *pData, int Size);
+};
+
+class CInputPlayer
+{
+	IOHANDLE m_File;
+	CInputRecordHeader m_Header;
+	unsigned char m_aBuffer[1024*2];
+
+public:
+	struct CRecord
+	{
+		int m_Type;
+		int m_ClientID;
+		int m_Tick;
+		int m_aInput[MAX_INPUT_SIZE];
+		const char *m_pReason;
+		const void *m_pData;
+		int m_DataSize;
+	};
+
+	CInputPlayer();
+	~CInputPlayer();
+
+	int Open(class IStorage *pStorage, const char *pFilename, int StorageType);
+	void Close();
+
+	const char *Map() const { return m_Header.m_aMap; }
+	unsigned MapCrc() const;
+
+	// false at the end of the file or when it's broken
+	bool NextRecord(CRecord *pRecord);
+};
+
+#endif
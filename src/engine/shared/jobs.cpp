@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <base/system.h>
+#include <base/tl/threading.h>
 #include "jobs.h"
 
 CJobPool::CJobPool()
@@ -9,6 +10,9 @@ CJobPool::CJobPool()
 	m_Lock = lock_create();
 	m_pFirstJob = 0;
 	m_pLastJob = 0;
+#if !defined(CONF_PLATFORM_MACOSX)
+	semaphore_init(&m_Semaphore);
+#endif
 }
 
 void CJobPool::WorkerThread(void *pUser)
@@ -19,6 +23,11 @@ void CJobPool::WorkerThread(void *pUser)
 	{
 		CJob *pJob = 0;
 
+#if !defined(CONF_PLATFORM_MACOSX)
+		// sleep until there is something to do
+		semaphore_wait(&pPool->m_Semaphore);
+#endif
+
 		// fetch job from queue
 		lock_wait(pPool->m_Lock);
 		if(pPool->m_pFirstJob)
@@ -37,10 +46,13 @@ void CJobPool::WorkerThread(void *pUser)
 		{
 			pJob->m_Status = CJob::STATE_RUNNING;
 			pJob->m_Result = pJob->m_pfnFunc(pJob->m_pFuncData);
+			sync_barrier(); // whatever the job produced is visible before it reports done
 			pJob->m_Status = CJob::STATE_DONE;
 		}
+#if defined(CONF_PLATFORM_MACOSX)
 		else
 			thread_sleep(10);
+#endif
 	}
 
 }
@@ -70,6 +82,9 @@ int CJobPool::Add(CJob *pJob, JOBFUNC pfnFunc, void *pData)
 		m_pFirstJob = pJob;
 
 	lock_release(m_Lock);
+#if !defined(CONF_PLATFORM_MACOSX)
+	semaphore_signal(&m_Semaphore);
+#endif
 	return 0;
 }
 
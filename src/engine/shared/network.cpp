@@ -121,27 +121,29 @@ void CNetBase::SendPacket(NETSOCKET Socket, NETADDR *pAddr, CNetPacketConstruct
 	CompressedSize = ms_Huffman.Compress(pPacket->m_aChunkData, pPacket->m_DataSize, &aBuffer[3], NET_MAX_PACKETSIZE-4);
 
 	// check if the compression was enabled, successful and good enough
+	const unsigned char *pPayload;
 	if(CompressedSize > 0 && CompressedSize < pPacket->m_DataSize)
 	{
 		FinalSize = CompressedSize;
+		pPayload = &aBuffer[3];
 		pPacket->m_Flags |= NET_PACKETFLAG_COMPRESSION;
 	}
 	else
 	{
-		// use uncompressed data
+		// use uncompressed data, it goes out straight from the construct
 		FinalSize = pPacket->m_DataSize;
-		mem_copy(&aBuffer[3], pPacket->m_aChunkData, pPacket->m_DataSize);
+		pPayload = pPacket->m_aChunkData;
 		pPacket->m_Flags &= ~NET_PACKETFLAG_COMPRESSION;
 	}
 
 	// set header and send the packet if all things are good
 	if(FinalSize >= 0)
 	{
-		FinalSize += NET_PACKETHEADERSIZE;
 		aBuffer[0] = ((pPacket->m_Flags<<4)&0xf0)|((pPacket->m_Ack>>8)&0xf);
 		aBuffer[1] = pPacket->m_Ack&0xff;
 		aBuffer[2] = pPacket->m_NumChunks;
-		net_udp_send(Socket, pAddr, aBuffer, FinalSize);
+		net_udp_send_vec(Socket, pAddr, aBuffer, NET_PACKETHEADERSIZE, pPayload, FinalSize);
+		FinalSize += NET_PACKETHEADERSIZE;
 
 		// log raw socket data
 		if(ms_DataLogSent)
@@ -149,7 +151,8 @@ void CNetBase::SendPacket(NETSOCKET Socket, NETADDR *pAddr, CNetPacketConstruct
 			int Type = 0;
 			io_write(ms_DataLogSent, &Type, sizeof(Type));
 			io_write(ms_DataLogSent, &FinalSize, sizeof(FinalSize));
-			io_write(ms_DataLogSent, aBuffer, FinalSize);
+			io_write(ms_DataLogSent, aBuffer, NET_PACKETHEADERSIZE);
+			io_write(ms_DataLogSent, pPayload, FinalSize-NET_PACKETHEADERSIZE);
 			io_flush(ms_DataLogSent);
 		}
 	}
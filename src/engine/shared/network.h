@@ -47,6 +47,7 @@ enum
 	NET_MAX_PACKETSIZE = 1400,
 	NET_MAX_PAYLOAD = NET_MAX_PACKETSIZE-6,
 	NET_MAX_CHUNKHEADERSIZE = 5,
+	NET_NONVITAL_CHUNKHEADERSIZE = 2,
 	NET_PACKETHEADERSIZE = 3,
 	NET_MAX_CLIENTS = 16,
 	NET_MAX_CONSOLE_CLIENTS = 4,
@@ -143,6 +144,7 @@ private:
 	bool m_BlockCloseMsg;
 
 	TStaticRingBuffer<CNetChunkResend, NET_CONN_BUFFERSIZE> m_Buffer;
+	int m_BufferedBytes;
 
 	int64 m_LastUpdateTime;
 	int64 m_LastRecvTime;
@@ -178,6 +180,11 @@ public:
 	int Feed(CNetPacketConstruct *pPacket, NETADDR *pAddr);
 	int QueueChunk(int Flags, int DataSize, const void *pData);
 
+	// non-vital chunks can be packed right into the packet, reserve
+	// room for one and commit what was actually written
+	unsigned char *ReserveChunk(int MaxSize);
+	void CommitChunk(int DataSize);
+
 	const char *ErrorString();
 	void SignalResend();
 	int State() const { return m_State; }
@@ -191,6 +198,9 @@ public:
 	int64 ConnectTime() const { return m_LastUpdateTime; }
 
 	int AckSequence() const { return m_Ack; }
+
+	// space left in the resend buffer, not counting fragmentation
+	int BufferFree() const { return NET_CONN_BUFFERSIZE - m_BufferedBytes; }
 };
 
 class CConsoleNetConnection
@@ -272,6 +282,8 @@ public:
 	//
 	int Recv(CNetChunk *pChunk);
 	int Send(CNetChunk *pChunk);
+	unsigned char *ReserveChunk(int ClientID, int MaxSize);
+	void CommitChunk(int ClientID, int DataSize, int Flags);
 	int Update();
 
 	//
@@ -279,6 +291,7 @@ public:
 
 	// status requests
 	const NETADDR *ClientAddr(int ClientID) const { return m_aSlots[ClientID].m_Connection.PeerAddress(); }
+	int ClientBufferFree(int ClientID) const { return m_aSlots[ClientID].m_Connection.BufferFree(); }
 	NETSOCKET Socket() const { return m_Socket; }
 	class CNetBan *NetBan() const { return m_pNetBan; }
 	int NetType() const { return m_Socket.type; }
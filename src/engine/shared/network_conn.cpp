@@ -23,6 +23,7 @@ void CNetConnection::Reset()
 	mem_zero(&m_PeerAddr, sizeof(m_PeerAddr));
 
 	m_Buffer.Init();
+	m_BufferedBytes = 0;
 
 	mem_zero(&m_Construct, sizeof(m_Construct));
 }
@@ -56,7 +57,10 @@ void CNetConnection::AckChunks(int Ack)
 			break;
 
 		if(CNetBase::IsSeqInBackroom(pResend->m_Sequence, Ack))
+		{
+			m_BufferedBytes -= CRingBufferBase::AllocationSize(sizeof(CNetChunkResend)+pResend->m_DataSize);
 			m_Buffer.PopFirst();
+		}
 		else
 			break;
 	}
@@ -122,6 +126,7 @@ int CNetConnection::QueueChunkEx(int Flags, int DataSize, const void *pData, int
 			pResend->m_FirstSendTime = time_get();
 			pResend->m_LastSendTime = pResend->m_FirstSendTime;
 			mem_copy(pResend->m_pData, pData, DataSize);
+			m_BufferedBytes += CRingBufferBase::AllocationSize(sizeof(CNetChunkResend)+DataSize);
 		}
 		else
 		{
@@ -141,6 +146,30 @@ int CNetConnection::QueueChunk(int Flags, int DataSize, const void *pData)
 	return QueueChunkEx(Flags, DataSize, pData, m_Sequence);
 }
 
+unsigned char *CNetConnection::ReserveChunk(int MaxSize)
+{
+	dbg_assert(MaxSize+NET_MAX_CHUNKHEADERSIZE <= (int)sizeof(m_Construct.m_aChunkData), "chunk too big");
+
+	// check if we have space for it, if not, flush the connection
+	if(m_Construct.m_DataSize + MaxSize + NET_MAX_CHUNKHEADERSIZE > (int)sizeof(m_Construct.m_aChunkData))
+		Flush();
+
+	// leave room for the header, it is packed once the size is known
+	return &m_Construct.m_aChunkData[m_Construct.m_DataSize + NET_NONVITAL_CHUNKHEADERSIZE];
+}
+
+void CNetConnection::CommitChunk(int DataSize)
+{
+	CNetChunkHeader Header;
+	Header.m_Flags = 0;
+	Header.m_Size = DataSize;
+	Header.m_Sequence = 0;
+	unsigned char *pChunkData = Header.Pack(&m_Construct.m_aChunkData[m_Construct.m_DataSize]);
+
+	m_Construct.m_NumChunks++;
+	m_Construct.m_DataSize = (int)(pChunkData+DataSize-m_Construct.m_aChunkData);
+}
+
 void CNetConnection::SendControl(int ControlMsg, const void *pExtra, int ExtraSize)
 {
 	// send the control message
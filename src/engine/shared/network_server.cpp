@@ -244,6 +244,22 @@ int CNetServer::Send(CNetChunk *pChunk)
 	return 0;
 }
 
+unsigned char *CNetServer::ReserveChunk(int ClientID, int MaxSize)
+{
+	dbg_assert(ClientID >= 0 && ClientID < MaxClients(), "errornous client id");
+	return m_aSlots[ClientID].m_Connection.ReserveChunk(MaxSize);
+}
+
+void CNetServer::CommitChunk(int ClientID, int DataSize, int Flags)
+{
+	dbg_assert(ClientID >= 0 && ClientID < MaxClients(), "errornous client id");
+	dbg_assert(!(Flags&NETSENDFLAG_VITAL), "vital chunks need to be queued");
+
+	m_aSlots[ClientID].m_Connection.CommitChunk(DataSize);
+	if(Flags&NETSENDFLAG_FLUSH)
+		m_aSlots[ClientID].m_Connection.Flush();
+}
+
 void CNetServer::SetMaxClientsPerIP(int Max)
 {
 	// clamp
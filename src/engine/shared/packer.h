@@ -13,17 +13,20 @@ class CPacker
 	};
 
 	unsigned char m_aBuffer[PACKER_BUFFER_SIZE];
+	unsigned char *m_pStart;
 	unsigned char *m_pCurrent;
 	unsigned char *m_pEnd;
 	int m_Error;
 public:
 	void Reset();
+	// pack into memory owned by someone else, e.g. a network packet
+	void Reset(void *pBuffer, int Size);
 	void AddInt(int i);
 	void AddString(const char *pStr, int Limit);
 	void AddRaw(const void *pData, int Size);
 
-	int Size() const { return (int)(m_pCurrent-m_aBuffer); }
-	const unsigned char *Data() const { return m_aBuffer; }
+	int Size() const { return (int)(m_pCurrent-m_pStart); }
+	const unsigned char *Data() const { return m_pStart; }
 	bool Error() const { return m_Error; }
 };
 
@@ -58,9 +58,14 @@ void CRingBufferBase::Init(void *pMemory, int Size, int Flags)
 
 }
 
+int CRingBufferBase::AllocationSize(int Size)
+{
+	return (Size+sizeof(CItem)+sizeof(CItem)-1)/sizeof(CItem)*sizeof(CItem);
+}
+
 void *CRingBufferBase::Allocate(int Size)
 {
-	int WantedSize = (Size+sizeof(CItem)+sizeof(CItem)-1)/sizeof(CItem)*sizeof(CItem);
+	int WantedSize = AllocationSize(Size);
 	CItem *pBlock = 0;
 
 	// check if we even can fit this block
@@ -45,6 +45,9 @@ public:
 		// Will start to destroy items to try to fit the next one
 		FLAG_RECYCLE=1
 	};
+
+	// bytes of the buffer taken by an item of the given size
+	static int AllocationSize(int Size);
 };
 
 template<typename T, int TSIZE, int TFLAGS=0>
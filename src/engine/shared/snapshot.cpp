@@ -71,6 +71,11 @@ enum
 	HASHLIST_SIZE = 256,
 };
 
+static int HashKey(int Key)
+{
+	return ((Key>>12)&0xf0) | (Key&0xf);
+}
+
 static void GenerateHash(CItemList *pHashlist, CSnapshot *pSnapshot)
 {
 	for(int i = 0; i < HASHLIST_SIZE; i++)
@@ -79,7 +84,7 @@ static void GenerateHash(CItemList *pHashlist, CSnapshot *pSnapshot)
 	for(int i = 0; i < pSnapshot->NumItems(); i++)
 	{
 		int Key = pSnapshot->GetItem(i)->Key();
-		int HashID = ((Key>>12)&0xf0) | (Key&0xf);
+		int HashID = HashKey(Key);
 		if(pHashlist[HashID].m_Num != 64)
 		{
 			pHashlist[HashID].m_aIndex[pHashlist[HashID].m_Num] = i;
@@ -91,7 +96,7 @@ static void GenerateHash(CItemList *pHashlist, CSnapshot *pSnapshot)
 
 static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
 {
-		int HashID = ((Key>>12)&0xf0) | (Key&0xf);
+		int HashID = HashKey(Key);
 		for(int i = 0; i < pHashlist[HashID].m_Num; i++)
 		{
 			if(pHashlist[HashID].m_aKeys[i] == Key)
@@ -101,6 +106,38 @@ static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
 	return -1;
 }
 
+// a full bucket might not hold the item, search the snapshot then
+static int FindItemIndex(int Key, const CItemList *pHashlist, CSnapshot *pSnapshot)
+{
+	int Index = GetItemIndexHashed(Key, pHashlist);
+	if(Index == -1 && pHashlist[HashKey(Key)].m_Num == 64)
+		Index = pSnapshot->GetItemIndex(Key);
+	return Index;
+}
+
+static unsigned CopyItem(int *pDst, const int *pSrc, int Size)
+{
+	unsigned Sum = 0;
+	while(Size)
+	{
+		Sum += (unsigned)*pSrc;
+		*pDst++ = *pSrc++;
+		Size--;
+	}
+	return Sum;
+}
+
+static unsigned SumItem(const int *pData, int Size)
+{
+	unsigned Sum = 0;
+	while(Size)
+	{
+		Sum += (unsigned)*pData++;
+		Size--;
+	}
+	return Sum;
+}
+
 static int DiffItem(int *pPast, int *pCurrent, int *pOut, int Size)
 {
 	int Needed = 0;
@@ -117,11 +154,13 @@ static int DiffItem(int *pPast, int *pCurrent, int *pOut, int Size)
 	return Needed;
 }
 
-void CSnapshotDelta::UndiffItem(int *pPast, int *pDiff, int *pOut, int Size)
+unsigned CSnapshotDelta::UndiffItem(int *pPast, int *pDiff, int *pOut, int Size)
 {
+	unsigned Sum = 0;
 	while(Size)
 	{
 		*pOut = *pPast+*pDiff;
+		Sum += (unsigned)*pOut;
 
 		if(*pDiff == 0)
 			m_aSnapshotDataRate[m_SnapshotCurrent] += 1;
@@ -137,6 +176,7 @@ void CSnapshotDelta::UndiffItem(int *pPast, int *pDiff, int *pOut, int Size)
 		pDiff++;
 		Size--;
 	}
+	return Sum;
 }
 
 CSnapshotDelta::CSnapshotDelta()
@@ -276,7 +316,7 @@ static int RangeCheck(void *pEnd, void *pPtr, int Size)
 	return 0;
 }
 
-int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData, int DataSize)
+int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData, int DataSize, int *pCrc)
 {
 	CSnapshotBuilder Builder;
 	CData *pDelta = (CData *)pSrcData;
@@ -284,11 +324,12 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 	int *pEnd = (int *)(((char *)pSrcData + DataSize));
 
 	CSnapshotItem *pFromItem;
-	int Keep, ItemSize;
+	int ItemSize;
 	int *pDeleted;
 	int ID, Type, Key;
 	int FromIndex;
 	int *pNewData;
+	unsigned Crc = 0;
 
 	Builder.Init();
 
@@ -298,30 +339,34 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 	if(pData > pEnd)
 		return -1;
 
+	CItemList Hashlist[HASHLIST_SIZE];
+	GenerateHash(Hashlist, pFrom);
+
+	// where the items of the old snapshot end up in the new one
+	int aBuilderIndex[1024];
+	const int NumFromItems = pFrom->NumItems();
+	for(int i = 0; i < NumFromItems; i++)
+		aBuilderIndex[i] = 0;
+	for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
+	{
+		FromIndex = FindItemIndex(pDeleted[d], Hashlist, pFrom);
+		if(FromIndex != -1)
+			aBuilderIndex[FromIndex] = -1;
+	}
+
 	// copy all non deleted stuff
-	for(int i = 0; i < pFrom->NumItems(); i++)
+	for(int i = 0; i < NumFromItems; i++)
 	{
-		// dbg_assert(0, "fail!");
+		if(aBuilderIndex[i] == -1)
+			continue;
+
+		// keep it
 		pFromItem = pFrom->GetItem(i);
 		ItemSize = pFrom->GetItemSize(i);
-		Keep = 1;
-		for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
-		{
-			if(pDeleted[d] == pFromItem->Key())
-			{
-				Keep = 0;
-				break;
-			}
-		}
-
-		if(Keep)
-		{
-			// keep it
-			mem_copy(
-				Builder.NewItem(pFromItem->Type(), pFromItem->ID(), ItemSize),
-				pFromItem->Data(), ItemSize);
-		}
+		aBuilderIndex[i] = Builder.NumItems();
+		Crc += CopyItem((int *)Builder.NewItem(pFromItem->Type(), pFromItem->ID(), ItemSize), pFromItem->Data(), ItemSize/4);
 	}
+	const int NumKept = Builder.NumItems();
 
 	// unpack updated stuff
 	for(int i = 0; i < pDelta->m_NumUpdateItems; i++)
@@ -345,23 +390,47 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 
 		Key = (Type<<16)|ID;
 
+		// find the item if it was created already, only new ones have to be searched
+		pNewData = 0;
+		FromIndex = FindItemIndex(Key, Hashlist, pFrom);
+		if(FromIndex != -1)
+		{
+			if(aBuilderIndex[FromIndex] != -1)
+				pNewData = Builder.GetItem(aBuilderIndex[FromIndex])->Data();
+		}
+		else
+		{
+			for(int b = NumKept; b < Builder.NumItems(); b++)
+			{
+				if(Builder.GetItem(b)->Key() == Key)
+				{
+					pNewData = Builder.GetItem(b)->Data();
+					break;
+				}
+			}
+		}
+
 		// create the item if needed
-		pNewData = Builder.GetItemData(Key);
-		if(!pNewData)
+		if(pNewData)
+			Crc -= SumItem(pNewData, ItemSize/4);
+		else
+		{
+			if(FromIndex != -1)
+				aBuilderIndex[FromIndex] = Builder.NumItems();
 			pNewData = (int *)Builder.NewItem(Key>>16, Key&0xffff, ItemSize);
+		}
 
 		//if(range_check(pEnd, pNewData, ItemSize)) return -4;
 
-		FromIndex = pFrom->GetItemIndex(Key);
 		if(FromIndex != -1)
 		{
 			// we got an update so we need pTo apply the diff
-			UndiffItem((int *)pFrom->GetItem(FromIndex)->Data(), pData, pNewData, ItemSize/4);
+			Crc += UndiffItem((int *)pFrom->GetItem(FromIndex)->Data(), pData, pNewData, ItemSize/4);
 			m_aSnapshotDataUpdates[m_SnapshotCurrent]++;
 		}
 		else // no previous, just copy the pData
 		{
-			mem_copy(pNewData, pData, ItemSize);
+			Crc += CopyItem(pNewData, pData, ItemSize/4);
 			m_aSnapshotDataRate[m_SnapshotCurrent] += ItemSize*8;
 			m_aSnapshotDataUpdates[m_SnapshotCurrent]++;
 		}
@@ -370,16 +439,35 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 	}
 
 	// finish up
+	if(pCrc)
+		*pCrc = (int)Crc;
 	return Builder.Finish(pTo);
 }
 
 
 // CSnapshotStorage
 
+void CSnapshotStorage::CHolder::DetachAlt()
+{
+	if(m_pAltSnap == m_pSnap && m_pAltData)
+	{
+		mem_copy(m_pAltData, m_pSnap, m_SnapSize);
+		m_pAltSnap = m_pAltData;
+	}
+}
+
 void CSnapshotStorage::Init()
 {
 	m_pFirst = 0;
 	m_pLast = 0;
+	mem_zero(m_apIndex, sizeof(m_apIndex));
+}
+
+void CSnapshotStorage::Free(CHolder *pHolder)
+{
+	if(m_apIndex[pHolder->m_Tick&INDEX_MASK] == pHolder)
+		m_apIndex[pHolder->m_Tick&INDEX_MASK] = 0;
+	mem_free(pHolder);
 }
 
 void CSnapshotStorage::PurgeAll()
@@ -390,7 +478,7 @@ void CSnapshotStorage::PurgeAll()
 	while(pHolder)
 	{
 		pNext = pHolder->m_pNext;
-		mem_free(pHolder);
+		Free(pHolder);
 		pHolder = pNext;
 	}
 
@@ -409,7 +497,7 @@ void CSnapshotStorage::PurgeUntil(int Tick)
 		pNext = pHolder->m_pNext;
 		if(pHolder->m_Tick >= Tick)
 			return; // no more to remove
-		mem_free(pHolder);
+		Free(pHolder);
 
 		// did we come to the end of the list?
 		if (!pNext)
@@ -443,13 +531,16 @@ void CSnapshotStorage::Add(int Tick, int64 Tagtime, int DataSize, void *pData, i
 	pHolder->m_pSnap = (CSnapshot*)(pHolder+1);
 	mem_copy(pHolder->m_pSnap, pData, DataSize);
 
-	if(CreateAlt) // create alternative if wanted
+	if(CreateAlt) // create alternative if wanted, it's only copied when it gets changed
 	{
-		pHolder->m_pAltSnap = (CSnapshot*)(((char *)pHolder->m_pSnap) + DataSize);
-		mem_copy(pHolder->m_pAltSnap, pData, DataSize);
+		pHolder->m_pAltSnap = pHolder->m_pSnap;
+		pHolder->m_pAltData = (CSnapshot*)(((char *)pHolder->m_pSnap) + DataSize);
 	}
 	else
+	{
 		pHolder->m_pAltSnap = 0;
+		pHolder->m_pAltData = 0;
+	}
 
 
 	// link
@@ -460,29 +551,34 @@ void CSnapshotStorage::Add(int Tick, int64 Tagtime, int DataSize, void *pData, i
 	else
 		m_pFirst = pHolder;
 	m_pLast = pHolder;
+	m_apIndex[Tick&INDEX_MASK] = pHolder;
 }
 
 int CSnapshotStorage::Get(int Tick, int64 *pTagtime, CSnapshot **ppData, CSnapshot **ppAltData)
 {
-	CHolder *pHolder = m_pFirst;
+	if(Tick < 0)
+		return -1;
 
-	while(pHolder)
+	// ticks are added in order and purged from the oldest, so an empty slot
+	// means the tick isn't stored. only a slot taken by a newer tick needs the list
+	CHolder *pHolder = m_apIndex[Tick&INDEX_MASK];
+	if(!pHolder)
+		return -1;
+	if(pHolder->m_Tick != Tick)
 	{
-		if(pHolder->m_Tick == Tick)
-		{
-			if(pTagtime)
-				*pTagtime = pHolder->m_Tagtime;
-			if(ppData)
-				*ppData = pHolder->m_pSnap;
-			if(ppAltData)
-				*ppAltData = pHolder->m_pAltSnap;
-			return pHolder->m_SnapSize;
-		}
-
-		pHolder = pHolder->m_pNext;
+		for(pHolder = m_pFirst; pHolder && pHolder->m_Tick != Tick; pHolder = pHolder->m_pNext)
+			;
+		if(!pHolder)
+			return -1;
 	}
 
-	return -1;
+	if(pTagtime)
+		*pTagtime = pHolder->m_Tagtime;
+	if(ppData)
+		*ppData = pHolder->m_pSnap;
+	if(ppAltData)
+		*ppAltData = pHolder->m_pAltSnap;
+	return pHolder->m_SnapSize;
 }
 
 // CSnapshotBuilder
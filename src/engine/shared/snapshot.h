@@ -67,7 +67,7 @@ private:
 	int m_SnapshotCurrent;
 	CData m_Empty;
 
-	void UndiffItem(int *pPast, int *pDiff, int *pOut, int Size);
+	unsigned UndiffItem(int *pPast, int *pDiff, int *pOut, int Size);
 
 public:
 	CSnapshotDelta();
@@ -76,7 +76,8 @@ public:
 	void SetStaticsize(int ItemType, int Size);
 	CData *EmptyDelta();
 	int CreateDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pData);
-	int UnpackDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pData, int DataSize);
+	// pCrc gets what pTo->Crc() would return, summed up while unpacking
+	int UnpackDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pData, int DataSize, int *pCrc = 0);
 };
 
 
@@ -85,6 +86,13 @@ public:
 class CSnapshotStorage
 {
 public:
+	enum
+	{
+		// more ticks than anyone keeps snapshots for
+		INDEX_SIZE=256,
+		INDEX_MASK=INDEX_SIZE-1,
+	};
+
 	class CHolder
 	{
 	public:
@@ -96,13 +104,22 @@ public:
 
 		int m_SnapSize;
 		CSnapshot *m_pSnap;
-		CSnapshot *m_pAltSnap;
+		CSnapshot *m_pAltSnap; // the same as m_pSnap until something in it gets changed
+		CSnapshot *m_pAltData; // room for the alternative, 0 if there is none
+
+		// call before changing the alternative snapshot
+		void DetachAlt();
 	};
 
 
 	CHolder *m_pFirst;
 	CHolder *m_pLast;
 
+	// the newest holder for each tick modulo the index size
+	CHolder *m_apIndex[INDEX_SIZE];
+
+	void Free(CHolder *pHolder);
+
 	void Init();
 	void PurgeAll();
 	void PurgeUntil(int Tick);
@@ -130,6 +147,7 @@ public:
 
 	CSnapshotItem *GetItem(int Index);
 	int *GetItemData(int Key);
+	int NumItems() const { return m_NumItems; }
 
 	int Finish(void *Snapdata);
 };
@@ -18,6 +18,7 @@ public:
 
 	virtual bool IsSoundEnabled() = 0;
 
+	// thread safe, the game client loads its sounds on the job threads
 	virtual int LoadWV(const char *pFilename) = 0;
 
 	virtual void SetChannel(int ChannelID, float Volume, float Panning) = 0;
@@ -11,6 +11,7 @@
 #include <engine/shared/linereader.h>
 
 #include "countryflags.h"
+#include "menus.h"
 
 
 void CCountryFlags::LoadCountryflagsIndexfile()
@@ -22,6 +23,8 @@ void CCountryFlags::LoadCountryflagsIndexfile()
 		return;
 	}
 
+	array<CCountryFlag> aEntries;
+	array<CPngLoadJob *> apJobs;
 	char aOrigin[128];
 	CLineReader LineReader;
 	LineReader.Init(File);
@@ -56,40 +59,53 @@ void CCountryFlags::LoadCountryflagsIndexfile()
 			continue;
 		}
 
-		// load the graphic file
-		char aBuf[128];
-		CImageInfo Info;
+		// add entry, the graphic is decoded on the job threads in the meantime
+		CCountryFlag CountryFlag;
+		CountryFlag.m_CountryCode = CountryCode;
+		str_copy(CountryFlag.m_aCountryCodeString, aOrigin, sizeof(CountryFlag.m_aCountryCodeString));
+		CountryFlag.m_Texture = -1;
+		aEntries.add(CountryFlag);
+
+		CPngLoadJob *pJob = 0;
 		if(g_Config.m_ClLoadCountryFlags)
 		{
+			char aBuf[128];
 			str_format(aBuf, sizeof(aBuf), "countryflags/%s.png", aOrigin);
-			if(!Graphics()->LoadPNG(&Info, aBuf, IStorage::TYPE_ALL))
+			pJob = new CPngLoadJob;
+			m_pClient->StartLoadPng(pJob, aBuf, IStorage::TYPE_ALL);
+		}
+		apJobs.add(pJob);
+	}
+	io_close(File);
+
+	// create the textures
+	if(g_Config.m_ClLoadCountryFlags)
+		m_pClient->m_pMenus->IncreaseLoadTotal(aEntries.size());
+	for(int i = 0; i < aEntries.size(); i++)
+	{
+		CCountryFlag CountryFlag = aEntries[i];
+		if(apJobs[i])
+		{
+			CountryFlag.m_Texture = m_pClient->FinishLoadPng(apJobs[i], CImageInfo::FORMAT_AUTO, 0);
+			m_pClient->m_pMenus->RenderLoading();
+			if(CountryFlag.m_Texture == -1)
 			{
 				char aMsg[128];
-				str_format(aMsg, sizeof(aMsg), "failed to load '%s'", aBuf);
+				str_format(aMsg, sizeof(aMsg), "failed to load '%s'", apJobs[i]->m_aFilename);
 				Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "countryflags", aMsg);
+				delete apJobs[i];
 				continue;
 			}
+			delete apJobs[i];
 		}
-
-		// add entry
-		CCountryFlag CountryFlag;
-		CountryFlag.m_CountryCode = CountryCode;
-		str_copy(CountryFlag.m_aCountryCodeString, aOrigin, sizeof(CountryFlag.m_aCountryCodeString));
-		if(g_Config.m_ClLoadCountryFlags)
-		{
-			CountryFlag.m_Texture = Graphics()->LoadTextureRaw(Info.m_Width, Info.m_Height, Info.m_Format, Info.m_pData, Info.m_Format, 0);
-			mem_free(Info.m_pData);
-		}
-		else
-			CountryFlag.m_Texture = -1;
 		if(g_Config.m_Debug)
 		{
-			str_format(aBuf, sizeof(aBuf), "loaded country flag '%s'", aOrigin);
+			char aBuf[128];
+			str_format(aBuf, sizeof(aBuf), "loaded country flag '%s'", CountryFlag.m_aCountryCodeString);
 			Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "countryflags", aBuf);
 		}
 		m_aCountryFlags.add_unsorted(CountryFlag);
 	}
-	io_close(File);
 	m_aCountryFlags.sort_range();
 
 	// find index of default item
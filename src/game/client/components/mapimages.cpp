@@ -28,7 +28,9 @@ void CMapImages::OnMapLoad()
 	int Start;
 	pMap->GetType(MAPITEMTYPE_IMAGE, &Start, &m_Count);
 
-	// load new textures
+	// load new textures. external images are decoded on the job threads
+	// while the embedded ones are uploaded
+	bool aExternal[64] = {false};
 	for(int i = 0; i < m_Count; i++)
 	{
 		m_aTextures[i] = 0;
@@ -39,7 +41,8 @@ void CMapImages::OnMapLoad()
 			char Buf[256];
 			char *pName = (char *)pMap->GetData(pImg->m_ImageName);
 			str_format(Buf, sizeof(Buf), "mapres/%s.png", pName);
-			m_aTextures[i] = Graphics()->LoadTexture(Buf, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, 0);
+			m_pClient->StartLoadPng(&m_aLoadJobs[i], Buf, IStorage::TYPE_ALL);
+			aExternal[i] = true;
 		}
 		else
 		{
@@ -48,4 +51,13 @@ void CMapImages::OnMapLoad()
 			pMap->UnloadData(pImg->m_ImageData);
 		}
 	}
+
+	for(int i = 0; i < m_Count; i++)
+	{
+		if(!aExternal[i])
+			continue;
+		m_aTextures[i] = m_pClient->FinishLoadPng(&m_aLoadJobs[i], CImageInfo::FORMAT_AUTO, 0);
+		if(m_aTextures[i] == -1) // gets the invalid texture and reports the error
+			m_aTextures[i] = Graphics()->LoadTexture(m_aLoadJobs[i].m_aFilename, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, 0);
+	}
 }
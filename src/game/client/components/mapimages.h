@@ -8,6 +8,7 @@ class CMapImages : public CComponent
 {
 	int m_aTextures[64];
 	int m_Count;
+	CPngLoadJob m_aLoadJobs[64];
 public:
 	CMapImages();
 
@@ -25,6 +25,8 @@ CMapLayers::CMapLayers(int t)
 	m_CurrentLocalTick = 0;
 	m_LastLocalTick = 0;
 	m_EnvelopeUpdate = false;
+	m_paTileBlocks = 0;
+	m_NumTileBlocks = 0;
 }
 
 void CMapLayers::OnInit()
@@ -32,6 +34,52 @@ void CMapLayers::OnInit()
 	m_pLayers = Layers();
 }
 
+void CMapLayers::DestroyTileBlocks()
+{
+	for(int i = 0; i < m_NumTileBlocks; i++)
+		if(m_paTileBlocks[i].m_pOpaque)
+			RenderTools()->DestroyTilemapBlocks(&m_paTileBlocks[i]);
+	delete [] m_paTileBlocks;
+	m_paTileBlocks = 0;
+	m_NumTileBlocks = 0;
+}
+
+void CMapLayers::OnMapLoad()
+{
+	DestroyTileBlocks();
+
+	m_NumTileBlocks = m_pLayers->NumLayers();
+	m_paTileBlocks = new CTilemapBlocks[m_NumTileBlocks];
+
+	// bake the tile layers this instance renders, same selection as in OnRender
+	bool PassedGameLayer = false;
+	for(int g = 0; g < m_pLayers->NumGroups(); g++)
+	{
+		CMapItemGroup *pGroup = m_pLayers->GetGroup(g);
+		for(int l = 0; l < pGroup->m_NumLayers; l++)
+		{
+			CMapItemLayer *pLayer = m_pLayers->GetLayer(pGroup->m_StartLayer+l);
+			if(pLayer == (CMapItemLayer*)m_pLayers->GameLayer())
+			{
+				PassedGameLayer = true;
+				continue;
+			}
+
+			if(m_Type == TYPE_BACKGROUND && PassedGameLayer)
+				return;
+			if(m_Type == TYPE_FOREGROUND && !PassedGameLayer)
+				continue;
+
+			if(pLayer->m_Type == LAYERTYPE_TILES)
+			{
+				CMapItemLayerTilemap *pTMap = (CMapItemLayerTilemap *)pLayer;
+				CTile *pTiles = (CTile *)m_pLayers->Map()->GetData(pTMap->m_Data);
+				RenderTools()->CreateTilemapBlocks(&m_paTileBlocks[pGroup->m_StartLayer+l], pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f);
+			}
+		}
+	}
+}
+
 void CMapLayers::EnvelopeUpdate()
 {
 	if(Client()->State() == IClient::STATE_DEMOPLAYBACK)
@@ -215,12 +263,13 @@ void CMapLayers::OnRender()
 						Graphics()->TextureSet(m_pClient->m_pMapimages->Get(pTMap->m_Image));
 
 					CTile *pTiles = (CTile *)m_pLayers->Map()->GetData(pTMap->m_Data);
+					const CTilemapBlocks *pBlocks = &m_paTileBlocks[pGroup->m_StartLayer+l];
 					Graphics()->BlendNone();
 					vec4 Color = vec4(pTMap->m_Color.r/255.0f, pTMap->m_Color.g/255.0f, pTMap->m_Color.b/255.0f, pTMap->m_Color.a/255.0f);
-					RenderTools()->RenderTilemap(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, Color, TILERENDERFLAG_EXTEND|LAYERRENDERFLAG_OPAQUE,
+					RenderTools()->RenderTilemapBlocks(pBlocks, pTiles, 32.0f, Color, TILERENDERFLAG_EXTEND|LAYERRENDERFLAG_OPAQUE,
 													EnvelopeEval, this, pTMap->m_ColorEnv, pTMap->m_ColorEnvOffset);
 					Graphics()->BlendNormal();
-					RenderTools()->RenderTilemap(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, Color, TILERENDERFLAG_EXTEND|LAYERRENDERFLAG_TRANSPARENT,
+					RenderTools()->RenderTilemapBlocks(pBlocks, pTiles, 32.0f, Color, TILERENDERFLAG_EXTEND|LAYERRENDERFLAG_TRANSPARENT,
 													EnvelopeEval, this, pTMap->m_ColorEnv, pTMap->m_ColorEnvOffset);
 				}
 				else if(pLayer->m_Type == LAYERTYPE_QUADS)
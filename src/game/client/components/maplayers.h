@@ -12,6 +12,11 @@ class CMapLayers : public CComponent
 	int m_LastLocalTick;
 	bool m_EnvelopeUpdate;
 
+	class CTilemapBlocks *m_paTileBlocks; // per map layer, empty for the ones this instance doesn't render
+	int m_NumTileBlocks;
+
+	void DestroyTileBlocks();
+
 	void MapScreenToGroup(float CenterX, float CenterY, CMapItemGroup *pGroup);
 	static void EnvelopeEval(float TimeOffset, int Env, float *pChannels, void *pUser);
 public:
@@ -23,6 +28,7 @@ public:
 
 	CMapLayers(int Type);
 	virtual void OnInit();
+	virtual void OnMapLoad();
 	virtual void OnRender();
 
 	void EnvelopeUpdate();
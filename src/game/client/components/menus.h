@@ -283,6 +283,7 @@ public:
 	CMenus();
 
 	void RenderLoading();
+	void IncreaseLoadTotal(int Amount) { m_LoadTotal += Amount; }
 
 	bool IsActive() const { return m_MenuActive; }
 
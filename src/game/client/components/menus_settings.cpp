@@ -248,17 +248,16 @@ void CMenus::RenderSettingsTee(CUIRect MainView)
 	MainView.HSplitTop(10.0f, 0, &MainView);
 
 	// skin info
-	const CSkins::CSkin *pOwnSkin = m_pClient->m_pSkins->Get(m_pClient->m_pSkins->Find(g_Config.m_PlayerSkin));
 	CTeeRenderInfo OwnSkinInfo;
+	OwnSkinInfo.m_Skin = m_pClient->m_pSkins->Find(g_Config.m_PlayerSkin);
+	OwnSkinInfo.m_CustomColoring = g_Config.m_PlayerUseCustomColor;
 	if(g_Config.m_PlayerUseCustomColor)
 	{
-		OwnSkinInfo.m_Texture = pOwnSkin->m_ColorTexture;
 		OwnSkinInfo.m_ColorBody = m_pClient->m_pSkins->GetColorV4(g_Config.m_PlayerColorBody);
 		OwnSkinInfo.m_ColorFeet = m_pClient->m_pSkins->GetColorV4(g_Config.m_PlayerColorFeet);
 	}
 	else
 	{
-		OwnSkinInfo.m_Texture = pOwnSkin->m_OrgTexture;
 		OwnSkinInfo.m_ColorBody = vec4(1.0f, 1.0f, 1.0f, 1.0f);
 		OwnSkinInfo.m_ColorFeet = vec4(1.0f, 1.0f, 1.0f, 1.0f);
 	}
@@ -342,47 +341,45 @@ void CMenus::RenderSettingsTee(CUIRect MainView)
 	// skin selector
 	MainView.HSplitTop(20.0f, 0, &MainView);
 	static bool s_InitSkinlist = true;
-	static sorted_array<const CSkins::CSkin *> s_paSkinList;
+	static array<int> s_aSkinList;
 	static float s_ScrollValue = 0.0f;
 	if(s_InitSkinlist)
 	{
-		s_paSkinList.clear();
+		s_aSkinList.clear();
 		for(int i = 0; i < m_pClient->m_pSkins->Num(); ++i)
 		{
 			const CSkins::CSkin *s = m_pClient->m_pSkins->Get(i);
 			// no special skins
 			if(s->m_aName[0] == 'x' && s->m_aName[1] == '_')
 				continue;
-			s_paSkinList.add(s);
+			s_aSkinList.add(i);
 		}
 		s_InitSkinlist = false;
 	}
 
 	int OldSelected = -1;
-	UiDoListboxStart(&s_InitSkinlist, &MainView, 50.0f, Localize("Skins"), "", s_paSkinList.size(), 4, OldSelected, s_ScrollValue);
+	UiDoListboxStart(&s_InitSkinlist, &MainView, 50.0f, Localize("Skins"), "", s_aSkinList.size(), 4, OldSelected, s_ScrollValue);
 
-	for(int i = 0; i < s_paSkinList.size(); ++i)
+	for(int i = 0; i < s_aSkinList.size(); ++i)
 	{
-		const CSkins::CSkin *s = s_paSkinList[i];
-		if(s == 0)
-			continue;
+		const CSkins::CSkin *s = m_pClient->m_pSkins->Get(s_aSkinList[i]);
 
 		if(str_comp(s->m_aName, g_Config.m_PlayerSkin) == 0)
 			OldSelected = i;
 
-		CListboxItem Item = UiDoListboxNextItem(&s_paSkinList[i], OldSelected == i);
+		CListboxItem Item = UiDoListboxNextItem(&s_aSkinList[i], OldSelected == i);
 		if(Item.m_Visible)
 		{
 			CTeeRenderInfo Info;
+			Info.m_Skin = s_aSkinList[i];
+			Info.m_CustomColoring = g_Config.m_PlayerUseCustomColor;
 			if(g_Config.m_PlayerUseCustomColor)
 			{
-				Info.m_Texture = s->m_ColorTexture;
 				Info.m_ColorBody = m_pClient->m_pSkins->GetColorV4(g_Config.m_PlayerColorBody);
 				Info.m_ColorFeet = m_pClient->m_pSkins->GetColorV4(g_Config.m_PlayerColorFeet);
 			}
 			else
 			{
-				Info.m_Texture = s->m_OrgTexture;
 				Info.m_ColorBody = vec4(1.0f, 1.0f, 1.0f, 1.0f);
 				Info.m_ColorFeet = vec4(1.0f, 1.0f, 1.0f, 1.0f);
 			}
@@ -407,7 +404,7 @@ void CMenus::RenderSettingsTee(CUIRect MainView)
 	const int NewSelected = UiDoListboxEnd(&s_ScrollValue, 0);
 	if(OldSelected != NewSelected)
 	{
-		mem_copy(g_Config.m_PlayerSkin, s_paSkinList[NewSelected]->m_aName, sizeof(g_Config.m_PlayerSkin));
+		mem_copy(g_Config.m_PlayerSkin, m_pClient->m_pSkins->Get(s_aSkinList[NewSelected])->m_aName, sizeof(g_Config.m_PlayerSkin));
 		m_NeedSendinfo = true;
 	}
 }
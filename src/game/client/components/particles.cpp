@@ -3,6 +3,7 @@
 #include <base/math.h>
 #include <engine/graphics.h>
 #include <engine/demo.h>
+#include <engine/shared/config.h>
 
 #include <game/generated/client_data.h>
 #include <game/client/render.h>
@@ -11,28 +12,63 @@
 
 CParticles::CParticles()
 {
-	OnReset();
+	mem_zero(m_aGroups, sizeof(m_aGroups));
+	m_pPool = 0;
+	m_MaxParticles = 0;
+	m_NumParticles = 0;
+	m_pSpriteItems = 0;
 	m_RenderTrail.m_pParts = this;
 	m_RenderExplosions.m_pParts = this;
 	m_RenderGeneral.m_pParts = this;
 }
 
+CParticles::~CParticles()
+{
+	mem_free(m_pPool);
+	mem_free(m_pSpriteItems);
+}
 
-void CParticles::OnReset()
+void CParticles::Allocate(int MaxParticles)
 {
-	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
+	mem_free(m_pPool);
+	mem_free(m_pSpriteItems);
+
+	// every group can take up the whole budget
+	int GroupSize = MaxParticles*(12*sizeof(float) + sizeof(vec4) + sizeof(int));
+	m_pPool = mem_alloc(GroupSize*NUM_GROUPS, sizeof(vec4));
+	m_pSpriteItems = (IGraphics::CSpriteQuadItem *)mem_alloc(MaxParticles*sizeof(IGraphics::CSpriteQuadItem), sizeof(float));
+	m_MaxParticles = MaxParticles;
+
+	char *pData = (char *)m_pPool;
+	for(int g = 0; g < NUM_GROUPS; g++)
 	{
-		m_aParticles[i].m_PrevPart = i-1;
-		m_aParticles[i].m_NextPart = i+1;
+		CGroup *pGroup = &m_aGroups[g];
+		pGroup->m_pColor = (vec4 *)pData; pData += MaxParticles*sizeof(vec4);
+		pGroup->m_pPosX = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pPosY = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pVelX = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pVelY = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pLife = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pLifeSpan = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pStartSize = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pEndSize = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pRot = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pRotspeed = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pGravity = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pFriction = (float *)pData; pData += MaxParticles*sizeof(float);
+		pGroup->m_pSpr = (int *)pData; pData += MaxParticles*sizeof(int);
 	}
+}
 
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES-1].m_NextPart = -1;
-	m_FirstFree = 0;
+void CParticles::OnReset()
+{
+	// a new particle cap is picked up here
+	if(m_MaxParticles != g_Config.m_GfxParticles)
+		Allocate(g_Config.m_GfxParticles);
 
-	for(int i = 0; i < NUM_GROUPS; i++)
-		m_aFirstPart[i] = -1;
+	for(int g = 0; g < NUM_GROUPS; g++)
+		m_aGroups[g].m_Num = 0;
+	m_NumParticles = 0;
 }
 
 void CParticles::Add(int Group, CParticle *pPart)
@@ -49,27 +85,27 @@ void CParticles::Add(int Group, CParticle *pPart)
 			return;
 	}
 
-	if (m_FirstFree == -1)
+	if(m_NumParticles >= m_MaxParticles)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = 0;
+	CGroup *pGroup = &m_aGroups[Group];
+	int i = pGroup->m_Num++;
+	m_NumParticles++;
+
+	pGroup->m_pPosX[i] = pPart->m_Pos.x;
+	pGroup->m_pPosY[i] = pPart->m_Pos.y;
+	pGroup->m_pVelX[i] = pPart->m_Vel.x;
+	pGroup->m_pVelY[i] = pPart->m_Vel.y;
+	pGroup->m_pLife[i] = 0;
+	pGroup->m_pLifeSpan[i] = pPart->m_LifeSpan;
+	pGroup->m_pStartSize[i] = pPart->m_StartSize;
+	pGroup->m_pEndSize[i] = pPart->m_EndSize;
+	pGroup->m_pRot[i] = pPart->m_Rot;
+	pGroup->m_pRotspeed[i] = pPart->m_Rotspeed;
+	pGroup->m_pGravity[i] = pPart->m_Gravity;
+	pGroup->m_pFriction[i] = pPart->m_Friction;
+	pGroup->m_pColor[i] = pPart->m_Color;
+	pGroup->m_pSpr[i] = pPart->m_Spr;
 }
 
 void CParticles::Update(float TimePassed)
@@ -89,45 +125,64 @@ void CParticles::Update(float TimePassed)
 
 	for(int g = 0; g < NUM_GROUPS; g++)
 	{
-		int i = m_aFirstPart[g];
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity*TimePassed;
+		CGroup *pGroup = &m_aGroups[g];
+		const int Num = pGroup->m_Num;
 
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
+		// plain passes over the arrays first, these the compiler can vectorize
+		for(int i = 0; i < Num; i++)
+			pGroup->m_pVelY[i] += pGroup->m_pGravity[i]*TimePassed;
+
+		for(int f = 0; f < FrictionCount; f++) // apply friction
+			for(int i = 0; i < Num; i++)
+			{
+				pGroup->m_pVelX[i] *= pGroup->m_pFriction[i];
+				pGroup->m_pVelY[i] *= pGroup->m_pFriction[i];
+			}
 
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel*TimePassed;
-			Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, 0.1f+0.9f*frandom(), NULL);
-			m_aParticles[i].m_Vel = Vel* (1.0f/TimePassed);
+		for(int i = 0; i < Num; i++)
+		{
+			pGroup->m_pLife[i] += TimePassed;
+			pGroup->m_pRot[i] += TimePassed * pGroup->m_pRotspeed[i];
+		}
 
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
+		// move the points, collision has to go one by one
+		for(int i = 0; i < Num; i++)
+		{
+			vec2 Pos(pGroup->m_pPosX[i], pGroup->m_pPosY[i]);
+			vec2 Vel = vec2(pGroup->m_pVelX[i], pGroup->m_pVelY[i])*TimePassed;
+			Collision()->MovePoint(&Pos, &Vel, 0.1f+0.9f*frandom(), NULL);
+			Vel *= 1.0f/TimePassed;
+			pGroup->m_pPosX[i] = Pos.x;
+			pGroup->m_pPosY[i] = Pos.y;
+			pGroup->m_pVelX[i] = Vel.x;
+			pGroup->m_pVelY[i] = Vel.y;
+		}
 
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
+		// check particle death, the last particle takes the place of a dead one
+		for(int i = 0; i < pGroup->m_Num;)
+		{
+			if(pGroup->m_pLife[i] <= pGroup->m_pLifeSpan[i])
 			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					m_aFirstPart[g] = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
+				i++;
+				continue;
 			}
 
-			i = Next;
+			int Last = --pGroup->m_Num;
+			m_NumParticles--;
+			pGroup->m_pPosX[i] = pGroup->m_pPosX[Last];
+			pGroup->m_pPosY[i] = pGroup->m_pPosY[Last];
+			pGroup->m_pVelX[i] = pGroup->m_pVelX[Last];
+			pGroup->m_pVelY[i] = pGroup->m_pVelY[Last];
+			pGroup->m_pLife[i] = pGroup->m_pLife[Last];
+			pGroup->m_pLifeSpan[i] = pGroup->m_pLifeSpan[Last];
+			pGroup->m_pStartSize[i] = pGroup->m_pStartSize[Last];
+			pGroup->m_pEndSize[i] = pGroup->m_pEndSize[Last];
+			pGroup->m_pRot[i] = pGroup->m_pRot[Last];
+			pGroup->m_pRotspeed[i] = pGroup->m_pRotspeed[Last];
+			pGroup->m_pGravity[i] = pGroup->m_pGravity[Last];
+			pGroup->m_pFriction[i] = pGroup->m_pFriction[Last];
+			pGroup->m_pColor[i] = pGroup->m_pColor[Last];
+			pGroup->m_pSpr[i] = pGroup->m_pSpr[Last];
 		}
 	}
 }
@@ -157,32 +212,46 @@ void CParticles::OnRender()
 
 void CParticles::RenderGroup(int Group)
 {
+	const CGroup *pGroup = &m_aGroups[Group];
+	int NumItems = 0;
+	for(int i = 0; i < pGroup->m_Num; i++)
+	{
+		int Spr = pGroup->m_pSpr[i];
+		if(Spr < 0 || Spr >= g_pData->m_NumSprites)
+			continue;
+
+		// the subset SelectSprite would pick
+		const CDataSprite *pSpr = &g_pData->m_aSprites[Spr];
+		IGraphics::CSpriteQuadItem *pItem = &m_pSpriteItems[NumItems++];
+		pItem->m_TlU = pSpr->m_X/(float)pSpr->m_pSet->m_Gridx;
+		pItem->m_TlV = pSpr->m_Y/(float)pSpr->m_pSet->m_Gridy;
+		pItem->m_BrU = (pSpr->m_X+pSpr->m_W)/(float)pSpr->m_pSet->m_Gridx;
+		pItem->m_BrV = (pSpr->m_Y+pSpr->m_H)/(float)pSpr->m_pSet->m_Gridy;
+
+		pItem->m_R = pGroup->m_pColor[i].r;
+		pItem->m_G = pGroup->m_pColor[i].g;
+		pItem->m_B = pGroup->m_pColor[i].b;
+		pItem->m_A = pGroup->m_pColor[i].a; // pow(a, 0.75f) *
+
+		// rotate the corners around the center
+		float a = pGroup->m_pLife[i] / pGroup->m_pLifeSpan[i];
+		float HalfSize = mix(pGroup->m_pStartSize[i], pGroup->m_pEndSize[i], a)/2;
+		float c = cosf(pGroup->m_pRot[i])*HalfSize;
+		float s = sinf(pGroup->m_pRot[i])*HalfSize;
+		float x = pGroup->m_pPosX[i];
+		float y = pGroup->m_pPosY[i];
+		pItem->m_Corners = IGraphics::CFreeformItem(
+			x - c + s, y - s - c,
+			x + c + s, y + s - c,
+			x - c - s, y - s + c,
+			x + c - s, y + s + c);
+	}
+
 	Graphics()->BlendNormal();
 	//gfx_blend_additive();
 	Graphics()->TextureSet(g_pData->m_aImages[IMAGE_PARTICLES].m_Id);
 	Graphics()->QuadsBegin();
-
-	int i = m_aFirstPart[Group];
-	while(i != -1)
-	{
-		RenderTools()->SelectSprite(m_aParticles[i].m_Spr);
-		float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-		vec2 p = m_aParticles[i].m_Pos;
-		float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-
-		Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
-
-		Graphics()->SetColor(
-			m_aParticles[i].m_Color.r,
-			m_aParticles[i].m_Color.g,
-			m_aParticles[i].m_Color.b,
-			m_aParticles[i].m_Color.a); // pow(a, 0.75f) *
-
-		IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
-		Graphics()->QuadsDraw(&QuadItem, 1);
-
-		i = m_aParticles[i].m_NextPart;
-	}
+	Graphics()->QuadsDrawSprites(m_pSpriteItems, NumItems);
 	Graphics()->QuadsEnd();
 	Graphics()->BlendNormal();
 }
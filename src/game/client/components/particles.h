@@ -3,6 +3,7 @@
 #ifndef GAME_CLIENT_COMPONENTS_PARTICLES_H
 #define GAME_CLIENT_COMPONENTS_PARTICLES_H
 #include <base/vmath.h>
+#include <engine/graphics.h>
 #include <game/client/component.h>
 
 // particles
@@ -41,11 +42,6 @@ struct CParticle
 	float m_Friction;
 
 	vec4 m_Color;
-
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
 };
 
 class CParticles : public CComponent
@@ -61,6 +57,7 @@ public:
 	};
 
 	CParticles();
+	~CParticles();
 
 	void Add(int Group, CParticle *pPart);
 
@@ -69,15 +66,34 @@ public:
 
 private:
 
-	enum
+	// the particles of a group, one array per field. dead particles are
+	// replaced by the last one so the live ones stay packed at the front
+	struct CGroup
 	{
-		MAX_PARTICLES=1024*8,
+		int m_Num;
+		float *m_pPosX;
+		float *m_pPosY;
+		float *m_pVelX;
+		float *m_pVelY;
+		float *m_pLife;
+		float *m_pLifeSpan;
+		float *m_pStartSize;
+		float *m_pEndSize;
+		float *m_pRot;
+		float *m_pRotspeed;
+		float *m_pGravity;
+		float *m_pFriction;
+		vec4 *m_pColor;
+		int *m_pSpr;
 	};
 
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	CGroup m_aGroups[NUM_GROUPS];
+	void *m_pPool;
+	int m_MaxParticles; // over all groups, from gfx_particles
+	int m_NumParticles;
+	IGraphics::CSpriteQuadItem *m_pSpriteItems;
 
+	void Allocate(int MaxParticles);
 	void RenderGroup(int Group);
 	void Update(float TimePassed);
 
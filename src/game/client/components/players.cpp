@@ -46,7 +46,7 @@ void CPlayers::RenderHand(CTeeRenderInfo *pInfo, vec2 CenterPos, vec2 Dir, float
 	HandPos += DirY * PostRotOffset.y;
 
 	//Graphics()->TextureSet(data->m_aImages[IMAGE_CHAR_DEFAULT].id);
-	Graphics()->TextureSet(pInfo->m_Texture);
+	RenderTools()->SelectTeeSkin(pInfo);
 	Graphics()->QuadsBegin();
 	Graphics()->SetColor(pInfo->m_ColorBody.r, pInfo->m_ColorBody.g, pInfo->m_ColorBody.b, pInfo->m_ColorBody.a);
 
@@ -544,11 +544,10 @@ void CPlayers::OnRender()
 			int Skin = m_pClient->m_pSkins->Find("x_ninja");
 			if(Skin != -1)
 			{
-				if(IsTeamplay)
-					m_aRenderInfo[i].m_Texture = m_pClient->m_pSkins->Get(Skin)->m_ColorTexture;
-				else
+				m_aRenderInfo[i].m_Skin = Skin;
+				m_aRenderInfo[i].m_CustomColoring = IsTeamplay;
+				if(!IsTeamplay)
 				{
-					m_aRenderInfo[i].m_Texture = m_pClient->m_pSkins->Get(Skin)->m_OrgTexture;
 					m_aRenderInfo[i].m_ColorBody = vec4(1,1,1,1);
 					m_aRenderInfo[i].m_ColorFeet = vec4(1,1,1,1);
 				}
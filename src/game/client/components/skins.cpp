@@ -5,12 +5,79 @@
 #include <base/system.h>
 #include <base/math.h>
 
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/storage.h>
 #include <engine/shared/config.h>
 
 #include "skins.h"
 
+// box filters an image to the given size, the result is always rgba
+static void ScaleImage(const CImageInfo *pInfo, unsigned char *pDst, int Width, int Height)
+{
+	const unsigned char *pSrc = (const unsigned char *)pInfo->m_pData;
+	int Step = pInfo->m_Format == CImageInfo::FORMAT_RGBA ? 4 : 3;
+	for(int y = 0; y < Height; y++)
+	{
+		int y0 = y*pInfo->m_Height/Height;
+		int y1 = max(y0+1, (y+1)*pInfo->m_Height/Height);
+		for(int x = 0; x < Width; x++)
+		{
+			int x0 = x*pInfo->m_Width/Width;
+			int x1 = max(x0+1, (x+1)*pInfo->m_Width/Width);
+			int aSum[4] = {0};
+			for(int sy = y0; sy < y1; sy++)
+				for(int sx = x0; sx < x1; sx++)
+				{
+					const unsigned char *p = &pSrc[(sy*pInfo->m_Width+sx)*Step];
+					aSum[0] += p[0];
+					aSum[1] += p[1];
+					aSum[2] += p[2];
+					aSum[3] += Step == 4 ? p[3] : 255;
+				}
+			int Count = (y1-y0)*(x1-x0);
+			for(int c = 0; c < 4; c++)
+				pDst[(y*Width+x)*4+c] = aSum[c]/Count;
+		}
+	}
+}
+
+// fills in the levels after the first one, they follow each other in memory
+static void BuildMipmaps(unsigned char *pData, int Width, int Height, int NumLevels)
+{
+	for(int l = 1; l < NumLevels; l++)
+	{
+		const unsigned char *pSrc = pData;
+		unsigned char *pDst = pData + Width*Height*4;
+		Width /= 2;
+		Height /= 2;
+		for(int y = 0; y < Height; y++)
+			for(int x = 0; x < Width; x++)
+				for(int c = 0; c < 4; c++)
+				{
+					int Sum = pSrc[((y*2)*Width*2+x*2)*4+c] + pSrc[((y*2)*Width*2+x*2+1)*4+c] +
+						pSrc[((y*2+1)*Width*2+x*2)*4+c] + pSrc[((y*2+1)*Width*2+x*2+1)*4+c];
+					pDst[(y*Width+x)*4+c] = Sum/4;
+				}
+		pData = pDst;
+	}
+}
+
+static int MipmapsSize(int Width, int Height, int NumLevels)
+{
+	int Size = 0;
+	for(int l = 0; l < NumLevels; l++)
+		Size += (Width>>l)*(Height>>l)*4;
+	return Size;
+}
+
+CSkins::CSkins()
+{
+	m_AtlasTexture = -1;
+	m_DefaultSkin = -1;
+	m_Frame = 0;
+}
+
 int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 {
 	CSkins *pSelf = (CSkins *)pUser;
@@ -18,22 +85,36 @@ int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 	if(l < 4 || IsDir || str_comp(pName+l-4, ".png") != 0)
 		return 0;
 
-	char aBuf[512];
-	str_format(aBuf, sizeof(aBuf), "skins/%s", pName);
+	// only remember where it is, it gets decoded when it is needed
+	CSkin Skin;
+	str_copy(Skin.m_aName, pName, min((int)sizeof(Skin.m_aName),l-3));
+	Skin.m_BloodColor = vec3(1.0f, 1.0f, 1.0f);
+	Skin.m_DirType = DirType;
+	Skin.m_State = STATE_UNLOADED;
+	Skin.m_Slot = -1;
+	Skin.m_LastUsed = 0;
+	Skin.m_pJob = 0;
+	pSelf->m_aSkins.add(Skin);
+	return 0;
+}
+
+int CSkins::LoadSkinJob(void *pUser)
+{
+	CLoadJob *pJob = (CLoadJob *)pUser;
 	CImageInfo Info;
-	if(!pSelf->Graphics()->LoadPNG(&Info, aBuf, DirType))
-	{
-		str_format(aBuf, sizeof(aBuf), "failed to load skin from %s", pName);
-		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+	if(!pJob->m_pGraphics->LoadPNG(&Info, pJob->m_aFilename, pJob->m_DirType))
 		return 0;
-	}
 
-	CSkin Skin;
-	Skin.m_OrgTexture = pSelf->Graphics()->LoadTextureRaw(Info.m_Width, Info.m_Height, Info.m_Format, Info.m_pData, Info.m_Format, 0);
+	// bring it to the size of a cell
+	int DataSize = MipmapsSize(CELL_WIDTH, CELL_HEIGHT, NUM_LEVELS);
+	pJob->m_apData[0] = (unsigned char *)mem_alloc(DataSize, 1);
+	pJob->m_apData[1] = (unsigned char *)mem_alloc(DataSize, 1);
+	ScaleImage(&Info, pJob->m_apData[0], CELL_WIDTH, CELL_HEIGHT);
+	mem_free(Info.m_pData);
 
 	int BodySize = 96; // body size
-	unsigned char *d = (unsigned char *)Info.m_pData;
-	int Pitch = Info.m_Width*4;
+	unsigned char *d = pJob->m_apData[0];
+	int Pitch = CELL_WIDTH*4;
 
 	// dig out blood color
 	{
@@ -49,19 +130,20 @@ int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 				}
 			}
 
-		Skin.m_BloodColor = normalize(vec3(aColors[0], aColors[1], aColors[2]));
+		pJob->m_BloodColor = normalize(vec3(aColors[0], aColors[1], aColors[2]));
 	}
 
 	// create colorless version
-	int Step = Info.m_Format == CImageInfo::FORMAT_RGBA ? 4 : 3;
+	mem_copy(pJob->m_apData[1], pJob->m_apData[0], CELL_WIDTH*CELL_HEIGHT*4);
+	d = pJob->m_apData[1];
 
 	// make the texture gray scale
-	for(int i = 0; i < Info.m_Width*Info.m_Height; i++)
+	for(int i = 0; i < CELL_WIDTH*CELL_HEIGHT; i++)
 	{
-		int v = (d[i*Step]+d[i*Step+1]+d[i*Step+2])/3;
-		d[i*Step] = v;
-		d[i*Step+1] = v;
-		d[i*Step+2] = v;
+		int v = (d[i*4]+d[i*4+1]+d[i*4+2])/3;
+		d[i*4] = v;
+		d[i*4+1] = v;
+		d[i*4+2] = v;
 	}
 
 
@@ -99,37 +181,197 @@ int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 			d[y*Pitch+x*4+2] = v;
 		}
 
-	Skin.m_ColorTexture = pSelf->Graphics()->LoadTextureRaw(Info.m_Width, Info.m_Height, Info.m_Format, Info.m_pData, Info.m_Format, 0);
-	mem_free(Info.m_pData);
+	// the atlas is updated a cell at a time, so the mipmaps are made here
+	BuildMipmaps(pJob->m_apData[0], CELL_WIDTH, CELL_HEIGHT, NUM_LEVELS);
+	BuildMipmaps(pJob->m_apData[1], CELL_WIDTH, CELL_HEIGHT, NUM_LEVELS);
 
-	// set skin data
-	str_copy(Skin.m_aName, pName, min((int)sizeof(Skin.m_aName),l-3));
-	if(g_Config.m_Debug)
+	pJob->m_Loaded = 1;
+	return 0;
+}
+
+void CSkins::Request(int Index)
+{
+	CSkin *pSkin = &m_aSkins[Index];
+	if(pSkin->m_State != STATE_UNLOADED)
+		return;
+
+	CLoadJob *pJob = new CLoadJob;
+	pJob->m_pGraphics = Graphics();
+	str_format(pJob->m_aFilename, sizeof(pJob->m_aFilename), "skins/%s.png", pSkin->m_aName);
+	pJob->m_DirType = pSkin->m_DirType;
+	pJob->m_apData[0] = 0;
+	pJob->m_apData[1] = 0;
+	pJob->m_Loaded = 0;
+	pSkin->m_pJob = pJob;
+	pSkin->m_State = STATE_LOADING;
+	m_aLoading.add(Index);
+	m_pClient->Engine()->AddJob(&pJob->m_Job, LoadSkinJob, pJob);
+}
+
+int CSkins::FindSlot()
+{
+	for(int i = 0; i < NUM_SLOTS; i++)
+		if(m_aSlotOwner[i] == -1)
+			return i;
+
+	// evict the skin that wasn't rendered for the longest time. anything
+	// drawn last frame stays, the new skin has to wait then
+	int Oldest = -1;
+	for(int i = 0; i < NUM_SLOTS; i++)
 	{
-		str_format(aBuf, sizeof(aBuf), "load skin %s", Skin.m_aName);
-		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+		const CSkin *pSkin = &m_aSkins[m_aSlotOwner[i]];
+		if(m_aSlotOwner[i] == m_DefaultSkin || pSkin->m_LastUsed >= m_Frame-1)
+			continue;
+		if(Oldest == -1 || pSkin->m_LastUsed < m_aSkins[m_aSlotOwner[Oldest]].m_LastUsed)
+			Oldest = i;
 	}
-	pSelf->m_aSkins.add(Skin);
+	if(Oldest == -1)
+		return -1;
 
-	return 0;
+	CSkin *pEvicted = &m_aSkins[m_aSlotOwner[Oldest]];
+	pEvicted->m_State = STATE_UNLOADED;
+	pEvicted->m_Slot = -1;
+	m_aSlotOwner[Oldest] = -1;
+	if(g_Config.m_Debug)
+	{
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "evicted skin %s", pEvicted->m_aName);
+		Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "skins", aBuf);
+	}
+	return Oldest;
 }
 
+void CSkins::Upload(int Index)
+{
+	CSkin *pSkin = &m_aSkins[Index];
+	CLoadJob *pJob = pSkin->m_pJob;
+	int x = (pSkin->m_Slot%SLOTS_X)*CELL_WIDTH*2;
+	int y = (pSkin->m_Slot/SLOTS_X)*CELL_HEIGHT;
+	for(int v = 0; v < 2; v++)
+	{
+		const unsigned char *pData = pJob->m_apData[v];
+		for(int l = 0; l < NUM_LEVELS; l++)
+		{
+			Graphics()->LoadTextureRawSubLevel(m_AtlasTexture, l, (x+v*CELL_WIDTH)>>l, y>>l, CELL_WIDTH>>l, CELL_HEIGHT>>l, CImageInfo::FORMAT_RGBA, pData);
+			pData += (CELL_WIDTH>>l)*(CELL_HEIGHT>>l)*4;
+		}
+	}
+	pSkin->m_BloodColor = pJob->m_BloodColor;
+	pSkin->m_State = STATE_RESIDENT;
+	m_aSlotOwner[pSkin->m_Slot] = Index;
+
+	if(g_Config.m_Debug)
+	{
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "load skin %s", pSkin->m_aName);
+		Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+	}
+}
 
 void CSkins::OnInit()
 {
-	// load skins
+	// list skins
 	m_aSkins.clear();
+	m_aLoading.clear();
 	Storage()->ListDirectory(IStorage::TYPE_ALL, "skins", SkinScan, this);
 	if(!m_aSkins.size())
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "gameclient", "failed to load skins. folder='skins/'");
 		CSkin DummySkin;
-		DummySkin.m_OrgTexture = -1;
-		DummySkin.m_ColorTexture = -1;
 		str_copy(DummySkin.m_aName, "dummy", sizeof(DummySkin.m_aName));
 		DummySkin.m_BloodColor = vec3(1.0f, 1.0f, 1.0f);
+		DummySkin.m_DirType = IStorage::TYPE_ALL;
+		DummySkin.m_State = STATE_FAILED;
+		DummySkin.m_Slot = -1;
+		DummySkin.m_LastUsed = 0;
+		DummySkin.m_pJob = 0;
 		m_aSkins.add(DummySkin);
 	}
+
+	// create the atlas
+	for(int i = 0; i < NUM_SLOTS; i++)
+		m_aSlotOwner[i] = -1;
+	m_AtlasTexture = Graphics()->CreateTextureLevels(ATLAS_WIDTH, ATLAS_HEIGHT, NUM_LEVELS, CImageInfo::FORMAT_RGBA);
+
+	// the default skin stands in for the others while they load, it never leaves the atlas
+	m_DefaultSkin = Find("default");
+	if(m_DefaultSkin == -1)
+		m_DefaultSkin = 0;
+	Request(m_DefaultSkin);
+	CSkin *pDefault = &m_aSkins[m_DefaultSkin];
+	if(pDefault->m_pJob)
+	{
+		m_pClient->WaitForJob(&pDefault->m_pJob->m_Job);
+		OnRender();
+
+		// skins bleed in the default color until they are decoded on first use
+		for(int i = 0; i < m_aSkins.size(); i++)
+			if(i != m_DefaultSkin)
+				m_aSkins[i].m_BloodColor = pDefault->m_BloodColor;
+	}
+}
+
+void CSkins::OnRender()
+{
+	m_Frame++;
+
+	// move decoded skins into the atlas
+	int Uploads = 0;
+	for(int i = 0; i < m_aLoading.size() && Uploads < MAX_UPLOADS_PER_FRAME; )
+	{
+		CSkin *pSkin = &m_aSkins[m_aLoading[i]];
+		CLoadJob *pJob = pSkin->m_pJob;
+		if(pJob->m_Job.Status() != CJob::STATE_DONE)
+		{
+			i++;
+			continue;
+		}
+
+		if(!pJob->m_Loaded)
+		{
+			char aBuf[512];
+			str_format(aBuf, sizeof(aBuf), "failed to load skin from %s.png", pSkin->m_aName);
+			Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+			pSkin->m_State = STATE_FAILED;
+		}
+		else
+		{
+			pSkin->m_Slot = FindSlot();
+			if(pSkin->m_Slot == -1)
+				break; // everything in the atlas is on screen, try again next frame
+			Upload(m_aLoading[i]);
+			Uploads++;
+		}
+
+		mem_free(pJob->m_apData[0]);
+		mem_free(pJob->m_apData[1]);
+		delete pJob;
+		pSkin->m_pJob = 0;
+		m_aLoading.remove_index_fast(i);
+	}
+}
+
+int CSkins::GetTexture(int Index, bool CustomColoring, vec4 *pRect)
+{
+	if(Index < 0 || Index >= m_aSkins.size())
+		Index = m_DefaultSkin;
+
+	CSkin *pSkin = &m_aSkins[Index];
+	pSkin->m_LastUsed = m_Frame;
+	if(pSkin->m_State == STATE_UNLOADED)
+		Request(Index);
+	if(pSkin->m_State != STATE_RESIDENT)
+		pSkin = &m_aSkins[m_DefaultSkin];
+	if(pSkin->m_State != STATE_RESIDENT)
+	{
+		*pRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		return -1;
+	}
+
+	float x = (pSkin->m_Slot%SLOTS_X)*CELL_WIDTH*2 + (CustomColoring ? CELL_WIDTH : 0);
+	float y = (pSkin->m_Slot/SLOTS_X)*CELL_HEIGHT;
+	*pRect = vec4(x/ATLAS_WIDTH, y/ATLAS_HEIGHT, (x+CELL_WIDTH)/ATLAS_WIDTH, (y+CELL_HEIGHT)/ATLAS_HEIGHT);
+	return m_AtlasTexture;
 }
 
 int CSkins::Num()
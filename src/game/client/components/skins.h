@@ -4,23 +4,36 @@
 #define GAME_CLIENT_COMPONENTS_SKINS_H
 #include <base/vmath.h>
 #include <base/tl/sorted_array.h>
+#include <engine/shared/jobs.h>
 #include <game/client/component.h>
 
+// skins are only listed at startup. a skin is decoded on the job threads the
+// first time it is rendered and then lives in a shared atlas until the least
+// recently used ones have to make room for others
 class CSkins : public CComponent
 {
+	struct CLoadJob;
+
 public:
 	// do this better and nicer
 	struct CSkin
 	{
-		int m_OrgTexture;
-		int m_ColorTexture;
 		char m_aName[24];
 		vec3 m_BloodColor;
 
+		int m_DirType;
+		int m_State;
+		int m_Slot; // place in the atlas while resident
+		int m_LastUsed; // frame it was rendered in the last time
+		CLoadJob *m_pJob;
+
 		bool operator<(const CSkin &Other) { return str_comp(m_aName, Other.m_aName) < 0; }
 	};
 
-	void OnInit();
+	CSkins();
+
+	virtual void OnInit();
+	virtual void OnRender();
 
 	vec3 GetColorV3(int v);
 	vec4 GetColorV4(int v);
@@ -28,9 +41,55 @@ public:
 	const CSkin *Get(int Index);
 	int Find(const char *pName);
 
+	// the atlas texture and the part of it that holds the skin. a skin that
+	// isn't decoded yet is requested and the default skin stands in for it
+	int GetTexture(int Index, bool CustomColoring, vec4 *pRect);
+
 private:
+	enum
+	{
+		// every skin is scaled to one cell, the colorless version sits next to it
+		CELL_WIDTH=256,
+		CELL_HEIGHT=128,
+		NUM_LEVELS=8, // mipmaps down to 2x1
+		ATLAS_WIDTH=2048,
+		ATLAS_HEIGHT=1024,
+		SLOTS_X=ATLAS_WIDTH/(CELL_WIDTH*2),
+		NUM_SLOTS=SLOTS_X*(ATLAS_HEIGHT/CELL_HEIGHT),
+
+		MAX_UPLOADS_PER_FRAME=4,
+
+		STATE_UNLOADED=0,
+		STATE_LOADING,
+		STATE_RESIDENT,
+		STATE_FAILED,
+	};
+
+	struct CLoadJob
+	{
+		CJob m_Job;
+		class IGraphics *m_pGraphics;
+		char m_aFilename[512];
+		int m_DirType;
+
+		// both versions with all their mipmaps
+		unsigned char *m_apData[2];
+		vec3 m_BloodColor;
+		int m_Loaded;
+	};
+
 	sorted_array<CSkin> m_aSkins;
+	array<int> m_aLoading;
+	int m_aSlotOwner[NUM_SLOTS];
+	int m_AtlasTexture;
+	int m_DefaultSkin;
+	int m_Frame;
+
+	void Request(int Index);
+	int FindSlot();
+	void Upload(int Index);
 
 	static int SkinScan(const char *pName, int IsDir, int DirType, void *pUser);
+	static int LoadSkinJob(void *pUser);
 };
 #endif
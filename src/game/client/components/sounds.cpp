@@ -10,28 +10,10 @@
 #include "sounds.h"
 
 
-struct CUserData
+int CSounds::LoadSoundJob(void *pUser)
 {
-	CGameClient *m_pGameClient;
-	bool m_Render;
-} g_UserData;
-
-static int LoadSoundsThread(void *pUser)
-{
-	CUserData *pData = static_cast<CUserData *>(pUser);
-
-	for(int s = 0; s < g_pData->m_NumSounds; s++)
-	{
-		for(int i = 0; i < g_pData->m_aSounds[s].m_NumSounds; i++)
-		{
-			int Id = pData->m_pGameClient->Sound()->LoadWV(g_pData->m_aSounds[s].m_aSounds[i].m_pFilename);
-			g_pData->m_aSounds[s].m_aSounds[i].m_Id = Id;
-		}
-
-		if(pData->m_Render)
-			pData->m_pGameClient->m_pMenus->RenderLoading();
-	}
-
+	CLoadJob *pJob = static_cast<CLoadJob *>(pUser);
+	pJob->m_pData->m_Id = pJob->m_pSound->LoadWV(pJob->m_pData->m_pFilename);
 	return 0;
 }
 
@@ -70,19 +52,32 @@ void CSounds::OnInit()
 
 	ClearQueue();
 
-	// load sounds
+	// load sounds, every file is a job of its own
+	m_NumLoadJobs = 0;
+	for(int s = 0; s < g_pData->m_NumSounds; s++)
+		m_NumLoadJobs += g_pData->m_aSounds[s].m_NumSounds;
+	m_paLoadJobs = new CLoadJob[m_NumLoadJobs];
+	for(int s = 0, j = 0; s < g_pData->m_NumSounds; s++)
+		for(int i = 0; i < g_pData->m_aSounds[s].m_NumSounds; i++, j++)
+		{
+			m_paLoadJobs[j].m_pSound = Sound();
+			m_paLoadJobs[j].m_pData = &g_pData->m_aSounds[s].m_aSounds[i];
+			m_pClient->Engine()->AddJob(&m_paLoadJobs[j].m_Job, LoadSoundJob, &m_paLoadJobs[j]);
+		}
+
 	if(g_Config.m_ClThreadsoundloading)
-	{
-		g_UserData.m_pGameClient = m_pClient;
-		g_UserData.m_Render = false;
-		m_pClient->Engine()->AddJob(&m_SoundJob, LoadSoundsThread, &g_UserData);
 		m_WaitForSoundJob = true;
-	}
 	else
 	{
-		g_UserData.m_pGameClient = m_pClient;
-		g_UserData.m_Render = true;
-		LoadSoundsThread(&g_UserData);
+		// wait for them set by set
+		for(int s = 0, j = 0; s < g_pData->m_NumSounds; s++)
+		{
+			for(int i = 0; i < g_pData->m_aSounds[s].m_NumSounds; i++, j++)
+				m_pClient->WaitForJob(&m_paLoadJobs[j].m_Job);
+			m_pClient->m_pMenus->RenderLoading();
+		}
+		delete [] m_paLoadJobs;
+		m_paLoadJobs = 0;
 		m_WaitForSoundJob = false;
 	}
 }
@@ -107,10 +102,12 @@ void CSounds::OnRender()
 	// check for sound initialisation
 	if(m_WaitForSoundJob)
 	{
-		if(m_SoundJob.Status() == CJob::STATE_DONE)
-			m_WaitForSoundJob = false;
-		else
-			return;
+		for(int i = 0; i < m_NumLoadJobs; i++)
+			if(m_paLoadJobs[i].m_Job.Status() != CJob::STATE_DONE)
+				return;
+		delete [] m_paLoadJobs;
+		m_paLoadJobs = 0;
+		m_WaitForSoundJob = false;
 	}
 
 	// set listner pos
@@ -17,9 +17,19 @@ class CSounds : public CComponent
 	} m_aQueue[QUEUE_SIZE];
 	int m_QueuePos;
 	int64 m_QueueWaitTime;
-	class CJob m_SoundJob;
+
+	struct CLoadJob
+	{
+		CJob m_Job;
+		class ISound *m_pSound;
+		struct CDataSound *m_pData;
+	};
+	CLoadJob *m_paLoadJobs;
+	int m_NumLoadJobs;
 	bool m_WaitForSoundJob;
-	
+
+	static int LoadSoundJob(void *pUser);
+
 	int GetSampleId(int SetId);
 
 public:
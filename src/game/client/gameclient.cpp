@@ -226,6 +226,7 @@ void CGameClient::OnInit()
 	m_UI.SetGraphics(Graphics(), TextRender());
 	m_RenderTools.m_pGraphics = Graphics();
 	m_RenderTools.m_pUI = UI();
+	m_RenderTools.m_pSkins = m_pSkins;
 	
 	int64 Start = time_get();
 
@@ -254,12 +255,18 @@ void CGameClient::OnInit()
 	for(int i = m_All.m_Num-1; i >= 0; --i)
 		m_All.m_paComponents[i]->OnInit();
 
-	// setup load amount// load textures
+	// load textures
+	CPngLoadJob *paImageJobs = new CPngLoadJob[g_pData->m_NumImages];
+	for(int i = 0; i < g_pData->m_NumImages; i++)
+		StartLoadPng(&paImageJobs[i], g_pData->m_aImages[i].m_pFilename, IStorage::TYPE_ALL);
 	for(int i = 0; i < g_pData->m_NumImages; i++)
 	{
-		g_pData->m_aImages[i].m_Id = Graphics()->LoadTexture(g_pData->m_aImages[i].m_pFilename, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, 0);
+		g_pData->m_aImages[i].m_Id = FinishLoadPng(&paImageJobs[i], CImageInfo::FORMAT_AUTO, 0);
+		if(g_pData->m_aImages[i].m_Id == -1) // gets the invalid texture and reports the error
+			g_pData->m_aImages[i].m_Id = Graphics()->LoadTexture(g_pData->m_aImages[i].m_pFilename, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, 0);
 		g_GameClient.m_pMenus->RenderLoading();
 	}
+	delete [] paImageJobs;
 
 	for(int i = 0; i < m_All.m_Num; i++)
 		m_All.m_paComponents[i]->OnReset();
@@ -718,11 +725,10 @@ void CGameClient::OnNewSnapshot()
 						m_aClients[ClientID].m_SkinID = 0;
 				}
 
-				if(m_aClients[ClientID].m_UseCustomColor)
-					m_aClients[ClientID].m_SkinInfo.m_Texture = g_GameClient.m_pSkins->Get(m_aClients[ClientID].m_SkinID)->m_ColorTexture;
-				else
+				m_aClients[ClientID].m_SkinInfo.m_Skin = m_aClients[ClientID].m_SkinID;
+				m_aClients[ClientID].m_SkinInfo.m_CustomColoring = m_aClients[ClientID].m_UseCustomColor;
+				if(!m_aClients[ClientID].m_UseCustomColor)
 				{
-					m_aClients[ClientID].m_SkinInfo.m_Texture = g_GameClient.m_pSkins->Get(m_aClients[ClientID].m_SkinID)->m_OrgTexture;
 					m_aClients[ClientID].m_SkinInfo.m_ColorBody = vec4(1,1,1,1);
 					m_aClients[ClientID].m_SkinInfo.m_ColorFeet = vec4(1,1,1,1);
 				}
@@ -1042,7 +1048,7 @@ void CGameClient::CClientData::UpdateRenderInfo()
 	// force team colors
 	if(g_GameClient.m_Snap.m_pGameInfoObj && g_GameClient.m_Snap.m_pGameInfoObj->m_GameFlags&GAMEFLAG_TEAMS)
 	{
-		m_RenderInfo.m_Texture = g_GameClient.m_pSkins->Get(m_SkinID)->m_ColorTexture;
+		m_RenderInfo.m_CustomColoring = true;
 		const int TeamColors[2] = {65387, 10223467};
 		if(m_Team >= TEAM_RED && m_Team <= TEAM_BLUE)
 		{
@@ -1069,7 +1075,8 @@ void CGameClient::CClientData::Reset()
 	m_EmoticonStart = -1;
 	m_Active = false;
 	m_ChatIgnore = false;
-	m_SkinInfo.m_Texture = g_GameClient.m_pSkins->Get(0)->m_ColorTexture;
+	m_SkinInfo.m_Skin = 0;
+	m_SkinInfo.m_CustomColoring = true;
 	m_SkinInfo.m_ColorBody = vec4(1,1,1,1);
 	m_SkinInfo.m_ColorFeet = vec4(1,1,1,1);
 	UpdateRenderInfo();
@@ -1120,6 +1127,44 @@ void CGameClient::SendKill(int ClientID)
 	Client()->SendPackMsg(&Msg, MSGFLAG_VITAL);
 }
 
+int CPngLoadJob::Run(void *pUser)
+{
+	CPngLoadJob *pJob = (CPngLoadJob *)pUser;
+	pJob->m_Loaded = pJob->m_pGraphics->LoadPNG(&pJob->m_Info, pJob->m_aFilename, pJob->m_StorageType);
+	return 0;
+}
+
+void CGameClient::StartLoadPng(CPngLoadJob *pJob, const char *pFilename, int StorageType)
+{
+	pJob->m_pGraphics = Graphics();
+	str_copy(pJob->m_aFilename, pFilename, sizeof(pJob->m_aFilename));
+	pJob->m_StorageType = StorageType;
+	pJob->m_Loaded = 0;
+	Engine()->AddJob(&pJob->m_Job, CPngLoadJob::Run, pJob);
+}
+
+int CGameClient::FinishLoadPng(CPngLoadJob *pJob, int StoreFormat, int Flags)
+{
+	WaitForJob(&pJob->m_Job);
+	if(!pJob->m_Loaded)
+		return -1;
+
+	if(StoreFormat == CImageInfo::FORMAT_AUTO)
+		StoreFormat = pJob->m_Info.m_Format;
+	int ID = Graphics()->LoadTextureRaw(pJob->m_Info.m_Width, pJob->m_Info.m_Height, pJob->m_Info.m_Format, pJob->m_Info.m_pData, StoreFormat, Flags);
+	mem_free(pJob->m_Info.m_pData);
+	pJob->m_Info.m_pData = 0;
+	pJob->m_Loaded = 0;
+	return ID;
+}
+
+void CGameClient::WaitForJob(const CJob *pJob)
+{
+	// the workers have the cores, just hand the time slice on
+	while(pJob->Status() != CJob::STATE_DONE)
+		thread_yield();
+}
+
 void CGameClient::ConTeam(IConsole::IResult *pResult, void *pUserData)
 {
 	((CGameClient*)pUserData)->SendSwitchTeam(pResult->GetInteger(0));
@@ -6,10 +6,27 @@
 #include <base/vmath.h>
 #include <engine/client.h>
 #include <engine/console.h>
+#include <engine/graphics.h>
+#include <engine/shared/jobs.h>
 #include <game/layers.h>
 #include <game/gamecore.h>
 #include "render.h"
 
+// decodes a png on one of the engine job threads, the texture is created
+// from it on the main thread with CGameClient::FinishLoadPng
+class CPngLoadJob
+{
+public:
+	CJob m_Job;
+	class IGraphics *m_pGraphics;
+	char m_aFilename[128];
+	int m_StorageType;
+	CImageInfo m_Info;
+	int m_Loaded;
+
+	static int Run(void *pUser);
+};
+
 class CGameClient : public IGameClient
 {
 	class CStack
@@ -223,6 +240,12 @@ public:
 	void SendInfo(bool Start);
 	void SendKill(int ClientID);
 
+	// asset loading. files are decoded on the job threads while the main
+	// thread creates the textures in order as the jobs come in
+	void StartLoadPng(CPngLoadJob *pJob, const char *pFilename, int StorageType);
+	int FinishLoadPng(CPngLoadJob *pJob, int StoreFormat, int Flags);
+	void WaitForJob(const CJob *pJob);
+
 	// pointers to all systems
 	class CGameConsole *m_pGameConsole;
 	class CBinds *m_pBinds;
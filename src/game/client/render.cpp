@@ -12,9 +12,11 @@
 #include <game/layers.h>
 #include "animstate.h"
 #include "render.h"
+#include "components/skins.h"
 
 static float gs_SpriteWScale;
 static float gs_SpriteHScale;
+static vec4 gs_SkinRect(0.0f, 0.0f, 1.0f, 1.0f);
 
 
 /*
@@ -56,6 +58,15 @@ void CRenderTools::SelectSprite(CDataSprite *pSpr, int Flags, int sx, int sy)
 	float y2 = (y+h)/(float)cy;
 	float Temp = 0;
 
+	if(pSpr->m_pSet == g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet)
+	{
+		// skins share one texture
+		x1 = mix(gs_SkinRect.x, gs_SkinRect.z, x1);
+		x2 = mix(gs_SkinRect.x, gs_SkinRect.z, x2);
+		y1 = mix(gs_SkinRect.y, gs_SkinRect.w, y1);
+		y2 = mix(gs_SkinRect.y, gs_SkinRect.w, y2);
+	}
+
 	if(Flags&SPRITE_FLAG_FLIP_Y)
 	{
 		Temp = y1;
@@ -80,6 +91,17 @@ void CRenderTools::SelectSprite(int Id, int Flags, int sx, int sy)
 	SelectSprite(&g_pData->m_aSprites[Id], Flags, sx, sy);
 }
 
+void CRenderTools::SelectTeeSkin(const CTeeRenderInfo *pInfo)
+{
+	if(m_pSkins)
+		Graphics()->TextureSet(m_pSkins->GetTexture(pInfo->m_Skin, pInfo->m_CustomColoring, &gs_SkinRect));
+	else
+	{
+		gs_SkinRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		Graphics()->TextureSet(-1);
+	}
+}
+
 void CRenderTools::DrawSprite(float x, float y, float Size)
 {
 	IGraphics::CQuadItem QuadItem(x, y, Size*gs_SpriteWScale, Size*gs_SpriteHScale);
@@ -171,7 +193,7 @@ void CRenderTools::RenderTee(CAnimState *pAnim, CTeeRenderInfo *pInfo, int Emote
 	vec2 Position = Pos;
 
 	//Graphics()->TextureSet(data->images[IMAGE_CHAR_DEFAULT].id);
-	Graphics()->TextureSet(pInfo->m_Texture);
+	SelectTeeSkin(pInfo);
 
 	// TODO: FIX ME
 	Graphics()->QuadsBegin();
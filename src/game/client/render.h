@@ -13,14 +13,16 @@ class CTeeRenderInfo
 public:
 	CTeeRenderInfo()
 	{
-		m_Texture = -1;
+		m_Skin = -1;
+		m_CustomColoring = false;
 		m_ColorBody = vec4(1,1,1,1);
 		m_ColorFeet = vec4(1,1,1,1);
 		m_Size = 1.0f;
 		m_GotAirJump = 1;
 	};
 
-	int m_Texture;
+	int m_Skin;
+	bool m_CustomColoring; // use the colorless version of the skin
 	vec4 m_ColorBody;
 	vec4 m_ColorFeet;
 	float m_Size;
@@ -37,6 +39,28 @@ enum
 	LAYERRENDERFLAG_TRANSPARENT=2,
 
 	TILERENDERFLAG_EXTEND=4,
+	TILERENDERFLAG_SKIP_INSIDE=8, // only the extended border outside of the map
+};
+
+// a tile layer baked into quad blocks of BLOCK_SIZE*BLOCK_SIZE tiles at map load,
+// so the visible part can be drawn with a handful of commands instead of a quad per tile
+class CTilemapBlocks
+{
+public:
+	enum
+	{
+		BLOCK_SIZE=32,
+		BLOCK_IMMEDIATE=-2, // no quad block could be created, the chunk is drawn tile by tile
+	};
+
+	int m_Width;
+	int m_Height;
+	int m_BlocksX;
+	int m_BlocksY;
+	int *m_pOpaque; // quad block per chunk, -1 if the chunk has no such tiles
+	int *m_pTransparent;
+
+	CTilemapBlocks() : m_Width(0), m_Height(0), m_BlocksX(0), m_BlocksY(0), m_pOpaque(0), m_pTransparent(0) {}
 };
 
 typedef void (*ENVELOPE_EVAL)(float TimeOffset, int Env, float *pChannels, void *pUser);
@@ -46,6 +70,7 @@ class CRenderTools
 public:
 	class IGraphics *m_pGraphics;
 	class CUI *m_pUI;
+	class CSkins *m_pSkins;
 
 	class IGraphics *Graphics() const { return m_pGraphics; }
 	class CUI *UI() const { return m_pUI; }
@@ -55,6 +80,9 @@ public:
 	void SelectSprite(struct CDataSprite *pSprite, int Flags=0, int sx=0, int sy=0);
 	void SelectSprite(int id, int Flags=0, int sx=0, int sy=0);
 
+	// binds the skin atlas, the tee sprites selected after this come from the skin's part of it
+	void SelectTeeSkin(const CTeeRenderInfo *pInfo);
+
 	void DrawSprite(float x, float y, float size);
 
 	// rects
@@ -73,6 +101,11 @@ public:
 	static void RenderEvalEnvelope(CEnvPoint *pPoints, int NumPoints, int Channels, float Time, float *pResult);
 	void RenderQuads(CQuad *pQuads, int NumQuads, int Flags, ENVELOPE_EVAL pfnEval, void *pUser);
 	void RenderTilemap(CTile *pTiles, int w, int h, float Scale, vec4 Color, int RenderFlags, ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset);
+	void RenderTilemapPart(CTile *pTiles, int w, int h, float Scale, vec4 Color, int RenderFlags, ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset,
+		int ClipX0, int ClipY0, int ClipX1, int ClipY1);
+	void CreateTilemapBlocks(CTilemapBlocks *pBlocks, CTile *pTiles, int w, int h, float Scale);
+	void DestroyTilemapBlocks(CTilemapBlocks *pBlocks);
+	void RenderTilemapBlocks(const CTilemapBlocks *pBlocks, CTile *pTiles, float Scale, vec4 Color, int RenderFlags, ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset);
 
 	// helpers
 	void MapscreenToWorld(float CenterX, float CenterY, float ParallaxX, float ParallaxY,
@@ -165,6 +165,15 @@ void CRenderTools::RenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags, ENV
 
 void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, vec4 Color, int RenderFlags,
 									ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset)
+{
+	RenderTilemapPart(pTiles, w, h, Scale, Color, RenderFlags, pfnEval, pUser, ColorEnv, ColorEnvOffset,
+		-0x7fffffff, -0x7fffffff, 0x7fffffff, 0x7fffffff);
+}
+
+// only draws the tiles inside the clip rect, in tiles, end exclusive
+void CRenderTools::RenderTilemapPart(CTile *pTiles, int w, int h, float Scale, vec4 Color, int RenderFlags,
+									ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset,
+									int ClipX0, int ClipY0, int ClipX1, int ClipY1)
 {
 	//Graphics()->TextureSet(img_get(tmap->image));
 	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
@@ -190,10 +199,10 @@ void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, vec4
 	Graphics()->QuadsBegin();
 	Graphics()->SetColor(Color.r*r, Color.g*g, Color.b*b, Color.a*a);
 
-	int StartY = (int)(ScreenY0/Scale)-1;
-	int StartX = (int)(ScreenX0/Scale)-1;
-	int EndY = (int)(ScreenY1/Scale)+1;
-	int EndX = (int)(ScreenX1/Scale)+1;
+	int StartY = max((int)(ScreenY0/Scale)-1, ClipY0);
+	int StartX = max((int)(ScreenX0/Scale)-1, ClipX0);
+	int EndY = min((int)(ScreenY1/Scale)+1, ClipY1);
+	int EndX = min((int)(ScreenX1/Scale)+1, ClipX1);
 
 	// adjust the texture shift according to mipmap level
 	float TexSize = 1024.0f;
@@ -206,6 +215,12 @@ void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, vec4
 			int mx = x;
 			int my = y;
 
+			if(RenderFlags&TILERENDERFLAG_SKIP_INSIDE && x >= 0 && x < w && y >= 0 && y < h)
+			{
+				x = w-1;
+				continue;
+			}
+
 			if(RenderFlags&TILERENDERFLAG_EXTEND)
 			{
 				if(mx<0)
@@ -308,3 +323,215 @@ void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, vec4
 	Graphics()->QuadsEnd();
 	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
 }
+
+// texture coordinate of a tile corner, split into the part that is fixed at map
+// load and the direction the corner is pulled inwards by the mipmap dependent inset
+struct CTileTexCoord
+{
+	float m_Base;
+	float m_Inset;
+};
+
+void CRenderTools::CreateTilemapBlocks(CTilemapBlocks *pBlocks, CTile *pTiles, int w, int h, float Scale)
+{
+	pBlocks->m_Width = w;
+	pBlocks->m_Height = h;
+	pBlocks->m_BlocksX = (w+CTilemapBlocks::BLOCK_SIZE-1)/CTilemapBlocks::BLOCK_SIZE;
+	pBlocks->m_BlocksY = (h+CTilemapBlocks::BLOCK_SIZE-1)/CTilemapBlocks::BLOCK_SIZE;
+	int NumBlocks = pBlocks->m_BlocksX*pBlocks->m_BlocksY;
+	pBlocks->m_pOpaque = new int[NumBlocks];
+	pBlocks->m_pTransparent = new int[NumBlocks];
+
+	const int MaxQuads = CTilemapBlocks::BLOCK_SIZE*CTilemapBlocks::BLOCK_SIZE;
+	IGraphics::CBlockVertex *pOpaque = new IGraphics::CBlockVertex[MaxQuads*4];
+	IGraphics::CBlockVertex *pTransparent = new IGraphics::CBlockVertex[MaxQuads*4];
+	float TexSize = 1024.0f;
+
+	for(int by = 0; by < pBlocks->m_BlocksY; by++)
+		for(int bx = 0; bx < pBlocks->m_BlocksX; bx++)
+		{
+			int NumOpaque = 0;
+			int NumTransparent = 0;
+			int EndY = min((by+1)*(int)CTilemapBlocks::BLOCK_SIZE, h);
+			int EndX = min((bx+1)*(int)CTilemapBlocks::BLOCK_SIZE, w);
+
+			for(int y = by*CTilemapBlocks::BLOCK_SIZE; y < EndY; y++)
+				for(int x = bx*CTilemapBlocks::BLOCK_SIZE; x < EndX; x++)
+				{
+					int c = x + y*w;
+					unsigned char Index = pTiles[c].m_Index;
+					if(!Index)
+						continue;
+					unsigned char Flags = pTiles[c].m_Flags;
+
+					// same corners as RenderTilemap, with the nudge and inset left for draw time
+					int tx = Index%16;
+					int ty = Index/16;
+					int Px0 = tx*(1024/16);
+					int Py0 = ty*(1024/16);
+					int Px1 = Px0+(1024/16)-1;
+					int Py1 = Py0+(1024/16)-1;
+
+					CTileTexCoord x0 = {Px0/TexSize, 1.0f};
+					CTileTexCoord y0 = {Py0/TexSize, 1.0f};
+					CTileTexCoord x1 = {Px1/TexSize, -1.0f};
+					CTileTexCoord y1 = {Py0/TexSize, 1.0f};
+					CTileTexCoord x2 = {Px1/TexSize, -1.0f};
+					CTileTexCoord y2 = {Py1/TexSize, -1.0f};
+					CTileTexCoord x3 = {Px0/TexSize, 1.0f};
+					CTileTexCoord y3 = {Py1/TexSize, -1.0f};
+
+					if(Flags&TILEFLAG_VFLIP)
+					{
+						x0 = x2;
+						x1 = x3;
+						x2 = x3;
+						x3 = x0;
+					}
+
+					if(Flags&TILEFLAG_HFLIP)
+					{
+						y0 = y3;
+						y2 = y1;
+						y3 = y1;
+						y1 = y0;
+					}
+
+					if(Flags&TILEFLAG_ROTATE)
+					{
+						CTileTexCoord Tmp = x0;
+						x0 = x3;
+						x3 = x2;
+						x2 = x1;
+						x1 = Tmp;
+						Tmp = y0;
+						y0 = y3;
+						y3 = y2;
+						y2 = y1;
+						y1 = Tmp;
+					}
+
+					IGraphics::CBlockVertex *pQuad;
+					if(Flags&TILEFLAG_OPAQUE)
+						pQuad = &pOpaque[4*NumOpaque++];
+					else
+						pQuad = &pTransparent[4*NumTransparent++];
+
+					const CTileTexCoord *apU[4] = {&x0, &x1, &x2, &x3};
+					const CTileTexCoord *apV[4] = {&y0, &y1, &y2, &y3};
+					for(int i = 0; i < 4; i++)
+					{
+						// corners in the order QuadsDrawTL emits them
+						pQuad[i].m_X = (x + (i == 1 || i == 2 ? 1 : 0))*Scale;
+						pQuad[i].m_Y = (y + (i >= 2 ? 1 : 0))*Scale;
+						pQuad[i].m_U = apU[i]->m_Base;
+						pQuad[i].m_V = apV[i]->m_Base;
+						pQuad[i].m_InsetU = apU[i]->m_Inset;
+						pQuad[i].m_InsetV = apV[i]->m_Inset;
+					}
+				}
+
+			int Block = bx + by*pBlocks->m_BlocksX;
+			pBlocks->m_pOpaque[Block] = NumOpaque ? Graphics()->QuadBlockCreate(pOpaque, NumOpaque) : -1;
+			pBlocks->m_pTransparent[Block] = NumTransparent ? Graphics()->QuadBlockCreate(pTransparent, NumTransparent) : -1;
+
+			// out of quad blocks, draw the whole chunk the old way instead of leaving a hole
+			if((NumOpaque && pBlocks->m_pOpaque[Block] < 0) || (NumTransparent && pBlocks->m_pTransparent[Block] < 0))
+			{
+				static bool s_Logged = false;
+				if(!s_Logged)
+				{
+					dbg_msg("render", "out of quad blocks, some map chunks are drawn tile by tile");
+					s_Logged = true;
+				}
+				Graphics()->QuadBlockDestroy(pBlocks->m_pOpaque[Block]);
+				Graphics()->QuadBlockDestroy(pBlocks->m_pTransparent[Block]);
+				pBlocks->m_pOpaque[Block] = CTilemapBlocks::BLOCK_IMMEDIATE;
+				pBlocks->m_pTransparent[Block] = CTilemapBlocks::BLOCK_IMMEDIATE;
+			}
+		}
+
+	delete [] pOpaque;
+	delete [] pTransparent;
+}
+
+void CRenderTools::DestroyTilemapBlocks(CTilemapBlocks *pBlocks)
+{
+	for(int i = 0; i < pBlocks->m_BlocksX*pBlocks->m_BlocksY; i++)
+	{
+		Graphics()->QuadBlockDestroy(pBlocks->m_pOpaque[i]);
+		Graphics()->QuadBlockDestroy(pBlocks->m_pTransparent[i]);
+	}
+	delete [] pBlocks->m_pOpaque;
+	delete [] pBlocks->m_pTransparent;
+	*pBlocks = CTilemapBlocks();
+}
+
+void CRenderTools::RenderTilemapBlocks(const CTilemapBlocks *pBlocks, CTile *pTiles, float Scale, vec4 Color, int RenderFlags,
+									ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset)
+{
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+
+	// calculate the final pixelsize for the tiles
+	float TilePixelSize = 1024/32.0f;
+	float FinalTileSize = Scale/(ScreenX1-ScreenX0) * Graphics()->ScreenWidth();
+	float FinalTilesetScale = FinalTileSize/TilePixelSize;
+
+	float r=1, g=1, b=1, a=1;
+	if(ColorEnv >= 0)
+	{
+		float aChannels[4];
+		pfnEval(ColorEnvOffset/1000.0f, ColorEnv, aChannels, pUser);
+		r = aChannels[0];
+		g = aChannels[1];
+		b = aChannels[2];
+		a = aChannels[3];
+	}
+
+	int StartY = (int)(ScreenY0/Scale)-1;
+	int StartX = (int)(ScreenX0/Scale)-1;
+	int EndY = (int)(ScreenY1/Scale)+1;
+	int EndX = (int)(ScreenX1/Scale)+1;
+
+	// adjust the texture shift according to mipmap level
+	float TexSize = 1024.0f;
+	float Frac = (1.25f/TexSize) * (1/FinalTilesetScale);
+	float Nudge = (0.5f/TexSize) * (1/FinalTilesetScale);
+
+	// opaque tiles go with the transparent ones when the layer is faded
+	bool FullAlpha = Color.a*a > 254.0f/255.0f;
+	bool DrawOpaque = FullAlpha ? (RenderFlags&LAYERRENDERFLAG_OPAQUE) != 0 : (RenderFlags&LAYERRENDERFLAG_TRANSPARENT) != 0;
+	bool DrawTransparent = (RenderFlags&LAYERRENDERFLAG_TRANSPARENT) != 0;
+
+	if(pBlocks->m_pOpaque && StartX < pBlocks->m_Width && EndX > 0 && StartY < pBlocks->m_Height && EndY > 0)
+	{
+		int StartBX = max(StartX, 0)/CTilemapBlocks::BLOCK_SIZE;
+		int StartBY = max(StartY, 0)/CTilemapBlocks::BLOCK_SIZE;
+		int EndBX = (min(EndX, pBlocks->m_Width)-1)/CTilemapBlocks::BLOCK_SIZE;
+		int EndBY = (min(EndY, pBlocks->m_Height)-1)/CTilemapBlocks::BLOCK_SIZE;
+
+		for(int by = StartBY; by <= EndBY; by++)
+			for(int bx = StartBX; bx <= EndBX; bx++)
+			{
+				int Block = bx + by*pBlocks->m_BlocksX;
+				if(pBlocks->m_pOpaque[Block] == CTilemapBlocks::BLOCK_IMMEDIATE)
+				{
+					int x = bx*CTilemapBlocks::BLOCK_SIZE;
+					int y = by*CTilemapBlocks::BLOCK_SIZE;
+					RenderTilemapPart(pTiles, pBlocks->m_Width, pBlocks->m_Height, Scale, Color, RenderFlags&(LAYERRENDERFLAG_OPAQUE|LAYERRENDERFLAG_TRANSPARENT),
+						pfnEval, pUser, ColorEnv, ColorEnvOffset, x, y, x+CTilemapBlocks::BLOCK_SIZE, y+CTilemapBlocks::BLOCK_SIZE);
+					continue;
+				}
+				if(DrawOpaque)
+					Graphics()->QuadBlockDraw(pBlocks->m_pOpaque[Block], Color.r*r, Color.g*g, Color.b*b, Color.a*a, Nudge, Frac);
+				if(DrawTransparent)
+					Graphics()->QuadBlockDraw(pBlocks->m_pTransparent[Block], Color.r*r, Color.g*g, Color.b*b, Color.a*a, Nudge, Frac);
+			}
+	}
+
+	// the border around the map is still stretched out per tile
+	if(RenderFlags&TILERENDERFLAG_EXTEND && (StartX < 0 || EndX > pBlocks->m_Width || StartY < 0 || EndY > pBlocks->m_Height))
+		RenderTilemap(pTiles, pBlocks->m_Width, pBlocks->m_Height, Scale, Color, RenderFlags|TILERENDERFLAG_SKIP_INSIDE,
+			pfnEval, pUser, ColorEnv, ColorEnvOffset);
+}
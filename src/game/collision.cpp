@@ -18,6 +18,15 @@ CCollision::CCollision()
 	m_Width = 0;
 	m_Height = 0;
 	m_pLayers = 0;
+	m_pTriggerIndex = 0;
+
+	mem_zero(m_aTriggerTiles, sizeof(m_aTriggerTiles));
+	m_aTriggerTiles[COLFLAG_DEATH] = true;
+}
+
+CCollision::~CCollision()
+{
+	mem_free(m_pTriggerIndex);
 }
 
 void CCollision::Init(class CLayers *pLayers)
@@ -56,9 +65,70 @@ void CCollision::Init(class CLayers *pLayers)
 		case TILE_BLUESCORE:
 			break;// don't touch custom stuff as their indices are fine
 		default:
-			m_pTiles[i].m_Index = 0;
+			if(!m_aTriggerTiles[Index])
+				m_pTiles[i].m_Index = 0;
 		}
 	}
+
+	BuildTriggerRegions();
+}
+
+void CCollision::AddTriggerTile(int Tile)
+{
+	dbg_assert(!m_pTiles, "trigger tiles have to be added before Init");
+	dbg_assert(Tile > 0 && Tile <= MAX_TRIGGER_TILE, "trigger tile out of range");
+	m_aTriggerTiles[Tile] = true;
+}
+
+void CCollision::BuildTriggerRegions()
+{
+	m_aTriggerRegions.clear();
+	mem_free(m_pTriggerIndex);
+	m_pTriggerIndex = (int *)mem_alloc(m_Width*m_Height*sizeof(int), 1);
+	for(int i = 0; i < m_Width*m_Height; i++)
+		m_pTriggerIndex[i] = -1;
+
+	// greedy merge, grow a run of equal tiles to the right and then downwards
+	for(int y = 0; y < m_Height; y++)
+		for(int x = 0; x < m_Width; x++)
+		{
+			int Tile = m_pTiles[y*m_Width+x].m_Index;
+			if(Tile > MAX_TRIGGER_TILE || !m_aTriggerTiles[Tile] || m_pTriggerIndex[y*m_Width+x] != -1)
+				continue;
+
+			int x1 = x;
+			while(x1+1 < m_Width && m_pTiles[y*m_Width+x1+1].m_Index == Tile && m_pTriggerIndex[y*m_Width+x1+1] == -1)
+				x1++;
+
+			int y1 = y;
+			while(y1+1 < m_Height)
+			{
+				bool Equal = true;
+				for(int i = x; Equal && i <= x1; i++)
+					Equal = m_pTiles[(y1+1)*m_Width+i].m_Index == Tile && m_pTriggerIndex[(y1+1)*m_Width+i] == -1;
+				if(!Equal)
+					break;
+				y1++;
+			}
+
+			CTriggerRegion Region;
+			Region.m_Tile = Tile;
+			Region.m_X0 = x;
+			Region.m_Y0 = y;
+			Region.m_X1 = x1;
+			Region.m_Y1 = y1;
+			int Index = m_aTriggerRegions.add(Region);
+			for(int j = y; j <= y1; j++)
+				for(int i = x; i <= x1; i++)
+					m_pTriggerIndex[j*m_Width+i] = Index;
+		}
+}
+
+int CCollision::GetTriggerRegion(int TileX, int TileY)
+{
+	int Nx = clamp(TileX, 0, m_Width-1);
+	int Ny = clamp(TileY, 0, m_Height-1);
+	return m_pTriggerIndex[Ny*m_Width+Nx];
 }
 
 int CCollision::GetTile(int x, int y)
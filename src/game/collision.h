@@ -4,16 +4,42 @@
 #define GAME_COLLISION_H
 
 #include <base/vmath.h>
+#include <base/tl/array.h>
 
 class CCollision
 {
+public:
+	enum
+	{
+		MAX_TRIGGER_TILE=128, // the indices above are entities
+	};
+
+	// a rectangle of equal trigger tiles, in tiles, inclusive
+	struct CTriggerRegion
+	{
+		int m_Tile;
+		int m_X0;
+		int m_Y0;
+		int m_X1;
+		int m_Y1;
+	};
+
+private:
 	class CTile *m_pTiles;
 	int m_Width;
 	int m_Height;
 	class CLayers *m_pLayers;
 
+	// trigger tiles are merged into regions at load time and the region
+	// every tile belongs to is kept, so moving things only need a lookup
+	// when they cross a tile border instead of sampling the map every tick
+	bool m_aTriggerTiles[MAX_TRIGGER_TILE+1];
+	array<CTriggerRegion> m_aTriggerRegions;
+	int *m_pTriggerIndex;
+
 	bool IsTileSolid(int x, int y);
 	int GetTile(int x, int y);
+	void BuildTriggerRegions();
 
 public:
 	enum
@@ -24,7 +50,19 @@ public:
 	};
 
 	CCollision();
+	~CCollision();
 	void Init(class CLayers *pLayers);
+
+	// makes a tile index a trigger, Init keeps it in the game layer and
+	// merges it into regions. has to be called before Init, the game
+	// types do it in their AddTriggerTiles. death tiles are always triggers.
+	// indices up to 7 with the death bit set kill, so pick another one
+	void AddTriggerTile(int Tile);
+	int GetTriggerRegion(int TileX, int TileY); // -1 if none
+	int GetTriggerRegionAt(float x, float y) { return GetTriggerRegion(round_to_int(x)/32, round_to_int(y)/32); }
+	const CTriggerRegion *TriggerRegion(int Index) { return &m_aTriggerRegions[Index]; }
+	int NumTriggerRegions() { return m_aTriggerRegions.size(); }
+
 	bool CheckPoint(float x, float y) { return IsTileSolid(round_to_int(x), round_to_int(y)); }
 	bool CheckPoint(vec2 Pos) { return CheckPoint(Pos.x, Pos.y); }
 	int GetCollisionAt(float x, float y) { return GetTile(round_to_int(x), round_to_int(y)); }
@@ -86,6 +86,10 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 	m_MoltenByHammer = false;
 
 	m_HammeredBy = -1;
+	m_TileX = m_TileY = -1;
+	m_TriggerRegion = -1;
+	m_Tile = 0;
+	UpdateTriggerRegion();
 
 	return true;
 }
@@ -341,6 +345,7 @@ void CCharacter::FireWeapon()
 				Hits++;
 
 				pTarget->m_HammeredBy = GetPlayer()->GetCID();
+				GameServer()->m_pController->OnCharacterEvent(pTarget, IGameController::CHAREVENT_HAMMERED);
 
 				if (MeltHit)
 				{
@@ -595,6 +600,25 @@ void CCharacter::Freeze(int Ticks, int By)
 	if (By != -1 && Ticks > 0)
 		m_FrozenBy = By;
 	m_Core.m_Frozen = Ticks;
+	GameServer()->m_pController->OnCharacterEvent(this, IGameController::CHAREVENT_FREEZE);
+}
+
+void CCharacter::UpdateTriggerRegion()
+{
+	// only look the region up when we moved to another tile
+	int TileX = round_to_int(m_Pos.x)/32;
+	int TileY = round_to_int(m_Pos.y)/32;
+	if(TileX == m_TileX && TileY == m_TileY)
+		return;
+	m_TileX = TileX;
+	m_TileY = TileY;
+
+	int Region = GameServer()->Collision()->GetTriggerRegion(TileX, TileY);
+	if(Region == m_TriggerRegion)
+		return;
+	m_TriggerRegion = Region;
+	m_Tile = Region == -1 ? 0 : GameServer()->Collision()->TriggerRegion(Region)->m_Tile;
+	GameServer()->m_pController->OnCharacterEvent(this, IGameController::CHAREVENT_TILE);
 }
 
 void CCharacter::OnPredictedInput(CNetObj_PlayerInput *pNewInput)
@@ -656,6 +680,9 @@ void CCharacter::Tick()
 	m_Core.m_Input = m_Input;
 	m_Core.Tick(true);
 
+	if(m_Core.m_TriggeredEvents&COREEVENT_HOOK_ATTACH_PLAYER)
+		GameServer()->m_pController->OnCharacterEvent(this, IGameController::CHAREVENT_HOOK);
+
 	if (m_BloodTicks > 0)
 	{
 		if (m_BloodTicks % g_Config.m_SvBloodInterval == 0)
@@ -663,8 +690,7 @@ void CCharacter::Tick()
 		--m_BloodTicks;
 	}
 
-	int Col = GameServer()->Collision()->GetCollisionAt(m_Pos.x, m_Pos.y);
-	if((Col <= 7 && Col&CCollision::COLFLAG_DEATH) || GameLayerClipped(m_Pos)) //seriously.
+	if((m_Tile <= 7 && m_Tile&CCollision::COLFLAG_DEATH) || GameLayerClipped(m_Pos)) //seriously.
 	{
 		// handle death-tiles and leaving gamelayer
 		m_Core.m_Frozen = 0; //we just unfreeze so it never counts as a sacrifice
@@ -726,6 +752,8 @@ void CCharacter::TickDefered()
 	bool StuckAfterQuant = GameServer()->Collision()->TestBox(m_Core.m_Pos, vec2(28.0f, 28.0f));
 	m_Pos = m_Core.m_Pos;
 
+	UpdateTriggerRegion();
+
 	if(!StuckBefore && (StuckAfterMove || StuckAfterQuant))
 	{
 		// Hackish solution to get rid of strict-aliasing warning
@@ -962,8 +990,11 @@ void CCharacter::Snap(int SnappingClient)
 	if(NetworkClipped(SnappingClient))
 		return;
 
+	// demos (-1) and clients that aren't in game get the vanilla item
 	IServer::CClientInfo CltInfo;
-	Server()->GetClientInfo(SnappingClient, &CltInfo);
+	CltInfo.m_CustClt = false;
+	if(SnappingClient != -1)
+		Server()->GetClientInfo(SnappingClient, &CltInfo);
 
 	// measure distance between start and and first vanilla field
 	size_t Offset = (char*)(&Measure.m_Tick) - (char*)(&Measure);
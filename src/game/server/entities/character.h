@@ -77,6 +77,8 @@ public:
 	int GetHookedPlayer() { return m_Core.m_HookedPlayer; }
 	int GetHookTick() { return m_Core.m_HookTick; }//starts from 0 on every new hooking
 	int LastHammeredBy() { return m_HammeredBy; }
+	int GetTile() { return m_Tile; } // trigger tile at m_Pos as of the last move, 0 if none
+	int GetTriggerRegion() { return m_TriggerRegion; }
 	void ClearLastHammeredBy() { m_HammeredBy = -1; } 
 private:
 	// player controlling this character
@@ -152,6 +154,13 @@ private:
 	bool m_MoltenByHammer;
 
 	int m_HammeredBy;
+
+	int m_TileX;
+	int m_TileY;
+	int m_TriggerRegion;
+	int m_Tile;
+
+	void UpdateTriggerRegion();
 };
 
 #endif
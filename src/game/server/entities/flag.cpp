@@ -3,6 +3,8 @@
 #include <game/server/gamecontext.h>
 #include "flag.h"
 
+MACRO_ALLOC_POOL_IMPL(CFlag, 2)
+
 CFlag::CFlag(CGameWorld *pGameWorld, int Team)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_FLAG)
 {
@@ -7,6 +7,7 @@
 
 class CFlag : public CEntity
 {
+	MACRO_ALLOC_POOL()
 public:
 	static const int ms_PhysSize = 14;
 	CCharacter *m_pCarryingCharacter;
@@ -1,33 +1,113 @@
+#include <base/math.h>
 #include <engine/shared/config.h>
 #include <game/generated/protocol.h>
 #include <game/server/gamecontext.h>
 #include "loltext.h"
 
-CLolPlasma *CLoltext::s_aapPlasma[MAX_LOLTEXTS][MAX_PLASMA_PER_LOLTEXT];
-int CLoltext::s_aExpire[MAX_LOLTEXTS];
+MACRO_ALLOC_POOL_IMPL(CLoltext, MAX_LOLTEXTS)
 
-CLolPlasma::CLolPlasma(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, int ltid, int plid)
-: CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER), m_ltid(ltid), m_plid(plid)
+CLoltext *CLoltext::s_apTexts[MAX_LOLTEXTS];
+int CLoltext::s_aSerials[MAX_LOLTEXTS];
+
+CLoltext::CLoltext(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, const char *pText, bool Center, int TextID)
+: CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER)
 {
+	m_Offset = Pos;
 	m_LocalPos = vec2(0.0f, 0.0f);
-	m_StartOff = Pos;
-	CEntity::m_Pos = (pParent?pParent->m_Pos:vec2(0.0f,0.0f)) + m_StartOff;
 	m_Vel = Vel;
+	m_Lifespan = Lifespan;
 	m_Life = Lifespan;
 	m_StartTick = Server()->Tick();
 	m_pParent = pParent;
+	m_TextID = TextID;
+	m_Center = Center;
+	m_LowPriority = true;
+	CEntity::m_Pos = (m_pParent?m_pParent->m_Pos:vec2(0.0f,0.0f)) + m_Offset;
+
+	m_NumChars = 0;
+	m_NumLit = 0;
+	for(int i = 0; i < MAX_CELLS; i++)
+		m_aCellIDs[i] = -1;
+	SetText(pText);
+
 	GameWorld()->InsertEntity(this);
 }
 
-void CLolPlasma::Reset()
+CLoltext::~CLoltext()
+{
+	for(int i = 0; i < MAX_CELLS; i++)
+		if(m_aCellIDs[i] != -1)
+			Server()->SnapFreeID(m_aCellIDs[i]);
+	if(Find(m_TextID) == this)
+		s_apTexts[m_TextID%MAX_LOLTEXTS] = 0;
+}
+
+void CLoltext::SetText(const char *pText)
+{
+	// keep the characters that can be drawn
+	char aChars[MAX_LOLTEXT_CHARS];
+	int NumChars = 0;
+	char c;
+	while((c = *pText++) && NumChars < MAX_LOLTEXT_CHARS)
+	{
+		if (c >= 'a' && c <= 'z')
+			c -= ('a' - 'A');
+		if (c != ' ' && !HasRepr(c))
+			continue;
+		aChars[NumChars++] = c;
+	}
+
+	m_NumChars = NumChars;
+	mem_copy(m_aChars, aChars, NumChars);
+
+	float Hspace = g_Config.m_SvLoltextHspace;
+	float Vspace = g_Config.m_SvLoltextVspace;
+	m_Origin = vec2(0.0f, 0.0f);
+	if(m_Center)
+		m_Origin -= vec2(NumChars*Hspace*4.0f, Vspace*5.0f)*0.5f;
+
+	// collect the lit pixels
+	m_NumLit = 0;
+	m_BoxMin = m_Origin;
+	m_BoxMax = m_Origin;
+	for(int i = 0; i < NumChars && m_NumLit < MAX_PLASMA_PER_LOLTEXT; i++)
+		for(int Cell = 0; Cell < CELLS_PER_CHAR && m_NumLit < MAX_PLASMA_PER_LOLTEXT; Cell++)
+		{
+			if(!s_aaaChars[(unsigned char)m_aChars[i]][Cell/3][Cell%3])
+				continue;
+			m_aLitCells[m_NumLit++] = i*CELLS_PER_CHAR + Cell;
+			vec2 CellPos = m_Origin + vec2((i*4 + Cell%3)*Hspace, (Cell/3)*Vspace);
+			m_BoxMin = vec2(min(m_BoxMin.x, CellPos.x), min(m_BoxMin.y, CellPos.y));
+			m_BoxMax = vec2(max(m_BoxMax.x, CellPos.x), max(m_BoxMax.y, CellPos.y));
+		}
+
+	// pixels that stay lit keep their snap id, the ones that went dark give it back
+	bool aLit[MAX_CELLS] = {0};
+	for(int i = 0; i < m_NumLit; i++)
+		aLit[m_aLitCells[i]] = true;
+	for(int Index = 0; Index < MAX_CELLS; Index++)
+	{
+		if(aLit[Index] && m_aCellIDs[Index] == -1)
+			m_aCellIDs[Index] = Server()->SnapNewID();
+		else if(!aLit[Index] && m_aCellIDs[Index] != -1)
+		{
+			Server()->SnapFreeID(m_aCellIDs[Index]);
+			m_aCellIDs[Index] = -1;
+		}
+	}
+}
+
+void CLoltext::Reset()
 {
 	GameWorld()->DestroyEntity(this);
-	if (m_ltid >= 0)
-		CLoltext::PlasmaGone(m_ltid, m_plid);
-	m_ltid = -1;
+
+	// the slot is free right away, the entity goes at the end of the tick
+	if(Find(m_TextID) == this)
+		s_apTexts[m_TextID%MAX_LOLTEXTS] = 0;
+	m_TextID = -1;
 }
 
-void CLolPlasma::Tick()
+void CLoltext::Tick()
 {
 	if (m_Life < 0)
 	{
@@ -36,24 +116,43 @@ void CLolPlasma::Tick()
 	}
 	m_Life--;
 
-	CEntity::m_Pos = (m_pParent?m_pParent->m_Pos:vec2(0.0f,0.0f)) + m_StartOff + (m_LocalPos += m_Vel);
+	CEntity::m_Pos = (m_pParent?m_pParent->m_Pos:vec2(0.0f,0.0f)) + m_Offset + (m_LocalPos += m_Vel);
 }
 
-void CLolPlasma::Snap(int SnappingClient)
+void CLoltext::Snap(int SnappingClient)
 {
-	if (NetworkClipped(SnappingClient))
+	if(!m_NumLit)
 		return;
 
+	// clip by the point of the box that is closest to the viewer
+	if(SnappingClient != -1)
+	{
+		vec2 ViewPos = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos;
+		vec2 Closest = vec2(clamp(ViewPos.x, m_Pos.x+m_BoxMin.x, m_Pos.x+m_BoxMax.x), clamp(ViewPos.y, m_Pos.y+m_BoxMin.y, m_Pos.y+m_BoxMax.y));
+		if(NetworkClipped(SnappingClient, Closest))
+			return;
+	}
 
-	CNetObj_Laser *pObj = static_cast<CNetObj_Laser*>
-	            (Server()->SnapNewItem(NETOBJTYPE_LASER, m_ID, sizeof(CNetObj_Laser)));
+	float Hspace = g_Config.m_SvLoltextHspace;
+	float Vspace = g_Config.m_SvLoltextVspace;
+	for(int i = 0; i < m_NumLit; i++)
+	{
+		int Index = m_aLitCells[i];
+		int Char = Index/CELLS_PER_CHAR;
+		int Cell = Index%CELLS_PER_CHAR;
+		vec2 Pos = m_Pos + m_Origin + vec2((Char*4 + Cell%3)*Hspace, (Cell/3)*Vspace);
 
-	pObj->m_X = (int)m_Pos.x;
-	pObj->m_Y = (int)m_Pos.y;
-	pObj->m_FromX = (int)m_Pos.x;
-	pObj->m_FromY = (int)m_Pos.y;
-	pObj->m_StartTick = m_StartTick;
+		CNetObj_Laser *pObj = static_cast<CNetObj_Laser*>
+		            (Server()->SnapNewItem(NETOBJTYPE_LASER, m_aCellIDs[Index], sizeof(CNetObj_Laser)));
+		if(!pObj)
+			return;
 
+		pObj->m_X = (int)Pos.x;
+		pObj->m_Y = (int)Pos.y;
+		pObj->m_FromX = (int)Pos.x;
+		pObj->m_FromY = (int)Pos.y;
+		pObj->m_StartTick = m_StartTick;
+	}
 }
 
 
@@ -74,67 +173,41 @@ vec2 CLoltext::TextSize(const char *pText)
 
 int CLoltext::Create(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, const char *pText, bool Center, bool Follow)
 {
-	char c;
-	vec2 CurPos = Pos;
-	if (Center)
-		CurPos -= TextSize(pText)*0.5f;
-
 	if (pParent && !Follow)
 	{
-		CurPos += pParent->m_Pos;
+		Pos += pParent->m_Pos;
 		pParent = 0;
 	}
 
-	int TextID = 0;
-	for(; TextID < MAX_LOLTEXTS; ++TextID)
-		if (s_aExpire[TextID] < pGameWorld->Server()->Tick())
-		{
-			s_aExpire[TextID] = pGameWorld->Server()->Tick() + Lifespan;
+	int NumTexts = min(g_Config.m_SvLoltextMax, (int)MAX_LOLTEXTS);
+	int Slot = 0;
+	for(; Slot < NumTexts; ++Slot)
+		if (!s_apTexts[Slot])
 			break;
-		}
 
-	if (TextID == MAX_LOLTEXTS)
+	if (Slot == NumTexts)
 		return -1;
 
-	int NumPlasmas = 0;
-
-	for(int i = 0; i < MAX_PLASMA_PER_LOLTEXT; i++)
-		s_aapPlasma[TextID][i] = 0;
-
-	while((c = *pText++))
-	{
-		if (c >= 'a' && c <= 'z')
-			c -= ('a' - 'A');
-		if (c != ' ' && !HasRepr(c))
-			continue;
-
-		for(int y = 0; y < 5/*XXX*/; ++y)
-			for(int x = 0; x < 3/*XXX*/; ++x)
-				if (s_aaaChars[(unsigned)c][y][x] && NumPlasmas < MAX_PLASMA_PER_LOLTEXT) {
-					s_aapPlasma[TextID][NumPlasmas] =
-					    new CLolPlasma(pGameWorld, pParent, CurPos + vec2(x*g_Config.m_SvLoltextHspace, y*g_Config.m_SvLoltextVspace),
-					    Vel, Lifespan, TextID, NumPlasmas);
-					NumPlasmas++;
-				}
-		CurPos.x += 4*g_Config.m_SvLoltextHspace;
-	}
+	// a new serial per text, so handles to an expired text don't reach the next one in the slot
+	s_aSerials[Slot] = (s_aSerials[Slot]+1) % (0x7fffffff/MAX_LOLTEXTS);
+	int TextID = s_aSerials[Slot]*MAX_LOLTEXTS + Slot;
+	s_apTexts[Slot] = new CLoltext(pGameWorld, pParent, Pos, Vel, Lifespan, pText, Center, TextID);
 	return TextID;
 }
 
-void CLoltext::Dump()
+CLoltext *CLoltext::Find(int TextID)
 {
-	for(int i = 0; i < MAX_LOLTEXTS; i++)
-		dbg_msg("lt", "s_aExpire[%d] = %d", i, s_aExpire[i]);
+	if (TextID < 0)
+		return 0;
+	CLoltext *pLoltext = s_apTexts[TextID%MAX_LOLTEXTS];
+	return pLoltext && pLoltext->m_TextID == TextID ? pLoltext : 0;
+}
 
+void CLoltext::Dump()
+{
 	for(int i = 0; i < MAX_LOLTEXTS; i++)
-	{
-		int Count = 0;
-		for(int j = 0; j < MAX_PLASMA_PER_LOLTEXT; j++)
-			if (s_aapPlasma[i][j])
-				Count++;
-		dbg_msg("tl", "|s_aapPlasma[%d]| = %d", i, Count);
-	}
-
+		if (s_apTexts[i])
+			dbg_msg("lt", "s_apTexts[%d]: life=%d chars=%d lit=%d", i, s_apTexts[i]->m_Life, s_apTexts[i]->m_NumChars, s_apTexts[i]->m_NumLit);
 }
 
 void CLoltext::Destroy(CGameWorld *pGameWorld, int TextID)
@@ -142,29 +215,24 @@ void CLoltext::Destroy(CGameWorld *pGameWorld, int TextID)
 	if (TextID == -1) //all
 	{
 		for(int i = 0; i < MAX_LOLTEXTS; ++i)
-			Destroy(pGameWorld, i);
+			if (s_apTexts[i])
+				s_apTexts[i]->Reset();
 		return;
 	}
-	
-	if (TextID < 0 || TextID >= MAX_LOLTEXTS)
-		return;
 
-	if (s_aExpire[TextID] < pGameWorld->Server()->Tick())
-	{
-		s_aExpire[TextID] = 0; //explicitly unset incase map cycles because Tick counting starts over with 0 then.
-		return;
-	}
-	
-	for(int i = 0; i < MAX_PLASMA_PER_LOLTEXT; i++)
-		if (s_aapPlasma[TextID][i])
-			s_aapPlasma[TextID][i]->Reset();
-
-	s_aExpire[TextID] = 0;
+	if (CLoltext *pLoltext = Find(TextID))
+		pLoltext->Reset();
 }
 
-void CLoltext::PlasmaGone(int TextID, int plid)
+bool CLoltext::Update(int TextID, const char *pText)
 {
-	s_aapPlasma[TextID][plid] = 0;
+	CLoltext *pLoltext = Find(TextID);
+	if (!pLoltext)
+		return false;
+
+	pLoltext->SetText(pText);
+	pLoltext->m_Life = pLoltext->m_Lifespan;
+	return true;
 }
 
 bool CLoltext::HasRepr(char c) // can be removed when we have a full character set
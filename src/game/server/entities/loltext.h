@@ -3,48 +3,69 @@
 
 #include <game/server/entity.h>
 
-#define MAX_LOLTEXTS 16
+#define MAX_LOLTEXTS 64 // upper bound of sv_loltext_max, all of them lit take half of the server's snap ids
 #define MAX_PLASMA_PER_LOLTEXT 128
+#define MAX_LOLTEXT_CHARS 32
 
 //usage: GameServer()->CreateLoltext(...)
 //it will dispose itself after lifespan ended
 
-class CLolPlasma : public CEntity
+// one entity per text. the lit 'pixels' are laid out once, the text is culled
+// as a whole and snaps a laser item per pixel. every pixel keeps its snap id
+// while it's lit, so patching a few characters leaves the others untouched
+class CLoltext : public CEntity
 {
+	MACRO_ALLOC_POOL()
 public:
 	//position relative to pParent->m_Pos. if pParent is NULL, Pos is absolute. lifespan in ticks
-	CLolPlasma(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, int ltid, int plid);
+	CLoltext(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, const char *pText, bool Center, int TextID);
+	virtual ~CLoltext();
 
 	virtual void Reset();
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
 
+	static vec2 TextSize(const char *pText);
+	// returns a handle that stops working once the text is gone, -1 if there's no room
+	static int Create(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, const char *pText, bool Center, bool Follow);
+	static void Destroy(CGameWorld *pGameWorld, int TextID);
+	// changes the text, returns false if the text is gone
+	static bool Update(int TextID, const char *pText);
+	static void Dump(); //debugging
 
 private:
-	vec2 m_LocalPos; // local coordinate system is origin'd wherever we actually start (i.e. this is (0,0) after creation)
+	enum
+	{
+		CELLS_PER_CHAR=5*3,
+		MAX_CELLS=MAX_LOLTEXT_CHARS*CELLS_PER_CHAR,
+	};
+
+	static bool s_aaaChars[256][5][3];
+	static CLoltext *s_apTexts[MAX_LOLTEXTS];
+	static int s_aSerials[MAX_LOLTEXTS];
+	static CLoltext *Find(int TextID);
+	static bool HasRepr(char c);
+
+	void SetText(const char *pText);
+
+	vec2 m_Offset; // from the parent, where the text was placed
+	vec2 m_LocalPos; // moved by m_Vel since creation
 	vec2 m_Vel;
+	int m_Lifespan;
 	int m_Life; // remaining ticks
 	int m_StartTick; // tick created
-	vec2 m_StartOff; // initial offset from parent, for proper following
 	CEntity *m_pParent;
-	int m_ltid;
-	int m_plid;
-};
+	int m_TextID; // the handle, the slot in s_apTexts is m_TextID%MAX_LOLTEXTS
+	bool m_Center;
 
-class CLoltext
-{
-private:
-	static bool s_aaaChars[256][5][3];
-	static CLolPlasma *s_aapPlasma[MAX_LOLTEXTS][MAX_PLASMA_PER_LOLTEXT];
-	static int s_aExpire[MAX_LOLTEXTS];
-	static bool HasRepr(char c);
-public:
-	static vec2 TextSize(const char *pText);
-	static int Create(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan, const char *pText, bool Center, bool Follow);
-	static void Destroy(CGameWorld *pGameWorld, int TextID);
-	static void PlasmaGone(int TextID, int plid);
-	static void Dump(); //debugging
+	char m_aChars[MAX_LOLTEXT_CHARS]; // what is shown, unknown characters are dropped
+	int m_NumChars;
+	vec2 m_Origin; // top left corner, relative to m_Pos
+	vec2 m_BoxMin; // bounding box of the lit pixels, relative to m_Pos
+	vec2 m_BoxMax;
+	int m_aCellIDs[MAX_CELLS]; // snap id while the pixel is lit, -1 otherwise
+	short m_aLitCells[MAX_PLASMA_PER_LOLTEXT];
+	int m_NumLit;
 };
 
 #endif
-
@@ -4,12 +4,15 @@
 #include <game/server/gamecontext.h>
 #include "pickup.h"
 
+MACRO_ALLOC_POOL_IMPL(CPickup, 256)
+
 CPickup::CPickup(CGameWorld *pGameWorld, int Type, int SubType)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_PICKUP)
 {
 	m_Type = Type;
 	m_Subtype = SubType;
 	m_ProximityRadius = PickupPhysSize;
+	m_LowPriority = true;
 
 	Reset();
 
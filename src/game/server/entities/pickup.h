@@ -9,6 +9,7 @@ const int PickupPhysSize = 14;
 
 class CPickup : public CEntity
 {
+	MACRO_ALLOC_POOL()
 public:
 	CPickup(CGameWorld *pGameWorld, int Type, int SubType = 0);
 
@@ -4,6 +4,8 @@
 #include <game/server/gamecontext.h>
 #include "projectile.h"
 
+MACRO_ALLOC_POOL_IMPL(CProjectile, 512)
+
 CProjectile::CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_PROJECTILE)
@@ -5,6 +5,7 @@
 
 class CProjectile : public CEntity
 {
+	MACRO_ALLOC_POOL()
 public:
 	CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon);
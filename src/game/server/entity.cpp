@@ -16,7 +16,27 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType)
 	m_ProximityRadius = 0;
 
 	m_MarkedForDestroy = false;
-	m_ID = Server()->SnapNewID();
+	m_LowPriority = false;
+	CEntityPool::CSlot *pSlot = CEntityPool::ms_pNewSlot;
+	CEntityPool::ms_pNewSlot = 0;
+	if(pSlot)
+	{
+		// clients may still know the old entity, respect the snap id timeout
+		if(pSlot->m_SnapID != -1 && pSlot->m_FreeTick+Server()->TickSpeed()*5 > Server()->Tick())
+		{
+			Server()->SnapFreeID(pSlot->m_SnapID);
+			pSlot->m_SnapID = -1;
+		}
+		if(pSlot->m_SnapID == -1)
+			pSlot->m_SnapID = Server()->SnapNewID();
+		m_ID = pSlot->m_SnapID;
+		m_pPoolSlot = pSlot;
+	}
+	else
+	{
+		m_ID = Server()->SnapNewID();
+		m_pPoolSlot = 0;
+	}
 
 	m_pPrevTypeEntity = 0;
 	m_pNextTypeEntity = 0;
@@ -25,7 +45,11 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType)
 CEntity::~CEntity()
 {
 	GameWorld()->RemoveEntity(this);
-	Server()->SnapFreeID(m_ID);
+	// game time, so replays of recorded input hand out the same ids
+	if(m_pPoolSlot)
+		m_pPoolSlot->m_FreeTick = Server()->Tick();
+	else
+		Server()->SnapFreeID(m_ID);
 }
 
 int CEntity::NetworkClipped(int SnappingClient)
@@ -38,13 +62,18 @@ int CEntity::NetworkClipped(int SnappingClient, vec2 CheckPos)
 	if(SnappingClient == -1)
 		return 0;
 
+	// clients short on bandwidth see less of the low priority stuff at the edges
+	float Range = 1.0f;
+	if(m_LowPriority)
+		Range -= Server()->SnapDetail(SnappingClient)*0.25f;
+
 	float dx = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos.x-CheckPos.x;
 	float dy = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos.y-CheckPos.y;
 
-	if(absolute(dx) > 1000.0f || absolute(dy) > 800.0f)
+	if(absolute(dx) > 1000.0f*Range || absolute(dy) > 800.0f*Range)
 		return 1;
 
-	if(distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, CheckPos) > 1100.0f)
+	if(distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, CheckPos) > 1100.0f*Range)
 		return 1;
 	return 0;
 }
@@ -54,3 +83,108 @@ bool CEntity::GameLayerClipped(vec2 CheckPos)
 	return round_to_int(CheckPos.x)/32 < -200 || round_to_int(CheckPos.x)/32 > GameServer()->Collision()->GetWidth()+200 ||
 			round_to_int(CheckPos.y)/32 < -200 || round_to_int(CheckPos.y)/32 > GameServer()->Collision()->GetHeight()+200 ? true : false;
 }
+
+//////////////////////////////////////////////////
+// Entity pool
+//////////////////////////////////////////////////
+CEntityPool *CEntityPool::ms_pFirst = 0;
+CEntityPool::CSlot *CEntityPool::ms_pNewSlot = 0;
+
+CEntityPool::CEntityPool(const char *pName, int ObjSize, int NumSlots, char *pData, CSlot *pSlots)
+{
+	m_pName = pName;
+	m_pData = pData;
+	m_pSlots = pSlots;
+	m_ObjSize = ObjSize;
+	m_NumSlots = NumSlots;
+	for(int i = 0; i < m_NumSlots; i++)
+	{
+		m_pSlots[i].m_NextFree = i+1;
+		m_pSlots[i].m_SnapID = -1;
+		m_pSlots[i].m_FreeTick = 0;
+	}
+	m_pSlots[m_NumSlots-1].m_NextFree = -1;
+	m_FirstFree = 0;
+	m_LastFree = m_NumSlots-1;
+
+	m_Used = 0;
+	m_Peak = 0;
+	m_NumAllocs = 0;
+	m_NumOverflows = 0;
+
+	m_pNext = ms_pFirst;
+	ms_pFirst = this;
+}
+
+void *CEntityPool::Alloc()
+{
+	m_NumAllocs++;
+	if(m_FirstFree == -1)
+	{
+		// full, the entity gets a snap id of its own
+		m_NumOverflows++;
+		ms_pNewSlot = 0;
+		void *p = mem_alloc(m_ObjSize, 1);
+		mem_zero(p, m_ObjSize);
+		return p;
+	}
+
+	int Index = m_FirstFree;
+	m_FirstFree = m_pSlots[Index].m_NextFree;
+	if(m_FirstFree == -1)
+		m_LastFree = -1;
+	m_pSlots[Index].m_NextFree = -2;
+	m_Used++;
+	if(m_Used > m_Peak)
+		m_Peak = m_Used;
+
+	ms_pNewSlot = &m_pSlots[Index];
+	void *p = m_pData + Index*m_ObjSize;
+	mem_zero(p, m_ObjSize);
+	return p;
+}
+
+void CEntityPool::Free(void *p)
+{
+	if((char *)p < m_pData || (char *)p >= m_pData + m_NumSlots*m_ObjSize)
+	{
+		mem_free(p);
+		return;
+	}
+
+	int Index = ((char *)p - m_pData)/m_ObjSize;
+	dbg_assert(m_pSlots[Index].m_NextFree == -2, "not used");
+
+	// oldest free slots are reused first, so kept snap ids have timed out
+	m_pSlots[Index].m_NextFree = -1;
+	if(m_LastFree != -1)
+		m_pSlots[m_LastFree].m_NextFree = Index;
+	else
+		m_FirstFree = Index;
+	m_LastFree = Index;
+	m_Used--;
+}
+
+void CEntityPool::ReleaseSnapIDs(IServer *pServer)
+{
+	for(CEntityPool *pPool = ms_pFirst; pPool; pPool = pPool->m_pNext)
+		for(int i = 0; i < pPool->m_NumSlots; i++)
+		{
+			if(pPool->m_pSlots[i].m_SnapID != -1 && pPool->m_pSlots[i].m_NextFree != -2)
+			{
+				pServer->SnapFreeID(pPool->m_pSlots[i].m_SnapID);
+				pPool->m_pSlots[i].m_SnapID = -1;
+			}
+		}
+}
+
+void CEntityPool::PrintStats(IConsole *pConsole)
+{
+	for(CEntityPool *pPool = ms_pFirst; pPool; pPool = pPool->m_pNext)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "%s: used=%d peak=%d size=%d allocs=%d overflows=%d",
+			pPool->m_pName, pPool->m_Used, pPool->m_Peak, pPool->m_NumSlots, pPool->m_NumAllocs, pPool->m_NumOverflows);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "entities", aBuf);
+	}
+}
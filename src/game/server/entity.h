@@ -50,6 +50,76 @@
 		mem_zero(ms_PoolData##POOLTYPE[id], sizeof(POOLTYPE)); \
 	}
 
+/*
+	Class: CEntityPool
+		A slab of entities of one type. Slots are handed out from a first
+		in first out free list and keep the snap id of the first entity
+		that lived in them, so short lived entities don't churn through the
+		snap id pool. A slot freed less than the snap id timeout ago gets
+		a fresh snap id instead. When the slab is full, entities come from
+		the heap.
+*/
+class CEntityPool
+{
+public:
+	struct CSlot
+	{
+		int m_NextFree;
+		int m_SnapID;
+		int m_FreeTick;
+	};
+
+private:
+	static CEntityPool *ms_pFirst;
+
+	CEntityPool *m_pNext;
+	const char *m_pName;
+	char *m_pData;
+	CSlot *m_pSlots;
+	int m_ObjSize;
+	int m_NumSlots;
+	int m_FirstFree;
+	int m_LastFree;
+
+	int m_Used;
+	int m_Peak;
+	int m_NumAllocs;
+	int m_NumOverflows;
+
+public:
+	// slot of the entity that is being constructed, taken by CEntity
+	static CSlot *ms_pNewSlot;
+
+	CEntityPool(const char *pName, int ObjSize, int NumSlots, char *pData, CSlot *pSlots);
+
+	void *Alloc();
+	void Free(void *p);
+
+	// gives the kept snap ids back, when all entities are gone
+	static void ReleaseSnapIDs(class IServer *pServer);
+	static void PrintStats(class IConsole *pConsole);
+};
+
+#define MACRO_ALLOC_POOL() \
+	public: \
+	void *operator new(size_t Size); \
+	void operator delete(void *p); \
+	private:
+
+#define MACRO_ALLOC_POOL_IMPL(POOLTYPE, PoolSize) \
+	static char ms_PoolData##POOLTYPE[PoolSize][sizeof(POOLTYPE)] = {{0}}; \
+	static CEntityPool::CSlot ms_aPoolSlots##POOLTYPE[PoolSize]; \
+	static CEntityPool ms_Pool##POOLTYPE(#POOLTYPE, sizeof(POOLTYPE), PoolSize, ms_PoolData##POOLTYPE[0], ms_aPoolSlots##POOLTYPE); \
+	void *POOLTYPE::operator new(size_t Size) \
+	{ \
+		dbg_assert(sizeof(POOLTYPE) == Size, "size error"); \
+		return ms_Pool##POOLTYPE.Alloc(); \
+	} \
+	void POOLTYPE::operator delete(void *p) \
+	{ \
+		ms_Pool##POOLTYPE.Free(p); \
+	}
+
 /*
 	Class: Entity
 		Basic entity class.
@@ -63,10 +133,12 @@ class CEntity
 	CEntity *m_pNextTypeEntity;
 
 	class CGameWorld *m_pGameWorld;
+	CEntityPool::CSlot *m_pPoolSlot; // the snap id belongs to this pool slot
 protected:
 	bool m_MarkedForDestroy;
 	int m_ID;
 	int m_ObjType;
+	bool m_LowPriority; // clients short on bandwidth don't get it at the edges of their view
 public:
 	CEntity(CGameWorld *pGameWorld, int Objtype);
 	virtual ~CEntity();
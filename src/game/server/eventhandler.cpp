@@ -9,7 +9,17 @@
 CEventHandler::CEventHandler()
 {
 	m_pGameServer = 0;
-	Clear();
+	m_NumDropped = 0;
+	m_PeakEvents = 0;
+	m_CurrentBlock = 0;
+	m_CurrentOffset = 0;
+	m_NumBucketed = 0;
+}
+
+CEventHandler::~CEventHandler()
+{
+	for(int i = 0; i < m_apBlocks.size(); i++)
+		mem_free(m_apBlocks[i]);
 }
 
 void CEventHandler::SetGameServer(CGameContext *pGameServer)
@@ -19,40 +29,94 @@ void CEventHandler::SetGameServer(CGameContext *pGameServer)
 
 void *CEventHandler::Create(int Type, int Size, int Mask)
 {
-	if(m_NumEvents == MAX_EVENTS)
-		return 0;
-	if(m_CurrentOffset+Size >= MAX_DATASIZE)
+	if(m_aEvents.size() == MAX_EVENTS || Size > BLOCK_SIZE)
+	{
+		m_NumDropped++;
 		return 0;
+	}
 
-	void *p = &m_aData[m_CurrentOffset];
-	m_aOffsets[m_NumEvents] = m_CurrentOffset;
-	m_aTypes[m_NumEvents] = Type;
-	m_aSizes[m_NumEvents] = Size;
-	m_aClientMasks[m_NumEvents] = Mask;
-	m_CurrentOffset += Size;
-	m_NumEvents++;
-	return p;
+	// grab the next block when the current one is full
+	if(m_apBlocks.size() == 0 || m_CurrentOffset+Size > BLOCK_SIZE)
+	{
+		if(m_apBlocks.size() != 0)
+			m_CurrentBlock++;
+		if(m_CurrentBlock == m_apBlocks.size())
+			m_apBlocks.add((char *)mem_alloc(BLOCK_SIZE, sizeof(int)));
+		m_CurrentOffset = 0;
+	}
+
+	CEvent Event;
+	Event.m_Type = Type;
+	Event.m_Size = Size;
+	Event.m_ClientMask = Mask;
+	Event.m_pData = m_apBlocks[m_CurrentBlock] + m_CurrentOffset;
+	m_CurrentOffset += (Size+sizeof(int)-1)&~(sizeof(int)-1);
+	m_aEvents.add(Event);
+	return Event.m_pData;
 }
 
 void CEventHandler::Clear()
 {
-	m_NumEvents = 0;
+	if(m_aEvents.size() > m_PeakEvents)
+		m_PeakEvents = m_aEvents.size();
+
+	m_aEvents.clear_keep();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		m_aClientEvents[i].clear_keep();
+	m_NumBucketed = 0;
+	m_CurrentBlock = 0;
 	m_CurrentOffset = 0;
 }
 
+void CEventHandler::BucketEvents()
+{
+	// the event positions are only filled in after Create returns, so the
+	// distance test has to wait until the first snap of the tick
+	for(; m_NumBucketed < m_aEvents.size(); m_NumBucketed++)
+	{
+		const CEvent &Event = m_aEvents[m_NumBucketed];
+		const CNetEvent_Common *pCommon = (const CNetEvent_Common *)Event.m_pData;
+		vec2 Pos(pCommon->m_X, pCommon->m_Y);
+
+		for(int c = 0; c < MAX_CLIENTS; c++)
+		{
+			if(!CmaskIsSet(Event.m_ClientMask, c) || !GameServer()->m_apPlayers[c])
+				continue;
+
+			vec2 Diff = GameServer()->m_apPlayers[c]->m_ViewPos - Pos;
+			if(dot(Diff, Diff) < 1500.0f*1500.0f)
+				m_aClientEvents[c].add(m_NumBucketed);
+		}
+	}
+}
+
 void CEventHandler::Snap(int SnappingClient)
 {
-	for(int i = 0; i < m_NumEvents; i++)
+	if(SnappingClient == -1)
+	{
+		for(int i = 0; i < m_aEvents.size(); i++)
+		{
+			void *d = GameServer()->Server()->SnapNewItem(m_aEvents[i].m_Type, i, m_aEvents[i].m_Size);
+			if(d)
+				mem_copy(d, m_aEvents[i].m_pData, m_aEvents[i].m_Size);
+		}
+		return;
+	}
+
+	if(m_NumBucketed < m_aEvents.size())
+		BucketEvents();
+
+	const array<int> &Bucket = m_aClientEvents[SnappingClient];
+	for(int i = 0; i < Bucket.size(); i++)
 	{
-		if(SnappingClient == -1 || CmaskIsSet(m_aClientMasks[i], SnappingClient))
+		const CEvent &Event = m_aEvents[Bucket[i]];
+		void *d = GameServer()->Server()->SnapNewItem(Event.m_Type, Bucket[i], Event.m_Size);
+		if(!d)
 		{
-			CNetEvent_Common *ev = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
-			if(SnappingClient == -1 || distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, vec2(ev->m_X, ev->m_Y)) < 1500.0f)
-			{
-				void *d = GameServer()->Server()->SnapNewItem(m_aTypes[i], i, m_aSizes[i]);
-				if(d)
-					mem_copy(d, &m_aData[m_aOffsets[i]], m_aSizes[i]);
-			}
+			// snapshot is full, the rest won't fit either
+			m_NumDropped += Bucket.size()-i;
+			break;
 		}
+		mem_copy(d, Event.m_pData, Event.m_Size);
 	}
 }
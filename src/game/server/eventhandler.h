@@ -3,30 +3,55 @@
 #ifndef GAME_SERVER_EVENTHANDLER_H
 #define GAME_SERVER_EVENTHANDLER_H
 
+#include <base/tl/array.h>
+#include <engine/shared/protocol.h>
+
 //
 class CEventHandler
 {
-	static const int MAX_EVENTS = 128;
-	static const int MAX_DATASIZE = 128*64;
+	enum
+	{
+		MAX_EVENTS=4096, // hard limit per tick, anything beyond is counted as dropped
+		BLOCK_SIZE=8*1024,
+	};
+
+	struct CEvent
+	{
+		int m_Type;
+		int m_Size;
+		int m_ClientMask;
+		void *m_pData;
+	};
+
+	// event data lives in fixed blocks that are kept between ticks, so pointers stay valid
+	array<char *> m_apBlocks;
+	int m_CurrentBlock;
+	int m_CurrentOffset;
 
-	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
-	int m_aOffsets[MAX_EVENTS];
-	int m_aSizes[MAX_EVENTS];
-	int m_aClientMasks[MAX_EVENTS];
-	char m_aData[MAX_DATASIZE];
+	array<CEvent> m_aEvents;
+
+	// indices of the events each client gets, filled once per tick on the first snap
+	array<int> m_aClientEvents[MAX_CLIENTS];
+	int m_NumBucketed;
+
+	int m_NumDropped;
+	int m_PeakEvents;
 
 	class CGameContext *m_pGameServer;
 
-	int m_CurrentOffset;
-	int m_NumEvents;
+	void BucketEvents();
 public:
 	CGameContext *GameServer() const { return m_pGameServer; }
 	void SetGameServer(CGameContext *pGameServer);
 
 	CEventHandler();
+	~CEventHandler();
 	void *Create(int Type, int Size, int Mask = -1);
 	void Clear();
 	void Snap(int SnappingClient);
+
+	int NumDropped() const { return m_NumDropped; }
+	int PeakEvents() const { return m_PeakEvents; }
 };
 
 #endif
@@ -36,6 +36,8 @@ void CGameContext::Construct(int Resetting)
 	m_VoteCloseTime = 0;
 	m_pVoteOptionFirst = 0;
 	m_pVoteOptionLast = 0;
+	mem_zero(m_apVoteOptionHash, sizeof(m_apVoteOptionHash));
+	m_VoteOptionWaste = 0;
 	m_NumVoteOptions = 0;
 	m_LockTeams = 0;
 
@@ -70,6 +72,9 @@ void CGameContext::Clear()
 	CHeap *pVoteOptionHeap = m_pVoteOptionHeap;
 	CVoteOptionServer *pVoteOptionFirst = m_pVoteOptionFirst;
 	CVoteOptionServer *pVoteOptionLast = m_pVoteOptionLast;
+	CVoteOptionServer *apVoteOptionHash[VOTE_OPTION_HASH_SIZE];
+	mem_copy(apVoteOptionHash, m_apVoteOptionHash, sizeof(apVoteOptionHash));
+	int VoteOptionWaste = m_VoteOptionWaste;
 	int NumVoteOptions = m_NumVoteOptions;
 	CTuningParams Tuning = m_Tuning;
 
@@ -81,10 +86,165 @@ void CGameContext::Clear()
 	m_pVoteOptionHeap = pVoteOptionHeap;
 	m_pVoteOptionFirst = pVoteOptionFirst;
 	m_pVoteOptionLast = pVoteOptionLast;
+	mem_copy(m_apVoteOptionHash, apVoteOptionHash, sizeof(m_apVoteOptionHash));
+	m_VoteOptionWaste = VoteOptionWaste;
 	m_NumVoteOptions = NumVoteOptions;
 	m_Tuning = Tuning;
 }
 
+static unsigned VoteOptionHash(const char *pDescription)
+{
+	// case insensitive, matching the str_comp_nocase lookups
+	unsigned Hash = 5381;
+	for(; *pDescription; pDescription++)
+		Hash = ((Hash << 5) + Hash) + (unsigned char)str_uppercase(*pDescription);
+	return Hash;
+}
+
+CVoteOptionServer *CGameContext::FindVoteOption(const char *pDescription)
+{
+	unsigned Hash = VoteOptionHash(pDescription);
+	for(CVoteOptionServer *pOption = m_apVoteOptionHash[Hash%VOTE_OPTION_HASH_SIZE]; pOption; pOption = pOption->m_pHashNext)
+	{
+		if(pOption->m_Hash == Hash && str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
+			return pOption;
+	}
+	return 0;
+}
+
+void CGameContext::AddVoteOption(const char *pDescription, const char *pCommand)
+{
+	int Len = str_length(pCommand);
+
+	CVoteOptionServer *pOption = (CVoteOptionServer *)m_pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len);
+	pOption->m_pNext = 0;
+	pOption->m_pPrev = m_pVoteOptionLast;
+	if(pOption->m_pPrev)
+		pOption->m_pPrev->m_pNext = pOption;
+	m_pVoteOptionLast = pOption;
+	if(!m_pVoteOptionFirst)
+		m_pVoteOptionFirst = pOption;
+
+	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
+	mem_copy(pOption->m_aCommand, pCommand, Len+1);
+
+	pOption->m_Hash = VoteOptionHash(pOption->m_aDescription);
+	pOption->m_pHashNext = m_apVoteOptionHash[pOption->m_Hash%VOTE_OPTION_HASH_SIZE];
+	m_apVoteOptionHash[pOption->m_Hash%VOTE_OPTION_HASH_SIZE] = pOption;
+	++m_NumVoteOptions;
+}
+
+void CGameContext::RemoveVoteOption(CVoteOptionServer *pOption)
+{
+	// unlink from the hash chain
+	CVoteOptionServer **ppLink = &m_apVoteOptionHash[pOption->m_Hash%VOTE_OPTION_HASH_SIZE];
+	while(*ppLink != pOption)
+		ppLink = &(*ppLink)->m_pHashNext;
+	*ppLink = pOption->m_pHashNext;
+
+	// unlink from the list
+	if(pOption->m_pPrev)
+		pOption->m_pPrev->m_pNext = pOption->m_pNext;
+	else
+		m_pVoteOptionFirst = pOption->m_pNext;
+	if(pOption->m_pNext)
+		pOption->m_pNext->m_pPrev = pOption->m_pPrev;
+	else
+		m_pVoteOptionLast = pOption->m_pPrev;
+
+	// clients still receiving the list skip the removed option
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(m_apPlayers[i] && m_apPlayers[i]->m_pVoteOptionCursor == pOption)
+			m_apPlayers[i]->m_pVoteOptionCursor = pOption->m_pNext;
+
+	--m_NumVoteOptions;
+	m_VoteOptionWaste += sizeof(CVoteOptionServer) + str_length(pOption->m_aCommand);
+	if(m_VoteOptionWaste > VOTE_OPTION_MAX_WASTE)
+		CompactVoteOptions();
+}
+
+void CGameContext::CompactVoteOptions()
+{
+	// the heap can't free single options, so copy the live ones into a new one
+	CHeap *pVoteOptionHeap = m_pVoteOptionHeap;
+	CVoteOptionServer *pSrc = m_pVoteOptionFirst;
+	CVoteOptionServer *apCursors[MAX_CLIENTS];
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		apCursors[i] = m_apPlayers[i] ? m_apPlayers[i]->m_pVoteOptionCursor : 0;
+
+	m_pVoteOptionHeap = new CHeap();
+	m_pVoteOptionFirst = 0;
+	m_pVoteOptionLast = 0;
+	mem_zero(m_apVoteOptionHash, sizeof(m_apVoteOptionHash));
+	m_VoteOptionWaste = 0;
+	m_NumVoteOptions = 0;
+
+	for(; pSrc; pSrc = pSrc->m_pNext)
+	{
+		AddVoteOption(pSrc->m_aDescription, pSrc->m_aCommand);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(m_apPlayers[i] && apCursors[i] == pSrc)
+				m_apPlayers[i]->m_pVoteOptionCursor = m_pVoteOptionLast;
+	}
+
+	delete pVoteOptionHeap;
+}
+
+void CGameContext::ClearVoteOptions()
+{
+	m_pVoteOptionHeap->Reset();
+	m_pVoteOptionFirst = 0;
+	m_pVoteOptionLast = 0;
+	mem_zero(m_apVoteOptionHash, sizeof(m_apVoteOptionHash));
+	m_VoteOptionWaste = 0;
+	m_NumVoteOptions = 0;
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(m_apPlayers[i])
+			m_apPlayers[i]->m_pVoteOptionCursor = 0;
+}
+
+void CGameContext::SendVoteOptions(int ClientID)
+{
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+
+	// pace the list by the free resend buffer, so it doesn't crowd out game traffic
+	for(int Msgs = 0; Msgs < VOTE_OPTION_MSGS_PER_TICK && pPlayer->m_pVoteOptionCursor; Msgs++)
+	{
+		if(Server()->ClientSendBufferFree(ClientID) < VOTE_OPTION_BUFFER_RESERVE)
+			break;
+
+		const char *apDesc[15];
+		int NumOptions = 0;
+		for(; NumOptions < 15 && pPlayer->m_pVoteOptionCursor; NumOptions++)
+		{
+			apDesc[NumOptions] = pPlayer->m_pVoteOptionCursor->m_aDescription;
+			pPlayer->m_pVoteOptionCursor = pPlayer->m_pVoteOptionCursor->m_pNext;
+		}
+		for(int i = NumOptions; i < 15; i++)
+			apDesc[i] = "";
+
+		CNetMsg_Sv_VoteOptionListAdd OptionMsg;
+		OptionMsg.m_NumOptions = NumOptions;
+		OptionMsg.m_pDescription0 = apDesc[0];
+		OptionMsg.m_pDescription1 = apDesc[1];
+		OptionMsg.m_pDescription2 = apDesc[2];
+		OptionMsg.m_pDescription3 = apDesc[3];
+		OptionMsg.m_pDescription4 = apDesc[4];
+		OptionMsg.m_pDescription5 = apDesc[5];
+		OptionMsg.m_pDescription6 = apDesc[6];
+		OptionMsg.m_pDescription7 = apDesc[7];
+		OptionMsg.m_pDescription8 = apDesc[8];
+		OptionMsg.m_pDescription9 = apDesc[9];
+		OptionMsg.m_pDescription10 = apDesc[10];
+		OptionMsg.m_pDescription11 = apDesc[11];
+		OptionMsg.m_pDescription12 = apDesc[12];
+		OptionMsg.m_pDescription13 = apDesc[13];
+		OptionMsg.m_pDescription14 = apDesc[14];
+		Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
+	}
+}
+
 
 class CCharacter *CGameContext::GetPlayerChar(int ClientID)
 {
@@ -419,10 +579,16 @@ void CGameContext::OnTick()
 
 	// copy tuning
 	m_World.m_Core.m_Tuning = m_Tuning;
-	m_World.Tick();
+	{
+		PERF_SCOPE(game_world);
+		m_World.Tick();
+	}
 
 	//if(world.paused) // make sure that the game object always updates
-	m_pController->Tick();
+	{
+		PERF_SCOPE(game_controller);
+		m_pController->Tick();
+	}
 
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
@@ -430,6 +596,9 @@ void CGameContext::OnTick()
 		{
 			m_apPlayers[i]->Tick();
 			m_apPlayers[i]->PostTick();
+
+			if(m_apPlayers[i]->m_pVoteOptionCursor)
+				SendVoteOptions(i);
 		}
 	}
 
@@ -743,27 +912,18 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 
 			if(str_comp_nocase(pMsg->m_Type, "option") == 0)
 			{
-				CVoteOptionServer *pOption = m_pVoteOptionFirst;
-				while(pOption)
-				{
-					if(str_comp_nocase(pMsg->m_Value, pOption->m_aDescription) == 0)
-					{
-						str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
-									pOption->m_aDescription, pReason);
-						str_format(aDesc, sizeof(aDesc), "%s", pOption->m_aDescription);
-						str_format(aCmd, sizeof(aCmd), "%s", pOption->m_aCommand);
-						break;
-					}
-
-					pOption = pOption->m_pNext;
-				}
-
+				CVoteOptionServer *pOption = FindVoteOption(pMsg->m_Value);
 				if(!pOption)
 				{
 					str_format(aChatmsg, sizeof(aChatmsg), "'%s' isn't an option on this server", pMsg->m_Value);
 					SendChatTarget(ClientID, aChatmsg);
 					return;
 				}
+
+				str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
+							pOption->m_aDescription, pReason);
+				str_format(aDesc, sizeof(aDesc), "%s", pOption->m_aDescription);
+				str_format(aCmd, sizeof(aCmd), "%s", pOption->m_aCommand);
 			}
 			else if(str_comp_nocase(pMsg->m_Type, "kick") == 0)
 			{
@@ -1046,72 +1206,9 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			CNetMsg_Sv_VoteClearOptions ClearMsg;
 			Server()->SendPackMsg(&ClearMsg, MSGFLAG_VITAL, ClientID);
 
-			CNetMsg_Sv_VoteOptionListAdd OptionMsg;
-			int NumOptions = 0;
-			OptionMsg.m_pDescription0 = "";
-			OptionMsg.m_pDescription1 = "";
-			OptionMsg.m_pDescription2 = "";
-			OptionMsg.m_pDescription3 = "";
-			OptionMsg.m_pDescription4 = "";
-			OptionMsg.m_pDescription5 = "";
-			OptionMsg.m_pDescription6 = "";
-			OptionMsg.m_pDescription7 = "";
-			OptionMsg.m_pDescription8 = "";
-			OptionMsg.m_pDescription9 = "";
-			OptionMsg.m_pDescription10 = "";
-			OptionMsg.m_pDescription11 = "";
-			OptionMsg.m_pDescription12 = "";
-			OptionMsg.m_pDescription13 = "";
-			OptionMsg.m_pDescription14 = "";
-			CVoteOptionServer *pCurrent = m_pVoteOptionFirst;
-			while(pCurrent)
-			{
-				switch(NumOptions++)
-				{
-				case 0: OptionMsg.m_pDescription0 = pCurrent->m_aDescription; break;
-				case 1: OptionMsg.m_pDescription1 = pCurrent->m_aDescription; break;
-				case 2: OptionMsg.m_pDescription2 = pCurrent->m_aDescription; break;
-				case 3: OptionMsg.m_pDescription3 = pCurrent->m_aDescription; break;
-				case 4: OptionMsg.m_pDescription4 = pCurrent->m_aDescription; break;
-				case 5: OptionMsg.m_pDescription5 = pCurrent->m_aDescription; break;
-				case 6: OptionMsg.m_pDescription6 = pCurrent->m_aDescription; break;
-				case 7: OptionMsg.m_pDescription7 = pCurrent->m_aDescription; break;
-				case 8: OptionMsg.m_pDescription8 = pCurrent->m_aDescription; break;
-				case 9: OptionMsg.m_pDescription9 = pCurrent->m_aDescription; break;
-				case 10: OptionMsg.m_pDescription10 = pCurrent->m_aDescription; break;
-				case 11: OptionMsg.m_pDescription11 = pCurrent->m_aDescription; break;
-				case 12: OptionMsg.m_pDescription12 = pCurrent->m_aDescription; break;
-				case 13: OptionMsg.m_pDescription13 = pCurrent->m_aDescription; break;
-				case 14:
-					{
-						OptionMsg.m_pDescription14 = pCurrent->m_aDescription;
-						OptionMsg.m_NumOptions = NumOptions;
-						Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
-						OptionMsg = CNetMsg_Sv_VoteOptionListAdd();
-						NumOptions = 0;
-						OptionMsg.m_pDescription1 = "";
-						OptionMsg.m_pDescription2 = "";
-						OptionMsg.m_pDescription3 = "";
-						OptionMsg.m_pDescription4 = "";
-						OptionMsg.m_pDescription5 = "";
-						OptionMsg.m_pDescription6 = "";
-						OptionMsg.m_pDescription7 = "";
-						OptionMsg.m_pDescription8 = "";
-						OptionMsg.m_pDescription9 = "";
-						OptionMsg.m_pDescription10 = "";
-						OptionMsg.m_pDescription11 = "";
-						OptionMsg.m_pDescription12 = "";
-						OptionMsg.m_pDescription13 = "";
-						OptionMsg.m_pDescription14 = "";
-					}
-				}
-				pCurrent = pCurrent->m_pNext;
-			}
-			if(NumOptions > 0)
-			{
-				OptionMsg.m_NumOptions = NumOptions;
-				Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
-			}
+			// the list itself is streamed over the next ticks, see SendVoteOptions
+			pPlayer->m_pVoteOptionCursor = m_pVoteOptionFirst;
+			SendVoteOptions(ClientID);
 
 			// send tuning parameters to client
 			SendTuningParams(ClientID);
@@ -1163,6 +1260,20 @@ void CGameContext::ConTuneDump(IConsole::IResult *pResult, void *pUserData)
 	}
 }
 
+void CGameContext::ConEventStats(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "peak=%d events/tick dropped=%d", pSelf->m_Events.PeakEvents(), pSelf->m_Events.NumDropped());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "events", aBuf);
+}
+
+void CGameContext::ConEntityPools(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	CEntityPool::PrintStats(pSelf->Console());
+}
+
 void CGameContext::ConPause(IConsole::IResult *pResult, void *pUserData)
 {
 	CGameContext *pSelf = (CGameContext *)pUserData;
@@ -1324,42 +1435,30 @@ void CGameContext::ConAddVote(IConsole::IResult *pResult, void *pUserData)
 	}
 
 	// check for duplicate entry
-	CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-	while(pOption)
+	if(pSelf->FindVoteOption(pDescription))
 	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
-			pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-			return;
-		}
-		pOption = pOption->m_pNext;
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+		return;
 	}
 
 	// add the option
-	++pSelf->m_NumVoteOptions;
-	int Len = str_length(pCommand);
-
-	pOption = (CVoteOptionServer *)pSelf->m_pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len);
-	pOption->m_pNext = 0;
-	pOption->m_pPrev = pSelf->m_pVoteOptionLast;
-	if(pOption->m_pPrev)
-		pOption->m_pPrev->m_pNext = pOption;
-	pSelf->m_pVoteOptionLast = pOption;
-	if(!pSelf->m_pVoteOptionFirst)
-		pSelf->m_pVoteOptionFirst = pOption;
-
-	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
-	mem_copy(pOption->m_aCommand, pCommand, Len+1);
+	pSelf->AddVoteOption(pDescription, pCommand);
+	CVoteOptionServer *pOption = pSelf->m_pVoteOptionLast;
 	char aBuf[256];
 	str_format(aBuf, sizeof(aBuf), "added option '%s' '%s'", pOption->m_aDescription, pOption->m_aCommand);
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
-	// inform clients about added option
+	// inform clients about added option, the ones still receiving the list get it from there
 	CNetMsg_Sv_VoteOptionAdd OptionMsg;
 	OptionMsg.m_pDescription = pOption->m_aDescription;
-	pSelf->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, -1);
+	pSelf->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL|MSGFLAG_NOSEND, -1);
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(pSelf->m_apPlayers[i] && pSelf->Server()->ClientIngame(i) && !pSelf->m_apPlayers[i]->m_pVoteOptionCursor)
+			pSelf->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL|MSGFLAG_NORECORD, i);
+	}
 }
 
 void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
@@ -1368,13 +1467,7 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 	const char *pDescription = pResult->GetString(0);
 
 	// check for valid option
-	CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-	while(pOption)
-	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-			break;
-		pOption = pOption->m_pNext;
-	}
+	CVoteOptionServer *pOption = pSelf->FindVoteOption(pDescription);
 	if(!pOption)
 	{
 		char aBuf[256];
@@ -1388,43 +1481,11 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 	OptionMsg.m_pDescription = pOption->m_aDescription;
 	pSelf->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, -1);
 
-	// TODO: improve this
 	// remove the option
-	--pSelf->m_NumVoteOptions;
 	char aBuf[256];
 	str_format(aBuf, sizeof(aBuf), "removed option '%s' '%s'", pOption->m_aDescription, pOption->m_aCommand);
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-
-	CHeap *pVoteOptionHeap = new CHeap();
-	CVoteOptionServer *pVoteOptionFirst = 0;
-	CVoteOptionServer *pVoteOptionLast = 0;
-	int NumVoteOptions = pSelf->m_NumVoteOptions;
-	for(CVoteOptionServer *pSrc = pSelf->m_pVoteOptionFirst; pSrc; pSrc = pSrc->m_pNext)
-	{
-		if(pSrc == pOption)
-			continue;
-
-		// copy option
-		int Len = str_length(pSrc->m_aCommand);
-		CVoteOptionServer *pDst = (CVoteOptionServer *)pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len);
-		pDst->m_pNext = 0;
-		pDst->m_pPrev = pVoteOptionLast;
-		if(pDst->m_pPrev)
-			pDst->m_pPrev->m_pNext = pDst;
-		pVoteOptionLast = pDst;
-		if(!pVoteOptionFirst)
-			pVoteOptionFirst = pDst;
-
-		str_copy(pDst->m_aDescription, pSrc->m_aDescription, sizeof(pDst->m_aDescription));
-		mem_copy(pDst->m_aCommand, pSrc->m_aCommand, Len+1);
-	}
-
-	// clean up
-	delete pSelf->m_pVoteOptionHeap;
-	pSelf->m_pVoteOptionHeap = pVoteOptionHeap;
-	pSelf->m_pVoteOptionFirst = pVoteOptionFirst;
-	pSelf->m_pVoteOptionLast = pVoteOptionLast;
-	pSelf->m_NumVoteOptions = NumVoteOptions;
+	pSelf->RemoveVoteOption(pOption);
 }
 
 void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
@@ -1437,26 +1498,17 @@ void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
 
 	if(str_comp_nocase(pType, "option") == 0)
 	{
-		CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-		while(pOption)
-		{
-			if(str_comp_nocase(pValue, pOption->m_aDescription) == 0)
-			{
-				str_format(aBuf, sizeof(aBuf), "admin forced server option '%s' (%s)", pValue, pReason);
-				pSelf->SendChatTarget(-1, aBuf);
-				pSelf->Console()->ExecuteLine(pOption->m_aCommand);
-				break;
-			}
-
-			pOption = pOption->m_pNext;
-		}
-
+		CVoteOptionServer *pOption = pSelf->FindVoteOption(pValue);
 		if(!pOption)
 		{
 			str_format(aBuf, sizeof(aBuf), "'%s' isn't an option on this server", pValue);
 			pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 			return;
 		}
+
+		str_format(aBuf, sizeof(aBuf), "admin forced server option '%s' (%s)", pValue, pReason);
+		pSelf->SendChatTarget(-1, aBuf);
+		pSelf->Console()->ExecuteLine(pOption->m_aCommand);
 	}
 	else if(str_comp_nocase(pType, "kick") == 0)
 	{
@@ -1503,10 +1555,7 @@ void CGameContext::ConClearVotes(IConsole::IResult *pResult, void *pUserData)
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "cleared votes");
 	CNetMsg_Sv_VoteClearOptions VoteClearOptionsMsg;
 	pSelf->Server()->SendPackMsg(&VoteClearOptionsMsg, MSGFLAG_VITAL, -1);
-	pSelf->m_pVoteOptionHeap->Reset();
-	pSelf->m_pVoteOptionFirst = 0;
-	pSelf->m_pVoteOptionLast = 0;
-	pSelf->m_NumVoteOptions = 0;
+	pSelf->ClearVoteOptions();
 }
 
 void CGameContext::ConVote(IConsole::IResult *pResult, void *pUserData)
@@ -1599,6 +1648,11 @@ void CGameContext::DestroyLolText(int TextID)
 	CLoltext::Destroy(&m_World, TextID);
 }
 
+bool CGameContext::UpdateLolText(int TextID, const char *pText)
+{
+	return CLoltext::Update(TextID, pText);
+}
+
 void CGameContext::ConchainSpecialMotdupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -1621,6 +1675,8 @@ void CGameContext::OnConsoleInit()
 	Console()->Register("tune", "si", CFGFLAG_SERVER, ConTuneParam, this, "Tune variable to value");
 	Console()->Register("tune_reset", "", CFGFLAG_SERVER, ConTuneReset, this, "Reset tuning");
 	Console()->Register("tune_dump", "", CFGFLAG_SERVER, ConTuneDump, this, "Dump tuning");
+	Console()->Register("event_stats", "", CFGFLAG_SERVER, ConEventStats, this, "Show event buffer usage");
+	Console()->Register("entity_pools", "", CFGFLAG_SERVER, ConEntityPools, this, "Show entity pool usage");
 
 	Console()->Register("pause", "", CFGFLAG_SERVER, ConPause, this, "Pause/unpause game");
 	Console()->Register("change_map", "?r", CFGFLAG_SERVER|CFGFLAG_STORE, ConChangeMap, this, "Change map");
@@ -1661,6 +1717,12 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	for(int i = 0; i < NUM_NETOBJTYPES; i++)
 		Server()->SnapSetStaticsize(i, m_NetObjHandler.GetObjSize(i));
 
+	// the game type picks its trigger tiles before the regions are built
+	if(str_comp(g_Config.m_SvGametype, "mod") == 0)
+		CGameControllerMOD::AddTriggerTiles(&m_Collision);
+	else if(str_comp(g_Config.m_SvGametype, "openfng") == 0)
+		CGameControllerOpenFNG::AddTriggerTiles(&m_Collision);
+
 	m_Layers.Init(Kernel());
 	m_Collision.Init(&m_Layers);
 
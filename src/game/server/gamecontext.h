@@ -54,6 +54,8 @@ class CGameContext : public IGameServer
 	static void ConTuneParam(IConsole::IResult *pResult, void *pUserData);
 	static void ConTuneReset(IConsole::IResult *pResult, void *pUserData);
 	static void ConTuneDump(IConsole::IResult *pResult, void *pUserData);
+	static void ConEventStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConEntityPools(IConsole::IResult *pResult, void *pUserData);
 	static void ConPause(IConsole::IResult *pResult, void *pUserData);
 	static void ConChangeMap(IConsole::IResult *pResult, void *pUserData);
 	static void ConRestart(IConsole::IResult *pResult, void *pUserData);
@@ -114,6 +116,7 @@ public:
 
 	int CreateLolText(CEntity *pParent, bool Follow, vec2 Pos, vec2 Vel, int Lifespan, const char *pText);
 	void DestroyLolText(int TextID);
+	bool UpdateLolText(int TextID, const char *pText); // false if the text is gone
 
 	int m_VoteCreator;
 	int64 m_VoteCloseTime;
@@ -129,10 +132,23 @@ public:
 		VOTE_ENFORCE_UNKNOWN=0,
 		VOTE_ENFORCE_NO,
 		VOTE_ENFORCE_YES,
+
+		VOTE_OPTION_MAX_WASTE=16*1024,
+		VOTE_OPTION_BUFFER_RESERVE=16*1024,
+		VOTE_OPTION_MSGS_PER_TICK=4,
 	};
 	CHeap *m_pVoteOptionHeap;
 	CVoteOptionServer *m_pVoteOptionFirst;
 	CVoteOptionServer *m_pVoteOptionLast;
+	CVoteOptionServer *m_apVoteOptionHash[VOTE_OPTION_HASH_SIZE];
+	int m_VoteOptionWaste; // heap bytes held by removed options
+
+	CVoteOptionServer *FindVoteOption(const char *pDescription);
+	void AddVoteOption(const char *pDescription, const char *pCommand);
+	void RemoveVoteOption(CVoteOptionServer *pOption);
+	void CompactVoteOptions();
+	void ClearVoteOptions();
+	void SendVoteOptions(int ClientID);
 
 	// helper functions
 	void CreateDamageInd(vec2 Pos, float AngleMod, int Amount, int CltMask = -1);
@@ -33,28 +33,117 @@ IGameController::IGameController(class CGameContext *pGameServer)
 	m_aNumSpawnPoints[0] = 0;
 	m_aNumSpawnPoints[1] = 0;
 	m_aNumSpawnPoints[2] = 0;
+
+	m_SpawnCacheTick = -1;
+	m_SpawnCacheSerial = -1;
+	m_SpawnCacheMask = 0;
 }
 
 IGameController::~IGameController()
 {
 }
 
-float IGameController::EvaluateSpawnPos(CSpawnEval *pEval, vec2 Pos)
+const vec2 IGameController::ms_aSpawnOffsets[5] = { vec2(0.0f, 0.0f), vec2(-32.0f, 0.0f), vec2(0.0f, -32.0f), vec2(32.0f, 0.0f), vec2(0.0f, 32.0f) };	// start, left, up, right, down
+
+void IGameController::AddSpawnPoint(int Type, vec2 Pos)
+{
+	CSpawnInfo *pInfo = &m_aaSpawnInfo[Type][m_aNumSpawnPoints[Type]];
+	m_aaSpawnPoints[Type][m_aNumSpawnPoints[Type]++] = Pos;
+
+	pInfo->m_SolidMask = 0;
+	for(int Index = 0; Index < 5; ++Index)
+		if(GameServer()->Collision()->CheckPoint(Pos+ms_aSpawnOffsets[Index]))
+			pInfo->m_SolidMask |= 1<<Index;
+
+	// the cache doesn't know this one yet
+	m_SpawnCacheTick = -1;
+}
+
+void IGameController::UpdateSpawnInfo(int Type, int i, int NewCID)
 {
-	float Score = 0.0f;
+	CSpawnInfo *pInfo = &m_aaSpawnInfo[Type][i];
+	vec2 SpawnPos = m_aaSpawnPoints[Type][i];
+	int OldOffset = pInfo->m_Offset;
+
+	// check if the position is occupado
+	bool Blocking = false;
+	if(NewCID == -1)
+	{
+		pInfo->m_NearMask = 0;
+		for(int c = 0; c < MAX_CLIENTS; c++)
+			if((m_SpawnCacheMask&(1<<c)) && distance(m_aSpawnCachePos[c], SpawnPos) < 64+CCharacter::ms_PhysSize)
+				pInfo->m_NearMask |= 1<<c;
+		Blocking = true;
+	}
+	else if(distance(m_aSpawnCachePos[NewCID], SpawnPos) < 64+CCharacter::ms_PhysSize)
+	{
+		pInfo->m_NearMask |= 1<<NewCID;
+		Blocking = true;
+	}
+
+	if(Blocking)
+	{
+		// walls only count when someone is close, like they always did
+		pInfo->m_Offset = pInfo->m_NearMask ? -1 : 0;
+		for(int Index = 0; pInfo->m_NearMask && Index < 5 && pInfo->m_Offset == -1; ++Index)
+		{
+			if(pInfo->m_SolidMask&(1<<Index))
+				continue;
+			pInfo->m_Offset = Index;
+			for(int c = 0; c < MAX_CLIENTS; c++)
+				if((pInfo->m_NearMask&(1<<c)) && distance(m_aSpawnCachePos[c], SpawnPos+ms_aSpawnOffsets[Index]) <= CCharacter::ms_PhysSize)
+				{
+					pInfo->m_Offset = -1;
+					break;
+				}
+		}
+	}
+
+	if(pInfo->m_Offset == -1)
+		return;
+
+	// the danger only has to be summed up again if the position moved
+	vec2 P = SpawnPos+ms_aSpawnOffsets[pInfo->m_Offset];
+	if(NewCID == -1 || pInfo->m_Offset != OldOffset)
+	{
+		pInfo->m_aDanger[0] = pInfo->m_aDanger[1] = 0.0f;
+		for(int c = 0; c < MAX_CLIENTS; c++)
+			if(m_SpawnCacheMask&(1<<c))
+			{
+				float d = distance(P, m_aSpawnCachePos[c]);
+				pInfo->m_aDanger[m_aSpawnCacheTeam[c]&1] += d == 0 ? 1000000000.0f : 1.0f/d;
+			}
+	}
+	else
+	{
+		float d = distance(P, m_aSpawnCachePos[NewCID]);
+		pInfo->m_aDanger[m_aSpawnCacheTeam[NewCID]&1] += d == 0 ? 1000000000.0f : 1.0f/d;
+	}
+}
+
+void IGameController::UpdateSpawnCache()
+{
+	int Serial = GameServer()->m_World.ListSerial(CGameWorld::ENTTYPE_CHARACTER);
+	if(m_SpawnCacheTick == Server()->Tick() && m_SpawnCacheSerial == Serial)
+		return;
+
+	// characters only move in the world tick, so the positions hold for the rest of it
+	m_SpawnCacheMask = 0;
 	CCharacter *pC = static_cast<CCharacter *>(GameServer()->m_World.FindFirst(CGameWorld::ENTTYPE_CHARACTER));
 	for(; pC; pC = (CCharacter *)pC->TypeNext())
 	{
-		// team mates are not as dangerous as enemies
-		float Scoremod = 1.0f;
-		if(pEval->m_FriendlyTeam != -1 && pC->GetPlayer()->GetTeam() == pEval->m_FriendlyTeam)
-			Scoremod = 0.5f;
-
-		float d = distance(Pos, pC->m_Pos);
-		Score += Scoremod * (d == 0 ? 1000000000.0f : 1.0f/d);
+		int CID = pC->GetPlayer()->GetCID();
+		m_SpawnCacheMask |= 1<<CID;
+		m_aSpawnCachePos[CID] = pC->m_Pos;
+		m_aSpawnCacheTeam[CID] = pC->GetPlayer()->GetTeam();
 	}
 
-	return Score;
+	for(int Type = 0; Type < 3; Type++)
+		for(int i = 0; i < m_aNumSpawnPoints[Type]; i++)
+			UpdateSpawnInfo(Type, i, -1);
+
+	m_SpawnCacheTick = Server()->Tick();
+	m_SpawnCacheSerial = Serial;
 }
 
 void IGameController::EvaluateSpawnType(CSpawnEval *pEval, int Type)
@@ -62,32 +151,24 @@ void IGameController::EvaluateSpawnType(CSpawnEval *pEval, int Type)
 	// get spawn point
 	for(int i = 0; i < m_aNumSpawnPoints[Type]; i++)
 	{
-		// check if the position is occupado
-		CCharacter *aEnts[MAX_CLIENTS];
-		int Num = GameServer()->m_World.FindEntities(m_aaSpawnPoints[Type][i], 64, (CEntity**)aEnts, MAX_CLIENTS, CGameWorld::ENTTYPE_CHARACTER);
-		vec2 Positions[5] = { vec2(0.0f, 0.0f), vec2(-32.0f, 0.0f), vec2(0.0f, -32.0f), vec2(32.0f, 0.0f), vec2(0.0f, 32.0f) };	// start, left, up, right, down
-		int Result = -1;
-		for(int Index = 0; Index < 5 && Result == -1; ++Index)
-		{
-			Result = Index;
-			for(int c = 0; c < Num; ++c)
-				if(GameServer()->Collision()->CheckPoint(m_aaSpawnPoints[Type][i]+Positions[Index]) ||
-					distance(aEnts[c]->m_Pos, m_aaSpawnPoints[Type][i]+Positions[Index]) <= aEnts[c]->m_ProximityRadius)
-				{
-					Result = -1;
-					break;
-				}
-		}
-		if(Result == -1)
+		const CSpawnInfo *pInfo = &m_aaSpawnInfo[Type][i];
+		if(pInfo->m_Offset == -1)
 			continue;	// try next spawn point
 
-		vec2 P = m_aaSpawnPoints[Type][i]+Positions[Result];
-		float S = EvaluateSpawnPos(pEval, P);
+		// team mates are not as dangerous as enemies
+		float S;
+		if(pEval->m_FriendlyTeam == -1)
+			S = pInfo->m_aDanger[0] + pInfo->m_aDanger[1];
+		else if(pEval->m_FriendlyTeam&1)
+			S = pInfo->m_aDanger[0] + 0.5f*pInfo->m_aDanger[1];
+		else
+			S = 0.5f*pInfo->m_aDanger[0] + pInfo->m_aDanger[1];
+
 		if(!pEval->m_Got || pEval->m_Score > S)
 		{
 			pEval->m_Got = true;
 			pEval->m_Score = S;
-			pEval->m_Pos = P;
+			pEval->m_Pos = m_aaSpawnPoints[Type][i]+ms_aSpawnOffsets[pInfo->m_Offset];
 		}
 	}
 }
@@ -100,6 +181,8 @@ bool IGameController::CanSpawn(int Team, vec2 *pOutPos)
 	if(Team == TEAM_SPECTATORS)
 		return false;
 
+	UpdateSpawnCache();
+
 	if(IsTeamplay())
 	{
 		Eval.m_FriendlyTeam = Team;
@@ -131,11 +214,11 @@ bool IGameController::OnEntity(int Index, vec2 Pos)
 	int SubType = 0;
 
 	if(Index == ENTITY_SPAWN)
-		m_aaSpawnPoints[0][m_aNumSpawnPoints[0]++] = Pos;
+		AddSpawnPoint(0, Pos);
 	else if(Index == ENTITY_SPAWN_RED)
-		m_aaSpawnPoints[1][m_aNumSpawnPoints[1]++] = Pos;
+		AddSpawnPoint(1, Pos);
 	else if(Index == ENTITY_SPAWN_BLUE)
-		m_aaSpawnPoints[2][m_aNumSpawnPoints[2]++] = Pos;
+		AddSpawnPoint(2, Pos);
 	else if(Index == ENTITY_ARMOR_1)
 		Type = POWERUP_ARMOR;
 	else if(Index == ENTITY_HEALTH_1)
@@ -327,6 +410,10 @@ void IGameController::PostReset()
 	}
 }
 
+void IGameController::OnCharacterEvent(class CCharacter *pChr, int Event)
+{
+}
+
 void IGameController::OnPlayerInfoChange(class CPlayer *pP)
 {
 	const int aTeamColors[2] = {65387, 10223467};
@@ -368,6 +455,20 @@ int IGameController::OnCharacterDeath(class CCharacter *pVictim, class CPlayer *
 
 void IGameController::OnCharacterSpawn(class CCharacter *pChr)
 {
+	// mass spawns only add the new character to the spawn cache
+	int CID = pChr->GetPlayer()->GetCID();
+	if(m_SpawnCacheTick == Server()->Tick() && m_SpawnCacheSerial+1 == GameServer()->m_World.ListSerial(CGameWorld::ENTTYPE_CHARACTER) &&
+		!(m_SpawnCacheMask&(1<<CID)))
+	{
+		m_SpawnCacheMask |= 1<<CID;
+		m_aSpawnCachePos[CID] = pChr->m_Pos;
+		m_aSpawnCacheTeam[CID] = pChr->GetPlayer()->GetTeam();
+		for(int Type = 0; Type < 3; Type++)
+			for(int i = 0; i < m_aNumSpawnPoints[Type]; i++)
+				UpdateSpawnInfo(Type, i, CID);
+		m_SpawnCacheSerial++;
+	}
+
 	// default health
 	pChr->IncreaseHealth(10);
 
@@ -4,6 +4,7 @@
 #define GAME_SERVER_GAMECONTROLLER_H
 
 #include <base/vmath.h>
+#include <engine/shared/protocol.h>
 
 /*
 	Class: Game Controller
@@ -15,6 +16,30 @@ class IGameController
 	vec2 m_aaSpawnPoints[3][64];
 	int m_aNumSpawnPoints[3];
 
+	// what spawning at a spawn point looks like in the current tick. the
+	// solid offsets are found at map load, the rest is built on the first
+	// spawn in a tick and kept up to date as more characters spawn
+	struct CSpawnInfo
+	{
+		int m_SolidMask; // offsets that are inside a wall
+		unsigned m_NearMask; // characters close enough to block an offset
+		int m_Offset; // first free offset, -1 if all are blocked
+		float m_aDanger[2]; // by red/blue characters, for the chosen offset
+	};
+	CSpawnInfo m_aaSpawnInfo[3][64];
+
+	int m_SpawnCacheTick;
+	int m_SpawnCacheSerial; // character list serial of the world
+	unsigned m_SpawnCacheMask; // characters in the cache
+	vec2 m_aSpawnCachePos[MAX_CLIENTS];
+	int m_aSpawnCacheTeam[MAX_CLIENTS];
+
+	static const vec2 ms_aSpawnOffsets[5];
+
+	void AddSpawnPoint(int Type, vec2 Pos);
+	void UpdateSpawnCache();
+	void UpdateSpawnInfo(int Type, int Index, int NewCID);
+
 	class CGameContext *m_pGameServer;
 	class IServer *m_pServer;
 
@@ -37,7 +62,6 @@ protected:
 		float m_Score;
 	};
 
-	float EvaluateSpawnPos(CSpawnEval *pEval, vec2 Pos);
 	void EvaluateSpawnType(CSpawnEval *pEval, int Type);
 	bool EvaluateSpawn(class CPlayer *pP, vec2 *pPos);
 
@@ -129,6 +153,25 @@ public:
 	*/
 	virtual int OnCharacterDeath(class CCharacter *pVictim, class CPlayer *pKiller, int Weapon);
 
+	enum
+	{
+		CHAREVENT_FREEZE=0, // freeze ticks were set
+		CHAREVENT_HOOK, // the hook grabbed a player
+		CHAREVENT_HAMMERED,
+		CHAREVENT_TILE, // entered or left a trigger region, see CCollision
+	};
+
+	/*
+		Function: on_CCharacter_event
+			Called when the state of a CCharacter changes, so the game
+			mode doesn't have to look at every character every tick.
+
+		Arguments:
+			chr - The CCharacter that changed.
+			event - One of CHAREVENT_*.
+	*/
+	virtual void OnCharacterEvent(class CCharacter *pChr, int Event);
+
 
 	virtual void OnPlayerInfoChange(class CPlayer *pP);
 
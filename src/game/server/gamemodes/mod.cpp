@@ -12,6 +12,13 @@ CGameControllerMOD::CGameControllerMOD(class CGameContext *pGameServer)
 	//m_GameFlags = GAMEFLAG_TEAMS; // GAMEFLAG_TEAMS makes it a two-team gamemode
 }
 
+void CGameControllerMOD::AddTriggerTiles(CCollision *pCollision)
+{
+	// make your own tiles triggers here, characters that walk onto them
+	// or off them call OnCharacterEvent with CHAREVENT_TILE
+	//pCollision->AddTriggerTile(16);
+}
+
 void CGameControllerMOD::Tick()
 {
 	// this is the main part of the gamemode, this function is run every tick
@@ -10,6 +10,8 @@ class CGameControllerMOD : public IGameController
 {
 public:
 	CGameControllerMOD(class CGameContext *pGameServer);
+	// called before the map is loaded, see CCollision::AddTriggerTile
+	static void AddTriggerTiles(class CCollision *pCollision);
 	virtual void Tick();
 	// add more virtual functions here if you wish
 };
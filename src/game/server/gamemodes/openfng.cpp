@@ -35,6 +35,7 @@ CGameControllerOpenFNG::CGameControllerOpenFNG(class CGameContext *pGameServer)
 	m_pGameType = "openfng";
 	m_GameFlags = GAMEFLAG_TEAMS;
 	m_aCltMask[0] = m_aCltMask[1] = 0;
+	m_WatchMask = m_HookMask = m_HammerMask = 0;
 
 	Reset();
 }
@@ -44,6 +45,13 @@ CGameControllerOpenFNG::~CGameControllerOpenFNG()
 	Reset(true);
 }
 
+void CGameControllerOpenFNG::AddTriggerTiles(CCollision *pCollision)
+{
+	pCollision->AddTriggerTile(TILE_SHRINE_ALL);
+	pCollision->AddTriggerTile(TILE_SHRINE_RED);
+	pCollision->AddTriggerTile(TILE_SHRINE_BLUE);
+}
+
 void CGameControllerOpenFNG::Reset(bool Destruct)
 {
 	for(int i = 0; i < MAX_CLIENTS; i++)
@@ -55,6 +63,7 @@ void CGameControllerOpenFNG::Reset(bool Destruct)
 
 	m_ScoreDisplay.Reset(Destruct);
 	m_aCltMask[0] = m_aCltMask[1] = 0;
+	m_WatchMask = m_HookMask = m_HammerMask = 0;
 }
 
 void CGameControllerOpenFNG::Tick()
@@ -67,9 +76,15 @@ void CGameControllerOpenFNG::Tick()
 	if (DoEmpty())
 		return;
 
-	DoInteractions();
+	{
+		PERF_SCOPE(fng_interactions);
+		DoInteractions();
+	}
 
-	DoScoreDisplays();
+	{
+		PERF_SCOPE(fng_scoredisplays);
+		DoScoreDisplays();
+	}
 
 	DoBroadcasts();
 
@@ -92,13 +107,24 @@ bool CGameControllerOpenFNG::DoEmpty()
 
 void CGameControllerOpenFNG::DoHookers()
 {
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	unsigned Mask = m_HookMask | m_HammerMask;
+	m_HammerMask = 0;
+	for(int i = 0; Mask && i < MAX_CLIENTS; i++)
 	{
+		if (!(Mask & (1<<i)))
+			continue;
+		Mask &= ~(1<<i);
+
 		CCharacter *pChr = CHAR(i);
 		if (!pChr)
+		{
+			m_HookMask &= ~(1<<i);
 			continue;
+		}
 		
 		int Hooking = pChr->GetHookedPlayer();
+		if (Hooking < 0)
+			m_HookMask &= ~(1<<i);
 
 		if (Hooking >= 0)
 		{
@@ -141,16 +167,29 @@ void CGameControllerOpenFNG::DoHookers()
 
 void CGameControllerOpenFNG::DoInteractions()
 {
+	//the old way, every client every tick. the replay test checks both give the same game
+	if (g_Config.m_DbgFngPoll)
+		m_WatchMask = m_HookMask = (1u<<MAX_CLIENTS)-1;
+
 	DoHookers();
 
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	//m_WatchMask is read as we go, clients raising events further up still get their turn this tick
+	for(int i = 0; m_WatchMask >> i; i++)
 	{
+		if (!(m_WatchMask & (1<<i)))
+			continue;
+
 		CCharacter *pChr = CHAR(i);
+		int FrzTicks = pChr ? pChr->GetFreezeTicks() : 0;
+
+		//frozen ones need their damage indicators every tick, the rest is done after one look
+		if (FrzTicks <= 0)
+			m_WatchMask &= ~(1<<i);
+
 		if (!pChr)
 			continue;
 
-		int FrzTicks = pChr->GetFreezeTicks();
-		int Col = GameServer()->Collision()->GetCollisionAt(pChr->m_Pos.x, pChr->m_Pos.y);
+		int Col = g_Config.m_DbgFngPoll ? GameServer()->Collision()->GetCollisionAt(pChr->m_Pos.x, pChr->m_Pos.y) : pChr->GetTile();
 		if (Col == TILE_SHRINE_ALL || Col == TILE_SHRINE_RED || Col == TILE_SHRINE_BLUE)
 		{
 			if (FrzTicks > 0 && m_aLastInteraction[i] < 0)
@@ -453,9 +492,36 @@ int CGameControllerOpenFNG::OnCharacterDeath(class CCharacter *pVictim, class CP
 }
 
 
+void CGameControllerOpenFNG::OnCharacterEvent(class CCharacter *pChr, int Event)
+{
+	int Cid = pChr->GetPlayer()->GetCID();
+	switch(Event)
+	{
+	case CHAREVENT_FREEZE:
+		m_WatchMask |= (1<<Cid);
+		break;
+	case CHAREVENT_HOOK:
+		m_HookMask |= (1<<Cid);
+		break;
+	case CHAREVENT_HAMMERED:
+		m_HammerMask |= (1<<Cid);
+		break;
+	case CHAREVENT_TILE:
+		{
+			int Col = pChr->GetTile();
+			if (Col == TILE_SHRINE_ALL || Col == TILE_SHRINE_RED || Col == TILE_SHRINE_BLUE)
+				m_WatchMask |= (1<<Cid);
+		}
+		break;
+	}
+}
+
 void CGameControllerOpenFNG::OnCharacterSpawn(class CCharacter *pChr)
 {
 	m_aCltMask[pChr->GetPlayer()->GetTeam()&1] |= (1<<pChr->GetPlayer()->GetCID());
+
+	//one look to forget what the previous character left behind
+	m_WatchMask |= (1<<pChr->GetPlayer()->GetCID());
 	
 	IGameController::OnCharacterSpawn(pChr);
 
@@ -606,8 +672,9 @@ void CScoreDisplay::Operate()
 			str_format(aBuf, sizeof aBuf, "%d", m_aScoreDisplayValue[Team]);
 			for(int i = 0; i < m_aScoreDisplayCount[Team]; i++)
 			{
-				if (m_aScoreDisplayTextIDs[Team][i] != -1)
-					GS->DestroyLolText(m_aScoreDisplayTextIDs[Team][i]);
+				// only the digits that changed get new pixels
+				if (m_aScoreDisplayTextIDs[Team][i] != -1 && GS->UpdateLolText(m_aScoreDisplayTextIDs[Team][i], aBuf))
+					continue;
 				m_aScoreDisplayTextIDs[Team][i] = GS->CreateLolText(0, false, m_aScoreDisplays[Team][i], vec2(0.f, 0.f), 3600 * TS, aBuf);
 			}
 		}
@@ -70,6 +70,11 @@ private:
 
 	unsigned m_aCltMask[2]; //for sending damageindicators only to teammates
 
+	//raised by character events, so only these clients are looked at in a tick
+	unsigned m_WatchMask; //frozen, just thawed or on a special tile
+	unsigned m_HookMask; //hooking another player
+	unsigned m_HammerMask; //got hammered since the last tick
+
 	void SendFreezeKill(int Killer, int Victim, int Weapon);
 	void HandleFreeze(int Killer, int Victim);
 	void HandleMelt(int Melter, int Meltee);
@@ -87,11 +92,15 @@ public:
 	CGameControllerOpenFNG(class CGameContext *pGameServer);
 	virtual ~CGameControllerOpenFNG();
 
+	// the shrines, scored through the trigger regions
+	static void AddTriggerTiles(class CCollision *pCollision);
+
 	virtual bool CanBeMovedOnBalance(int ClientID);
 	virtual void Tick();
 	virtual void Snap(int SnappingClient);
 	virtual bool OnEntity(int Index, vec2 Pos);
 	virtual void OnCharacterSpawn(class CCharacter *pChr);
+	virtual void OnCharacterEvent(class CCharacter *pChr, int Event);
 	virtual int OnCharacterDeath(class CCharacter *pVictim,
 	                          class CPlayer *pUnusedKiller, int Weapon);
 	//virtual void OnPlayerInfoChange(class CPlayer *pP);
@@ -16,7 +16,10 @@ CGameWorld::CGameWorld()
 	m_Paused = false;
 	m_ResetRequested = false;
 	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
 		m_apFirstEntityTypes[i] = 0;
+		m_aListSerial[i] = 0;
+	}
 }
 
 CGameWorld::~CGameWorld()
@@ -25,6 +28,10 @@ CGameWorld::~CGameWorld()
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		while(m_apFirstEntityTypes[i])
 			delete m_apFirstEntityTypes[i];
+
+	// the pools keep the snap ids of their slots until now
+	if(m_pServer)
+		CEntityPool::ReleaseSnapIDs(m_pServer);
 }
 
 void CGameWorld::SetGameServer(CGameContext *pGameServer)
@@ -67,6 +74,7 @@ void CGameWorld::InsertEntity(CEntity *pEnt)
 #endif
 
 	// insert it
+	m_aListSerial[pEnt->m_ObjType]++;
 	if(m_apFirstEntityTypes[pEnt->m_ObjType])
 		m_apFirstEntityTypes[pEnt->m_ObjType]->m_pPrevTypeEntity = pEnt;
 	pEnt->m_pNextTypeEntity = m_apFirstEntityTypes[pEnt->m_ObjType];
@@ -86,6 +94,7 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 		return;
 
 	// remove
+	m_aListSerial[pEnt->m_ObjType]++;
 	if(pEnt->m_pPrevTypeEntity)
 		pEnt->m_pPrevTypeEntity->m_pNextTypeEntity = pEnt->m_pNextTypeEntity;
 	else
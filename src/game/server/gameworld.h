@@ -32,6 +32,7 @@ private:
 
 	CEntity *m_pNextTraverseEntity;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
+	int m_aListSerial[NUM_ENTTYPES];
 
 	class CGameContext *m_pGameServer;
 	class IServer *m_pServer;
@@ -51,6 +52,9 @@ public:
 
 	CEntity *FindFirst(int Type);
 
+	// changes whenever an entity of the type is inserted or removed
+	int ListSerial(int Type) { return m_aListSerial[Type]; }
+
 	/*
 		Function: find_entities
 			Finds entities close to a position and returns them in a list.
@@ -53,6 +53,8 @@ public:
 	//
 	int m_Vote;
 	int m_VotePos;
+	// next vote option to stream to the client, 0 when the list is complete
+	struct CVoteOptionServer *m_pVoteOptionCursor;
 	//
 	int m_LastVoteCall;
 	int m_LastVoteTry;
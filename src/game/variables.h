@@ -107,6 +107,7 @@ MACRO_CONFIG_INT(SvEndvoteScore, sv_endvote_score, 10, 0, 100, CFGFLAG_SERVER, "
 MACRO_CONFIG_INT(SvExtend, sv_extend, 0, 0, 0, CFGFLAG_SERVER, "when set to 1 before round ends, another round on the same map is enforced and this is reset to 0")
 MACRO_CONFIG_INT(SvLoltextHspace, sv_loltext_hspace, 14, 10, 25, CFGFLAG_SERVER, "horizontal offset between loltext 'pixels'")
 MACRO_CONFIG_INT(SvLoltextVspace, sv_loltext_vspace, 14, 10, 25, CFGFLAG_SERVER, "vertical offset between loltext 'pixels'")
+MACRO_CONFIG_INT(SvLoltextMax, sv_loltext_max, 16, 1, 64, CFGFLAG_SERVER, "maximum number of loltexts shown at once")
 MACRO_CONFIG_INT(SvBloodInterval, sv_blood_interval, 1, 1, 300, CFGFLAG_SERVER, "should stay at 1 for openfng (as we bleed for only 1 tick)")
 MACRO_CONFIG_INT(SvBleedOnFreeze, sv_bleed_on_freeze, 1, 0, 1, CFGFLAG_SERVER, "'blood' splash + sound on freezing someone")
 
@@ -165,6 +166,8 @@ MACRO_CONFIG_INT(SvClickyMelt, sv_clicky_melt, 1, 0, 2, CFGFLAG_SERVER, "Click s
 	MACRO_CONFIG_INT(DbgDummies, dbg_dummies, 0, 0, 15, CFGFLAG_SERVER, "")
 #endif
 
+MACRO_CONFIG_INT(DbgFngPoll, dbg_fng_poll, 0, 0, 1, CFGFLAG_SERVER, "Look at every client every tick instead of only those that raised events (the old openfng path)")
+
 MACRO_CONFIG_INT(DbgFocus, dbg_focus, 0, 0, 1, CFGFLAG_CLIENT, "")
 MACRO_CONFIG_INT(DbgTuning, dbg_tuning, 0, 0, 1, CFGFLAG_CLIENT, "")
 #endif
@@ -9,7 +9,8 @@ enum
 	VOTE_CMD_LENGTH=512,
 	VOTE_REASON_LENGTH=16,
 
-	MAX_VOTE_OPTIONS=128,
+	MAX_VOTE_OPTIONS=1024,
+	VOTE_OPTION_HASH_SIZE=256,
 };
 
 struct CVoteOptionClient
@@ -23,6 +24,8 @@ struct CVoteOptionServer
 {
 	CVoteOptionServer *m_pNext;
 	CVoteOptionServer *m_pPrev;
+	CVoteOptionServer *m_pHashNext;
+	unsigned m_Hash;
 	char m_aDescription[VOTE_DESC_LENGTH];
 	char m_aCommand[1];
 };
@@ -0,0 +1,656 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h> // rand
+#include <zlib.h>
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/message.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+#include <game/version.h>
+
+// connects a lot of bots to a game server. every bot does what a real client
+// does on the wire: handshake, map download, start info, 50 inputs a second
+// and decoding every snapshot against the one it acked. once a second the
+// totals are printed: round trip and server side latency, lost snapshots and
+// what the server sent per bot. the server needs sv_max_clients_per_ip set
+// high enough for all bots on one machine
+
+class CBot
+{
+public:
+	enum
+	{
+		STATE_OFFLINE=0,
+		STATE_CONNECTING,
+		STATE_LOADING,
+		STATE_READY,
+		STATE_INGAME,
+	};
+
+	CNetClient m_Net;
+	int m_ID;
+	int m_State;
+
+	// map download, the data isn't kept, only its crc
+	int m_MapCrc;
+	int m_MapSize;
+	int m_MapChunk;
+	int m_MapAmount;
+	unsigned m_MapDataCrc;
+
+	// snapshots
+	CSnapshotStorage m_Storage;
+	unsigned char m_aIncomingData[CSnapshot::MAX_SIZE];
+	char m_aDeltaData[CSnapshot::MAX_SIZE];
+	char m_aSnapData[CSnapshot::MAX_SIZE];
+	unsigned m_SnapshotParts;
+	int m_CurrentRecvTick;
+	int m_AckGameTick;
+	int64 m_LastSnapTime;
+
+	// input
+	int m_aInput[MAX_INPUT_SIZE];
+	int m_PredOffset;
+	int64 m_NextInput;
+	int64 m_NextChange;
+	bool m_HasTarget; // nearest enemy in the last snapshot, for -a
+	int m_TargetX;
+	int m_TargetY;
+
+	// stats, reset every report
+	int m_RecvBytes;
+	int m_Snaps;
+	int m_LostSnaps;
+	int m_CrcErrors;
+	int m_ServerLatency;
+	int m_TimeLeftSum;
+	int m_TimeLeftNum;
+	int64 m_PingSent;
+	int64 m_Rtt;
+
+	CBot()
+	{
+		m_ID = 0;
+		m_State = STATE_OFFLINE;
+		m_MapCrc = 0;
+		m_MapSize = 0;
+		m_MapChunk = 0;
+		m_MapAmount = 0;
+		m_MapDataCrc = 0;
+		m_SnapshotParts = 0;
+		m_CurrentRecvTick = 0;
+		m_AckGameTick = -1;
+		m_LastSnapTime = 0;
+		mem_zero(m_aInput, sizeof(m_aInput));
+		m_PredOffset = 0;
+		m_NextInput = 0;
+		m_NextChange = 0;
+		m_HasTarget = false;
+		m_TargetX = 0;
+		m_TargetY = 0;
+		m_RecvBytes = 0;
+		m_Snaps = 0;
+		m_LostSnaps = 0;
+		m_CrcErrors = 0;
+		m_ServerLatency = 0;
+		m_TimeLeftSum = 0;
+		m_TimeLeftNum = 0;
+		m_PingSent = 0;
+		m_Rtt = 0;
+	}
+};
+
+static CBot *s_pBots = 0;
+static int s_NumBots = 8;
+static int s_Duration = 0;
+static bool s_Idle = false;
+static bool s_Aim = false;
+static NETADDR s_ServerAddr;
+static CSnapshotDelta s_SnapshotDelta;
+static char s_aPassword[128] = {0};
+
+static void SendMsg(CBot *pBot, CMsgPacker *pMsg, int Flags, bool System)
+{
+	CNetChunk Packet;
+	mem_zero(&Packet, sizeof(CNetChunk));
+	Packet.m_ClientID = 0;
+	Packet.m_pData = pMsg->Data();
+	Packet.m_DataSize = pMsg->Size();
+
+	// same hack as the client: the message id carries the system flag
+	*((unsigned char*)Packet.m_pData) <<= 1;
+	if(System)
+		*((unsigned char*)Packet.m_pData) |= 1;
+
+	Packet.m_Flags = Flags;
+	pBot->m_Net.Send(&Packet);
+}
+
+static void SendStartInfo(CBot *pBot)
+{
+	char aName[16];
+	str_format(aName, sizeof(aName), "bot%d", pBot->m_ID);
+
+	CNetMsg_Cl_StartInfo Msg;
+	Msg.m_pName = aName;
+	Msg.m_pClan = "loadgen";
+	Msg.m_Country = -1;
+	Msg.m_pSkin = "default";
+	Msg.m_UseCustomColor = 0;
+	Msg.m_ColorBody = 0;
+	Msg.m_ColorFeet = 0;
+
+	CMsgPacker Packer(Msg.MsgID());
+	if(Msg.Pack(&Packer))
+		return;
+	SendMsg(pBot, &Packer, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, false);
+}
+
+static void UpdateInput(CBot *pBot, int64 Now)
+{
+	CNetObj_PlayerInput *pInput = (CNetObj_PlayerInput *)pBot->m_aInput;
+
+	// the server only fills in the latencies for players looking at the scoreboard
+	pInput->m_PlayerFlags = PLAYERFLAG_PLAYING|PLAYERFLAG_SCOREBOARD;
+	if(s_Aim && pBot->m_HasTarget)
+	{
+		pInput->m_TargetX = pBot->m_TargetX;
+		pInput->m_TargetY = pBot->m_TargetY;
+	}
+	if(s_Idle || Now < pBot->m_NextChange)
+	{
+		// aiming bots keep the trigger down while they have someone to shoot at
+		if(!s_Aim || !pBot->m_HasTarget)
+			pInput->m_Fire &= ~1;
+		return;
+	}
+
+	// a new plan every quarter to full second, roughly what a player does
+	pInput->m_Direction = rand()%3-1;
+	pInput->m_TargetX = rand()%600-300;
+	pInput->m_TargetY = rand()%600-300;
+	pInput->m_Jump = rand()%4 == 0;
+	pInput->m_Hook = rand()%3 == 0;
+	if(rand()%2)
+		pInput->m_Fire = (pInput->m_Fire+1)|1;
+	pInput->m_WantedWeapon = rand()%2 ? WEAPON_HAMMER+1 : WEAPON_RIFLE+1;
+	if(s_Aim && pBot->m_HasTarget)
+	{
+		// close in on the enemy with the rifle out
+		pInput->m_Direction = pBot->m_TargetX < 0 ? -1 : 1;
+		pInput->m_TargetX = pBot->m_TargetX;
+		pInput->m_TargetY = pBot->m_TargetY;
+		pInput->m_WantedWeapon = WEAPON_RIFLE+1;
+	}
+	pBot->m_NextChange = Now + time_freq()/4 + (rand()%(int)(time_freq()*3/4));
+}
+
+static void SendInput(CBot *pBot, int64 Now)
+{
+	// aim a bit ahead of the last snapshot, corrected by the input timing the server reports
+	int PredTick = pBot->m_CurrentRecvTick + (int)((Now-pBot->m_LastSnapTime)*SERVER_TICK_SPEED/time_freq()) + pBot->m_PredOffset;
+
+	CMsgPacker Msg(NETMSG_INPUT);
+	Msg.AddInt(pBot->m_AckGameTick);
+	Msg.AddInt(PredTick);
+	Msg.AddInt(sizeof(CNetObj_PlayerInput));
+	for(unsigned i = 0; i < sizeof(CNetObj_PlayerInput)/sizeof(int); i++)
+		Msg.AddInt(pBot->m_aInput[i]);
+	SendMsg(pBot, &Msg, NETSENDFLAG_FLUSH, true);
+}
+
+static void OnSnapshot(CBot *pBot, CSnapshot *pSnap, int Size)
+{
+	// the server side latency is in our own player info
+	int LocalID = -1;
+	int aTeams[MAX_CLIENTS];
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		aTeams[i] = TEAM_SPECTATORS;
+	for(int i = 0; i < pSnap->NumItems(); i++)
+	{
+		CSnapshotItem *pItem = pSnap->GetItem(i);
+		if(pItem->Type() != NETOBJTYPE_PLAYERINFO)
+			continue;
+		const CNetObj_PlayerInfo *pInfo = (const CNetObj_PlayerInfo *)pItem->Data();
+		if(pInfo->m_ClientID >= 0 && pInfo->m_ClientID < MAX_CLIENTS)
+			aTeams[pInfo->m_ClientID] = pInfo->m_Team;
+		if(pInfo->m_Local)
+		{
+			pBot->m_ServerLatency = pInfo->m_Latency;
+			LocalID = pInfo->m_ClientID;
+		}
+	}
+
+	// aim at the nearest enemy, so the bots actually get into fights
+	pBot->m_HasTarget = false;
+	if(!s_Aim || LocalID < 0 || LocalID >= MAX_CLIENTS)
+		return;
+	int LocalIndex = pSnap->GetItemIndex((NETOBJTYPE_CHARACTER<<16)|LocalID);
+	if(LocalIndex < 0)
+		return;
+	const CNetObj_Character *pLocal = (const CNetObj_Character *)pSnap->GetItem(LocalIndex)->Data();
+	int BestDist = 0;
+	for(int i = 0; i < pSnap->NumItems(); i++)
+	{
+		CSnapshotItem *pItem = pSnap->GetItem(i);
+		if(pItem->Type() != NETOBJTYPE_CHARACTER || pItem->ID() < 0 || pItem->ID() >= MAX_CLIENTS ||
+			pItem->ID() == LocalID || (aTeams[LocalID] != TEAM_SPECTATORS && aTeams[pItem->ID()] == aTeams[LocalID]))
+			continue;
+		const CNetObj_Character *pChr = (const CNetObj_Character *)pItem->Data();
+		int Dx = pChr->m_X-pLocal->m_X;
+		int Dy = pChr->m_Y-pLocal->m_Y;
+		int Dist = Dx*Dx+Dy*Dy;
+		if(!pBot->m_HasTarget || Dist < BestDist)
+		{
+			pBot->m_HasTarget = true;
+			pBot->m_TargetX = Dx;
+			pBot->m_TargetY = Dy;
+			BestDist = Dist;
+		}
+	}
+}
+
+static void ProcessSnap(CBot *pBot, int Msg, CUnpacker *pUnpacker)
+{
+	int NumParts = 1;
+	int Part = 0;
+	int GameTick = pUnpacker->GetInt();
+	int DeltaTick = GameTick-pUnpacker->GetInt();
+	int PartSize = 0;
+	int Crc = 0;
+
+	if(pBot->m_State < CBot::STATE_LOADING)
+		return;
+
+	if(Msg == NETMSG_SNAP)
+	{
+		NumParts = pUnpacker->GetInt();
+		Part = pUnpacker->GetInt();
+	}
+	if(Msg != NETMSG_SNAPEMPTY)
+	{
+		Crc = pUnpacker->GetInt();
+		PartSize = pUnpacker->GetInt();
+	}
+	const char *pData = (const char *)pUnpacker->GetRaw(PartSize);
+	if(pUnpacker->Error() || NumParts < 1 || NumParts > 32 || Part < 0 || Part >= NumParts ||
+		PartSize < 0 || (Part+1)*MAX_SNAPSHOT_PACKSIZE > CSnapshot::MAX_SIZE)
+		return;
+
+	if(GameTick < pBot->m_CurrentRecvTick)
+		return;
+	if(GameTick != pBot->m_CurrentRecvTick)
+	{
+		if(pBot->m_SnapshotParts)
+			pBot->m_LostSnaps++;
+		pBot->m_SnapshotParts = 0;
+		pBot->m_CurrentRecvTick = GameTick;
+	}
+
+	mem_copy(pBot->m_aIncomingData + Part*MAX_SNAPSHOT_PACKSIZE, pData, PartSize);
+	pBot->m_SnapshotParts |= 1<<Part;
+	if(pBot->m_SnapshotParts != (unsigned)((1<<NumParts)-1))
+		return;
+	pBot->m_SnapshotParts = 0;
+
+	static CSnapshot Emptysnap;
+	Emptysnap.Clear();
+	CSnapshot *pDeltaShot = &Emptysnap;
+	if(DeltaTick >= 0 && pBot->m_Storage.Get(DeltaTick, 0, &pDeltaShot, 0) < 0)
+	{
+		// the server deltaed against something we don't have, make it resend in full
+		pBot->m_LostSnaps++;
+		pBot->m_AckGameTick = -1;
+		return;
+	}
+
+	void *pDeltaData = s_SnapshotDelta.EmptyDelta();
+	int DeltaSize = sizeof(int)*3;
+	int CompleteSize = (NumParts-1)*MAX_SNAPSHOT_PACKSIZE + PartSize;
+	if(CompleteSize)
+	{
+		DeltaSize = CVariableInt::Decompress(pBot->m_aIncomingData, CompleteSize, pBot->m_aDeltaData);
+		if(DeltaSize < 0)
+			return;
+		pDeltaData = pBot->m_aDeltaData;
+	}
+
+	int SnapCrc;
+	int SnapSize = s_SnapshotDelta.UnpackDelta(pDeltaShot, (CSnapshot *)pBot->m_aSnapData, pDeltaData, DeltaSize, &SnapCrc);
+	if(SnapSize < 0 || (Msg != NETMSG_SNAPEMPTY && SnapCrc != Crc))
+	{
+		pBot->m_CrcErrors++;
+		pBot->m_AckGameTick = -1;
+		return;
+	}
+
+	int PurgeTick = DeltaTick;
+	if(pBot->m_AckGameTick > 0 && pBot->m_AckGameTick < PurgeTick)
+		PurgeTick = pBot->m_AckGameTick;
+	pBot->m_Storage.PurgeUntil(PurgeTick);
+	pBot->m_Storage.Add(GameTick, time_get(), SnapSize, pBot->m_aSnapData, 0);
+
+	pBot->m_AckGameTick = GameTick;
+	pBot->m_LastSnapTime = time_get();
+	pBot->m_Snaps++;
+	OnSnapshot(pBot, (CSnapshot *)pBot->m_aSnapData, SnapSize);
+}
+
+static void ProcessPacket(CBot *pBot, CNetChunk *pPacket)
+{
+	CUnpacker Unpacker;
+	Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+	pBot->m_RecvBytes += pPacket->m_DataSize;
+
+	int Msg = Unpacker.GetInt();
+	int Sys = Msg&1;
+	Msg >>= 1;
+	if(Unpacker.Error())
+		return;
+
+	if(!Sys)
+	{
+		if(Msg == NETMSGTYPE_SV_READYTOENTER && pBot->m_State == CBot::STATE_READY)
+		{
+			CMsgPacker Packer(NETMSG_ENTERGAME);
+			SendMsg(pBot, &Packer, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, true);
+			pBot->m_State = CBot::STATE_INGAME;
+		}
+		return;
+	}
+
+	if(Msg == NETMSG_MAP_CHANGE)
+	{
+		Unpacker.GetString(CUnpacker::SANITIZE_CC);
+		pBot->m_MapCrc = Unpacker.GetInt();
+		pBot->m_MapSize = Unpacker.GetInt();
+		if(Unpacker.Error())
+			return;
+
+		// every bot downloads the map, that's part of the load
+		pBot->m_State = CBot::STATE_LOADING;
+		pBot->m_MapChunk = 0;
+		pBot->m_MapAmount = 0;
+		pBot->m_MapDataCrc = crc32(0L, 0x0, 0);
+		pBot->m_Storage.PurgeAll();
+		pBot->m_CurrentRecvTick = 0;
+		pBot->m_AckGameTick = -1;
+
+		CMsgPacker Packer(NETMSG_REQUEST_MAP_DATA);
+		Packer.AddInt(pBot->m_MapChunk);
+		SendMsg(pBot, &Packer, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, true);
+	}
+	else if(Msg == NETMSG_MAP_DATA)
+	{
+		int Last = Unpacker.GetInt();
+		int MapCrc = Unpacker.GetInt();
+		int Chunk = Unpacker.GetInt();
+		int Size = Unpacker.GetInt();
+		const unsigned char *pData = Unpacker.GetRaw(Size);
+		if(Unpacker.Error() || Size <= 0 || MapCrc != pBot->m_MapCrc || Chunk != pBot->m_MapChunk)
+			return;
+
+		pBot->m_MapDataCrc = crc32(pBot->m_MapDataCrc, pData, Size);
+		pBot->m_MapAmount += Size;
+		if(Last)
+		{
+			if((int)pBot->m_MapDataCrc != pBot->m_MapCrc)
+				dbg_msg("loadgen", "bot %d: map crc mismatch (%08x, expected %08x)", pBot->m_ID, pBot->m_MapDataCrc, pBot->m_MapCrc);
+			CMsgPacker Packer(NETMSG_READY);
+			SendMsg(pBot, &Packer, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, true);
+		}
+		else
+		{
+			CMsgPacker Packer(NETMSG_REQUEST_MAP_DATA);
+			Packer.AddInt(++pBot->m_MapChunk);
+			SendMsg(pBot, &Packer, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, true);
+		}
+	}
+	else if(Msg == NETMSG_CON_READY)
+	{
+		pBot->m_State = CBot::STATE_READY;
+		SendStartInfo(pBot);
+	}
+	else if(Msg == NETMSG_PING)
+	{
+		CMsgPacker Packer(NETMSG_PING_REPLY);
+		SendMsg(pBot, &Packer, 0, true);
+	}
+	else if(Msg == NETMSG_PING_REPLY)
+	{
+		if(pBot->m_PingSent)
+			pBot->m_Rtt = time_get()-pBot->m_PingSent;
+		pBot->m_PingSent = 0;
+	}
+	else if(Msg == NETMSG_INPUTTIMING)
+	{
+		Unpacker.GetInt();
+		int TimeLeft = Unpacker.GetInt();
+		if(Unpacker.Error())
+			return;
+
+		// keep the inputs arriving a little early
+		if(TimeLeft < 0)
+			pBot->m_PredOffset++;
+		else if(TimeLeft > 1000/SERVER_TICK_SPEED*3 && pBot->m_PredOffset > 0)
+			pBot->m_PredOffset--;
+		pBot->m_TimeLeftSum += TimeLeft;
+		pBot->m_TimeLeftNum++;
+	}
+	else if(Msg == NETMSG_SNAP || Msg == NETMSG_SNAPSINGLE || Msg == NETMSG_SNAPEMPTY)
+		ProcessSnap(pBot, Msg, &Unpacker);
+}
+
+static void Connect(CBot *pBot)
+{
+	pBot->m_State = CBot::STATE_CONNECTING;
+	pBot->m_Net.Connect(&s_ServerAddr);
+	pBot->m_SnapshotParts = 0;
+	pBot->m_CurrentRecvTick = 0;
+	pBot->m_AckGameTick = -1;
+	pBot->m_LastSnapTime = time_get();
+	pBot->m_PredOffset = 2;
+	pBot->m_PingSent = 0;
+	pBot->m_Storage.PurgeAll();
+}
+
+static void ResetStats(CBot *pBot)
+{
+	pBot->m_RecvBytes = 0;
+	pBot->m_Snaps = 0;
+	pBot->m_LostSnaps = 0;
+	pBot->m_CrcErrors = 0;
+	pBot->m_TimeLeftSum = 0;
+	pBot->m_TimeLeftNum = 0;
+}
+
+static void Report(int Seconds)
+{
+	int Ingame = 0, Bytes = 0, MaxBytes = 0, Snaps = 0, Lost = 0, CrcErrors = 0;
+	int Latency = 0, MaxLatency = 0, TimeLeft = 0, TimeLeftNum = 0;
+	int64 Rtt = 0, MaxRtt = 0;
+	for(int i = 0; i < s_NumBots; i++)
+	{
+		CBot *pBot = &s_pBots[i];
+		Bytes += pBot->m_RecvBytes;
+		MaxBytes = max(MaxBytes, pBot->m_RecvBytes);
+		Snaps += pBot->m_Snaps;
+		Lost += pBot->m_LostSnaps;
+		CrcErrors += pBot->m_CrcErrors;
+		TimeLeft += pBot->m_TimeLeftSum;
+		TimeLeftNum += pBot->m_TimeLeftNum;
+		if(pBot->m_State == CBot::STATE_INGAME)
+		{
+			Ingame++;
+			Latency += pBot->m_ServerLatency;
+			MaxLatency = max(MaxLatency, pBot->m_ServerLatency);
+			Rtt += pBot->m_Rtt;
+			MaxRtt = max(MaxRtt, pBot->m_Rtt);
+		}
+		ResetStats(pBot);
+	}
+
+	dbg_msg("loadgen", "%ds: %d/%d ingame | rtt avg %.1fms max %.1fms | server latency avg %dms max %dms | input margin %dms | snaps %d lost %d crc errors %d | %d bytes/s per bot, max %d",
+		Seconds, Ingame, s_NumBots,
+		Ingame ? Rtt*1000.0/time_freq()/Ingame : 0.0, MaxRtt*1000.0/time_freq(),
+		Ingame ? Latency/Ingame : 0, MaxLatency,
+		TimeLeftNum ? TimeLeft/TimeLeftNum : 0,
+		Snaps, Lost, CrcErrors, Bytes/max(s_NumBots, 1), MaxBytes);
+}
+
+static int Run()
+{
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_IPV4;
+
+	s_pBots = new CBot[s_NumBots];
+	for(int i = 0; i < s_NumBots; i++)
+	{
+		CBot *pBot = &s_pBots[i];
+		if(!pBot->m_Net.Open(BindAddr, 0))
+		{
+			dbg_msg("loadgen", "couldn't open socket %d, running with %d bots", i, i);
+			s_NumBots = i;
+			break;
+		}
+		pBot->m_ID = i;
+		pBot->m_Storage.Init();
+	}
+
+	// connect gradually, a burst of connects looks like a flood to the server
+	int Connected = 0;
+	int64 NextConnect = time_get();
+	int64 StartTime = time_get();
+	int64 NextReport = StartTime + time_freq();
+
+	while(s_Duration <= 0 || time_get() < StartTime + time_freq()*s_Duration)
+	{
+		int64 Now = time_get();
+		if(Connected < s_NumBots && Now >= NextConnect)
+		{
+			Connect(&s_pBots[Connected++]);
+			NextConnect = Now + time_freq()/20;
+		}
+
+		for(int i = 0; i < Connected; i++)
+		{
+			CBot *pBot = &s_pBots[i];
+			pBot->m_Net.Update();
+
+			if(pBot->m_State != CBot::STATE_OFFLINE && pBot->m_Net.State() == NETSTATE_OFFLINE)
+			{
+				dbg_msg("loadgen", "bot %d: disconnected (%s), reconnecting", i, pBot->m_Net.ErrorString());
+				pBot->m_State = CBot::STATE_OFFLINE;
+				pBot->m_Net.ResetErrorString();
+				Connect(pBot);
+				continue;
+			}
+
+			if(pBot->m_State == CBot::STATE_CONNECTING && pBot->m_Net.State() == NETSTATE_ONLINE)
+			{
+				CMsgPacker Msg(NETMSG_INFO);
+				Msg.AddString(GAME_NETVERSION, 128);
+				Msg.AddString(s_aPassword, 128);
+				SendMsg(pBot, &Msg, NETSENDFLAG_VITAL|NETSENDFLAG_FLUSH, true);
+				pBot->m_State = CBot::STATE_LOADING;
+			}
+
+			CNetChunk Packet;
+			while(pBot->m_Net.Recv(&Packet))
+			{
+				if(!(Packet.m_Flags&NETSENDFLAG_CONNLESS))
+					ProcessPacket(pBot, &Packet);
+			}
+
+			if(pBot->m_State == CBot::STATE_INGAME && Now >= pBot->m_NextInput)
+			{
+				UpdateInput(pBot, Now);
+				SendInput(pBot, Now);
+				pBot->m_NextInput = Now + time_freq()/SERVER_TICK_SPEED;
+
+				if(!pBot->m_PingSent)
+				{
+					CMsgPacker Msg(NETMSG_PING);
+					SendMsg(pBot, &Msg, NETSENDFLAG_FLUSH, true);
+					pBot->m_PingSent = Now;
+				}
+			}
+		}
+
+		if(Now >= NextReport)
+		{
+			Report((int)((Now-StartTime)/time_freq()));
+			NextReport += time_freq();
+		}
+
+		thread_sleep(1);
+	}
+
+	for(int i = 0; i < s_NumBots; i++)
+	{
+		s_pBots[i].m_Net.Disconnect("load test done");
+		s_pBots[i].m_Storage.PurgeAll();
+	}
+	delete[] s_pBots;
+	return 0;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	net_init();
+	CNetBase::Init();
+
+	// the server only sends the size of items it knows the size of. the bots
+	// are vanilla clients, their characters lack the extended core
+	CNetObjHandler NetObjHandler;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		s_SnapshotDelta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+	CNetObj_Character Measure;
+	int Offset = (char *)(&Measure.m_Tick) - (char *)(&Measure);
+	s_SnapshotDelta.SetStaticsize(NETOBJTYPE_CHARACTER, sizeof(CNetObj_Character)-Offset);
+
+	net_host_lookup("localhost", &s_ServerAddr, NETTYPE_IPV4);
+	s_ServerAddr.port = 8303;
+
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-s") == 0 && i+1 < argc) // ignore_convention
+		{
+			if(net_host_lookup(argv[++i], &s_ServerAddr, NETTYPE_IPV4) != 0) // ignore_convention
+			{
+				dbg_msg("loadgen", "couldn't resolve server '%s'", argv[i]); // ignore_convention
+				return -1;
+			}
+			if(!s_ServerAddr.port)
+				s_ServerAddr.port = 8303;
+		}
+		else if(str_comp(argv[i], "-n") == 0 && i+1 < argc) // ignore_convention
+			s_NumBots = clamp(str_toint(argv[++i]), 1, (int)MAX_CLIENTS); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			s_Duration = str_toint(argv[++i]); // ignore_convention
+		else if(str_comp(argv[i], "-p") == 0 && i+1 < argc) // ignore_convention
+			str_copy(s_aPassword, argv[++i], sizeof(s_aPassword)); // ignore_convention
+		else if(str_comp(argv[i], "-i") == 0)
+			s_Idle = true;
+		else if(str_comp(argv[i], "-a") == 0)
+			s_Aim = true;
+		else
+		{
+			dbg_msg("loadgen", "usage: %s [-s server[:port]] [-n bots] [-t seconds] [-p password] [-i (idle bots)] [-a (aim at the nearest player)]", argv[0]); // ignore_convention
+			return -1;
+		}
+	}
+
+	srand((unsigned)time_get());
+	return Run();
+}
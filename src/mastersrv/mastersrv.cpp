@@ -1,6 +1,8 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <base/system.h>
+#include <base/math.h>
+#include <base/tl/array.h>
 
 #include <engine/config.h>
 #include <engine/console.h>
@@ -17,9 +19,10 @@
 enum {
 	MTU = 1400,
 	MAX_SERVERS_PER_PACKET=75,
-	MAX_PACKETS=16,
-	MAX_SERVERS=MAX_SERVERS_PER_PACKET*MAX_PACKETS,
-	EXPIRE_TIME = 90
+	EXPIRE_TIME = 90,
+	CHECK_RETRY_TIME = 5,
+	EXPIRE_WHEEL_SIZE = 128, // in seconds, must be larger than EXPIRE_TIME
+	SERVER_HASH_SIZE = 4096,
 };
 
 struct CCheckServer
@@ -29,45 +32,55 @@ struct CCheckServer
 	NETADDR m_AltAddress;
 	int m_TryCount;
 	int64 m_TryTime;
+
+	CCheckServer *m_apHashNext[2]; // chained by address and by alt address
+	CCheckServer *m_pPrev;
+	CCheckServer *m_pNext;
 };
 
-static CCheckServer m_aCheckServers[MAX_SERVERS];
-static int m_NumCheckServers = 0;
+static CCheckServer *m_apCheckHash[2][SERVER_HASH_SIZE] = {{0}};
+static CCheckServer *m_pFirstCheckServer = 0;
+static CCheckServer *m_pFreeCheckServers = 0;
 
 struct CServerEntry
 {
 	enum ServerType m_Type;
 	NETADDR m_Address;
-	int64 m_Expire;
+	int64 m_ExpireSec;
+	int m_Slot; // position in the list of its type
+
+	CServerEntry *m_pHashNext;
+	CServerEntry *m_pWheelPrev;
+	CServerEntry *m_pWheelNext;
 };
 
-static CServerEntry m_aServers[MAX_SERVERS];
+// registered servers, looked up by address and expired by a wheel with one second slots
+static CServerEntry *m_apServerHash[SERVER_HASH_SIZE] = {0};
+static CServerEntry *m_apExpireWheel[EXPIRE_WHEEL_SIZE] = {0};
+static int64 m_LastPurgeSec = 0;
+static bool m_PurgeStarted = false;
+static CServerEntry *m_pFreeServers = 0;
 static int m_NumServers = 0;
 
 struct CPacketData
 {
 	int m_Size;
-	struct {
-		unsigned char m_aHeader[sizeof(SERVERBROWSE_LIST)];
-		CMastersrvAddr m_aServers[MAX_SERVERS_PER_PACKET];
-	} m_Data;
+	unsigned char m_aData[sizeof(SERVERBROWSE_LIST)+sizeof(CMastersrvAddr)*MAX_SERVERS_PER_PACKET];
 };
 
-CPacketData m_aPackets[MAX_PACKETS];
-static int m_NumPackets = 0;
-
-// legacy code
-struct CPacketDataLegacy
+// the serialized list of one server type, kept up to date on every add and remove.
+// a server's slot maps directly to its position in the packets, removing one moves
+// the last server into the hole, so at most two packets change per update
+struct CServerList
 {
-	int m_Size;
-	struct {
-		unsigned char m_aHeader[sizeof(SERVERBROWSE_LIST_LEGACY)];
-		CMastersrvAddrLegacy m_aServers[MAX_SERVERS_PER_PACKET];
-	} m_Data;
+	const unsigned char *m_pHeader;
+	int m_HeaderSize;
+	int m_AddrSize;
+	array<CServerEntry *> m_apServers;
+	array<CPacketData> m_aPackets;
 };
 
-CPacketDataLegacy m_aPacketsLegacy[MAX_PACKETS];
-static int m_NumPacketsLegacy = 0;
+static CServerList m_aServerLists[2];
 
 
 struct CCountPacketData
@@ -88,84 +101,108 @@ static CNetClient m_NetOp; // main
 
 IConsole *m_pConsole;
 
-void BuildPackets()
+static unsigned HashAddr(const NETADDR *pAddr)
 {
-	CServerEntry *pCurrent = &m_aServers[0];
-	int ServersLeft = m_NumServers;
-	m_NumPackets = 0;
-	m_NumPacketsLegacy = 0;
-	int PacketIndex = 0;
-	int PacketIndexLegacy = 0;
-	while(ServersLeft-- && (m_NumPackets + m_NumPacketsLegacy) < MAX_PACKETS)
-	{
-		if(pCurrent->m_Type == SERVERTYPE_NORMAL)
-		{
-			if(PacketIndex % MAX_SERVERS_PER_PACKET == 0)
-			{
-				PacketIndex = 0;
-				m_NumPackets++;
-			}
-
-			// copy header
-			mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aHeader, SERVERBROWSE_LIST, sizeof(SERVERBROWSE_LIST));
+	unsigned Hash = pAddr->type*31 + pAddr->port;
+	int Len = pAddr->type == NETTYPE_IPV6 ? 16 : 4;
+	for(int i = 0; i < Len; i++)
+		Hash = Hash*31 + pAddr->ip[i];
+	return (Hash^(Hash>>16))%SERVER_HASH_SIZE;
+}
 
-			// copy server addresses
-			if(pCurrent->m_Address.type == NETTYPE_IPV6)
-			{
-				mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp, pCurrent->m_Address.ip,
-					sizeof(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp));
-			}
-			else
-			{
-				static char IPV4Mapping[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
+static void WriteSlot(CServerList *pList, int Slot)
+{
+	const CServerEntry *pEntry = pList->m_apServers[Slot];
+	unsigned char *pAddr = pList->m_aPackets[Slot/MAX_SERVERS_PER_PACKET].m_aData + pList->m_HeaderSize +
+		pList->m_AddrSize*(Slot%MAX_SERVERS_PER_PACKET);
 
-				mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp, IPV4Mapping, sizeof(IPV4Mapping));
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[12] = pCurrent->m_Address.ip[0];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[13] = pCurrent->m_Address.ip[1];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[14] = pCurrent->m_Address.ip[2];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[15] = pCurrent->m_Address.ip[3];
-			}
+	if(pEntry->m_Type == SERVERTYPE_NORMAL)
+	{
+		CMastersrvAddr *pOut = (CMastersrvAddr *)pAddr;
+		if(pEntry->m_Address.type == NETTYPE_IPV6)
+			mem_copy(pOut->m_aIp, pEntry->m_Address.ip, sizeof(pOut->m_aIp));
+		else
+		{
+			static char IPV4Mapping[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
 
-			m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aPort[0] = (pCurrent->m_Address.port>>8)&0xff;
-			m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aPort[1] = pCurrent->m_Address.port&0xff;
+			mem_copy(pOut->m_aIp, IPV4Mapping, sizeof(IPV4Mapping));
+			pOut->m_aIp[12] = pEntry->m_Address.ip[0];
+			pOut->m_aIp[13] = pEntry->m_Address.ip[1];
+			pOut->m_aIp[14] = pEntry->m_Address.ip[2];
+			pOut->m_aIp[15] = pEntry->m_Address.ip[3];
+		}
 
-			PacketIndex++;
+		pOut->m_aPort[0] = (pEntry->m_Address.port>>8)&0xff;
+		pOut->m_aPort[1] = pEntry->m_Address.port&0xff;
+	}
+	else
+	{
+		CMastersrvAddrLegacy *pOut = (CMastersrvAddrLegacy *)pAddr;
+		mem_copy(pOut->m_aIp, pEntry->m_Address.ip, sizeof(pOut->m_aIp));
+		// 0.5 has the port in little endian on the network
+		pOut->m_aPort[0] = pEntry->m_Address.port&0xff;
+		pOut->m_aPort[1] = (pEntry->m_Address.port>>8)&0xff;
+	}
+}
 
-			m_aPackets[m_NumPackets-1].m_Size = sizeof(SERVERBROWSE_LIST) + sizeof(CMastersrvAddr)*PacketIndex;
+static void ListAdd(CServerEntry *pEntry)
+{
+	CServerList *pList = &m_aServerLists[pEntry->m_Type];
+	pEntry->m_Slot = pList->m_apServers.add(pEntry);
 
-			pCurrent++;
-		}
-		else if(pCurrent->m_Type == SERVERTYPE_LEGACY)
-		{
-			if(PacketIndexLegacy % MAX_SERVERS_PER_PACKET == 0)
-			{
-				PacketIndexLegacy = 0;
-				m_NumPacketsLegacy++;
-			}
+	int Index = pEntry->m_Slot%MAX_SERVERS_PER_PACKET;
+	if(Index == 0)
+	{
+		CPacketData Packet;
+		mem_copy(Packet.m_aData, pList->m_pHeader, pList->m_HeaderSize);
+		pList->m_aPackets.add(Packet);
+	}
+	pList->m_aPackets[pEntry->m_Slot/MAX_SERVERS_PER_PACKET].m_Size = pList->m_HeaderSize + pList->m_AddrSize*(Index+1);
+	WriteSlot(pList, pEntry->m_Slot);
+}
 
-			// copy header
-			mem_copy(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aHeader, SERVERBROWSE_LIST_LEGACY, sizeof(SERVERBROWSE_LIST_LEGACY));
+static void ListRemove(CServerEntry *pEntry)
+{
+	CServerList *pList = &m_aServerLists[pEntry->m_Type];
+	int Last = pList->m_apServers.size()-1;
+	if(pEntry->m_Slot != Last)
+	{
+		pList->m_apServers[pEntry->m_Slot] = pList->m_apServers[Last];
+		pList->m_apServers[pEntry->m_Slot]->m_Slot = pEntry->m_Slot;
+		WriteSlot(pList, pEntry->m_Slot);
+	}
+	pList->m_apServers.set_size(Last);
 
-			// copy server addresses
-			mem_copy(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aIp, pCurrent->m_Address.ip,
-				sizeof(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aIp));
-			// 0.5 has the port in little endian on the network
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aPort[0] = pCurrent->m_Address.port&0xff;
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aPort[1] = (pCurrent->m_Address.port>>8)&0xff;
+	int Index = Last%MAX_SERVERS_PER_PACKET;
+	if(Index == 0)
+		pList->m_aPackets.set_size(pList->m_aPackets.size()-1);
+	else
+		pList->m_aPackets[Last/MAX_SERVERS_PER_PACKET].m_Size = pList->m_HeaderSize + pList->m_AddrSize*Index;
+}
 
-			PacketIndexLegacy++;
+static CServerEntry **WheelSlot(int64 Sec)
+{
+	return &m_apExpireWheel[((Sec%EXPIRE_WHEEL_SIZE)+EXPIRE_WHEEL_SIZE)%EXPIRE_WHEEL_SIZE];
+}
 
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Size = sizeof(SERVERBROWSE_LIST_LEGACY) + sizeof(CMastersrvAddrLegacy)*PacketIndexLegacy;
+static void WheelLink(CServerEntry *pEntry)
+{
+	CServerEntry **ppSlot = WheelSlot(pEntry->m_ExpireSec);
+	pEntry->m_pWheelPrev = 0;
+	pEntry->m_pWheelNext = *ppSlot;
+	if(*ppSlot)
+		(*ppSlot)->m_pWheelPrev = pEntry;
+	*ppSlot = pEntry;
+}
 
-			pCurrent++;
-		}
-		else
-		{
-			*pCurrent = m_aServers[m_NumServers-1];
-			m_NumServers--;
-			dbg_msg("mastersrv", "error: server of invalid type, dropping it");
-		}
-	}
+static void WheelUnlink(CServerEntry *pEntry)
+{
+	if(pEntry->m_pWheelPrev)
+		pEntry->m_pWheelPrev->m_pWheelNext = pEntry->m_pWheelNext;
+	else
+		*WheelSlot(pEntry->m_ExpireSec) = pEntry->m_pWheelNext;
+	if(pEntry->m_pWheelNext)
+		pEntry->m_pWheelNext->m_pWheelPrev = pEntry->m_pWheelPrev;
 }
 
 void SendOk(NETADDR *pAddr)
@@ -204,89 +241,161 @@ void SendCheck(NETADDR *pAddr)
 	m_NetChecker.Send(&p);
 }
 
-void AddCheckserver(NETADDR *pInfo, NETADDR *pAlt, ServerType Type)
+static CCheckServer *FindCheckserver(const NETADDR *pAddr)
 {
-	// add server
-	if(m_NumCheckServers == MAX_SERVERS)
+	for(CCheckServer *pCheck = m_apCheckHash[0][HashAddr(pAddr)]; pCheck; pCheck = pCheck->m_apHashNext[0])
+		if(net_addr_comp(&pCheck->m_Address, pAddr) == 0)
+			return pCheck;
+	for(CCheckServer *pCheck = m_apCheckHash[1][HashAddr(pAddr)]; pCheck; pCheck = pCheck->m_apHashNext[1])
+		if(net_addr_comp(&pCheck->m_AltAddress, pAddr) == 0)
+			return pCheck;
+	return 0;
+}
+
+static void RemoveCheckserver(CCheckServer *pCheck)
+{
+	for(int h = 0; h < 2; h++)
 	{
-		dbg_msg("mastersrv", "error: mastersrv is full");
-		return;
+		CCheckServer **ppLink = &m_apCheckHash[h][HashAddr(h == 0 ? &pCheck->m_Address : &pCheck->m_AltAddress)];
+		while(*ppLink != pCheck)
+			ppLink = &(*ppLink)->m_apHashNext[h];
+		*ppLink = pCheck->m_apHashNext[h];
 	}
 
+	if(pCheck->m_pPrev)
+		pCheck->m_pPrev->m_pNext = pCheck->m_pNext;
+	else
+		m_pFirstCheckServer = pCheck->m_pNext;
+	if(pCheck->m_pNext)
+		pCheck->m_pNext->m_pPrev = pCheck->m_pPrev;
+
+	pCheck->m_pNext = m_pFreeCheckServers;
+	m_pFreeCheckServers = pCheck;
+}
+
+void AddCheckserver(NETADDR *pInfo, NETADDR *pAlt, ServerType Type)
+{
+	// a check for this server is already running
+	for(CCheckServer *pCheck = m_apCheckHash[0][HashAddr(pInfo)]; pCheck; pCheck = pCheck->m_apHashNext[0])
+		if(net_addr_comp(&pCheck->m_Address, pInfo) == 0)
+			return;
+
 	char aAddrStr[NETADDR_MAXSTRSIZE];
 	net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
 	char aAltAddrStr[NETADDR_MAXSTRSIZE];
 	net_addr_str(pAlt, aAltAddrStr, sizeof(aAltAddrStr), true);
 	dbg_msg("mastersrv", "checking: %s (%s)", aAddrStr, aAltAddrStr);
-	m_aCheckServers[m_NumCheckServers].m_Address = *pInfo;
-	m_aCheckServers[m_NumCheckServers].m_AltAddress = *pAlt;
-	m_aCheckServers[m_NumCheckServers].m_TryCount = 0;
-	m_aCheckServers[m_NumCheckServers].m_TryTime = 0;
-	m_aCheckServers[m_NumCheckServers].m_Type = Type;
-	m_NumCheckServers++;
+
+	CCheckServer *pCheck = m_pFreeCheckServers;
+	if(pCheck)
+		m_pFreeCheckServers = pCheck->m_pNext;
+	else
+		pCheck = new CCheckServer;
+	pCheck->m_Address = *pInfo;
+	pCheck->m_AltAddress = *pAlt;
+	pCheck->m_TryCount = 0;
+	pCheck->m_TryTime = 0;
+	pCheck->m_Type = Type;
+
+	for(int h = 0; h < 2; h++)
+	{
+		CCheckServer **ppBucket = &m_apCheckHash[h][HashAddr(h == 0 ? pInfo : pAlt)];
+		pCheck->m_apHashNext[h] = *ppBucket;
+		*ppBucket = pCheck;
+	}
+
+	pCheck->m_pPrev = 0;
+	pCheck->m_pNext = m_pFirstCheckServer;
+	if(m_pFirstCheckServer)
+		m_pFirstCheckServer->m_pPrev = pCheck;
+	m_pFirstCheckServer = pCheck;
 }
 
 void AddServer(NETADDR *pInfo, ServerType Type)
 {
+	int64 ExpireSec = time_get()/time_freq()+EXPIRE_TIME;
+
 	// see if server already exists in list
-	for(int i = 0; i < m_NumServers; i++)
+	CServerEntry **ppBucket = &m_apServerHash[HashAddr(pInfo)];
+	for(CServerEntry *pEntry = *ppBucket; pEntry; pEntry = pEntry->m_pHashNext)
 	{
-		if(net_addr_comp(&m_aServers[i].m_Address, pInfo) == 0)
+		if(net_addr_comp(&pEntry->m_Address, pInfo) == 0)
 		{
 			char aAddrStr[NETADDR_MAXSTRSIZE];
 			net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
 			dbg_msg("mastersrv", "updated: %s", aAddrStr);
-			m_aServers[i].m_Expire = time_get()+time_freq()*EXPIRE_TIME;
+			WheelUnlink(pEntry);
+			pEntry->m_ExpireSec = ExpireSec;
+			WheelLink(pEntry);
 			return;
 		}
 	}
 
 	// add server
-	if(m_NumServers == MAX_SERVERS)
-	{
-		dbg_msg("mastersrv", "error: mastersrv is full");
-		return;
-	}
-
 	char aAddrStr[NETADDR_MAXSTRSIZE];
 	net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
 	dbg_msg("mastersrv", "added: %s", aAddrStr);
-	m_aServers[m_NumServers].m_Address = *pInfo;
-	m_aServers[m_NumServers].m_Expire = time_get()+time_freq()*EXPIRE_TIME;
-	m_aServers[m_NumServers].m_Type = Type;
+
+	CServerEntry *pEntry = m_pFreeServers;
+	if(pEntry)
+		m_pFreeServers = pEntry->m_pHashNext;
+	else
+		pEntry = new CServerEntry;
+	pEntry->m_Address = *pInfo;
+	pEntry->m_ExpireSec = ExpireSec;
+	pEntry->m_Type = Type;
+	pEntry->m_pHashNext = *ppBucket;
+	*ppBucket = pEntry;
+	WheelLink(pEntry);
+	ListAdd(pEntry);
 	m_NumServers++;
 }
 
+static void RemoveServer(CServerEntry *pEntry)
+{
+	CServerEntry **ppLink = &m_apServerHash[HashAddr(&pEntry->m_Address)];
+	while(*ppLink != pEntry)
+		ppLink = &(*ppLink)->m_pHashNext;
+	*ppLink = pEntry->m_pHashNext;
+
+	WheelUnlink(pEntry);
+	ListRemove(pEntry);
+	m_NumServers--;
+
+	pEntry->m_pHashNext = m_pFreeServers;
+	m_pFreeServers = pEntry;
+}
+
 void UpdateServers()
 {
 	int64 Now = time_get();
 	int64 Freq = time_freq();
-	for(int i = 0; i < m_NumCheckServers; i++)
+	CCheckServer *pNext;
+	for(CCheckServer *pCheck = m_pFirstCheckServer; pCheck; pCheck = pNext)
 	{
-		if(Now > m_aCheckServers[i].m_TryTime+Freq)
+		pNext = pCheck->m_pNext;
+		if(Now > pCheck->m_TryTime+Freq*CHECK_RETRY_TIME)
 		{
-			if(m_aCheckServers[i].m_TryCount == 10)
+			if(pCheck->m_TryCount == 10)
 			{
 				char aAddrStr[NETADDR_MAXSTRSIZE];
-				net_addr_str(&m_aCheckServers[i].m_Address, aAddrStr, sizeof(aAddrStr), true);
+				net_addr_str(&pCheck->m_Address, aAddrStr, sizeof(aAddrStr), true);
 				char aAltAddrStr[NETADDR_MAXSTRSIZE];
-				net_addr_str(&m_aCheckServers[i].m_AltAddress, aAltAddrStr, sizeof(aAltAddrStr), true);
+				net_addr_str(&pCheck->m_AltAddress, aAltAddrStr, sizeof(aAltAddrStr), true);
 				dbg_msg("mastersrv", "check failed: %s (%s)", aAddrStr, aAltAddrStr);
 
 				// FAIL!!
-				SendError(&m_aCheckServers[i].m_Address);
-				m_aCheckServers[i] = m_aCheckServers[m_NumCheckServers-1];
-				m_NumCheckServers--;
-				i--;
+				SendError(&pCheck->m_Address);
+				RemoveCheckserver(pCheck);
 			}
 			else
 			{
-				m_aCheckServers[i].m_TryCount++;
-				m_aCheckServers[i].m_TryTime = Now;
-				if(m_aCheckServers[i].m_TryCount&1)
-					SendCheck(&m_aCheckServers[i].m_Address);
+				pCheck->m_TryCount++;
+				pCheck->m_TryTime = Now;
+				if(pCheck->m_TryCount&1)
+					SendCheck(&pCheck->m_Address);
 				else
-					SendCheck(&m_aCheckServers[i].m_AltAddress);
+					SendCheck(&pCheck->m_AltAddress);
 			}
 		}
 	}
@@ -294,21 +403,31 @@ void UpdateServers()
 
 void PurgeServers()
 {
-	int64 Now = time_get();
-	int i = 0;
-	while(i < m_NumServers)
+	// only the wheel slots of the seconds that passed since the last purge can hold expired servers
+	int64 NowSec = time_get()/time_freq();
+	if(!m_PurgeStarted || NowSec-m_LastPurgeSec > EXPIRE_WHEEL_SIZE)
 	{
-		if(m_aServers[i].m_Expire < Now)
+		// the clock counts from boot, it can be below the wheel size
+		m_LastPurgeSec = max(NowSec-EXPIRE_WHEEL_SIZE, (int64)0);
+		m_PurgeStarted = true;
+	}
+
+	for(; m_LastPurgeSec < NowSec; m_LastPurgeSec++)
+	{
+		CServerEntry *pEntry = *WheelSlot(m_LastPurgeSec);
+		while(pEntry)
 		{
-			// remove server
-			char aAddrStr[NETADDR_MAXSTRSIZE];
-			net_addr_str(&m_aServers[i].m_Address, aAddrStr, sizeof(aAddrStr), true);
-			dbg_msg("mastersrv", "expired: %s", aAddrStr);
-			m_aServers[i] = m_aServers[m_NumServers-1];
-			m_NumServers--;
+			CServerEntry *pNext = pEntry->m_pWheelNext;
+			if(pEntry->m_ExpireSec <= m_LastPurgeSec)
+			{
+				// remove server
+				char aAddrStr[NETADDR_MAXSTRSIZE];
+				net_addr_str(&pEntry->m_Address, aAddrStr, sizeof(aAddrStr), true);
+				dbg_msg("mastersrv", "expired: %s", aAddrStr);
+				RemoveServer(pEntry);
+			}
+			pEntry = pNext;
 		}
-		else
-			i++;
 	}
 }
 
@@ -320,7 +439,7 @@ void ReloadBans()
 
 int main(int argc, const char **argv) // ignore_convention
 {
-	int64 LastBuild = 0, LastBanReload = 0;
+	int64 LastBanReload = 0;
 	ServerType Type = SERVERTYPE_INVALID;
 	NETADDR BindAddr;
 
@@ -330,6 +449,13 @@ int main(int argc, const char **argv) // ignore_convention
 	mem_copy(m_CountData.m_Header, SERVERBROWSE_COUNT, sizeof(SERVERBROWSE_COUNT));
 	mem_copy(m_CountDataLegacy.m_Header, SERVERBROWSE_COUNT_LEGACY, sizeof(SERVERBROWSE_COUNT_LEGACY));
 
+	m_aServerLists[SERVERTYPE_NORMAL].m_pHeader = SERVERBROWSE_LIST;
+	m_aServerLists[SERVERTYPE_NORMAL].m_HeaderSize = sizeof(SERVERBROWSE_LIST);
+	m_aServerLists[SERVERTYPE_NORMAL].m_AddrSize = sizeof(CMastersrvAddr);
+	m_aServerLists[SERVERTYPE_LEGACY].m_pHeader = SERVERBROWSE_LIST_LEGACY;
+	m_aServerLists[SERVERTYPE_LEGACY].m_HeaderSize = sizeof(SERVERBROWSE_LIST_LEGACY);
+	m_aServerLists[SERVERTYPE_LEGACY].m_AddrSize = sizeof(CMastersrvAddrLegacy);
+
 	IKernel *pKernel = IKernel::Create();
 	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_BASIC, argc, argv);
 	IConfig *pConfig = CreateConfig();
@@ -458,10 +584,11 @@ int main(int argc, const char **argv) // ignore_convention
 				p.m_Address = Packet.m_Address;
 				p.m_Flags = NETSENDFLAG_CONNLESS;
 
-				for(int i = 0; i < m_NumPackets; i++)
+				const CServerList *pList = &m_aServerLists[SERVERTYPE_NORMAL];
+				for(int i = 0; i < pList->m_aPackets.size(); i++)
 				{
-					p.m_DataSize = m_aPackets[i].m_Size;
-					p.m_pData = &m_aPackets[i].m_Data;
+					p.m_DataSize = pList->m_aPackets[i].m_Size;
+					p.m_pData = pList->m_aPackets[i].m_aData;
 					m_NetOp.Send(&p);
 				}
 			}
@@ -476,10 +603,11 @@ int main(int argc, const char **argv) // ignore_convention
 				p.m_Address = Packet.m_Address;
 				p.m_Flags = NETSENDFLAG_CONNLESS;
 
-				for(int i = 0; i < m_NumPacketsLegacy; i++)
+				const CServerList *pList = &m_aServerLists[SERVERTYPE_LEGACY];
+				for(int i = 0; i < pList->m_aPackets.size(); i++)
 				{
-					p.m_DataSize = m_aPacketsLegacy[i].m_Size;
-					p.m_pData = &m_aPacketsLegacy[i].m_Data;
+					p.m_DataSize = pList->m_aPackets[i].m_Size;
+					p.m_pData = pList->m_aPackets[i].m_aData;
 					m_NetOp.Send(&p);
 				}
 			}
@@ -497,16 +625,11 @@ int main(int argc, const char **argv) // ignore_convention
 			{
 				Type = SERVERTYPE_INVALID;
 				// remove it from checking
-				for(int i = 0; i < m_NumCheckServers; i++)
+				CCheckServer *pCheck = FindCheckserver(&Packet.m_Address);
+				if(pCheck)
 				{
-					if(net_addr_comp(&m_aCheckServers[i].m_Address, &Packet.m_Address) == 0 ||
-						net_addr_comp(&m_aCheckServers[i].m_AltAddress, &Packet.m_Address) == 0)
-					{
-						Type = m_aCheckServers[i].m_Type;
-						m_NumCheckServers--;
-						m_aCheckServers[i] = m_aCheckServers[m_NumCheckServers];
-						break;
-					}
+					Type = pCheck->m_Type;
+					RemoveCheckserver(pCheck);
 				}
 
 				// drops servers that were not in the CheckServers list
@@ -525,14 +648,10 @@ int main(int argc, const char **argv) // ignore_convention
 			ReloadBans();
 		}
 
-		if(time_get()-LastBuild > time_freq()*5)
-		{
-			LastBuild = time_get();
-
-			PurgeServers();
-			UpdateServers();
-			BuildPackets();
-		}
+		// the list packets are kept up to date as servers come and go, and checks
+		// are sent as they become due instead of in one burst every few seconds
+		PurgeServers();
+		UpdateServers();
 
 		// be nice to the CPU
 		thread_sleep(1);
@@ -0,0 +1,475 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/array.h>
+#include <base/tl/algorithm.h>
+
+#include <engine/config.h>
+#include <engine/console.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/server.h>
+#include <engine/storage.h>
+
+#include <engine/shared/config.h>
+#include <engine/shared/inputrecord.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+
+// runs the game logic headless on input recorded with sv_input_record. the
+// server below does what CServer does around the game, minus the network:
+// it plays the recorded calls back in order, snaps every tick and reports how
+// long the ticks took, how big the snapshots got and a hash of the world
+// after every tick. two runs of the same recording have to give the same
+// hashes, -o writes them out and -c compares against such a file
+
+class CReplayServer : public IServer
+{
+public:
+	enum
+	{
+		STATE_EMPTY=0,
+		STATE_READY,
+		STATE_INGAME,
+	};
+
+	struct CClient
+	{
+		int m_State;
+		char m_aName[MAX_NAME_LENGTH];
+		char m_aClan[MAX_CLAN_LENGTH];
+		int m_Country;
+		int m_MsgBytes;
+	};
+	CClient m_aClients[MAX_CLIENTS];
+
+	CSnapshotBuilder m_SnapshotBuilder;
+	CSnapshotDelta m_SnapshotDelta;
+
+	// snap ids are handed out again in the order they were freed
+	array<int> m_aFreeIDs;
+	int m_NextID;
+
+	CReplayServer()
+	{
+		m_CurrentGameTick = 0;
+		m_TickSpeed = SERVER_TICK_SPEED;
+		m_NextID = 0;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			m_aClients[i].m_State = STATE_EMPTY;
+			m_aClients[i].m_aName[0] = 0;
+			m_aClients[i].m_aClan[0] = 0;
+			m_aClients[i].m_Country = -1;
+			m_aClients[i].m_MsgBytes = 0;
+		}
+	}
+
+	void SetTick(int Tick) { m_CurrentGameTick = Tick; }
+
+	virtual int MaxClients() const { return MAX_CLIENTS; }
+
+	virtual const char *ClientName(int ClientID)
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == STATE_EMPTY)
+			return "(invalid)";
+		return m_aClients[ClientID].m_State == STATE_INGAME ? m_aClients[ClientID].m_aName : "(connecting)";
+	}
+
+	virtual const char *ClientClan(int ClientID)
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State != STATE_INGAME)
+			return "";
+		return m_aClients[ClientID].m_aClan;
+	}
+
+	virtual int ClientCountry(int ClientID)
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State != STATE_INGAME)
+			return -1;
+		return m_aClients[ClientID].m_Country;
+	}
+
+	virtual bool ClientIngame(int ClientID)
+	{
+		return ClientID >= 0 && ClientID < MAX_CLIENTS && m_aClients[ClientID].m_State == STATE_INGAME;
+	}
+
+	virtual int GetClientInfo(int ClientID, CClientInfo *pInfo)
+	{
+		if(!ClientIngame(ClientID))
+			return 0;
+		pInfo->m_pName = m_aClients[ClientID].m_aName;
+		pInfo->m_Latency = 0;
+		pInfo->m_CustClt = false;
+		return 1;
+	}
+
+	virtual void GetClientAddr(int ClientID, char *pAddrStr, int Size)
+	{
+		str_format(pAddrStr, Size, "replay:%d", ClientID);
+	}
+
+	virtual int ClientSendBufferFree(int ClientID) { return 1024*1024; }
+
+	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
+	{
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if((ClientID == -1 || ClientID == i) && m_aClients[i].m_State == STATE_INGAME)
+				m_aClients[i].m_MsgBytes += pMsg->Size();
+		return 0;
+	}
+
+	virtual void SetClientName(int ClientID, const char *pName) { str_copy(m_aClients[ClientID].m_aName, pName, MAX_NAME_LENGTH); }
+	virtual void SetClientClan(int ClientID, const char *pClan) { str_copy(m_aClients[ClientID].m_aClan, pClan, MAX_CLAN_LENGTH); }
+	virtual void SetClientCountry(int ClientID, int Country) { m_aClients[ClientID].m_Country = Country; }
+	virtual void SetClientScore(int ClientID, int Score) {}
+
+	virtual int SnapNewID()
+	{
+		if(m_aFreeIDs.size())
+		{
+			int ID = m_aFreeIDs[0];
+			m_aFreeIDs.remove_index(0);
+			return ID;
+		}
+		return m_NextID++;
+	}
+
+	virtual void SnapFreeID(int ID) { m_aFreeIDs.add(ID); }
+
+	virtual void *SnapNewItem(int Type, int ID, int Size)
+	{
+		dbg_assert(Type >= 0 && Type <=0xffff, "incorrect type");
+		dbg_assert(ID >= 0 && ID <=0xffff, "incorrect id");
+		return ID < 0 ? 0 : m_SnapshotBuilder.NewItem(Type, ID, Size);
+	}
+
+	virtual void SnapSetStaticsize(int ItemType, int Size) { m_SnapshotDelta.SetStaticsize(ItemType, Size); }
+	virtual int SnapDetail(int ClientID) { return 0; }
+
+	virtual void SetRconCID(int ClientID) {}
+	virtual bool IsAuthed(int ClientID) { return false; }
+	virtual void Kick(int ClientID, const char *pReason) {} // the recording has the drop
+
+	virtual void DemoRecorder_HandleAutoStart() {}
+	virtual bool DemoRecorder_IsRecording() { return false; }
+};
+
+struct CTickResult
+{
+	int m_Tick;
+	unsigned m_Hash;
+	int m_SnapSize;
+};
+
+static int64 Percentile(const array<int64> &aSorted, int Permille)
+{
+	if(!aSorted.size())
+		return 0;
+	return aSorted[min(aSorted.size()-1, aSorted.size()*Permille/1000)];
+}
+
+static double Us(int64 Ticks)
+{
+	return Ticks*1000000.0/time_freq();
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	perf_init();
+
+	const char *pOutFile = 0;
+	const char *pCheckFile = 0;
+	int Arg = 1;
+	for(; Arg+1 < argc; Arg += 2) // ignore_convention
+	{
+		if(str_comp(argv[Arg], "-o") == 0) // ignore_convention
+			pOutFile = argv[Arg+1]; // ignore_convention
+		else if(str_comp(argv[Arg], "-c") == 0) // ignore_convention
+			pCheckFile = argv[Arg+1]; // ignore_convention
+		else
+			break;
+	}
+	if(Arg >= argc) // ignore_convention
+	{
+		dbg_msg("replay", "usage: %s [-o hashes.txt] [-c hashes.txt] input_record [console commands]", argv[0]); // ignore_convention
+		return 1;
+	}
+	const char *pRecordFile = argv[Arg++]; // ignore_convention
+
+	CReplayServer *pServer = new CReplayServer;
+	IKernel *pKernel = IKernel::Create();
+	IEngineMap *pEngineMap = CreateEngineMap();
+	IGameServer *pGameServer = CreateGameServer();
+	IConsole *pConsole = CreateConsole(CFGFLAG_SERVER);
+	IStorage *pStorage = CreateStorage("OpenFNG", IStorage::STORAGETYPE_SERVER, argc, argv); // ignore_convention
+	IConfig *pConfig = CreateConfig();
+
+	{
+		bool RegisterFail = false;
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IServer*>(pServer));
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IEngineMap*>(pEngineMap)); // register as both
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(static_cast<IMap*>(pEngineMap));
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pGameServer);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConsole);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pStorage);
+		RegisterFail = RegisterFail || !pKernel->RegisterInterface(pConfig);
+		if(RegisterFail)
+			return 1;
+	}
+
+	pConfig->Init();
+	pGameServer->OnConsoleInit();
+
+	// same configs as the server, the recording doesn't know them
+	pConsole->ExecuteFile("autoexec.cfg");
+	pConsole->ExecuteFile("openfng.cfg");
+	if(Arg < argc) // ignore_convention
+		pConsole->ParseArguments(argc-Arg, &argv[Arg]); // ignore_convention
+	pConfig->RestoreStrings();
+
+	CInputPlayer Player;
+	if(Player.Open(pStorage, pRecordFile, IStorage::TYPE_ALL) != 0)
+	{
+		dbg_msg("replay", "could not open input record '%s'", pRecordFile);
+		return 1;
+	}
+
+	char aMapFile[128];
+	str_format(aMapFile, sizeof(aMapFile), "maps/%s.map", Player.Map());
+	if(!pEngineMap->Load(aMapFile))
+	{
+		dbg_msg("replay", "could not load map '%s'", aMapFile);
+		return 1;
+	}
+	if(pEngineMap->Crc() != Player.MapCrc())
+		dbg_msg("replay", "warning: map crc is %08x, the recording was made on %08x", pEngineMap->Crc(), Player.MapCrc());
+	str_copy(g_Config.m_SvMap, Player.Map(), sizeof(g_Config.m_SvMap));
+
+	// rand() is only used for a few cosmetic choices, keep it the same for every run
+	srand(0);
+	pGameServer->OnInit();
+
+	array<CTickResult> aResults;
+	array<int64> aTickTimes;
+	int64 TotalSnapTime = 0;
+	int64 NumSnaps = 0;
+	int64 TotalSnapSize = 0;
+	int64 TotalDeltaSize = 0;
+	int MaxSnapSize = 0;
+	int MaxClients = 0;
+	unsigned TotalHash = 0;
+
+	static char s_aSnapData[CSnapshot::MAX_SIZE];
+	static char s_aDeltaData[CSnapshot::MAX_SIZE];
+	static char s_aaLastSnap[MAX_CLIENTS][CSnapshot::MAX_SIZE];
+	bool aHasLastSnap[MAX_CLIENTS] = {0};
+
+	CInputPlayer::CRecord Record;
+	while(Player.NextRecord(&Record))
+	{
+		// the server only passes on what a client in the right state sent
+		int ClientID = Record.m_ClientID;
+		int State = ClientID >= 0 ? pServer->m_aClients[ClientID].m_State : CReplayServer::STATE_EMPTY;
+		switch(Record.m_Type)
+		{
+		case INPUTRECORD_CONNECTED:
+			pServer->m_aClients[ClientID].m_State = CReplayServer::STATE_READY;
+			pGameServer->OnClientConnected(ClientID);
+			break;
+		case INPUTRECORD_ENTER:
+			pServer->m_aClients[ClientID].m_State = CReplayServer::STATE_INGAME;
+			pGameServer->OnClientEnter(ClientID);
+			break;
+		case INPUTRECORD_DROP:
+			if(State == CReplayServer::STATE_EMPTY)
+				break;
+			pGameServer->OnClientDrop(ClientID, Record.m_pReason);
+			pServer->m_aClients[ClientID].m_State = CReplayServer::STATE_EMPTY;
+			pServer->m_aClients[ClientID].m_aName[0] = 0;
+			pServer->m_aClients[ClientID].m_aClan[0] = 0;
+			pServer->m_aClients[ClientID].m_Country = -1;
+			aHasLastSnap[ClientID] = false;
+			break;
+		case INPUTRECORD_DIRECTINPUT:
+			if(State == CReplayServer::STATE_INGAME)
+				pGameServer->OnClientDirectInput(ClientID, Record.m_aInput);
+			break;
+		case INPUTRECORD_PREDICTEDINPUT:
+			if(State == CReplayServer::STATE_INGAME)
+				pGameServer->OnClientPredictedInput(ClientID, Record.m_aInput);
+			break;
+		case INPUTRECORD_MESSAGE:
+			{
+				CUnpacker Unpacker;
+				Unpacker.Reset(Record.m_pData, Record.m_DataSize);
+				int Msg = Unpacker.GetInt();
+				if(State != CReplayServer::STATE_EMPTY && !Unpacker.Error() && !(Msg&1))
+					pGameServer->OnMessage(Msg>>1, &Unpacker, ClientID);
+			}
+			break;
+		case INPUTRECORD_TICK:
+			{
+				pServer->SetTick(Record.m_Tick);
+
+				int64 Start = time_get();
+				pGameServer->OnTick();
+				aTickTimes.add(time_get()-Start);
+
+				// the whole world, unclipped, is what gets hashed
+				Start = time_get();
+				pGameServer->OnPreSnap();
+				pServer->m_SnapshotBuilder.Init();
+				pGameServer->OnSnap(-1);
+				int Size = pServer->m_SnapshotBuilder.Finish(s_aSnapData);
+				CTickResult Result;
+				Result.m_Tick = Record.m_Tick;
+				Result.m_Hash = (unsigned)((CSnapshot *)s_aSnapData)->Crc() ^ (unsigned)Size;
+				Result.m_SnapSize = 0;
+				TotalHash = TotalHash*31 + Result.m_Hash;
+
+				// and what the clients would be sent on the ticks the server snaps
+				int NumClients = 0;
+				if(g_Config.m_SvHighBandwidth || (Record.m_Tick%2) == 0)
+				{
+					for(int i = 0; i < MAX_CLIENTS; i++)
+					{
+						if(pServer->m_aClients[i].m_State != CReplayServer::STATE_INGAME)
+							continue;
+						NumClients++;
+
+						pServer->m_SnapshotBuilder.Init();
+						pGameServer->OnSnap(i);
+						Size = pServer->m_SnapshotBuilder.Finish(s_aSnapData);
+						CSnapshot *pFrom = aHasLastSnap[i] ? (CSnapshot *)s_aaLastSnap[i] : 0;
+						CSnapshot Empty;
+						Empty.Clear();
+						int DeltaSize = pServer->m_SnapshotDelta.CreateDelta(pFrom ? pFrom : &Empty, (CSnapshot *)s_aSnapData, s_aDeltaData);
+						mem_copy(s_aaLastSnap[i], s_aSnapData, Size);
+						aHasLastSnap[i] = true;
+
+						Result.m_SnapSize += Size;
+						TotalSnapSize += Size;
+						TotalDeltaSize += DeltaSize;
+						MaxSnapSize = max(MaxSnapSize, Size);
+						NumSnaps++;
+					}
+					pGameServer->OnPostSnap();
+				}
+				TotalSnapTime += time_get()-Start;
+				MaxClients = max(MaxClients, NumClients);
+				aResults.add(Result);
+			}
+			break;
+		}
+	}
+
+	if(!aResults.size())
+	{
+		dbg_msg("replay", "no ticks in '%s'", pRecordFile);
+		return 1;
+	}
+
+	// report
+	int64 TotalTickTime = 0;
+	for(int i = 0; i < aTickTimes.size(); i++)
+		TotalTickTime += aTickTimes[i];
+	sort(aTickTimes.all());
+
+	dbg_msg("replay", "map '%s', %d ticks, up to %d clients", Player.Map(), aResults.size(), MaxClients);
+	dbg_msg("replay", "tick time: avg %.1fus, p50 %.1fus, p90 %.1fus, p99 %.1fus, p99.9 %.1fus, max %.1fus",
+		Us(TotalTickTime)/aTickTimes.size(), Us(Percentile(aTickTimes, 500)), Us(Percentile(aTickTimes, 900)),
+		Us(Percentile(aTickTimes, 990)), Us(Percentile(aTickTimes, 999)), Us(aTickTimes[aTickTimes.size()-1]));
+	dbg_msg("replay", "snap time: avg %.1fus per tick", Us(TotalSnapTime)/aResults.size());
+	if(NumSnaps)
+		dbg_msg("replay", "snapshots: %d, avg %d bytes, max %d bytes, avg delta %d bytes",
+			(int)NumSnaps, (int)(TotalSnapSize/NumSnaps), MaxSnapSize, (int)(TotalDeltaSize/NumSnaps));
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(pServer->m_aClients[i].m_MsgBytes)
+			dbg_msg("replay", "messages to client %d: %d bytes", i, pServer->m_aClients[i].m_MsgBytes);
+	dbg_msg("replay", "state hash %08x", TotalHash);
+
+	int Ret = 0;
+	if(pOutFile)
+	{
+		IOHANDLE File = io_open(pOutFile, IOFLAG_WRITE);
+		if(File)
+		{
+			for(int i = 0; i < aResults.size(); i++)
+			{
+				char aLine[64];
+				str_format(aLine, sizeof(aLine), "%d %08x %d\n", aResults[i].m_Tick, aResults[i].m_Hash, aResults[i].m_SnapSize);
+				io_write(File, aLine, str_length(aLine));
+			}
+			io_close(File);
+		}
+		else
+			dbg_msg("replay", "could not write '%s'", pOutFile);
+	}
+
+	if(pCheckFile)
+	{
+		IOHANDLE File = io_open(pCheckFile, IOFLAG_READ);
+		if(!File)
+		{
+			dbg_msg("replay", "could not read '%s'", pCheckFile);
+			Ret = 1;
+		}
+		else
+		{
+			// compare tick by tick, the first difference is where to start looking
+			int Length = (int)io_length(File);
+			char *pData = (char *)mem_alloc(Length+1, 1);
+			io_read(File, pData, Length);
+			pData[Length] = 0;
+			io_close(File);
+
+			const char *pLine = pData;
+			int i = 0;
+			for(; i < aResults.size() && *pLine; i++)
+			{
+				int Tick = atoi(pLine);
+				while(*pLine && *pLine != ' ')
+					pLine++;
+				unsigned Hash = (unsigned)strtoul(pLine, 0, 16);
+				while(*pLine && *pLine != '\n')
+					pLine++;
+				if(*pLine)
+					pLine++;
+
+				if(Tick != aResults[i].m_Tick || Hash != aResults[i].m_Hash)
+				{
+					dbg_msg("replay", "state differs at tick %d (%08x, expected %08x at tick %d)", aResults[i].m_Tick, aResults[i].m_Hash, Hash, Tick);
+					Ret = 1;
+					break;
+				}
+			}
+			if(!Ret && (i != aResults.size() || *pLine))
+			{
+				dbg_msg("replay", "number of ticks differs");
+				Ret = 1;
+			}
+			if(!Ret)
+				dbg_msg("replay", "state matches '%s'", pCheckFile);
+			mem_free(pData);
+		}
+	}
+
+	pGameServer->OnShutdown();
+	pEngineMap->Unload();
+
+	delete pKernel;
+	delete pGameServer;
+	delete pEngineMap;
+	delete pConsole;
+	delete pStorage;
+	delete pConfig;
+	delete pServer;
+	return Ret;
+}
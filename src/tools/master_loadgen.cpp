@@ -0,0 +1,251 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/shared/network.h>
+#include <mastersrv/mastersrv.h>
+
+#if defined(CONF_FAMILY_UNIX)
+	#include <sys/resource.h>
+	#include <sys/socket.h>
+#endif
+
+// simulates a lot of game servers heartbeating against a masterserver and
+// periodically checks that the master lists all of them
+
+struct CFakeServer
+{
+	NETSOCKET m_Socket;
+	int64 m_NextHeartbeat;
+	bool m_Registered;
+};
+
+static CFakeServer *s_pServers = 0;
+static int s_NumServers = 10000;
+static int s_Interval = 15;
+static int s_Duration = 0;
+static NETADDR s_MasterAddr;
+
+static int s_Heartbeats = 0;
+static int s_Checks = 0;
+static int s_Oks = 0;
+static int s_Errors = 0;
+
+static void SendConnless(NETSOCKET Socket, NETADDR *pAddr, const unsigned char *pData, int Size)
+{
+	CNetBase::SendPacketConnless(Socket, pAddr, pData, Size);
+}
+
+static bool IsMsg(const CNetPacketConstruct *pPacket, const unsigned char *pMsg, int Size)
+{
+	return pPacket->m_DataSize >= Size && mem_comp(pPacket->m_aChunkData, pMsg, Size) == 0;
+}
+
+static void RaiseFileLimit(int Wanted)
+{
+#if defined(CONF_FAMILY_UNIX)
+	struct rlimit Limit;
+	if(getrlimit(RLIMIT_NOFILE, &Limit) == 0 && Limit.rlim_cur < (rlim_t)Wanted)
+	{
+		Limit.rlim_cur = Limit.rlim_max < (rlim_t)Wanted ? Limit.rlim_max : (rlim_t)Wanted;
+		setrlimit(RLIMIT_NOFILE, &Limit);
+		dbg_msg("loadgen", "file limit is %d", (int)Limit.rlim_cur);
+	}
+#endif
+}
+
+static void GrowRecvBuffer(NETSOCKET Socket)
+{
+	// the full list is sent in one burst, which is more than the default buffer holds
+#if defined(CONF_FAMILY_UNIX)
+	int Size = 4*1024*1024;
+	setsockopt(Socket.ipv4sock, SOL_SOCKET, SO_RCVBUF, (const char *)&Size, sizeof(Size));
+#endif
+}
+
+static void PollServer(CFakeServer *pServer)
+{
+	unsigned char aBuffer[NET_MAX_PACKETSIZE];
+	NETADDR Addr;
+	CNetPacketConstruct Packet;
+
+	while(1)
+	{
+		int Bytes = net_udp_recv(pServer->m_Socket, &Addr, aBuffer, sizeof(aBuffer));
+		if(Bytes <= 0)
+			break;
+		if(CNetBase::UnpackPacket(aBuffer, Bytes, &Packet) != 0 || !(Packet.m_Flags&NET_PACKETFLAG_CONNLESS))
+			continue;
+
+		if(IsMsg(&Packet, SERVERBROWSE_FWCHECK, sizeof(SERVERBROWSE_FWCHECK)))
+		{
+			SendConnless(pServer->m_Socket, &Addr, SERVERBROWSE_FWRESPONSE, sizeof(SERVERBROWSE_FWRESPONSE));
+			s_Checks++;
+		}
+		else if(IsMsg(&Packet, SERVERBROWSE_FWOK, sizeof(SERVERBROWSE_FWOK)))
+		{
+			if(!pServer->m_Registered)
+				s_Oks++;
+			pServer->m_Registered = true;
+		}
+		else if(IsMsg(&Packet, SERVERBROWSE_FWERROR, sizeof(SERVERBROWSE_FWERROR)))
+			s_Errors++;
+	}
+}
+
+static void QueryMaster(NETSOCKET Socket)
+{
+	SendConnless(Socket, &s_MasterAddr, SERVERBROWSE_GETCOUNT, sizeof(SERVERBROWSE_GETCOUNT));
+	SendConnless(Socket, &s_MasterAddr, SERVERBROWSE_GETLIST, sizeof(SERVERBROWSE_GETLIST));
+}
+
+static void PollMaster(NETSOCKET Socket, int *pCount, int *pListed, int *pPackets)
+{
+	unsigned char aBuffer[NET_MAX_PACKETSIZE];
+	NETADDR Addr;
+	CNetPacketConstruct Packet;
+
+	while(1)
+	{
+		int Bytes = net_udp_recv(Socket, &Addr, aBuffer, sizeof(aBuffer));
+		if(Bytes <= 0)
+			break;
+		if(CNetBase::UnpackPacket(aBuffer, Bytes, &Packet) != 0 || !(Packet.m_Flags&NET_PACKETFLAG_CONNLESS))
+			continue;
+
+		if(IsMsg(&Packet, SERVERBROWSE_COUNT, sizeof(SERVERBROWSE_COUNT)) && Packet.m_DataSize >= (int)sizeof(SERVERBROWSE_COUNT)+2)
+			*pCount = (Packet.m_aChunkData[sizeof(SERVERBROWSE_COUNT)]<<8) | Packet.m_aChunkData[sizeof(SERVERBROWSE_COUNT)+1];
+		else if(IsMsg(&Packet, SERVERBROWSE_LIST, sizeof(SERVERBROWSE_LIST)))
+		{
+			*pListed += (Packet.m_DataSize-sizeof(SERVERBROWSE_LIST))/sizeof(CMastersrvAddr);
+			(*pPackets)++;
+		}
+	}
+}
+
+static int Run()
+{
+	RaiseFileLimit(s_NumServers+64);
+
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_IPV4;
+
+	NETSOCKET QuerySocket = net_udp_create(BindAddr);
+	if(QuerySocket.type == NETTYPE_INVALID)
+	{
+		dbg_msg("loadgen", "couldn't open query socket");
+		return -1;
+	}
+	GrowRecvBuffer(QuerySocket);
+
+	// every fake server needs its own port, the master identifies servers by address
+	s_pServers = (CFakeServer *)mem_alloc(sizeof(CFakeServer)*s_NumServers, 1);
+	int64 Now = time_get();
+	for(int i = 0; i < s_NumServers; i++)
+	{
+		s_pServers[i].m_Socket = net_udp_create(BindAddr);
+		if(s_pServers[i].m_Socket.type == NETTYPE_INVALID)
+		{
+			dbg_msg("loadgen", "couldn't open socket %d, running with %d servers", i, i);
+			s_NumServers = i;
+			break;
+		}
+		// spread the first heartbeats over one interval
+		s_pServers[i].m_NextHeartbeat = Now + time_freq()*s_Interval*i/s_NumServers;
+		s_pServers[i].m_Registered = false;
+	}
+
+	dbg_msg("loadgen", "simulating %d servers, heartbeat every %ds", s_NumServers, s_Interval);
+
+	unsigned char aHeartbeat[sizeof(SERVERBROWSE_HEARTBEAT)+2];
+	mem_copy(aHeartbeat, SERVERBROWSE_HEARTBEAT, sizeof(SERVERBROWSE_HEARTBEAT));
+	aHeartbeat[sizeof(SERVERBROWSE_HEARTBEAT)] = 0;
+	aHeartbeat[sizeof(SERVERBROWSE_HEARTBEAT)+1] = 0;
+
+	int64 StartTime = time_get();
+	int64 NextReport = StartTime + time_freq();
+	int Count = -1, Listed = 0, Packets = 0;
+
+	while(s_Duration <= 0 || time_get() < StartTime + time_freq()*s_Duration)
+	{
+		Now = time_get();
+		for(int i = 0; i < s_NumServers; i++)
+		{
+			CFakeServer *pServer = &s_pServers[i];
+			if(Now >= pServer->m_NextHeartbeat)
+			{
+				SendConnless(pServer->m_Socket, &s_MasterAddr, aHeartbeat, sizeof(aHeartbeat));
+				pServer->m_NextHeartbeat = Now + time_freq()*s_Interval;
+				s_Heartbeats++;
+			}
+			PollServer(pServer);
+		}
+		PollMaster(QuerySocket, &Count, &Listed, &Packets);
+
+		if(Now >= NextReport)
+		{
+			dbg_msg("loadgen", "%ds: heartbeats=%d checks=%d registered=%d errors=%d | master count=%d listed=%d in %d packets",
+				(int)((Now-StartTime)/time_freq()), s_Heartbeats, s_Checks, s_Oks, s_Errors, Count, Listed, Packets);
+			s_Heartbeats = 0;
+			s_Checks = 0;
+			Listed = 0;
+			Packets = 0;
+			QueryMaster(QuerySocket);
+			NextReport += time_freq();
+
+			// the list comes in a burst, read it right away so it doesn't overflow the socket buffer
+			int64 ListEnd = time_get() + time_freq()/10;
+			while(time_get() < ListEnd)
+			{
+				net_socket_read_wait(QuerySocket, 10);
+				PollMaster(QuerySocket, &Count, &Listed, &Packets);
+			}
+		}
+
+		net_socket_read_wait_us(QuerySocket, 1000);
+	}
+
+	for(int i = 0; i < s_NumServers; i++)
+		net_udp_close(s_pServers[i].m_Socket);
+	net_udp_close(QuerySocket);
+	mem_free(s_pServers);
+	return 0;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	net_init();
+	CNetBase::Init();
+
+	net_host_lookup("localhost", &s_MasterAddr, NETTYPE_IPV4);
+	s_MasterAddr.port = MASTERSERVER_PORT;
+
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-m") == 0 && i+1 < argc) // ignore_convention
+		{
+			if(net_host_lookup(argv[++i], &s_MasterAddr, NETTYPE_IPV4) != 0) // ignore_convention
+			{
+				dbg_msg("loadgen", "couldn't resolve master '%s'", argv[i]); // ignore_convention
+				return -1;
+			}
+			if(!s_MasterAddr.port)
+				s_MasterAddr.port = MASTERSERVER_PORT;
+		}
+		else if(str_comp(argv[i], "-n") == 0 && i+1 < argc) // ignore_convention
+			s_NumServers = max(str_toint(argv[++i]), 1); // ignore_convention
+		else if(str_comp(argv[i], "-i") == 0 && i+1 < argc) // ignore_convention
+			s_Interval = max(str_toint(argv[++i]), 1); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			s_Duration = str_toint(argv[++i]); // ignore_convention
+		else
+		{
+			dbg_msg("loadgen", "usage: %s [-m master[:port]] [-n servers] [-i heartbeat interval] [-t seconds]", argv[0]); // ignore_convention
+			return -1;
+		}
+	}
+
+	return Run();
+}